@@ -30,6 +30,8 @@
  */
 
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <pwd.h>
@@ -40,6 +42,7 @@
 #include "commons.h"
 #include "data-types.h"
 #include "generator.h"
+#include "request_channel.h"
 #include "sgx_urts.h"
 #include "Enclave_u.h"
 
@@ -69,6 +72,105 @@ int initialize_enclave(void) {
     return 0;
 }
 
+/**
+ * Runs the preloaded join and ships its materialized result into a host buffer with ecall_export_join_result.
+ */
+sgx_status_t export_join_result(const args_t *params, const joinconfig_t *config) {
+    uint64_t export_size = 0;
+    sgx_status_t ret = ecall_join_preload_export(global_eid, params->algorithm_name, config, &export_size);
+    if (ret != SGX_SUCCESS) {
+        return ret;
+    }
+
+    if (params->encrypt_export) {
+        // Stand-in for a key agreed on with the consumer of the results
+        uint8_t key[16];
+        for (auto &byte : key) {
+            byte = static_cast<uint8_t>(rand());
+        }
+        ret = ecall_set_export_key(global_eid, key);
+        if (ret != SGX_SUCCESS) {
+            return ret;
+        }
+    }
+
+    auto buffer = static_cast<uint8_t *>(aligned_alloc(64, std::max<uint64_t>((export_size + 63) / 64 * 64, 64)));
+    export_descriptor_t descriptor{};
+    sgx_status_t export_status = SGX_SUCCESS;
+    struct timespec t1, t2;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ret = ecall_export_join_result(global_eid, &export_status, buffer, export_size, params->encrypt_export,
+                                   (int) params->nthreads, &descriptor);
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    if (ret == SGX_SUCCESS) {
+        ret = export_status;
+    }
+    if (ret == SGX_SUCCESS) {
+        double time_s = (double) (t2.tv_sec - t1.tv_sec) + (double) (t2.tv_nsec - t1.tv_nsec) / 1e9;
+        logger(INFO, "Exported %lu tuples in %lu chunks, %.2lf MB %s in %.4fs", descriptor.num_tuples,
+               descriptor.num_chunks, B_TO_MB(descriptor.bytes_written),
+               descriptor.encrypted ? "encrypted" : "plain", time_s);
+    }
+    free(buffer);
+    return ret;
+}
+
+/**
+ * Runs the joins requested on stdin or the socket of --socket on the preloaded relations until "quit" or the end of
+ * the input. A request is "<algorithm> [threads]", e.g. "CHT 8", threads default to and are limited by -n. Every
+ * request is answered with one line holding its number of matches, time and throughput, or an error.
+ */
+static sgx_status_t
+serve_joins(const args_t *params, joinconfig_t config) {
+    request_channel_t channel;
+    if (open_request_channel(&channel, params->socket_path[0] != '\0' ? params->socket_path : nullptr) != 0) {
+        return SGX_ERROR_UNEXPECTED;
+    }
+    char line[256];
+    uint64_t served = 0;
+    while (next_request(&channel, line, sizeof(line))) {
+        char algorithm[128]{};
+        int nthreads = (int) params->nthreads;
+        if (sscanf(line, "%127s %d", algorithm, &nthreads) < 1) {
+            continue;
+        }
+        if (strcmp(algorithm, "quit") == 0) {
+            break;
+        }
+        if (nthreads < 1) {
+            reply(&channel, "ERROR malformed request: %s", line);
+            continue;
+        }
+        // checked here, the enclave exits on an unknown algorithm and sizes thread arrays by the thread count
+        if (!is_join_algorithm(algorithm)) {
+            reply(&channel, "ERROR unknown join algorithm: %s", algorithm);
+            continue;
+        }
+        if (nthreads > (int) params->nthreads) {
+            reply(&channel, "ERROR %d threads requested, at most %u (-n)", nthreads, params->nthreads);
+            continue;
+        }
+
+        config.NTHREADS = nthreads;
+        int64_t matches = 0;
+        struct timespec t1, t2;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        sgx_status_t ret = ecall_join_preload(global_eid, algorithm, &config, &matches);
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        if (ret != SGX_SUCCESS) {
+            close_request_channel(&channel);
+            return ret;
+        }
+        double time_s = (double) (t2.tv_sec - t1.tv_sec) + (double) (t2.tv_nsec - t1.tv_nsec) / 1e9;
+        reply(&channel, "%s %d threads: %ld matches in %.4fs (%.2lf M rec/s)", algorithm, nthreads, matches, time_s,
+              (double) (params->r_size + params->s_size) / time_s / 1e6);
+        served++;
+    }
+    close_request_channel(&channel);
+    logger(INFO, "Served %lu requests", served);
+    return SGX_SUCCESS;
+}
+
 /* Application entry */
 int SGX_CDECL main(int argc, char *argv[]) {
     clock_gettime(CLOCK_MONOTONIC, &ts_start);
@@ -96,6 +198,8 @@ int SGX_CDECL main(int argc, char *argv[]) {
     params.r_from_path = 0;
     params.s_from_path = 0;
     params.materialize = 0;
+    params.serve = 0;
+    params.socket_path[0] = '\0';
     strcpy(params.algorithm_name, "RHO");
 
     initLogger();
@@ -185,7 +289,14 @@ int SGX_CDECL main(int argc, char *argv[]) {
     config.MATERIALIZE = params.materialize;
     config.ALLOC_CORE = params.alloc_core;
 
-    ret = ecall_join_preload(global_eid, params.algorithm_name, &config);
+    if (params.serve) {
+        ret = serve_joins(&params, config);
+    } else if (params.export_result) {
+        ret = export_join_result(&params, &config);
+    } else {
+        int64_t matches = 0;
+        ret = ecall_join_preload(global_eid, params.algorithm_name, &config, &matches);
+    }
 
     clock_gettime(CLOCK_MONOTONIC, &tw2);
     double time_s = (((double) cpu_counter / CPMS) / 1000000.0);
@@ -1,192 +1,169 @@
+#include "ColumnFile.hpp"
 #include "Logger.hpp"
 #include "TpcHCommons.hpp"
-#include <algorithm>
+#include "TpcHGenerator.hpp"
 #include <filesystem>
-#include <fstream>
-#include <ranges>
-#include <span>
 #include <thread>
 
-template<class T>
-[[gnu::always_inline]] inline char *
-byte_cast(T *in) {
-    return reinterpret_cast<char *>(in);  //NOSONAR
-}
-
-void
-store_binary(std::span<char> data, const std::string &path) {
-    std::basic_ofstream<char> output{path, std::ios::binary};
-    std::ranges::copy(data, std::ostreambuf_iterator<char>(output));
-}
-
+/** Writes the columns of a table into its column file next to the .tbl file */
 void
-store_size(const std::string &path, uint64_t size) {
-    std::ofstream size_file{path + "/size"};
-    size_file << size;
-    size_file.close();
-}
-
-void
-store_orders(const OrdersTable &o, int scale_factor) {
-    if (o.numTuples == 0) {
-        logger(INFO, "Skipping Orders");
+store_table(const std::string &name, const std::string &path, uint64_t num_tuples,
+            const std::vector<ColumnSource> &columns) {
+    if (num_tuples == 0) {
+        logger(INFO, "Skipping %s", name.c_str());
         return;
     }
 
-    logger(INFO, "Writing Orders Table");
-
-    auto path = getPath(scale_factor, ORDERS_TBL) + ".dir";
-    std::filesystem::create_directory(path);
-    store_size(path, o.numTuples);
-
-    if (o.o_orderkey != nullptr) {
-        store_binary({byte_cast(o.o_orderkey), o.numTuples * sizeof(tuple_t)},
-                     path + "/o_orderkey.bin");
-    }
-    if (o.o_custkey != nullptr) {
-        store_binary({byte_cast(o.o_custkey), o.numTuples * sizeof(type_key)},
-                     path + "/o_custkey.bin");
-    }
-    if (o.o_orderdate != nullptr) {
-        store_binary({byte_cast(o.o_orderdate), o.numTuples * sizeof(uint64_t)},
-                     path + "/o_orderdate.bin");
+    logger(INFO, "Writing %s Table", name.c_str());
+    if (write_column_file(path + COLUMN_FILE_SUFFIX, num_tuples, columns) == 0) {
+        logger(INFO, "Done");
     }
+}
 
-    logger(INFO, "Done");
+void
+store_orders(const OrdersTable &o, int scale_factor) {
+    store_table("Orders", getPath(scale_factor, ORDERS_TBL), o.numTuples,
+                {column_source("o_orderkey", o.o_orderkey),
+                 column_source("o_custkey", o.o_custkey),
+                 column_source("o_orderdate", o.o_orderdate, o.o_orderdate_zones),
+                 column_source("o_orderdate_days", o.o_orderdate_days, o.o_orderdate_days_zones, ENCODING_DAYS),
+                 column_source("o_orderpriority", o.o_orderpriority),
+                 dictionary_source("o_orderpriority", o.o_orderpriority_dict),
+                 column_source("o_shippriority", o.o_shippriority)});
 }
 
 void
 store_customers(const CustomerTable &c, int scale_factor) {
-    if (c.numTuples == 0) {
-        logger(INFO, "Skipping Customers");
-        return;
-    }
-
-    logger(INFO, "Writing Customers Table");
-
-    auto path = getPath(scale_factor, CUSTOMER_TBL) + ".dir";
-    std::filesystem::create_directory(path);
-    store_size(path, c.numTuples);
-
-    if (c.c_custkey != nullptr) {
-        store_binary({byte_cast(c.c_custkey), c.numTuples * sizeof(tuple_t)},
-                     path + "/c_custkey.bin");
-    }
-    if (c.c_mktsegment != nullptr) {
-        store_binary({byte_cast(c.c_mktsegment), c.numTuples * sizeof(uint8_t)},
-                     path + "/c_mktsegment.bin");
-    }
-    if (c.c_nationkey != nullptr) {
-        store_binary({byte_cast(c.c_nationkey), c.numTuples * sizeof(type_key)},
-                     path + "/c_nationkey.bin");
-    }
-
-    logger(INFO, "Done");
+    store_table("Customers", getPath(scale_factor, CUSTOMER_TBL), c.numTuples,
+                {column_source("c_custkey", c.c_custkey),
+                 column_source("c_mktsegment", c.c_mktsegment),
+                 dictionary_source("c_mktsegment", c.c_mktsegment_dict),
+                 column_source("c_nationkey", c.c_nationkey)});
 }
 
 void
 store_parts(const PartTable &p, int scale_factor) {
-    if (p.numTuples == 0) {
-        logger(INFO, "Skipping Parts");
-        return;
-    }
-
-    logger(INFO, "Writing Parts Table");
-
-    auto path = getPath(scale_factor, PART_TBL) + ".dir";
-    std::filesystem::create_directory(path);
-    store_size(path, p.numTuples);
-
-    if (p.p_partkey != nullptr) {
-        store_binary({byte_cast(p.p_partkey), p.numTuples * sizeof(tuple_t)},
-                     path + "/p_partkey.bin");
-    }
-    if (p.p_brand != nullptr) {
-        store_binary({byte_cast(p.p_brand), p.numTuples * sizeof(uint8_t)}, path + "/p_brand.bin");
-    }
-    if (p.p_container != nullptr) {
-        store_binary({byte_cast(p.p_container), p.numTuples * sizeof(uint8_t)},
-                     path + "/p_container.bin");
-    }
-    if (p.p_size != nullptr) {
-        store_binary({byte_cast(p.p_size), p.numTuples * sizeof(uint32_t)}, path + "/p_size.bin");
-    }
-
-    logger(INFO, "Done");
+    store_table("Parts", getPath(scale_factor, PART_TBL), p.numTuples,
+                {column_source("p_partkey", p.p_partkey),
+                 column_source("p_brand", p.p_brand),
+                 dictionary_source("p_brand", p.p_brand_dict),
+                 column_source("p_container", p.p_container),
+                 dictionary_source("p_container", p.p_container_dict),
+                 column_source("p_size", p.p_size),
+                 column_source("p_name", p.p_name)});
 }
 
 void
 store_nations(const NationTable &n, int scale_factor) {
-    if (n.numTuples == 0) {
-        logger(INFO, "Skipping Nations");
-        return;
-    }
-
-    logger(INFO, "Writing Nations Table");
+    store_table("Nations", getPath(scale_factor, NATION_TBL), n.numTuples,
+                {column_source("n_nationkey", n.n_nationkey),
+                 column_source("n_regionkey", n.n_regionkey)});
+}
 
-    auto path = getPath(scale_factor, NATION_TBL) + ".dir";
-    std::filesystem::create_directory(path);
-    store_size(path, n.numTuples);
+void
+store_suppliers(const SupplierTable &s, int scale_factor) {
+    store_table("Suppliers", getPath(scale_factor, SUPPLIER_TBL), s.numTuples,
+                {column_source("s_suppkey", s.s_suppkey),
+                 column_source("s_nationkey", s.s_nationkey)});
+}
 
-    if (n.n_nationkey != nullptr) {
-        store_binary({byte_cast(n.n_nationkey), n.numTuples * sizeof(tuple_t)},
-                     path + "/n_nationkey.bin");
-    }
+void
+store_regions(const RegionTable &r, int scale_factor) {
+    store_table("Regions", getPath(scale_factor, REGION_TBL), r.numTuples,
+                {column_source("r_regionkey", r.r_regionkey),
+                 column_source("r_name", r.r_name),
+                 dictionary_source("r_name", r.r_name_dict)});
+}
 
-    logger(INFO, "Done");
+void
+store_partsupps(const PartSuppTable &ps, int scale_factor) {
+    store_table("PartSupps", getPath(scale_factor, PARTSUPP_TBL), ps.numTuples,
+                {column_source("ps_partkey", ps.ps_partkey),
+                 column_source("ps_suppkey", ps.ps_suppkey),
+                 column_source("ps_supplycost", ps.ps_supplycost),
+                 column_source("ps_supplycost_dec", ps.ps_supplycost_dec, nullptr, ENCODING_DECIMAL)});
 }
 
 void
 store_lineitem(const LineItemTable &l, int scale_factor) {
-    if (l.numTuples == 0) {
-        logger(INFO, "Skipping LineItems");
-        return;
-    }
-
-    logger(INFO, "Writing Lineitem Table");
-
-    auto path = getPath(scale_factor, LINEITEM_TBL) + ".dir";
-    std::filesystem::create_directory(path);
-    store_size(path, l.numTuples);
+    store_table("Lineitem", getPath(scale_factor, LINEITEM_TBL), l.numTuples,
+                {column_source("l_orderkey", l.l_orderkey),
+                 column_source("l_shipmode", l.l_shipmode),
+                 dictionary_source("l_shipmode", l.l_shipmode_dict),
+                 column_source("l_shipinstruct", l.l_shipinstruct),
+                 dictionary_source("l_shipinstruct", l.l_shipinstruct_dict),
+                 column_source("l_returnflag", l.l_returnflag),
+                 column_source("l_quantity", l.l_quantity),
+                 column_source("l_quantity_u8", l.l_quantity_u8, nullptr, ENCODING_NARROW),
+                 column_source("l_partkey", l.l_partkey),
+                 column_source("l_commitdate", l.l_commitdate, l.l_commitdate_zones),
+                 column_source("l_shipdate", l.l_shipdate, l.l_shipdate_zones),
+                 column_source("l_receiptdate", l.l_receiptdate, l.l_receiptdate_zones),
+                 column_source("l_commitdate_days", l.l_commitdate_days, l.l_commitdate_days_zones, ENCODING_DAYS),
+                 column_source("l_shipdate_days", l.l_shipdate_days, l.l_shipdate_days_zones, ENCODING_DAYS),
+                 column_source("l_receiptdate_days", l.l_receiptdate_days, l.l_receiptdate_days_zones, ENCODING_DAYS),
+                 column_source("l_extendedprice", l.l_extendedprice),
+                 column_source("l_discount", l.l_discount),
+                 column_source("l_tax", l.l_tax),
+                 column_source("l_quantity_dec", l.l_quantity_dec, nullptr, ENCODING_DECIMAL),
+                 column_source("l_extendedprice_dec", l.l_extendedprice_dec, nullptr, ENCODING_DECIMAL),
+                 column_source("l_discount_dec", l.l_discount_dec, nullptr, ENCODING_DECIMAL),
+                 column_source("l_tax_dec", l.l_tax_dec, nullptr, ENCODING_DECIMAL),
+                 column_source("l_linestatus", l.l_linestatus),
+                 column_source("l_suppkey", l.l_suppkey)});
+}
 
-    if (l.l_orderkey != nullptr) {
-        store_binary({byte_cast(l.l_orderkey), l.numTuples * sizeof(tuple_t)},
-                     path + "/l_orderkey.bin");
-    }
-    if (l.l_shipmode != nullptr) {
-        store_binary({byte_cast(l.l_shipmode), l.numTuples * sizeof(uint8_t)},
-                     path + "/l_shipmode.bin");
-    }
-    if (l.l_shipinstruct != nullptr) {
-        store_binary({byte_cast(l.l_shipinstruct), l.numTuples * sizeof(uint8_t)},
-                     path + "/l_shipinstruct.bin");
-    }
-    if (l.l_returnflag != nullptr) {
-        store_binary({byte_cast(l.l_returnflag), l.numTuples * sizeof(char)},
-                     path + "/l_returnflag.bin");
-    }
-    if (l.l_quantity != nullptr) {
-        store_binary({byte_cast(l.l_quantity), l.numTuples * sizeof(float)},
-                     path + "/l_quantity.bin");
+/** Generates the tables of the scale factor and writes their column files, without .tbl files */
+int
+generate_binary_tables(const tcph_args_t &params) {
+    const int scale = params.scale;
+    std::filesystem::create_directories(std::filesystem::path{getPath(scale, LINEITEM_TBL)}.parent_path());
+
+    OrdersTable o{};
+    LineItemTable l{};
+    if (generate_orders_and_lineitems(&o, &l, params.scale, params.nthreads) != 0) {
+        return 1;
     }
-    if (l.l_partkey != nullptr) {
-        store_binary({byte_cast(l.l_partkey), l.numTuples * sizeof(type_key)},
-                     path + "/l_partkey.bin");
+    store_orders(o, scale);
+    store_lineitem(l, scale);
+    free_orders(&o);
+    free_lineitem(&l);
+
+    CustomerTable c{};
+    if (generate_customers(&c, params.scale, params.nthreads) != 0) {
+        return 1;
     }
-    if (l.l_commitdate != nullptr) {
-        store_binary({byte_cast(l.l_commitdate), l.numTuples * sizeof(uint64_t)},
-                     path + "/l_commitdate.bin");
+    store_customers(c, scale);
+    free_customer(&c);
+
+    PartTable p{};
+    if (generate_parts(&p, params.scale, params.nthreads) != 0) {
+        return 1;
     }
-    if (l.l_shipdate != nullptr) {
-        store_binary({byte_cast(l.l_shipdate), l.numTuples * sizeof(uint64_t)},
-                     path + "/l_shipdate.bin");
+    store_parts(p, scale);
+    free_part(&p);
+
+    PartSuppTable ps{};
+    if (generate_partsupps(&ps, params.scale, params.nthreads) != 0) {
+        return 1;
     }
-    if (l.l_receiptdate != nullptr) {
-        store_binary({byte_cast(l.l_receiptdate), l.numTuples * sizeof(uint64_t)},
-                     path + "/l_receiptdate.bin");
+    store_partsupps(ps, scale);
+    free_partsupp(&ps);
+
+    SupplierTable s{};
+    NationTable n{};
+    RegionTable r{};
+    if (generate_suppliers(&s, params.scale, params.nthreads) != 0 || generate_nations(&n) != 0 ||
+        generate_regions(&r) != 0) {
+        return 1;
     }
-
-    logger(INFO, "Done");
+    store_suppliers(s, scale);
+    store_nations(n, scale);
+    store_regions(r, scale);
+    free_supplier(&s);
+    free_nation(&n);
+    free_region(&r);
+    return 0;
 }
 
 int
@@ -197,11 +174,16 @@ main(int argc, char *argv[]) {
     tcph_args_t params;
     tpch_parse_args(argc, argv, &params);
 
+    if (params.generate) {
+        logger(INFO, "Generating tables of scale factor %d", params.scale);
+        return generate_binary_tables(params);
+    }
+
     logger(INFO, "Transforming columns for query %d scale factor %d", params.query, params.scale);
 
     std::jthread lineitem_thread{[&params] {
         LineItemTable l{};
-        load_lineitem_from_csv(&l, params.scale);
+        load_lineitem_from_csv(&l, params.scale, params.nthreads);
         store_lineitem(l, params.scale);
         free_lineitem(&l);
     }};
@@ -212,7 +194,7 @@ main(int argc, char *argv[]) {
 
     std::jthread orders_thread {[&params] {
         OrdersTable o{};
-        load_orders_from_csv(&o, params.scale);
+        load_orders_from_csv(&o, params.scale, params.nthreads);
         store_orders(o, params.scale);
         free_orders(&o);
     }};
@@ -223,7 +205,7 @@ main(int argc, char *argv[]) {
 
     std::jthread customer_thread {[&params] {
         CustomerTable c{};
-        load_customer_from_csv(&c, params.scale);
+        load_customer_from_csv(&c, params.scale, params.nthreads);
         store_customers(c, params.scale);
         free_customer(&c);
     }};
@@ -234,7 +216,7 @@ main(int argc, char *argv[]) {
 
     std::jthread part_thread{[&params] {
         PartTable p{};
-        load_part_from_csv(&p, params.scale);
+        load_part_from_csv(&p, params.scale, params.nthreads);
         store_parts(p, params.scale);
         free_part(&p);
     }};
@@ -245,7 +227,7 @@ main(int argc, char *argv[]) {
 
     std::jthread nation_thread{[&params] {
         NationTable n{};
-        load_nation_from_csv(&n, params.scale);
+        load_nation_from_csv(&n, params.scale, params.nthreads);
         store_nations(n, params.scale);
         free_nation(&n);
     }};
@@ -253,4 +235,37 @@ main(int argc, char *argv[]) {
     if (!params.parallel) {
         nation_thread.join();
     }
+
+    std::jthread supplier_thread{[&params] {
+        SupplierTable s{};
+        load_supplier_from_csv(&s, params.scale, params.nthreads);
+        store_suppliers(s, params.scale);
+        free_supplier(&s);
+    }};
+
+    if (!params.parallel) {
+        supplier_thread.join();
+    }
+
+    std::jthread region_thread{[&params] {
+        RegionTable r{};
+        load_region_from_csv(&r, params.scale, params.nthreads);
+        store_regions(r, params.scale);
+        free_region(&r);
+    }};
+
+    if (!params.parallel) {
+        region_thread.join();
+    }
+
+    std::jthread partsupp_thread{[&params] {
+        PartSuppTable ps{};
+        load_partsupp_from_csv(&ps, params.scale, params.nthreads);
+        store_partsupps(ps, params.scale);
+        free_partsupp(&ps);
+    }};
+
+    if (!params.parallel) {
+        partsupp_thread.join();
+    }
 }
\ No newline at end of file
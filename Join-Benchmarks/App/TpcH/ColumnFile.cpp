@@ -0,0 +1,321 @@
+#include "ColumnFile.hpp"
+#include "Dictionary.hpp"
+#include "Logger.hpp"
+#include "TpcHCommons.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace {
+
+std::mutex mappings_mutex;
+std::unordered_map<void *, uint64_t> mappings; // address -> length of the column mappings
+
+uint64_t
+align_up(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Maps size bytes at offset of the file and faults them in. MAP_POPULATE would write-fault every page of a private
+ * writable mapping and copy it, MADV_POPULATE_READ maps the pages of the page cache without a copy. Joins that
+ * reorder their input in place (CrkJoin) still get private copies of the pages they write.
+ */
+void *
+map_region(int fd, uint64_t offset, uint64_t size) {
+    const uint64_t length = std::max<uint64_t>(size, 1);
+    void *region = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>(offset));
+    if (region == MAP_FAILED) {
+        return nullptr;
+    }
+    if (length >= COLUMN_HUGE_PAGE_SIZE) {
+        madvise(region, length, MADV_HUGEPAGE);
+    }
+#ifdef MADV_POPULATE_READ
+    if (madvise(region, length, MADV_POPULATE_READ) != 0)
+#endif
+    {
+        madvise(region, length, MADV_WILLNEED);
+    }
+    std::lock_guard lock{mappings_mutex};
+    mappings[region] = length;
+    return region;
+}
+
+/** Whether [offset, offset + size) lies within a file of file_size bytes */
+bool
+within_file(uint64_t offset, uint64_t size, uint64_t file_size) {
+    return offset <= file_size && size <= file_size - offset;
+}
+
+/** Writes size bytes at offset of the file, returns false on error */
+bool
+write_fully(int fd, const void *buffer, uint64_t size, uint64_t offset) {
+    const auto *bytes = static_cast<const char *>(buffer);
+    while (size != 0) {
+        const ssize_t written = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<uint64_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+int
+write_column_file(const std::string &path, uint64_t num_tuples, const std::vector<ColumnSource> &columns) {
+    std::vector<const ColumnSource *> sources;
+    for (const ColumnSource &column: columns) {
+        if (column.values != nullptr) {
+            sources.push_back(&column);
+        }
+    }
+
+    ColumnFileHeader header{};
+    std::copy_n(COLUMN_FILE_MAGIC, sizeof(header.magic), header.magic);
+    header.version = COLUMN_FILE_VERSION;
+    header.num_columns = static_cast<uint32_t>(sources.size());
+    header.num_tuples = num_tuples;
+
+    std::vector<ColumnDescriptor> descriptors(sources.size());
+    uint64_t end = sizeof(ColumnFileHeader) + sources.size() * sizeof(ColumnDescriptor);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const ColumnSource &source = *sources[i];
+        ColumnDescriptor &descriptor = descriptors[i];
+        if (source.name.size() >= sizeof(descriptor.name)) {
+            logger(ERROR, "Column name %s is too long", source.name.c_str());
+            return 1;
+        }
+        std::copy(source.name.begin(), source.name.end(), descriptor.name);
+        descriptor.value_size = source.value_size;
+        descriptor.encoding = source.encoding;
+        descriptor.size = source.size != 0 ? source.size : num_tuples * source.value_size;
+        descriptor.alignment = descriptor.size >= COLUMN_HUGE_PAGE_SIZE ? COLUMN_HUGE_PAGE_SIZE : COLUMN_PAGE_SIZE;
+        descriptor.offset = align_up(end, descriptor.alignment);
+        end = descriptor.offset + descriptor.size;
+        if (source.zones != nullptr) {
+            descriptor.num_zones = num_zones(num_tuples);
+            descriptor.zones_offset = align_up(end, COLUMN_PAGE_SIZE);
+            end = descriptor.zones_offset + descriptor.num_zones * sizeof(zone_t);
+        }
+    }
+
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        logger(ERROR, "Failed to create %s", path.c_str());
+        return 1;
+    }
+    bool written = ftruncate(fd, static_cast<off_t>(end)) == 0 &&
+                   write_fully(fd, &header, sizeof(header), 0) &&
+                   write_fully(fd, descriptors.data(), descriptors.size() * sizeof(ColumnDescriptor), sizeof(header));
+
+    // the columns are written in parallel, every one at its own offset of the file
+    std::vector<std::thread> writers;
+    std::vector<char> column_written(sources.size(), 0);
+    for (size_t i = 0; written && i < sources.size(); ++i) {
+        writers.emplace_back([&, i] {
+            const ColumnDescriptor &descriptor = descriptors[i];
+            column_written[i] = write_fully(fd, sources[i]->values, descriptor.size, descriptor.offset) &&
+                                write_fully(fd, sources[i]->zones, descriptor.num_zones * sizeof(zone_t),
+                                            descriptor.zones_offset);
+        });
+    }
+    for (std::thread &writer: writers) {
+        writer.join();
+    }
+    written = written && std::all_of(column_written.begin(), column_written.end(), [](char ok) { return ok; });
+    if (close(fd) != 0 || !written) {
+        logger(ERROR, "Failed to write %s", path.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+ColumnFile::~ColumnFile() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool
+ColumnFile::exists(const std::string &path) {
+    return std::filesystem::exists(path);
+}
+
+int
+ColumnFile::open(const std::string &file_path) {
+    path = file_path;
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        logger(ERROR, "Failed to open %s", path.c_str());
+        return 1;
+    }
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        std::memcmp(header.magic, COLUMN_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        (header.version != COLUMN_FILE_VERSION && header.version != COLUMN_FILE_LEGACY_VERSION)) {
+        logger(ERROR, "%s is not a column file of version %u", path.c_str(), COLUMN_FILE_VERSION);
+        return 1;
+    }
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0) {
+        logger(ERROR, "Failed to stat %s", path.c_str());
+        return 1;
+    }
+    const auto file_size = static_cast<uint64_t>(file_stat.st_size);
+    // checked before the descriptors are allocated, a corrupt count must not size the allocation
+    if (header.num_columns > (file_size - sizeof(header)) / sizeof(ColumnDescriptor)) {
+        logger(ERROR, "%s is too short for its %u columns", path.c_str(), header.num_columns);
+        return 1;
+    }
+    descriptors.resize(header.num_columns);
+    const auto descriptors_size = static_cast<ssize_t>(descriptors.size() * sizeof(ColumnDescriptor));
+    if (pread(fd, descriptors.data(), descriptors_size, sizeof(header)) != descriptors_size) {
+        logger(ERROR, "Failed to read the columns of %s", path.c_str());
+        return 1;
+    }
+
+    for (ColumnDescriptor &descriptor: descriptors) {
+        descriptor.name[sizeof(descriptor.name) - 1] = '\0';
+        uint64_t expected_size;
+        const bool size_matches = descriptor.encoding == ENCODING_DICTIONARY ||
+                                  (!__builtin_mul_overflow(header.num_tuples, descriptor.value_size, &expected_size) &&
+                                   descriptor.size == expected_size);
+        if (descriptor.offset % COLUMN_PAGE_SIZE != 0 || !within_file(descriptor.offset, descriptor.size, file_size) ||
+            !size_matches) {
+            logger(ERROR, "Column %s of %s has %lu bytes at offset %lu, expected %lu rows of %u bytes within %lu bytes",
+                   descriptor.name, path.c_str(), descriptor.size, descriptor.offset, header.num_tuples,
+                   descriptor.value_size, file_size);
+            return 1;
+        }
+        if (descriptor.num_zones != 0 &&
+            (descriptor.num_zones != num_zones(header.num_tuples) || descriptor.zones_offset % COLUMN_PAGE_SIZE != 0 ||
+             !within_file(descriptor.zones_offset, descriptor.num_zones * sizeof(zone_t), file_size))) {
+            logger(ERROR, "Zone map of column %s of %s has %lu zones at offset %lu, expected %lu within %lu bytes",
+                   descriptor.name, path.c_str(), descriptor.num_zones, descriptor.zones_offset,
+                   num_zones(header.num_tuples), file_size);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int
+ColumnFile::map_column(const std::vector<std::string> &columns, const std::string &name, uint32_t value_size,
+                       ColumnEncoding encoding, void **values, zone_t **zones) {
+    if (std::find(columns.begin(), columns.end(), name) == columns.end()) {
+        return 0;
+    }
+    const auto descriptor = std::find_if(descriptors.begin(), descriptors.end(), [&name](const ColumnDescriptor &d) {
+        return std::strncmp(d.name, name.c_str(), sizeof(d.name)) == 0;
+    });
+    if (descriptor == descriptors.end() && encoding != ENCODING_PLAIN) {
+        logger(INFO, "%s has no column %s, the filters scan the plain column", path.c_str(), name.c_str());
+        return 0;
+    }
+    if (descriptor == descriptors.end()) {
+        logger(ERROR, "%s has no column %s", path.c_str(), name.c_str());
+        return 1;
+    }
+    if (descriptor->value_size != value_size || descriptor->encoding != encoding) {
+        logger(ERROR, "Column %s of %s has %u-byte values with encoding %u, expected %u-byte values with encoding %u",
+               name.c_str(), path.c_str(), descriptor->value_size, descriptor->encoding, value_size, encoding);
+        return 1;
+    }
+
+    *values = map_region(fd, descriptor->offset, descriptor->size);
+    if (*values == nullptr) {
+        logger(ERROR, "Failed to map column %s of %s", name.c_str(), path.c_str());
+        return 1;
+    }
+    if (zones == nullptr) {
+        return 0;
+    }
+    if (descriptor->num_zones == 0 && encoding == ENCODING_DAYS) {
+        *zones = build_zone_map(static_cast<const uint16_t *>(*values), header.num_tuples);
+    } else if (descriptor->num_zones == 0) {
+        *zones = build_zone_map(static_cast<const uint64_t *>(*values), header.num_tuples);
+    } else {
+        *zones = static_cast<zone_t *>(
+                map_region(fd, descriptor->zones_offset, descriptor->num_zones * sizeof(zone_t)));
+    }
+    if (*zones == nullptr) {
+        logger(ERROR, "Failed to load the zone map of column %s of %s", name.c_str(), path.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+int
+ColumnFile::map_dictionary(const std::vector<std::string> &columns, const std::string &name,
+                           dictionary_t *dictionary) {
+    if (std::find(columns.begin(), columns.end(), name) == columns.end()) {
+        return 0;
+    }
+    if (header.version == COLUMN_FILE_LEGACY_VERSION) {
+        return legacy_dictionary(name, dictionary);
+    }
+    const std::string dictionary_name = name + "_dict";
+    const auto descriptor = std::find_if(descriptors.begin(), descriptors.end(), [&](const ColumnDescriptor &d) {
+        return std::strncmp(d.name, dictionary_name.c_str(), sizeof(d.name)) == 0;
+    });
+    if (descriptor == descriptors.end() || descriptor->encoding != ENCODING_DICTIONARY ||
+        descriptor->size < sizeof(uint32_t)) {
+        logger(ERROR, "%s has no dictionary of column %s", path.c_str(), name.c_str());
+        return 1;
+    }
+    if (descriptor->size > UINT32_MAX) {
+        logger(ERROR, "Dictionary of column %s of %s has %lu bytes, at most %u are supported", name.c_str(),
+               path.c_str(), descriptor->size, UINT32_MAX);
+        return 1;
+    }
+    auto values = static_cast<char *>(map_region(fd, descriptor->offset, descriptor->size));
+    if (values == nullptr) {
+        logger(ERROR, "Failed to map the dictionary of column %s of %s", name.c_str(), path.c_str());
+        return 1;
+    }
+    // the values start after the num_values + 1 offsets, which must lie within the dictionary and be in order
+    const auto size = static_cast<uint32_t>(descriptor->size);
+    uint32_t values_offset;
+    std::memcpy(&values_offset, values, sizeof(values_offset));
+    const uint32_t num_values = values_offset / sizeof(uint32_t) - 1;
+    bool valid = values_offset >= sizeof(uint32_t) && values_offset % sizeof(uint32_t) == 0 && values_offset <= size &&
+                 num_values <= MAX_DICTIONARY_VALUES;
+    for (uint32_t i = 1, previous = values_offset; valid && i <= num_values; ++i) {
+        uint32_t offset;
+        std::memcpy(&offset, values + i * sizeof(uint32_t), sizeof(offset));
+        valid = previous <= offset && offset <= size;
+        previous = offset;
+    }
+    if (!valid) {
+        logger(ERROR, "Dictionary of column %s of %s is corrupt", name.c_str(), path.c_str());
+        release_column(values);
+        return 1;
+    }
+    dictionary->values = values;
+    dictionary->num_values = num_values;
+    dictionary->size = size;
+    return 0;
+}
+
+bool
+release_column(void *column) {
+    std::lock_guard lock{mappings_mutex};
+    const auto mapping = mappings.find(column);
+    if (mapping == mappings.end()) {
+        return false;
+    }
+    munmap(mapping->first, mapping->second);
+    mappings.erase(mapping);
+    return true;
+}
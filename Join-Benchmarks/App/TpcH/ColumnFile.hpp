@@ -0,0 +1,150 @@
+#ifndef TPCH_COLUMN_FILE_HPP
+#define TPCH_COLUMN_FILE_HPP
+
+#include "TpcHTypes.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Columnar table file: one file per TPC-H table, written by csv_convert and mapped into memory by the loaders.
+ *
+ *     ColumnFileHeader | ColumnDescriptor[num_columns] | column 0 | zone map of column 0 | column 1 | ...
+ *
+ * Every column and zone map starts at a multiple of its alignment, a page, or a huge page for columns of at least
+ * 2 MiB, so it can be mapped on its own and its address is the address of the mapping.
+ *
+ * The dictionary of a string column is stored as a column of its own, e.g. l_shipmode_dict, which holds the values of
+ * the dictionary_t. Files of version 1 have no dictionaries, their string columns have the codes of
+ * legacy_dictionary().
+ */
+
+/** Appended to the path of the .tbl file */
+const std::string COLUMN_FILE_SUFFIX = ".col";
+
+constexpr char COLUMN_FILE_MAGIC[8] = {'T', 'P', 'C', 'H', 'C', 'O', 'L', 'S'};
+constexpr uint32_t COLUMN_FILE_VERSION = 2;
+constexpr uint32_t COLUMN_FILE_LEGACY_VERSION = 1;
+constexpr uint64_t COLUMN_PAGE_SIZE = 4096;
+constexpr uint64_t COLUMN_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+/** The string columns hold 8-bit codes, so a dictionary has at most 256 values */
+constexpr uint32_t MAX_DICTIONARY_VALUES = 256;
+
+/**
+ * Encoding of the values of a column. The narrow encodings are stored next to the plain column under their own name,
+ * e.g. l_shipdate_days, so the filters can scan them with more values per vector, the decimal encodings likewise,
+ * e.g. l_extendedprice_dec, for exact arithmetic. They are optional, files written before they existed have none and
+ * the queries scan the plain column.
+ */
+enum ColumnEncoding : uint32_t {
+    ENCODING_PLAIN = 0,      // values as they are in memory
+    ENCODING_DAYS = 1,       // dates as uint16_t days since 1970-01-01 instead of uint64_t seconds
+    ENCODING_NARROW = 2,     // integers of a float or wider integer column in a smaller unsigned type
+    ENCODING_DECIMAL = 3,    // values of a float column as fixed-point decimal_t, see TpcHTypes.hpp
+    ENCODING_DICTIONARY = 4, // the values of the dictionary of a string column, not one value per row
+};
+
+struct ColumnFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_columns;
+    uint64_t num_tuples;
+};
+
+struct ColumnDescriptor {
+    char name[32];
+    uint32_t value_size;    // bytes per row
+    uint32_t encoding;      // ColumnEncoding
+    uint64_t alignment;
+    uint64_t offset;        // from the start of the file
+    uint64_t size;          // bytes
+    uint64_t zones_offset;
+    uint64_t num_zones;     // 0 if the column has no zone map
+};
+
+/** A column of an in-memory table to write into a column file, skipped if values is nullptr */
+struct ColumnSource {
+    std::string name;
+    const void *values;
+    uint32_t value_size;
+    const zone_t *zones;
+    ColumnEncoding encoding;
+    uint64_t size = 0; // bytes, 0 for value_size bytes per row
+};
+
+template<typename T>
+[[nodiscard]] ColumnSource
+column_source(const std::string &name, const T *values, const zone_t *zones = nullptr,
+              ColumnEncoding encoding = ENCODING_PLAIN) {
+    return {name, values, sizeof(T), zones, encoding};
+}
+
+/** The dictionary of the string column name */
+[[nodiscard]] inline ColumnSource
+dictionary_source(const std::string &name, const dictionary_t &dictionary) {
+    return {name + "_dict", dictionary.values, 1, nullptr, ENCODING_DICTIONARY, dictionary.size};
+}
+
+/** Writes the columns with num_tuples rows into a column file, returns 0 on success */
+int
+write_column_file(const std::string &path, uint64_t num_tuples, const std::vector<ColumnSource> &columns);
+
+/**
+ * Read access to a column file. The header is read on open(), columns are only mapped when a query references them.
+ * Mapped columns are private copy-on-write mappings of the file, they stay valid after the ColumnFile is destroyed and
+ * are released with release_column().
+ */
+class ColumnFile {
+public:
+    ColumnFile() = default;
+    ColumnFile(const ColumnFile &) = delete;
+    ColumnFile &operator=(const ColumnFile &) = delete;
+    ~ColumnFile();
+
+    [[nodiscard]] static bool
+    exists(const std::string &path);
+
+    /** Reads and checks the header, returns 0 on success */
+    int
+    open(const std::string &path);
+
+    [[nodiscard]] uint64_t
+    num_tuples() const {
+        return header.num_tuples;
+    }
+
+    /**
+     * Maps the column name into *values if it is one of the columns a query reads, otherwise leaves *values untouched.
+     * If zones is given, the zone map of the column is mapped into *zones, or built if the file has none. Columns of a
+     * narrow encoding are left untouched if the file does not have them. Returns 0 on success.
+     */
+    template<typename T>
+    int
+    map(const std::vector<std::string> &columns, const std::string &name, T **values, zone_t **zones = nullptr,
+        ColumnEncoding encoding = ENCODING_PLAIN) {
+        return map_column(columns, name, sizeof(T), encoding, reinterpret_cast<void **>(values), zones);
+    }
+
+    /**
+     * Maps the dictionary of the string column name into *dictionary if the column is one of the columns a query
+     * reads, a file of version 1 gets its legacy_dictionary(). Returns 0 on success.
+     */
+    int
+    map_dictionary(const std::vector<std::string> &columns, const std::string &name, dictionary_t *dictionary);
+
+private:
+    int
+    map_column(const std::vector<std::string> &columns, const std::string &name, uint32_t value_size,
+               ColumnEncoding encoding, void **values, zone_t **zones);
+
+    std::string path;
+    int fd = -1;
+    ColumnFileHeader header{};
+    std::vector<ColumnDescriptor> descriptors;
+};
+
+/** Unmaps column if it was mapped from a column file and returns true, returns false for any other pointer */
+bool
+release_column(void *column);
+
+#endif//TPCH_COLUMN_FILE_HPP
@@ -0,0 +1,124 @@
+#include "Dictionary.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+int
+make_dictionary(const std::vector<std::string> &values, dictionary_t *dictionary) {
+    const uint64_t offsets_size = (values.size() + 1) * sizeof(uint32_t);
+    uint64_t size = offsets_size;
+    for (const std::string &value: values) {
+        size += value.size();
+    }
+    if (size > UINT32_MAX) {
+        logger(ERROR, "Dictionary of %lu values is too large", values.size());
+        return 1;
+    }
+    auto *bytes = static_cast<char *>(malloc(std::max<uint64_t>(size, 1)));
+    if (bytes == nullptr) {
+        logger(ERROR, "malloc error");
+        return 1;
+    }
+    auto *offsets = reinterpret_cast<uint32_t *>(bytes);
+    auto offset = static_cast<uint32_t>(offsets_size);
+    for (size_t i = 0; i < values.size(); ++i) {
+        offsets[i] = offset;
+        std::memcpy(bytes + offset, values[i].data(), values[i].size());
+        offset += static_cast<uint32_t>(values[i].size());
+    }
+    offsets[values.size()] = offset;
+    dictionary->num_values = static_cast<uint32_t>(values.size());
+    dictionary->size = static_cast<uint32_t>(size);
+    dictionary->values = bytes;
+    return 0;
+}
+
+int
+legacy_dictionary(const std::string &column, dictionary_t *dictionary) {
+    static const std::map<std::string, std::vector<std::string>> LEGACY_VALUES{
+            {"l_shipmode", {"", "MAIL", "SHIP", "AIR", "AIR REG"}},
+            {"l_shipinstruct", {"", "DELIVER IN PERSON"}},
+            {"o_orderpriority", {"", "1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED", "5-LOW"}},
+            {"c_mktsegment", {"", "BUILDING"}},
+            {"r_name", {"", "ASIA"}},
+            {"p_brand", {"", "Brand#12", "Brand#23", "Brand#34"}},
+            {"p_container", {"", "SM CASE", "SM BOX", "SM PACK", "SM PKG", "MED BAG", "MED BOX", "MED PKG", "MED PACK",
+                             "LG CASE", "LG BOX", "LG PACK", "LG PKG"}}};
+    const auto values = LEGACY_VALUES.find(column);
+    if (values == LEGACY_VALUES.end()) {
+        logger(ERROR, "Column %s has no legacy codes", column.c_str());
+        return 1;
+    }
+    return make_dictionary(values->second, dictionary);
+}
+
+namespace {
+
+/** FNV-1a */
+uint64_t
+hash_value(std::string_view value) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c: value) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t
+slot_count(uint32_t max_values) {
+    uint64_t count = 1;
+    while (count < 4 * static_cast<uint64_t>(max_values)) {
+        count *= 2;
+    }
+    return count;
+}
+
+} // namespace
+
+DictionaryBuilder::DictionaryBuilder(uint32_t max_values)
+    : max_values(max_values), slot_mask(slot_count(max_values) - 1),
+      slots(new std::atomic<uint32_t>[slot_count(max_values)]()), values(new std::string[max_values]) {}
+
+uint32_t
+DictionaryBuilder::code(std::string_view value) {
+    for (uint64_t slot = hash_value(value) & slot_mask;; slot = (slot + 1) & slot_mask) {
+        uint32_t entry = slots[slot].load(std::memory_order_acquire);
+        if (entry == 0) {
+            std::lock_guard lock{mutex};
+            entry = slots[slot].load(std::memory_order_relaxed);
+            if (entry == 0) {
+                if (num_values == max_values) {
+                    overflow = true;
+                    return 0;
+                }
+                values[num_values] = value;
+                slots[slot].store(++num_values, std::memory_order_release);
+                return num_values - 1;
+            }
+        }
+        if (values[entry - 1] == value) {
+            return entry - 1;
+        }
+    }
+}
+
+int
+DictionaryBuilder::sort(const char *column, std::vector<uint32_t> &ranks, dictionary_t *dictionary) {
+    if (overflow) {
+        logger(ERROR, "Column %s has more than %u values", column, max_values);
+        return 1;
+    }
+    std::vector<uint32_t> order(num_values);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+    std::vector<std::string> sorted;
+    ranks.resize(num_values);
+    for (uint32_t rank = 0; rank < num_values; ++rank) {
+        ranks[order[rank]] = rank;
+        sorted.push_back(values[order[rank]]);
+    }
+    return make_dictionary(sorted, dictionary);
+}
@@ -0,0 +1,80 @@
+#ifndef TPCH_DICTIONARY_HPP
+#define TPCH_DICTIONARY_HPP
+
+#include "TpcHTypes.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Building the dictionaries of the string columns, see dictionary_t in TpcHTypes.hpp. The loaders and the converter
+ * build sorted dictionaries from the data, the generator from the value lists of the specification. The dictionaries
+ * are allocated with malloc() and freed like the columns.
+ */
+
+/** Builds the dictionary in which code i is values[i], returns 0 on success */
+int
+make_dictionary(const std::vector<std::string> &values, dictionary_t *dictionary);
+
+/**
+ * Builds the dictionary of the codes that column files of version 1 and the .dir tables have for column. They only
+ * distinguish the values of the TPC-H queries, code 0 is the empty value, which stands for all other values. Returns 0
+ * on success, 1 if the column has no legacy codes.
+ */
+int
+legacy_dictionary(const std::string &column, dictionary_t *dictionary);
+
+/**
+ * Collects the values of a string column while its rows are parsed in parallel. code() hands out provisional codes in
+ * the order the values are first seen, finish() sorts the values and replaces the provisional codes with their ranks,
+ * so the codes of the dictionary are in the order of its values.
+ */
+class DictionaryBuilder {
+public:
+    /** max_values is the number of codes, 256 for a column of 8-bit codes */
+    explicit DictionaryBuilder(uint32_t max_values = 256);
+
+    /** The provisional code of value, thread-safe. Lookups of known values take no lock. */
+    [[nodiscard]] uint32_t
+    code(std::string_view value);
+
+    /**
+     * Sorts the dictionary, replaces the provisional codes of the num_tuples rows of codes and stores the dictionary.
+     * Returns 0 on success, 1 if column has more than max_values values.
+     */
+    template<typename T>
+    int
+    finish(const char *column, T *codes, uint64_t num_tuples, dictionary_t *dictionary);
+
+private:
+    /** Sorts the values, ranks[code] is the position of value code, returns 0 on success */
+    int
+    sort(const char *column, std::vector<uint32_t> &ranks, dictionary_t *dictionary);
+
+    const uint32_t max_values;
+    const uint64_t slot_mask;
+    std::unique_ptr<std::atomic<uint32_t>[]> slots; // open addressing by hash, code + 1 of a value, 0 marks a free slot
+    std::unique_ptr<std::string[]> values;          // max_values entries, so published values never move
+    uint32_t num_values = 0;
+    bool overflow = false;
+    std::mutex mutex;
+};
+
+template<typename T>
+int
+DictionaryBuilder::finish(const char *column, T *codes, uint64_t num_tuples, dictionary_t *dictionary) {
+    std::vector<uint32_t> ranks;
+    if (sort(column, ranks, dictionary) != 0) {
+        return 1;
+    }
+    for (uint64_t i = 0; i < num_tuples; ++i) {
+        codes[i] = static_cast<T>(ranks[codes[i]]);
+    }
+    return 0;
+}
+
+#endif//TPCH_DICTIONARY_HPP
@@ -0,0 +1,222 @@
+#include "TblFile.hpp"
+#include "Logger.hpp"
+#include "TpcHTypes.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+/** Bytes [0, length) of a 64 byte block, length < 64 for the last block of a chunk */
+[[nodiscard]] uint64_t
+block_mask(uint64_t length) {
+    return length >= 64 ? ~0ull : (1ull << length) - 1;
+}
+
+/**
+ * Masks of the '|' and '\n' bytes of the block of length bytes at block. The last block of a chunk is loaded with a
+ * masked load, which never reads past the end of the mapping.
+ */
+void
+scan_block(const char *block, uint64_t length, uint64_t &delimiters, uint64_t &newlines) {
+#ifdef __AVX512BW__
+    const __mmask64 valid = block_mask(length);
+    const __m512i bytes = _mm512_maskz_loadu_epi8(valid, block);
+    newlines = _mm512_mask_cmpeq_epi8_mask(valid, bytes, _mm512_set1_epi8('\n'));
+    delimiters = _mm512_mask_cmpeq_epi8_mask(valid, bytes, _mm512_set1_epi8('|')) | newlines;
+#else
+    delimiters = 0;
+    newlines = 0;
+    for (uint64_t i = 0; i < std::min<uint64_t>(length, 64); ++i) {
+        newlines |= static_cast<uint64_t>(block[i] == '\n') << i;
+        delimiters |= static_cast<uint64_t>(block[i] == '|' || block[i] == '\n') << i;
+    }
+#endif
+}
+
+/** Rows of the chunk [begin, end), the last line of the file counts even without a '\n' */
+[[nodiscard]] uint64_t
+count_rows(const char *begin, const char *end, bool last_chunk) {
+    uint64_t rows = 0;
+    for (const char *block = begin; block < end; block += 64) {
+        uint64_t delimiters, newlines;
+        scan_block(block, static_cast<uint64_t>(end - block), delimiters, newlines);
+        rows += static_cast<uint64_t>(__builtin_popcountll(newlines));
+    }
+    return rows + (last_chunk && begin < end && end[-1] != '\n');
+}
+
+} // namespace
+
+template<typename T>
+void
+TblRow::number(unsigned field, T &value) const {
+    const std::string_view text = (*this)[field];
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        parse_error(field, "a number");
+    }
+}
+
+template void TblRow::number<uint8_t>(unsigned, uint8_t &) const;
+template void TblRow::number<uint32_t>(unsigned, uint32_t &) const;
+template void TblRow::number<uint64_t>(unsigned, uint64_t &) const;
+template void TblRow::number<float>(unsigned, float &) const;
+
+void
+TblRow::decimal(unsigned field, int64_t &value) const {
+    const std::string_view text = (*this)[field];
+    const bool negative = !text.empty() && text[0] == '-';
+    const char *begin = text.data() + negative;
+    const char *end = text.data() + text.size();
+    const char *point = std::find(begin, end, '.');
+    int64_t units = 0;
+    const auto [units_end, error] = std::from_chars(begin, point, units);
+    bool valid = error == std::errc{} && units_end == point;
+    int64_t fraction = 0;
+    int digits = 0;
+    for (const char *digit = point + (point != end); digit < end; ++digit, ++digits) {
+        valid &= *digit >= '0' && *digit <= '9' && digits < DECIMAL_SCALE;
+        fraction = fraction * 10 + (*digit - '0');
+    }
+    if (!valid) {
+        parse_error(field, "a decimal number");
+        return;
+    }
+    for (; digits < DECIMAL_SCALE; ++digits) {
+        fraction *= 10;
+    }
+    value = (units * DECIMAL_ONE + fraction) * (negative ? -1 : 1);
+}
+
+uint64_t
+TblRow::date(unsigned field) const {
+    const std::string_view text = (*this)[field];
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') {
+        parse_error(field, "a YYYY-MM-DD date");
+        return 0;
+    }
+    return static_cast<uint64_t>(parse_epoch_days(text.data())) * SECONDS_PER_DAY;
+}
+
+void
+TblRow::parse_error(unsigned field, const char *type) const {
+    const std::string_view text = (*this)[field];
+    logger(ERROR, "Failed to parse row %lu: field %u '%.*s' is not %s", index, field, static_cast<int>(text.size()),
+           text.data(), type);
+}
+
+TblFile::~TblFile() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+}
+
+int
+TblFile::open(const std::string &file_path, uint32_t num_threads) {
+    path = file_path;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat status{};
+    if (fd < 0 || fstat(fd, &status) != 0) {
+        logger(ERROR, "Failed to open %s", path.c_str());
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    size = static_cast<uint64_t>(status.st_size);
+    if (size != 0) {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            logger(ERROR, "Failed to map %s", path.c_str());
+            close(fd);
+            return 1;
+        }
+        data = static_cast<char *>(mapping);
+        madvise(data, size, MADV_SEQUENTIAL);
+        madvise(data, size, MADV_WILLNEED);
+    }
+    close(fd);
+
+    // every chunk but the first starts after the first '\n' behind its even share of the file
+    num_threads = std::max<uint32_t>(num_threads, 1);
+    std::vector<const char *> bounds{data};
+    for (uint32_t t = 1; t < num_threads; ++t) {
+        const char *start = std::max<const char *>(bounds.back(), data + size * t / num_threads);
+        const auto *newline = static_cast<const char *>(memchr(start, '\n', static_cast<size_t>(data + size - start)));
+        if (newline == nullptr) {
+            break;
+        }
+        bounds.push_back(newline + 1);
+    }
+    bounds.push_back(data + size);
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    chunks.clear();
+    for (size_t c = 0; c + 1 < bounds.size(); ++c) {
+        chunks.push_back({bounds[c], bounds[c + 1], 0, 0});
+    }
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        threads.emplace_back([this, c] {
+            chunks[c].num_rows = count_rows(chunks[c].begin, chunks[c].end, c + 1 == chunks.size());
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    for (size_t c = 1; c < chunks.size(); ++c) {
+        chunks[c].first_row = chunks[c - 1].first_row + chunks[c - 1].num_rows;
+    }
+    logger(INFO, "File %s has %lu lines", path.c_str(), num_rows());
+    return 0;
+}
+
+void
+TblFile::parse_chunks(RowCallback callback) const {
+    const auto parse_chunk = [callback](const Chunk &chunk) {
+        TblRow row;
+        row.index = chunk.first_row;
+        const char *field = chunk.begin;
+        for (const char *block = chunk.begin; block < chunk.end; block += 64) {
+            uint64_t delimiters, newlines;
+            scan_block(block, static_cast<uint64_t>(chunk.end - block), delimiters, newlines);
+            for (; delimiters != 0; delimiters &= delimiters - 1) {
+                const int offset = __builtin_ctzll(delimiters);
+                const char *delimiter = block + offset;
+                if ((newlines >> offset & 1) == 0) {
+                    row.add(field, delimiter);
+                } else {
+                    // dbgen ends every line with '|', a last field without it is taken as well
+                    if (field < delimiter) {
+                        row.add(field, delimiter);
+                    }
+                    callback.call(callback.context, row);
+                    row.clear();
+                    ++row.index;
+                }
+                field = delimiter + 1;
+            }
+        }
+        if (row.index < chunk.first_row + chunk.num_rows) {
+            if (field < chunk.end) {
+                row.add(field, chunk.end);
+            }
+            callback.call(callback.context, row);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (const Chunk &chunk: chunks) {
+        threads.emplace_back(parse_chunk, std::cref(chunk));
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,141 @@
+#ifndef TPCH_TBL_FILE_HPP
+#define TPCH_TBL_FILE_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Parallel reader of the '|' separated .tbl files of dbgen. The file is mapped read-only and split into one chunk per
+ * thread at line boundaries. Every thread counts the lines of its chunk, the prefix sum of the counts is the index of
+ * the first row of every chunk, so the threads can then parse their chunks independently and write row i of a table
+ * to index i of its columns.
+ *
+ * Lines are split with a delimiter scanner that compares 64 bytes at once against '|' and '\n' and walks the bits of
+ * the resulting masks, fields are views into the mapping.
+ */
+
+/** Most fields of a TPC-H table, lineitem has 16 */
+constexpr unsigned TBL_MAX_FIELDS = 16;
+
+/** Fields of one line of a .tbl file */
+class TblRow {
+public:
+    uint64_t index = 0;
+
+    [[nodiscard]] std::string_view
+    operator[](unsigned field) const {
+        return field < num_fields ? fields[field] : std::string_view{};
+    }
+
+    [[nodiscard]] char
+    first(unsigned field) const {
+        return field < num_fields && !fields[field].empty() ? fields[field][0] : '\0';
+    }
+
+    /** Parses an integer or float field, logs and leaves value untouched if the field is not a number */
+    template<typename T>
+    void
+    number(unsigned field, T &value) const;
+
+    /**
+     * Parses a field like "-12.3" exactly into a decimal with DECIMAL_SCALE digits after the point, logs and leaves
+     * value untouched if the field is not a number or has more digits after the point
+     */
+    void
+    decimal(unsigned field, int64_t &value) const;
+
+    /** Parses a YYYY-MM-DD field into seconds since the epoch (UTC midnight) */
+    [[nodiscard]] uint64_t
+    date(unsigned field) const;
+
+    void
+    add(const char *begin, const char *end) {
+        if (num_fields < TBL_MAX_FIELDS) {
+            fields[num_fields] = std::string_view{begin, static_cast<size_t>(end - begin)};
+        }
+        ++num_fields;
+    }
+
+    void
+    clear() {
+        num_fields = 0;
+    }
+
+private:
+    void
+    parse_error(unsigned field, const char *type) const;
+
+    std::array<std::string_view, TBL_MAX_FIELDS> fields{};
+    unsigned num_fields = 0;
+};
+
+/**
+ * Days since 1970-01-01 of a YYYY-MM-DD date, without branches or calls to mktime. Days are counted in years that
+ * start on March 1st so the leap day is the last day of a year (H. Hinnant, days_from_civil).
+ */
+[[nodiscard]] inline int64_t
+parse_epoch_days(const char *date) {
+    const auto digit = [date](int i) { return static_cast<int64_t>(date[i] - '0'); };
+    const int64_t month = digit(5) * 10 + digit(6);
+    const int64_t day = digit(8) * 10 + digit(9);
+    const int64_t january_or_february = month <= 2;
+    const int64_t year = digit(0) * 1000 + digit(1) * 100 + digit(2) * 10 + digit(3) - january_or_february;
+    const int64_t era = year / 400; // dates of TPC-H are after the year 0
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month - 3 + 12 * january_or_february) + 2) / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+class TblFile {
+public:
+    TblFile() = default;
+    TblFile(const TblFile &) = delete;
+    TblFile &operator=(const TblFile &) = delete;
+    ~TblFile();
+
+    /** Maps the file and counts its rows with num_threads threads, returns 0 on success */
+    int
+    open(const std::string &path, uint32_t num_threads);
+
+    [[nodiscard]] uint64_t
+    num_rows() const {
+        return chunks.empty() ? 0 : chunks.back().first_row + chunks.back().num_rows;
+    }
+
+    /** Calls function(const TblRow &) for every row, one thread per chunk, rows of a chunk in order */
+    template<typename Function>
+    void
+    parse(const Function &function) const {
+        parse_chunks(RowCallback{&function, [](const void *context, const TblRow &row) {
+            (*static_cast<const Function *>(context))(row);
+        }});
+    }
+
+private:
+    struct Chunk {
+        const char *begin;
+        const char *end;
+        uint64_t first_row;
+        uint64_t num_rows;
+    };
+
+    /** The row function of parse(), called through a function pointer so the threads live in the .cpp */
+    struct RowCallback {
+        const void *context;
+        void (*call)(const void *context, const TblRow &row);
+    };
+
+    void
+    parse_chunks(RowCallback callback) const;
+
+    std::string path;
+    char *data = nullptr;
+    uint64_t size = 0;
+    std::vector<Chunk> chunks;
+};
+
+#endif//TPCH_TBL_FILE_HPP
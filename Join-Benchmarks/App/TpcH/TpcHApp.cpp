@@ -2,7 +2,14 @@
 #include "ErrorSupport.h"
 #include "Logger.hpp"
 #include "TpcHCommons.hpp"
+#include "TpcHGenerator.hpp"
+#include "TpcHRefresh.hpp"
+#include "TpcHThroughput.hpp"
+#include "commons.h"
+#include "request_channel.h"
 #include "sgx_urts.h"
+#include <cstring>
+#include <ctime>
 
 constexpr std::string_view ENCLAVE_FILENAME = "joinenclave.signed.so";
 
@@ -26,83 +33,387 @@ int initialize_enclave(void)
     return 0;
 }
 
-int main(int argc, char *argv[])
+/** Runs the query with the ECALL that copies the tables given as arguments into the enclave */
+static sgx_status_t
+run_query(uint8_t query, tcph_args_t &params, joinconfig_t *joinconfig, result_t *result, LineItemTable *l,
+          OrdersTable *o, CustomerTable *c, PartTable *p, NationTable *n, SupplierTable *s, RegionTable *r,
+          PartSuppTable *ps)
 {
-    initLogger();
-    joinconfig_t joinconfig;
-    logger(INFO, "************* TPC-H APP *************");
-    // 1. Parse args
-    tcph_args_t params;
-    tpch_parse_args(argc, argv, &params);
-    uint8_t query = params.query;
-    joinconfig.NTHREADS = (int) params.nthreads;
-    joinconfig.RADIXBITS = -1;
-    logger(INFO, "Run Q%d (scale %d) with join algorithm %s (%d threads)",
-           query, params.scale, params.algorithm_name, joinconfig.NTHREADS);
-
-    // 2. load required TPC-H tables
-    LineItemTable l;
-    OrdersTable o;
-    CustomerTable c;
-    PartTable p;
-    NationTable n;
-
-    load_orders_from_binary(&o, query, params.scale);
-    load_customers_from_binary(&c, query, params.scale);
-    load_parts_from_binary(&p, query, params.scale);
-    load_nations_from_binary(&n, query, params.scale);
-    load_lineitems_from_binary(&l, query, params.scale);
-
-    // 3. init enclave
-    initialize_enclave();
-    ecall_init_logger(global_eid, logger_get_start());
-
-    // 4. execute specified query using an ECALL
-    sgx_status_t ret = SGX_SUCCESS, retval;
-    result_t result{};
+    sgx_status_t ret = SGX_ERROR_INVALID_PARAMETER, retval = SGX_SUCCESS;
     switch(query) {
+        case 1:
+            ret = ecall_tpch_q1(global_eid,
+                                &retval,
+                                result,
+                                l,
+                                joinconfig);
+            break;
         case 3:
             ret = ecall_tpch_q3(global_eid,
                                 &retval,
-                                &result,
-                                &c,
-                                &o,
-                                &l,
+                                result,
+                                c,
+                                o,
+                                l,
+                                params.algorithm_name,
+                                joinconfig);
+            break;
+        case 5:
+            ret = ecall_tpch_q5(global_eid,
+                                &retval,
+                                result,
+                                c,
+                                o,
+                                l,
+                                s,
+                                n,
+                                r,
                                 params.algorithm_name,
-                                &joinconfig);
+                                joinconfig);
+            break;
+        case 6:
+            ret = ecall_tpch_q6(global_eid,
+                                &retval,
+                                result,
+                                l,
+                                joinconfig);
+            break;
+        case 9:
+            ret = ecall_tpch_q9(global_eid,
+                                &retval,
+                                result,
+                                p,
+                                s,
+                                l,
+                                ps,
+                                o,
+                                n,
+                                params.algorithm_name,
+                                joinconfig);
             break;
         case 10:
             ret = ecall_tpch_q10(global_eid,
                                  &retval,
-                                 &result,
-                                 &c,
-                                 &o,
-                                 &l,
-                                 &n,
+                                 result,
+                                 c,
+                                 o,
+                                 l,
+                                 n,
                                  params.algorithm_name,
-                                 &joinconfig);
+                                 joinconfig);
             break;
         case 12:
             ret = ecall_tpch_q12(global_eid,
                                  &retval,
-                                 &result,
-                                 &l,
-                                 &o,
+                                 result,
+                                 l,
+                                 o,
                                  params.algorithm_name,
-                                 &joinconfig);
+                                 joinconfig);
             break;
         case 19:
             ret = ecall_tpch_q19(global_eid,
                                  &retval,
-                                 &result,
-                                 &l,
-                                 &p,
+                                 result,
+                                 l,
+                                 p,
                                  params.algorithm_name,
-                                 &joinconfig);
+                                 joinconfig);
             break;
         default:
             logger(ERROR, "TPC-H Q%d is not supported", query);
     }
+    return ret == SGX_SUCCESS ? retval : ret;
+}
+
+/**
+ * Copies the tables into the enclave once, decrypting them there with -e. Reports the load time separately from the
+ * query time.
+ */
+static sgx_status_t
+load_enclave_tables(tcph_args_t &params, LineItemTable *l, OrdersTable *o, CustomerTable *c, PartTable *p,
+                    NationTable *n, SupplierTable *s, RegionTable *r, PartSuppTable *ps)
+{
+    sgx_status_t ret, retval = SGX_SUCCESS;
+    if (params.encrypt_tables) {
+        // Stand-in for a key agreed on with the owner of the data, who ships the tables encrypted
+        uint8_t key[16];
+        for (auto &byte : key) {
+            byte = static_cast<uint8_t>(rand());
+        }
+        ret = ecall_set_load_key(global_eid, key);
+        if (ret == SGX_SUCCESS) {
+            ret = ecall_tpch_encrypt_tables(global_eid, &retval, l, o, c, p, n, s, r, ps, (int) params.nthreads);
+        }
+        if (ret != SGX_SUCCESS || retval != SGX_SUCCESS) {
+            return ret != SGX_SUCCESS ? ret : retval;
+        }
+    }
+
+    uint64_t bytes_loaded = 0;
+    struct timespec t1, t2;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ret = ecall_tpch_load_tables(global_eid, &retval, l, o, c, p, n, s, r, ps, params.encrypt_tables,
+                                 (int) params.nthreads, &bytes_loaded);
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    if (ret != SGX_SUCCESS || retval != SGX_SUCCESS) {
+        return ret != SGX_SUCCESS ? ret : retval;
+    }
+    double time_s = (double) (t2.tv_sec - t1.tv_sec) + (double) (t2.tv_nsec - t1.tv_nsec) / 1e9;
+    logger(INFO, "Loaded %.2lf MB of tables into the enclave%s in %.4fs (%.2lf GB/s)", B_TO_MB(bytes_loaded),
+           params.encrypt_tables ? " (decrypted)" : "", time_s, (double) bytes_loaded / time_s / 1e9);
+    return SGX_SUCCESS;
+}
+
+/**
+ * Runs the queries requested on stdin or the socket of -U on the resident tables until "quit" or the end of the input.
+ * A request is "<query> [algorithm] [threads]", e.g. "12 RHO 8", algorithm and threads default to -a and -n, and the
+ * threads are limited by -n. Every request is answered with one line holding its result count and time, or an error.
+ */
+static sgx_status_t
+serve_queries(tcph_args_t &params, joinconfig_t joinconfig)
+{
+    request_channel_t channel;
+    if (open_request_channel(&channel, params.socket_path[0] != '\0' ? params.socket_path : nullptr) != 0) {
+        return SGX_ERROR_UNEXPECTED;
+    }
+    char line[256];
+    uint64_t served = 0;
+    while (next_request(&channel, line, sizeof(line))) {
+        char query_name[16]{};
+        char algorithm[128]{};
+        int nthreads = params.nthreads;
+        strcpy(algorithm, params.algorithm_name);
+        if (sscanf(line, "%15s %127s %d", query_name, algorithm, &nthreads) < 1) {
+            continue;
+        }
+        if (strcmp(query_name, "quit") == 0) {
+            break;
+        }
+        const char *number = query_name[0] == 'q' || query_name[0] == 'Q' ? query_name + 1 : query_name;
+        char *end;
+        long query = strtol(number, &end, 10);
+        if (*end != '\0' || query < 1 || query > UINT8_MAX || nthreads < 1) {
+            reply(&channel, "ERROR malformed request: %s", line);
+            continue;
+        }
+        // checked here, the enclave exits on an unknown algorithm and sizes thread arrays by the thread count
+        if (!is_join_algorithm(algorithm)) {
+            reply(&channel, "ERROR unknown join algorithm: %s", algorithm);
+            continue;
+        }
+        if (nthreads > params.nthreads) {
+            reply(&channel, "ERROR %d threads requested, at most %d (-n)", nthreads, params.nthreads);
+            continue;
+        }
+
+        joinconfig.NTHREADS = nthreads;
+        result_t result{};
+        sgx_status_t retval = SGX_SUCCESS;
+        struct timespec t1, t2;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        sgx_status_t ret = ecall_tpch_query(global_eid, &retval, &result, (uint8_t) query, algorithm, &joinconfig);
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        if (ret != SGX_SUCCESS) {
+            close_request_channel(&channel);
+            return ret;
+        }
+        if (retval != SGX_SUCCESS) {
+            reply(&channel, "ERROR Q%ld is not supported", query);
+            continue;
+        }
+        double time_s = (double) (t2.tv_sec - t1.tv_sec) + (double) (t2.tv_nsec - t1.tv_nsec) / 1e9;
+        reply(&channel, "Q%ld %s %d threads: %ld results in %.4fs", query, algorithm, nthreads, result.totalresults,
+              time_s);
+        served++;
+    }
+    close_request_channel(&channel);
+    logger(INFO, "Served %lu requests", served);
+    return SGX_SUCCESS;
+}
+
+/** Checks the status of an ECALL and of the function it called */
+static bool
+ecall_succeeded(sgx_status_t ret, sgx_status_t retval)
+{
+    if (ret == SGX_SUCCESS) {
+        ret = retval;
+    }
+    if (ret != SGX_SUCCESS) {
+        ret_error_support(ret);
+        return false;
+    }
+    return true;
+}
+
+/** Runs a query on the resident tables with nthreads threads, for the query streams and the refresh test */
+static bool
+resident_query(uint8_t query, int nthreads, const tcph_args_t &params, joinconfig_t joinconfig)
+{
+    joinconfig.NTHREADS = nthreads;
+    result_t result{};
+    sgx_status_t retval = SGX_SUCCESS;
+    sgx_status_t ret = ecall_tpch_query(global_eid, &retval, &result, query, params.algorithm_name, &joinconfig);
+    return ecall_succeeded(ret, retval);
+}
+
+/** Runs the refresh test of -f on the resident tables, the merges run as ECALLs of their own */
+static sgx_status_t
+run_enclave_refresh_test(const tcph_args_t &params, const joinconfig_t &joinconfig)
+{
+    refresh_target_t target;
+    target.start = [&](uint32_t delta_percent) {
+        sgx_status_t retval = SGX_SUCCESS;
+        sgx_status_t ret = ecall_tpch_refresh_start(global_eid, &retval, delta_percent, (int) params.nthreads);
+        return ecall_succeeded(ret, retval);
+    };
+    target.query = [&](uint8_t query, int nthreads) {
+        return resident_query(query, nthreads, params, joinconfig);
+    };
+    target.insert = [](const OrdersTable *o, const LineItemTable *l, uint64_t *inserted) {
+        sgx_status_t retval = SGX_SUCCESS;
+        sgx_status_t ret = ecall_tpch_refresh_insert(global_eid, &retval, o, l, inserted);
+        return ecall_succeeded(ret, retval);
+    };
+    target.remove = [](const type_key *orderkeys, uint64_t num_keys, uint64_t *deleted) {
+        sgx_status_t retval = SGX_SUCCESS;
+        sgx_status_t ret = ecall_tpch_refresh_delete(global_eid, &retval, orderkeys, num_keys, deleted);
+        return ecall_succeeded(ret, retval);
+    };
+    target.merge = [](int nthreads, bool *merged) {
+        sgx_status_t retval = SGX_SUCCESS;
+        int merge_ran = 0;
+        sgx_status_t ret = ecall_tpch_refresh_merge(global_eid, &retval, nthreads, &merge_ran);
+        *merged = merge_ran != 0;
+        return ecall_succeeded(ret, retval);
+    };
+    target.stats = [](refresh_stats_t *stats) {
+        sgx_status_t retval = SGX_SUCCESS;
+        sgx_status_t ret = ecall_tpch_refresh_stats(global_eid, &retval, stats);
+        return ecall_succeeded(ret, retval);
+    };
+    int rv = run_refresh_test(params.refresh_rounds, params.nthreads, params.scale, params.merge_percent, target);
+    return rv == 0 ? SGX_SUCCESS : SGX_ERROR_UNEXPECTED;
+}
+
+static void
+free_host_tables(LineItemTable *l, OrdersTable *o, CustomerTable *c, PartTable *p, NationTable *n, SupplierTable *s,
+                 RegionTable *r, PartSuppTable *ps)
+{
+    free_orders(o);
+    free_part(p);
+    free_customer(c);
+    free_lineitem(l);
+    free_nation(n);
+    free_supplier(s);
+    free_region(r);
+    free_partsupp(ps);
+}
+
+int main(int argc, char *argv[])
+{
+    initLogger();
+    joinconfig_t joinconfig{};
+    logger(INFO, "************* TPC-H APP *************");
+    // 1. Parse args
+    tcph_args_t params;
+    tpch_parse_args(argc, argv, &params);
+    uint8_t query = params.query;
+    joinconfig.NTHREADS = (int) params.nthreads;
+    joinconfig.RADIXBITS = -1;
+    if (params.refresh_rounds > 0) {
+        logger(INFO, "Refresh test with %u rounds on scale %d with join algorithm %s (%d threads)",
+               params.refresh_rounds, params.scale, params.algorithm_name, joinconfig.NTHREADS);
+    } else if (params.streams > 0) {
+        logger(INFO, "Throughput test with %d streams on scale %d with join algorithm %s (%d threads)",
+               params.streams, params.scale, params.algorithm_name, joinconfig.NTHREADS);
+    } else if (params.serve) {
+        logger(INFO, "Serve queries on scale %d, by default with join algorithm %s (%d threads)",
+               params.scale, params.algorithm_name, joinconfig.NTHREADS);
+    } else {
+        logger(INFO, "Run Q%d (scale %d) with join algorithm %s (%d threads)",
+               query, params.scale, params.algorithm_name, joinconfig.NTHREADS);
+    }
+
+    // 2. load required TPC-H tables
+    LineItemTable l{};
+    OrdersTable o{};
+    CustomerTable c{};
+    PartTable p{};
+    NationTable n{};
+    SupplierTable s{};
+    RegionTable r{};
+    PartSuppTable ps{};
+
+    if (params.generate) {
+        generate_tables(params.scale, params.nthreads, &l, &o, &c, &p, &n, &s, &r, &ps);
+    } else if (params.serve || params.streams > 0 || params.refresh_rounds > 0) {
+        if (load_all_tables(params.scale, params.nthreads, &l, &o, &c, &p, &n, &s, &r, &ps) != 0) {
+            logger(ERROR, "Loading the tables failed");
+            return 1;
+        }
+    } else {
+        load_orders_from_binary(&o, query, params.scale);
+        load_customers_from_binary(&c, query, params.scale);
+        load_parts_from_binary(&p, query, params.scale);
+        load_nations_from_binary(&n, query, params.scale);
+        load_suppliers_from_binary(&s, query, params.scale);
+        load_regions_from_binary(&r, query, params.scale);
+        load_partsupps_from_binary(&ps, query, params.scale);
+        load_lineitems_from_binary(&l, query, params.scale);
+    }
+
+    // 3. init enclave
+    initialize_enclave();
+    ecall_init_logger(global_eid, logger_get_start());
+
+    // 4. execute specified query using an ECALL, on tables copied into the enclave once with -l, -e or -S
+    sgx_status_t ret = SGX_SUCCESS;
+    result_t result{};
+    bool host_tables = true;
+    if (params.enclave_tables) {
+        ret = load_enclave_tables(params, &l, &o, &c, &p, &n, &s, &r, &ps);
+        // the queries only read the copies in the enclave from now on
+        free_host_tables(&l, &o, &c, &p, &n, &s, &r, &ps);
+        host_tables = false;
+    }
+    if (params.refresh_rounds > 0) {
+        if (ret == SGX_SUCCESS) {
+            ret = run_enclave_refresh_test(params, joinconfig);
+        }
+    } else if (params.streams > 0) {
+        if (ret == SGX_SUCCESS) {
+            // every query of a stream is its own ECALL, the streams run in the enclave at the same time
+            int rv = run_throughput_test(params.streams, params.nthreads, params.runs, params.scale,
+                                         [&](uint8_t stream_query, int nthreads) {
+                return resident_query(stream_query, nthreads, params, joinconfig);
+            });
+            ret = rv == 0 ? SGX_SUCCESS : SGX_ERROR_UNEXPECTED;
+        }
+    } else if (params.serve) {
+        if (ret == SGX_SUCCESS) {
+            ret = serve_queries(params, joinconfig);
+        }
+    } else {
+        for (uint8_t run = 0; run < params.runs && ret == SGX_SUCCESS; run++) {
+            struct timespec t1, t2;
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            if (params.enclave_tables) {
+                sgx_status_t retval = SGX_SUCCESS;
+                ret = ecall_tpch_query(global_eid, &retval, &result, query, params.algorithm_name, &joinconfig);
+                if (ret == SGX_SUCCESS) {
+                    ret = retval;
+                }
+            } else {
+                ret = run_query(query, params, &joinconfig, &result, &l, &o, &c, &p, &n, &s, &r, &ps);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t2);
+            if (ret == SGX_SUCCESS && params.runs > 1) {
+                double time_s = (double) (t2.tv_sec - t1.tv_sec) + (double) (t2.tv_nsec - t1.tv_nsec) / 1e9;
+                logger(INFO, "Run %d of Q%d: %.4fs", run + 1, query, time_s);
+            }
+        }
+    }
     // 4. report and clean up
     if (ret != SGX_SUCCESS) {
         ret_error_support(ret);
@@ -110,11 +421,10 @@ int main(int argc, char *argv[])
         logger(INFO, "Query completed");
     }
 
-    free_orders(&o);
-    free_part(&p);
-    free_customer(&c);
-    free_lineitem(&l);
-    free_nation(&n);
+    if (host_tables) {
+        free_host_tables(&l, &o, &c, &p, &n, &s, &r, &ps);
+    }
+    ecall_tpch_free_tables(global_eid);
 
     // 5. destroy enclave
     ret = sgx_destroy_enclave(global_eid);
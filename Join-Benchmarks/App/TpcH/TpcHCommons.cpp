@@ -1,94 +1,21 @@
 #include "TpcHCommons.hpp"
+#include "ColumnFile.hpp"
+#include "Dictionary.hpp"
 #include "Logger.hpp"
+#include "TblFile.hpp"
 #include <algorithm>
-#include <charconv>
 #include <cstdlib>
 #include <cstring>
-#include <ctime>
+#include <filesystem>
 #include <fstream>
 #include <getopt.h>
 #include <iomanip>
-#include <istream>
+#include <map>
 #include <sstream>
 #include <string>
 
-#include "csv.hpp"
-
-#include <iterator>
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <string>
-
-class CSVRow {
-public:
-    std::string m_line;
-
-    std::string_view operator[](std::size_t index) const {
-        return std::string_view(&m_line[m_data[index] + 1], m_data[index + 1] - (m_data[index] + 1));
-    }
-
-    std::size_t size() const {
-        return m_data.size() - 1;
-    }
-
-    void readNextRow(std::istream &str) {
-        std::getline(str, m_line);
-
-        m_data.clear();
-        m_data.emplace_back(-1);
-        std::string::size_type pos = 0;
-        while ((pos = m_line.find('|', pos)) != std::string::npos) {
-            m_data.emplace_back(pos);
-            ++pos;
-        }
-        // This checks for a trailing comma with no data after it.
-        pos = m_line.size();
-        m_data.emplace_back(pos);
-    }
-
-private:
-    std::vector<int> m_data;
-};
-
-std::istream &operator>>(std::istream &str, CSVRow &data) {
-    data.readNextRow(str);
-    return str;
-}
-
-template<typename T>
-void
-vton(const std::string_view &view, T &out) {
-    std::from_chars(view.data(), view.data() + view.size(), out);
-}
-
-void
-vtof(const std::string_view &view, float &out) {
-    std::from_chars(view.data(), view.data() + view.size(), out, std::chars_format::general);
-}
-
-template<typename T>
-void
-vton_debug(const std::string_view &view, T &out) {
-    auto ret = std::from_chars(view.data(), view.data() + view.size(), out);
-    if (ret.ec == std::errc::invalid_argument) {
-        throw std::runtime_error{"vton failed with invalid argument"};
-    } else if (ret.ec == std::errc::result_out_of_range) {
-        throw std::runtime_error{"vton failed with out of range"};
-    } else if (ret.ptr != view.data() + view.size()) {
-        throw std::runtime_error{"vton was unable to parse whole range"};
-    }
-}
-
 uint8_t
-parsePartBrand(const std::string &value);
-
-uint8_t
-parsePartContainer(const std::string &value);
-
-uint8_t
-parseLineitemShipinstruct(const std::string &value);
+parsePartName(std::string_view value);
 
 void
 tpch_parse_args(int argc, char **argv, tcph_args_t *params) {
@@ -102,7 +29,7 @@ tpch_parse_args(int argc, char **argv, tcph_args_t *params) {
 
         int option_index = 0;
 
-        c = getopt_long(argc, argv, "a:b:m:n:q:s:p", long_options, &option_index);
+        c = getopt_long(argc, argv, "a:b:f:m:n:q:r:s:t:M:U:pgleS", long_options, &option_index);
 
         if (c == -1)
             break;
@@ -113,6 +40,13 @@ tpch_parse_args(int argc, char **argv, tcph_args_t *params) {
             case 'b':
                 params->bits = (uint8_t) atoi(optarg);
                 break;
+            case 'f':
+                params->enclave_tables = true;
+                params->refresh_rounds = (uint32_t) atoi(optarg);
+                break;
+            case 'M':
+                params->merge_percent = (uint32_t) std::max(1, atoi(optarg));
+                break;
             case 'n':
                 params->nthreads = (uint8_t) atoi(optarg);
                 break;
@@ -125,6 +59,32 @@ tpch_parse_args(int argc, char **argv, tcph_args_t *params) {
             case 'p':
                 params->parallel = true;
                 break;
+            case 'g':
+                params->generate = true;
+                break;
+            case 'l':
+                params->enclave_tables = true;
+                break;
+            case 'e':
+                params->enclave_tables = true;
+                params->encrypt_tables = true;
+                break;
+            case 'r':
+                params->runs = (uint8_t) std::max(1, atoi(optarg));
+                break;
+            case 'S':
+                params->enclave_tables = true;
+                params->serve = true;
+                break;
+            case 't':
+                params->enclave_tables = true;
+                params->streams = (uint8_t) atoi(optarg);
+                break;
+            case 'U':
+                params->enclave_tables = true;
+                params->serve = true;
+                strncpy(params->socket_path, optarg, sizeof(params->socket_path) - 1);
+                break;
             default:
                 break;
         }
@@ -138,58 +98,6 @@ tpch_parse_args(int argc, char **argv, tcph_args_t *params) {
     }
 }
 
-uint8_t
-parseShipMode(const std::string &value) {
-    if (value == "MAIL") {
-        return L_SHIPMODE_MAIL;
-    } else if (value == "SHIP") {
-        return L_SHIPMODE_SHIP;
-    } else if (value == "AIR") {
-        return L_SHIPMODE_AIR;
-    } else if (value == "AIR REG") {
-        return L_SHIPMODE_AIR_REG;
-    } else {
-        return 0;
-    }
-}
-
-uint64_t
-parseDateToLong(const std::string &value) {
-    std::tm tm = {};
-    std::istringstream ss(value + " 00:00:00");
-    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-    std::time_t time_stamp = mktime(&tm) - timezone;
-    return static_cast<uint64_t>(time_stamp);
-}
-
-uint64_t
-parseDateToLong_2(const std::string &&value) {
-    static std::tm tm{};
-    static auto time_getter = std::get_time(&tm, "%Y-%m-%d");
-
-    std::istringstream ss(value);
-    ss >> time_getter;
-    const std::time_t time_stamp = mktime(&tm) - timezone;
-    return static_cast<uint64_t>(time_stamp);
-}
-
-uint8_t
-parseMktSegment(const std::string &value) {
-    if (value == "BUILDING") {
-        return MKT_BUILDING;
-    } else {
-        return 0;
-    }
-}
-
-uint64_t
-getNumberOfLines(const std::string &filename) {
-    std::ifstream ifs(filename);
-    auto lines = std::count(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>(), '\n');
-    logger(INFO, "File %s has %lu lines", filename.c_str(), lines);
-    return lines;
-}
-
 std::string
 getPath(int scale, const std::string &tbl) {
     std::stringstream ss;
@@ -213,30 +121,318 @@ read_binary(char *buffer, const uint64_t size, const std::string &path) {
     binary_file.close();
 }
 
-std::string
-row_to_string(const csv::CSVRow &row) {
-    std::ostringstream row_stream{};
-    std::for_each(row.begin(), row.end(),
-                  [&row_stream](const csv::CSVField &field) { row_stream << field.get_sv() << '|'; });
-    return row_stream.str();
+uint64_t
+num_zones(uint64_t num_tuples) {
+    return (num_tuples + ZONE_ROWS - 1) / ZONE_ROWS;
 }
 
-void
-handle_parse_error(const csv::CSVRow &row, const uint64_t i, const std::runtime_error &error) {
-    logger(ERROR, "Failed to parse row %lld\nRow: %s\nException: %s", i, row_to_string(row).c_str(), error.what());
+template<typename T>
+zone_t *
+build_zone_map_of(const T *column, uint64_t num_tuples) {
+    auto zones = static_cast<zone_t *>(malloc(std::max<uint64_t>(num_zones(num_tuples), 1) * sizeof(zone_t)));
+    if (zones == nullptr) {
+        return nullptr;
+    }
+    for (uint64_t zone = 0; zone < num_zones(num_tuples); ++zone) {
+        const uint64_t begin = zone * ZONE_ROWS;
+        const auto [min, max] = std::minmax_element(column + begin, column + std::min(begin + ZONE_ROWS, num_tuples));
+        zones[zone] = {*min, *max};
+    }
+    return zones;
 }
 
-void
-handle_parse_error(const CSVRow &row, const uint64_t i, const std::runtime_error &error) {
-    logger(ERROR, "Failed to parse row %lld\nRow: %s\nException: %s", i, row.m_line.c_str(), error.what());
+zone_t *
+build_zone_map(const uint64_t *column, uint64_t num_tuples) {
+    return build_zone_map_of(column, num_tuples);
+}
+
+zone_t *
+build_zone_map(const uint16_t *column, uint64_t num_tuples) {
+    return build_zone_map_of(column, num_tuples);
+}
+
+/**
+ * Day numbers of a date column with their zone map into *days and *zones. Leaves both nullptr if a date does not fit
+ * into 16 bits or is not at midnight, returns 1 if an allocation fails.
+ */
+int
+encode_days(const uint64_t *dates, uint64_t num_tuples, uint16_t **days, zone_t **zones) {
+    if (dates == nullptr) {
+        return 0;
+    }
+    const bool fits = std::all_of(dates, dates + num_tuples, [](uint64_t date) {
+        return date % SECONDS_PER_DAY == 0 && date / SECONDS_PER_DAY <= UINT16_MAX;
+    });
+    if (!fits) {
+        logger(INFO, "Dates do not fit into 16-bit days, the filters scan the seconds");
+        return 0;
+    }
+    if (posix_memalign((void **) days, 64, sizeof(uint16_t) * num_tuples) != 0) {
+        *days = nullptr;
+        return 1;
+    }
+    std::transform(dates, dates + num_tuples, *days,
+                   [](uint64_t date) { return static_cast<uint16_t>(date / SECONDS_PER_DAY); });
+    *zones = build_zone_map(*days, num_tuples);
+    return *zones == nullptr;
+}
+
+int
+encode_narrow_lineitem(LineItemTable *l_table) {
+    const uint64_t num_tuples = l_table->numTuples;
+    int rv = 0;
+    rv |= encode_days(l_table->l_shipdate, num_tuples, &l_table->l_shipdate_days, &l_table->l_shipdate_days_zones);
+    rv |= encode_days(l_table->l_commitdate, num_tuples, &l_table->l_commitdate_days,
+                      &l_table->l_commitdate_days_zones);
+    rv |= encode_days(l_table->l_receiptdate, num_tuples, &l_table->l_receiptdate_days,
+                      &l_table->l_receiptdate_days_zones);
+    const float *quantity = l_table->l_quantity;
+    if (quantity != nullptr && std::all_of(quantity, quantity + num_tuples, [](float value) {
+            return value >= 0 && value <= UINT8_MAX && value == static_cast<float>(static_cast<uint8_t>(value));
+        })) {
+        if (posix_memalign((void **) &(l_table->l_quantity_u8), 64, sizeof(uint8_t) * num_tuples) != 0) {
+            l_table->l_quantity_u8 = nullptr;
+            rv = 1;
+        } else {
+            std::transform(quantity, quantity + num_tuples, l_table->l_quantity_u8,
+                           [](float value) { return static_cast<uint8_t>(value); });
+        }
+    }
+    if (rv != 0) {
+        logger(ERROR, "malloc error");
+        return 1;
+    }
+    return 0;
+}
+
+int
+encode_narrow_orders(OrdersTable *o_table) {
+    if (encode_days(o_table->o_orderdate, o_table->numTuples, &o_table->o_orderdate_days,
+                    &o_table->o_orderdate_days_zones) != 0) {
+        logger(ERROR, "malloc error");
+        return 1;
+    }
+    return 0;
+}
+
+int
+load_zone_map(zone_t **zones, const uint64_t *column, uint64_t num_tuples, const std::string &path) {
+    if (!std::filesystem::exists(path)) {
+        logger(INFO, "%s not found, building the zone map", path.c_str());
+        *zones = build_zone_map(column, num_tuples);
+        return *zones == nullptr;
+    }
+    *zones = static_cast<zone_t *>(malloc(std::max<uint64_t>(num_zones(num_tuples), 1) * sizeof(zone_t)));
+    if (*zones == nullptr) {
+        return 1;
+    }
+    read_binary(reinterpret_cast<char *>(*zones), num_zones(num_tuples) * sizeof(zone_t), path);
+    return 0;
+}
+
+/* Loaders of the column files written by csv_convert, every query maps only the columns it reads */
+
+int
+map_lineitems(LineItemTable *l_table, uint8_t query, const std::string &path) {
+    static const std::map<uint8_t, std::vector<std::string>> QUERY_COLUMNS{
+            {ALL_QUERIES, {"l_orderkey", "l_shipdate", "l_commitdate", "l_receiptdate", "l_shipmode", "l_partkey",
+                           "l_quantity", "l_shipinstruct", "l_returnflag", "l_extendedprice", "l_discount", "l_tax",
+                           "l_linestatus", "l_suppkey", "l_shipdate_days", "l_commitdate_days", "l_receiptdate_days",
+                           "l_quantity_u8", "l_quantity_dec", "l_extendedprice_dec", "l_discount_dec", "l_tax_dec"}},
+            {1, {"l_orderkey", "l_shipdate", "l_returnflag", "l_linestatus", "l_quantity", "l_tax", "l_extendedprice",
+                 "l_discount", "l_quantity_dec", "l_extendedprice_dec", "l_discount_dec", "l_tax_dec"}},
+            {3, {"l_orderkey", "l_shipdate", "l_shipdate_days", "l_extendedprice", "l_discount", "l_extendedprice_dec",
+                 "l_discount_dec"}},
+            {5, {"l_orderkey", "l_suppkey", "l_extendedprice", "l_discount", "l_extendedprice_dec", "l_discount_dec"}},
+            {6, {"l_orderkey", "l_shipdate", "l_quantity", "l_extendedprice", "l_discount", "l_quantity_dec",
+                 "l_extendedprice_dec", "l_discount_dec"}},
+            {9, {"l_orderkey", "l_partkey", "l_suppkey", "l_quantity", "l_extendedprice", "l_discount",
+                 "l_quantity_dec", "l_extendedprice_dec", "l_discount_dec"}},
+            {10, {"l_orderkey", "l_returnflag", "l_extendedprice", "l_discount", "l_extendedprice_dec",
+                  "l_discount_dec"}},
+            {12, {"l_orderkey", "l_shipdate", "l_commitdate", "l_receiptdate", "l_shipdate_days", "l_commitdate_days",
+                  "l_receiptdate_days", "l_shipmode"}},
+            {19, {"l_orderkey", "l_partkey", "l_quantity", "l_quantity_u8", "l_shipinstruct", "l_shipmode"}}};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    const std::vector<std::string> &columns = QUERY_COLUMNS.at(query);
+    l_table->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(columns, "l_orderkey", &l_table->l_orderkey);
+    rv |= file.map(columns, "l_shipdate", &l_table->l_shipdate, &l_table->l_shipdate_zones);
+    rv |= file.map(columns, "l_commitdate", &l_table->l_commitdate, &l_table->l_commitdate_zones);
+    rv |= file.map(columns, "l_receiptdate", &l_table->l_receiptdate, &l_table->l_receiptdate_zones);
+    rv |= file.map(columns, "l_shipmode", &l_table->l_shipmode);
+    rv |= file.map(columns, "l_partkey", &l_table->l_partkey);
+    rv |= file.map(columns, "l_quantity", &l_table->l_quantity);
+    rv |= file.map(columns, "l_shipinstruct", &l_table->l_shipinstruct);
+    rv |= file.map(columns, "l_returnflag", &l_table->l_returnflag);
+    rv |= file.map(columns, "l_extendedprice", &l_table->l_extendedprice);
+    rv |= file.map(columns, "l_discount", &l_table->l_discount);
+    rv |= file.map(columns, "l_tax", &l_table->l_tax);
+    rv |= file.map(columns, "l_linestatus", &l_table->l_linestatus);
+    rv |= file.map(columns, "l_suppkey", &l_table->l_suppkey);
+    rv |= file.map(columns, "l_shipdate_days", &l_table->l_shipdate_days, &l_table->l_shipdate_days_zones,
+                   ENCODING_DAYS);
+    rv |= file.map(columns, "l_commitdate_days", &l_table->l_commitdate_days, &l_table->l_commitdate_days_zones,
+                   ENCODING_DAYS);
+    rv |= file.map(columns, "l_receiptdate_days", &l_table->l_receiptdate_days, &l_table->l_receiptdate_days_zones,
+                   ENCODING_DAYS);
+    rv |= file.map(columns, "l_quantity_u8", &l_table->l_quantity_u8, nullptr, ENCODING_NARROW);
+    rv |= file.map(columns, "l_quantity_dec", &l_table->l_quantity_dec, nullptr, ENCODING_DECIMAL);
+    rv |= file.map(columns, "l_extendedprice_dec", &l_table->l_extendedprice_dec, nullptr, ENCODING_DECIMAL);
+    rv |= file.map(columns, "l_discount_dec", &l_table->l_discount_dec, nullptr, ENCODING_DECIMAL);
+    rv |= file.map(columns, "l_tax_dec", &l_table->l_tax_dec, nullptr, ENCODING_DECIMAL);
+    rv |= file.map_dictionary(columns, "l_shipmode", &l_table->l_shipmode_dict);
+    rv |= file.map_dictionary(columns, "l_shipinstruct", &l_table->l_shipinstruct_dict);
+    return rv;
+}
+
+int
+map_orders(OrdersTable *o_table, uint8_t query, const std::string &path) {
+    static const std::map<uint8_t, std::vector<std::string>> QUERY_COLUMNS{
+            {ALL_QUERIES, {"o_orderkey", "o_orderdate", "o_custkey", "o_orderpriority", "o_shippriority",
+                           "o_orderdate_days"}},
+            {3, {"o_orderkey", "o_orderdate", "o_orderdate_days", "o_custkey", "o_shippriority"}},
+            {5, {"o_orderkey", "o_orderdate", "o_custkey"}},
+            {9, {"o_orderkey", "o_orderdate"}},
+            {10, {"o_orderkey", "o_orderdate", "o_orderdate_days", "o_custkey"}},
+            {12, {"o_orderkey", "o_orderpriority"}}};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    const std::vector<std::string> &columns = QUERY_COLUMNS.at(query);
+    o_table->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(columns, "o_orderkey", &o_table->o_orderkey);
+    rv |= file.map(columns, "o_orderdate", &o_table->o_orderdate, &o_table->o_orderdate_zones);
+    rv |= file.map(columns, "o_custkey", &o_table->o_custkey);
+    rv |= file.map(columns, "o_orderpriority", &o_table->o_orderpriority);
+    rv |= file.map(columns, "o_shippriority", &o_table->o_shippriority);
+    rv |= file.map(columns, "o_orderdate_days", &o_table->o_orderdate_days, &o_table->o_orderdate_days_zones,
+                   ENCODING_DAYS);
+    rv |= file.map_dictionary(columns, "o_orderpriority", &o_table->o_orderpriority_dict);
+    return rv;
+}
+
+int
+map_customers(CustomerTable *c_table, uint8_t query, const std::string &path) {
+    static const std::map<uint8_t, std::vector<std::string>> QUERY_COLUMNS{
+            {ALL_QUERIES, {"c_custkey", "c_mktsegment", "c_nationkey"}},
+            {3, {"c_custkey", "c_mktsegment"}}, {5, {"c_custkey", "c_nationkey"}}, {10, {"c_custkey", "c_nationkey"}}};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    const std::vector<std::string> &columns = QUERY_COLUMNS.at(query);
+    c_table->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(columns, "c_custkey", &c_table->c_custkey);
+    rv |= file.map(columns, "c_mktsegment", &c_table->c_mktsegment);
+    rv |= file.map(columns, "c_nationkey", &c_table->c_nationkey);
+    rv |= file.map_dictionary(columns, "c_mktsegment", &c_table->c_mktsegment_dict);
+    return rv;
+}
+
+int
+map_parts(PartTable *p, uint8_t query, const std::string &path) {
+    static const std::map<uint8_t, std::vector<std::string>> QUERY_COLUMNS{
+            {ALL_QUERIES, {"p_partkey", "p_brand", "p_size", "p_container", "p_name"}},
+            {9, {"p_partkey", "p_name"}}, {19, {"p_partkey", "p_brand", "p_container", "p_size"}}};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    const std::vector<std::string> &columns = QUERY_COLUMNS.at(query);
+    p->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(columns, "p_partkey", &p->p_partkey);
+    rv |= file.map(columns, "p_brand", &p->p_brand);
+    rv |= file.map(columns, "p_size", &p->p_size);
+    rv |= file.map(columns, "p_container", &p->p_container);
+    rv |= file.map(columns, "p_name", &p->p_name);
+    rv |= file.map_dictionary(columns, "p_brand", &p->p_brand_dict);
+    rv |= file.map_dictionary(columns, "p_container", &p->p_container_dict);
+    return rv;
+}
+
+int
+map_nations(NationTable *n, uint8_t query, const std::string &path) {
+    static const std::map<uint8_t, std::vector<std::string>> QUERY_COLUMNS{
+            {ALL_QUERIES, {"n_nationkey", "n_regionkey"}},
+            {5, {"n_nationkey", "n_regionkey"}}, {9, {"n_nationkey"}}, {10, {"n_nationkey"}}};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    const std::vector<std::string> &columns = QUERY_COLUMNS.at(query);
+    n->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(columns, "n_nationkey", &n->n_nationkey);
+    rv |= file.map(columns, "n_regionkey", &n->n_regionkey);
+    return rv;
+}
+
+int
+map_suppliers(SupplierTable *s, const std::string &path) {
+    static const std::vector<std::string> COLUMNS{"s_suppkey", "s_nationkey"};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    s->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(COLUMNS, "s_suppkey", &s->s_suppkey);
+    rv |= file.map(COLUMNS, "s_nationkey", &s->s_nationkey);
+    return rv;
+}
+
+int
+map_regions(RegionTable *r, const std::string &path) {
+    static const std::vector<std::string> COLUMNS{"r_regionkey", "r_name"};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    r->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(COLUMNS, "r_regionkey", &r->r_regionkey);
+    rv |= file.map(COLUMNS, "r_name", &r->r_name);
+    rv |= file.map_dictionary(COLUMNS, "r_name", &r->r_name_dict);
+    return rv;
+}
+
+int
+map_partsupps(PartSuppTable *ps, const std::string &path) {
+    static const std::vector<std::string> COLUMNS{"ps_partkey", "ps_suppkey", "ps_supplycost", "ps_supplycost_dec"};
+    ColumnFile file;
+    if (file.open(path) != 0) {
+        return 1;
+    }
+    ps->numTuples = file.num_tuples();
+    int rv = 0;
+    rv |= file.map(COLUMNS, "ps_partkey", &ps->ps_partkey);
+    rv |= file.map(COLUMNS, "ps_suppkey", &ps->ps_suppkey);
+    rv |= file.map(COLUMNS, "ps_supplycost", &ps->ps_supplycost);
+    rv |= file.map(COLUMNS, "ps_supplycost_dec", &ps->ps_supplycost_dec, nullptr, ENCODING_DECIMAL);
+    return rv;
 }
 
 int
 load_lineitems_from_binary(LineItemTable *l_table, uint8_t query, uint8_t scale) {
-    if (query != 3 && query != 10 && query != 12 && query != 19) {
+    if (query != 1 && query != 3 && query != 5 && query != 6 && query != 9 && query != 10 && query != 12 &&
+        query != 19) {
         return 0;
     }
 
+    const std::string COLUMN_PATH = getPath(scale, LINEITEM_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_lineitems(l_table, query, COLUMN_PATH);
+    }
+
     const std::string PATH = getPath(scale, LINEITEM_TBL) + ".dir";
     uint64_t numTuples = read_size_file(PATH);
 
@@ -244,8 +440,23 @@ load_lineitems_from_binary(LineItemTable *l_table, uint8_t query, uint8_t scale)
 
     int rv = 0;
     rv |= posix_memalign((void **) &(l_table->l_orderkey), 64, sizeof(tuple_t) * numTuples);
-    if (query == 3) {
+    if (query == 1) {
         rv |= posix_memalign((void **) &(l_table->l_shipdate), 64, sizeof(uint64_t) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_returnflag), 64, sizeof(char) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_linestatus), 64, sizeof(char) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_quantity), 64, sizeof(float) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_tax), 64, sizeof(float) * numTuples);
+    } else if (query == 3) {
+        rv |= posix_memalign((void **) &(l_table->l_shipdate), 64, sizeof(uint64_t) * numTuples);
+    } else if (query == 5) {
+        rv |= posix_memalign((void **) &(l_table->l_suppkey), 64, sizeof(type_key) * numTuples);
+    } else if (query == 6) {
+        rv |= posix_memalign((void **) &(l_table->l_shipdate), 64, sizeof(uint64_t) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_quantity), 64, sizeof(float) * numTuples);
+    } else if (query == 9) {
+        rv |= posix_memalign((void **) &(l_table->l_partkey), 64, sizeof(type_key) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_suppkey), 64, sizeof(type_key) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_quantity), 64, sizeof(float) * numTuples);
     } else if (query == 10) {
         rv |= posix_memalign((void **) &(l_table->l_returnflag), 64, sizeof(char) * numTuples);
     } else if (query == 12) {
@@ -259,15 +470,42 @@ load_lineitems_from_binary(LineItemTable *l_table, uint8_t query, uint8_t scale)
         rv |= posix_memalign((void **) &(l_table->l_shipinstruct), 64, sizeof(uint8_t) * numTuples);
         rv |= posix_memalign((void **) &(l_table->l_shipmode), 64, sizeof(uint8_t) * numTuples);
     }
+    if (query == 1 || query == 3 || query == 5 || query == 6 || query == 9 || query == 10) {
+        // revenue of the aggregation
+        rv |= posix_memalign((void **) &(l_table->l_extendedprice), 64, sizeof(float) * numTuples);
+        rv |= posix_memalign((void **) &(l_table->l_discount), 64, sizeof(float) * numTuples);
+    }
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
     read_binary(reinterpret_cast<char *>(l_table->l_orderkey), numTuples * sizeof(tuple_t), PATH + "/l_orderkey.bin");
-    if (query == 3) {
+    if (query == 1) {
+        read_binary(reinterpret_cast<char *>(l_table->l_shipdate), numTuples * sizeof(uint64_t),
+                    PATH + "/l_shipdate.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_returnflag), numTuples * sizeof(char),
+                    PATH + "/l_returnflag.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_linestatus), numTuples * sizeof(char),
+                    PATH + "/l_linestatus.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_quantity), numTuples * sizeof(float), PATH + "/l_quantity.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_tax), numTuples * sizeof(float), PATH + "/l_tax.bin");
+    } else if (query == 3) {
+        read_binary(reinterpret_cast<char *>(l_table->l_shipdate), numTuples * sizeof(uint64_t),
+                    PATH + "/l_shipdate.bin");
+    } else if (query == 5) {
+        read_binary(reinterpret_cast<char *>(l_table->l_suppkey), numTuples * sizeof(type_key),
+                    PATH + "/l_suppkey.bin");
+    } else if (query == 6) {
         read_binary(reinterpret_cast<char *>(l_table->l_shipdate), numTuples * sizeof(uint64_t),
                     PATH + "/l_shipdate.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_quantity), numTuples * sizeof(float), PATH + "/l_quantity.bin");
+    } else if (query == 9) {
+        read_binary(reinterpret_cast<char *>(l_table->l_partkey), numTuples * sizeof(type_key),
+                    PATH + "/l_partkey.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_suppkey), numTuples * sizeof(type_key),
+                    PATH + "/l_suppkey.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_quantity), numTuples * sizeof(float), PATH + "/l_quantity.bin");
     } else if (query == 10) {
         read_binary(reinterpret_cast<char *>(l_table->l_returnflag), numTuples * sizeof(char),
                     PATH + "/l_returnflag.bin");
@@ -280,6 +518,7 @@ load_lineitems_from_binary(LineItemTable *l_table, uint8_t query, uint8_t scale)
                     PATH + "/l_receiptdate.bin");
         read_binary(reinterpret_cast<char *>(l_table->l_shipmode), numTuples * sizeof(uint8_t),
                     PATH + "/l_shipmode.bin");
+        rv |= legacy_dictionary("l_shipmode", &l_table->l_shipmode_dict);
     } else if (query == 19) {
         read_binary(reinterpret_cast<char *>(l_table->l_partkey), numTuples * sizeof(type_key),
                     PATH + "/l_partkey.bin");
@@ -288,19 +527,47 @@ load_lineitems_from_binary(LineItemTable *l_table, uint8_t query, uint8_t scale)
                     PATH + "/l_shipinstruct.bin");
         read_binary(reinterpret_cast<char *>(l_table->l_shipmode), numTuples * sizeof(uint8_t),
                     PATH + "/l_shipmode.bin");
+        rv |= legacy_dictionary("l_shipinstruct", &l_table->l_shipinstruct_dict);
+        rv |= legacy_dictionary("l_shipmode", &l_table->l_shipmode_dict);
+    }
+    if (query == 1 || query == 3 || query == 5 || query == 6 || query == 9 || query == 10) {
+        read_binary(reinterpret_cast<char *>(l_table->l_extendedprice), numTuples * sizeof(float),
+                    PATH + "/l_extendedprice.bin");
+        read_binary(reinterpret_cast<char *>(l_table->l_discount), numTuples * sizeof(float),
+                    PATH + "/l_discount.bin");
+    }
+    if (rv != 0) {
+        return 1;
+    }
+
+    if (l_table->l_shipdate != nullptr) {
+        rv |= load_zone_map(&l_table->l_shipdate_zones, l_table->l_shipdate, numTuples, PATH + "/l_shipdate.zones");
+    }
+    if (l_table->l_commitdate != nullptr) {
+        rv |= load_zone_map(&l_table->l_commitdate_zones, l_table->l_commitdate, numTuples,
+                            PATH + "/l_commitdate.zones");
+    }
+    if (l_table->l_receiptdate != nullptr) {
+        rv |= load_zone_map(&l_table->l_receiptdate_zones, l_table->l_receiptdate, numTuples,
+                            PATH + "/l_receiptdate.zones");
+    }
+    if (rv != 0) {
+        logger(ERROR, "malloc error");
+        return 1;
     }
 
     return 0;
 }
 
 int
-load_lineitem_from_csv(LineItemTable *l_table, uint8_t scale) {
+load_lineitem_from_csv(LineItemTable *l_table, uint8_t scale, uint32_t num_threads) {
     logger(INFO, "Loading Lineitem");
 
-    const std::string PATH = getPath(scale, LINEITEM_TBL);
-
-    const uint64_t num_tuples = getNumberOfLines(PATH);
-
+    TblFile file;
+    if (file.open(getPath(scale, LINEITEM_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
     l_table->numTuples = num_tuples;
     int rv = 0;
     rv |= posix_memalign((void **) &(l_table->l_orderkey), 64, sizeof(tuple_t) * num_tuples);
@@ -312,55 +579,79 @@ load_lineitem_from_csv(LineItemTable *l_table, uint8_t scale) {
     rv |= posix_memalign((void **) &(l_table->l_partkey), 64, sizeof(type_key) * num_tuples);
     rv |= posix_memalign((void **) &(l_table->l_quantity), 64, sizeof(float) * num_tuples);
     rv |= posix_memalign((void **) &(l_table->l_shipinstruct), 64, sizeof(uint8_t) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_extendedprice), 64, sizeof(float) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_discount), 64, sizeof(float) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_tax), 64, sizeof(float) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_linestatus), 64, sizeof(char) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_suppkey), 64, sizeof(type_key) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_quantity_dec), 64, sizeof(decimal_t) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_extendedprice_dec), 64, sizeof(decimal_t) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_discount_dec), 64, sizeof(decimal_t) * num_tuples);
+    rv |= posix_memalign((void **) &(l_table->l_tax_dec), 64, sizeof(decimal_t) * num_tuples);
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
-    std::ifstream csv_file_stream{PATH};
-    CSVRow row;
-
-    for (uint64_t i = 0; i < num_tuples; ++i) {
-        csv_file_stream >> row;
-
-        if ((i & (1 << 20) - 1) == 0) {
-            logger(INFO, "Processed %lld rows of lineitem", i);
-        }
-
-        try {
-            vton_debug<type_key>(row[0], l_table->l_orderkey[i].key);
-            l_table->l_orderkey[i].payload = static_cast<type_value>(i);
-            vton_debug<type_key>(row[1], l_table->l_partkey[i]);
-            vton_debug<float>(row[4], l_table->l_quantity[i]);
-            l_table->l_returnflag[i] = row[8][0];
-            l_table->l_shipdate[i] = parseDateToLong_2(std::string{row[10]});
-            l_table->l_commitdate[i] = parseDateToLong_2(std::string{row[11]});
-            l_table->l_receiptdate[i] = parseDateToLong_2(std::string{row[12]});
-            l_table->l_shipinstruct[i] = parseLineitemShipinstruct(std::string{row[13]});
-            l_table->l_shipmode[i] = parseShipMode(std::string{row[14]});
-        } catch (const std::runtime_error &error) { handle_parse_error(row, i, error); }
-    }
+    DictionaryBuilder shipinstructs;
+    DictionaryBuilder shipmodes;
+    file.parse([&](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, l_table->l_orderkey[i].key);
+        l_table->l_orderkey[i].payload = static_cast<type_value>(i);
+        row.number(1, l_table->l_partkey[i]);
+        row.number(2, l_table->l_suppkey[i]);
+        row.number(4, l_table->l_quantity[i]);
+        row.number(5, l_table->l_extendedprice[i]);
+        row.number(6, l_table->l_discount[i]);
+        row.number(7, l_table->l_tax[i]);
+        row.decimal(4, l_table->l_quantity_dec[i]);
+        row.decimal(5, l_table->l_extendedprice_dec[i]);
+        row.decimal(6, l_table->l_discount_dec[i]);
+        row.decimal(7, l_table->l_tax_dec[i]);
+        l_table->l_returnflag[i] = row.first(8);
+        l_table->l_linestatus[i] = row.first(9);
+        l_table->l_shipdate[i] = row.date(10);
+        l_table->l_commitdate[i] = row.date(11);
+        l_table->l_receiptdate[i] = row.date(12);
+        l_table->l_shipinstruct[i] = static_cast<uint8_t>(shipinstructs.code(row[13]));
+        l_table->l_shipmode[i] = static_cast<uint8_t>(shipmodes.code(row[14]));
+    });
     logger(INFO, "lineitem table parsed");
-    return 0;
-}
+    if (shipinstructs.finish("l_shipinstruct", l_table->l_shipinstruct, num_tuples,
+                             &l_table->l_shipinstruct_dict) != 0 ||
+        shipmodes.finish("l_shipmode", l_table->l_shipmode, num_tuples, &l_table->l_shipmode_dict) != 0) {
+        return 1;
+    }
 
-uint8_t
-parseLineitemShipinstruct(const std::string &value) {
-    if (value == "DELIVER IN PERSON")
-        return L_SHIPINSTRUCT_DELIVER_IN_PERSON;
-    else
-        return 0;
+    l_table->l_shipdate_zones = build_zone_map(l_table->l_shipdate, num_tuples);
+    l_table->l_commitdate_zones = build_zone_map(l_table->l_commitdate, num_tuples);
+    l_table->l_receiptdate_zones = build_zone_map(l_table->l_receiptdate, num_tuples);
+    if (l_table->l_shipdate_zones == nullptr || l_table->l_commitdate_zones == nullptr ||
+        l_table->l_receiptdate_zones == nullptr) {
+        logger(ERROR, "malloc error");
+        return 1;
+    }
+    return encode_narrow_lineitem(l_table);
 }
 
 template<typename T>
 void
 checked_free(T * &ptr) {
     if (ptr != nullptr) {
-        free(ptr);
+        if (!release_column(ptr)) {
+            free(ptr);
+        }
         ptr = nullptr;
     }
 }
 
+void
+free_dictionary(dictionary_t *dictionary) {
+    checked_free(dictionary->values);
+    *dictionary = {};
+}
+
 void
 free_lineitem(LineItemTable *l_table) {
     l_table->numTuples = 0;
@@ -373,81 +664,130 @@ free_lineitem(LineItemTable *l_table) {
     checked_free(l_table->l_quantity);
     checked_free(l_table->l_shipinstruct);
     checked_free(l_table->l_shipmode);
+    checked_free(l_table->l_extendedprice);
+    checked_free(l_table->l_discount);
+    checked_free(l_table->l_tax);
+    checked_free(l_table->l_linestatus);
+    checked_free(l_table->l_suppkey);
+    checked_free(l_table->l_shipdate_zones);
+    checked_free(l_table->l_commitdate_zones);
+    checked_free(l_table->l_receiptdate_zones);
+    checked_free(l_table->l_shipdate_days);
+    checked_free(l_table->l_commitdate_days);
+    checked_free(l_table->l_receiptdate_days);
+    checked_free(l_table->l_quantity_u8);
+    checked_free(l_table->l_quantity_dec);
+    checked_free(l_table->l_extendedprice_dec);
+    checked_free(l_table->l_discount_dec);
+    checked_free(l_table->l_tax_dec);
+    checked_free(l_table->l_shipdate_days_zones);
+    checked_free(l_table->l_commitdate_days_zones);
+    checked_free(l_table->l_receiptdate_days_zones);
+    free_dictionary(&l_table->l_shipmode_dict);
+    free_dictionary(&l_table->l_shipinstruct_dict);
 }
 
 int
-load_orders_from_csv(OrdersTable *o_table, uint8_t scale) {
+load_orders_from_csv(OrdersTable *o_table, uint8_t scale, uint32_t num_threads) {
     logger(INFO, "Loading Orders");
 
-    const std::string PATH = getPath(scale, ORDERS_TBL);
-
-    const uint64_t num_tuples = getNumberOfLines(PATH);
-
+    TblFile file;
+    if (file.open(getPath(scale, ORDERS_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
     o_table->numTuples = num_tuples;
-    int rv = posix_memalign((void **) &(o_table->o_orderkey), 64, sizeof(tuple_t) * num_tuples);
+    int rv = 0;
+    rv |= posix_memalign((void **) &(o_table->o_orderkey), 64, sizeof(tuple_t) * num_tuples);
     rv |= posix_memalign((void **) &(o_table->o_orderdate), 64, sizeof(uint64_t) * num_tuples);
     rv |= posix_memalign((void **) &(o_table->o_custkey), 64, sizeof(type_key) * num_tuples);
+    rv |= posix_memalign((void **) &(o_table->o_orderpriority), 64, sizeof(uint8_t) * num_tuples);
+    rv |= posix_memalign((void **) &(o_table->o_shippriority), 64, sizeof(uint32_t) * num_tuples);
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
-    csv::CSVFormat format{};
-
-    format.delimiter('|');
-    format.no_header();
-    format.quote(false);
-
-    csv::CSVReader reader{PATH, format};
-    csv::CSVRow row;
-
-    for (uint64_t i = 0; i < num_tuples; ++i) {
-        reader.read_row(row);
-
-        if ((i & (1 << 20) - 1) == 0) {
-            logger(INFO, "Processed %lld rows of orders", i);
-        }
+    DictionaryBuilder priorities;
+    file.parse([&](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, o_table->o_orderkey[i].key);
+        o_table->o_orderkey[i].payload = static_cast<type_value>(i);
+        row.number(1, o_table->o_custkey[i]);
+        o_table->o_orderdate[i] = row.date(4);
+        o_table->o_orderpriority[i] = static_cast<uint8_t>(priorities.code(row[5]));
+        row.number(7, o_table->o_shippriority[i]);
+    });
+    logger(INFO, "orders table parsed");
+    if (priorities.finish("o_orderpriority", o_table->o_orderpriority, num_tuples, &o_table->o_orderpriority_dict) !=
+        0) {
+        return 1;
+    }
 
-        try {
-            o_table->o_orderkey[i].key = row[0].get<type_key>();
-            o_table->o_orderkey[i].payload = static_cast<type_value>(i);
-            o_table->o_custkey[i] = row[1].get<type_key>();
-            o_table->o_orderdate[i] = parseDateToLong_2(row[4].get());
-        } catch (std::runtime_error &error) { handle_parse_error(row, i, error); }
+    o_table->o_orderdate_zones = build_zone_map(o_table->o_orderdate, num_tuples);
+    if (o_table->o_orderdate_zones == nullptr) {
+        logger(ERROR, "malloc error");
+        return 1;
     }
-    logger(INFO, "orders table parsed");
-    return 0;
+    return encode_narrow_orders(o_table);
 }
 
 int
 load_orders_from_binary(OrdersTable *o_table, uint8_t query, uint8_t scale) {
-    if (query != 3 && query != 10 && query != 12) {
+    if (query != 3 && query != 5 && query != 9 && query != 10 && query != 12) {
         return 0;
     }
 
+    const std::string COLUMN_PATH = getPath(scale, ORDERS_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_orders(o_table, query, COLUMN_PATH);
+    }
+
     const std::string PATH = getPath(scale, ORDERS_TBL) + ".dir";
     uint64_t numTuples = read_size_file(PATH);
 
     o_table->numTuples = numTuples;
     int rv = posix_memalign((void **) &(o_table->o_orderkey), 64, sizeof(tuple_t) * numTuples);
-    if (query == 3 || query == 10) {
+    if (query == 3 || query == 5 || query == 9 || query == 10) {
         rv |= posix_memalign((void **) &(o_table->o_orderdate), 64, sizeof(uint64_t) * numTuples);
+    }
+    if (query == 3 || query == 5 || query == 10) {
         rv |= posix_memalign((void **) &(o_table->o_custkey), 64, sizeof(type_key) * numTuples);
     }
+    if (query == 3) {
+        rv |= posix_memalign((void **) &(o_table->o_shippriority), 64, sizeof(uint32_t) * numTuples);
+    } else if (query == 12) {
+        rv |= posix_memalign((void **) &(o_table->o_orderpriority), 64, sizeof(uint8_t) * numTuples);
+    }
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
     read_binary(reinterpret_cast<char *>(o_table->o_orderkey), numTuples * sizeof(tuple_t), PATH + "/o_orderkey.bin");
-    if (query == 3 || query == 10) {
+    if (query == 3 || query == 5 || query == 9 || query == 10) {
         read_binary(reinterpret_cast<char *>(o_table->o_orderdate), numTuples * sizeof(uint64_t),
                     PATH + "/o_orderdate.bin");
+    }
+    if (query == 3 || query == 5 || query == 10) {
         read_binary(reinterpret_cast<char *>(o_table->o_custkey), numTuples * sizeof(type_key),
                     PATH + "/o_custkey.bin");
     }
+    if (query == 3) {
+        read_binary(reinterpret_cast<char *>(o_table->o_shippriority), numTuples * sizeof(uint32_t),
+                    PATH + "/o_shippriority.bin");
+    } else if (query == 12) {
+        read_binary(reinterpret_cast<char *>(o_table->o_orderpriority), numTuples * sizeof(uint8_t),
+                    PATH + "/o_orderpriority.bin");
+        rv |= legacy_dictionary("o_orderpriority", &o_table->o_orderpriority_dict);
+    }
+    if (o_table->o_orderdate != nullptr &&
+        load_zone_map(&o_table->o_orderdate_zones, o_table->o_orderdate, numTuples, PATH + "/o_orderdate.zones") != 0) {
+        logger(ERROR, "malloc error");
+        return 1;
+    }
 
-    return 0;
+    return rv;
 }
 
 void
@@ -456,58 +796,56 @@ free_orders(OrdersTable *o_table) {
     checked_free(o_table->o_orderkey);
     checked_free(o_table->o_custkey);
     checked_free(o_table->o_orderdate);
+    checked_free(o_table->o_orderpriority);
+    checked_free(o_table->o_shippriority);
+    checked_free(o_table->o_orderdate_zones);
+    checked_free(o_table->o_orderdate_days);
+    checked_free(o_table->o_orderdate_days_zones);
+    free_dictionary(&o_table->o_orderpriority_dict);
 }
 
 int
-load_customer_from_csv(CustomerTable *c_table, uint8_t scale) {
+load_customer_from_csv(CustomerTable *c_table, uint8_t scale, uint32_t num_threads) {
     logger(INFO, "Loading Customers");
 
-    const std::string PATH = getPath(scale, CUSTOMER_TBL);
-
-    const uint64_t num_tuples = getNumberOfLines(PATH);
-
+    TblFile file;
+    if (file.open(getPath(scale, CUSTOMER_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
     c_table->numTuples = num_tuples;
-    int rv = posix_memalign((void **) &(c_table->c_custkey), 64, sizeof(tuple_t) * num_tuples);
+    int rv = 0;
+    rv |= posix_memalign((void **) &(c_table->c_custkey), 64, sizeof(tuple_t) * num_tuples);
     rv |= posix_memalign((void **) &(c_table->c_mktsegment), 64, sizeof(uint8_t) * num_tuples);
     rv |= posix_memalign((void **) &(c_table->c_nationkey), 64, sizeof(type_key) * num_tuples);
-
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
-    csv::CSVFormat format{};
-
-    format.delimiter('|');
-    format.no_header();
-    format.quote(false);
-
-    csv::CSVReader reader{PATH, format};
-    csv::CSVRow row;
-
-    for (uint64_t i = 0; i < num_tuples; i++) {
-        reader.read_row(row);
-
-        if ((i & (1 << 20) - 1) == 0) {
-            logger(INFO, "Processed %lld rows of customer", i);
-        }
 
-        try {
-            c_table->c_custkey[i].key = row[0].get<type_key>();
-            c_table->c_custkey[i].payload = static_cast<type_value>(i);
-            c_table->c_mktsegment[i] = parseMktSegment(row[6].get());
-            c_table->c_nationkey[i] = row[3].get<type_key>();
-        } catch (std::runtime_error &error) { handle_parse_error(row, i, error); }
-    }
+    DictionaryBuilder segments;
+    file.parse([&](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, c_table->c_custkey[i].key);
+        c_table->c_custkey[i].payload = static_cast<type_value>(i);
+        c_table->c_mktsegment[i] = static_cast<uint8_t>(segments.code(row[6]));
+        row.number(3, c_table->c_nationkey[i]);
+    });
     logger(INFO, "customer table parsed");
-    return 0;
+    return segments.finish("c_mktsegment", c_table->c_mktsegment, num_tuples, &c_table->c_mktsegment_dict);
 }
 
 int
 load_customers_from_binary(CustomerTable *c_table, uint8_t query, uint8_t scale) {
-    if (query != 3 && query != 10) {
+    if (query != 3 && query != 5 && query != 10) {
         return 0;
     }
 
+    const std::string COLUMN_PATH = getPath(scale, CUSTOMER_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_customers(c_table, query, COLUMN_PATH);
+    }
+
     const std::string PATH = getPath(scale, CUSTOMER_TBL) + ".dir";
     uint64_t numTuples = read_size_file(PATH);
 
@@ -516,7 +854,7 @@ load_customers_from_binary(CustomerTable *c_table, uint8_t query, uint8_t scale)
     int rv = posix_memalign(reinterpret_cast<void **>(&c_table->c_custkey), 64, sizeof(tuple_t) * numTuples);
     if (query == 3) {
         rv |= posix_memalign((void **) &c_table->c_mktsegment, 64, sizeof(uint8_t) * numTuples);
-    } else if (query == 10) {
+    } else if (query == 5 || query == 10) {
         rv |= posix_memalign((void **) &c_table->c_nationkey, 64, sizeof(type_key) * numTuples);
     }
     if (rv != 0) {
@@ -528,7 +866,8 @@ load_customers_from_binary(CustomerTable *c_table, uint8_t query, uint8_t scale)
     if (query == 3) {
         read_binary(reinterpret_cast<char *>(c_table->c_mktsegment), numTuples * sizeof(uint8_t),
                     PATH + "/c_mktsegment.bin");
-    } else if (query == 10) {
+        return legacy_dictionary("c_mktsegment", &c_table->c_mktsegment_dict);
+    } else if (query == 5 || query == 10) {
         read_binary(reinterpret_cast<char *>(c_table->c_nationkey), numTuples * sizeof(type_key),
                     PATH + "/c_nationkey.bin");
     }
@@ -542,60 +881,59 @@ free_customer(CustomerTable *c_table) {
     checked_free(c_table->c_custkey);
     checked_free(c_table->c_mktsegment);
     checked_free(c_table->c_nationkey);
+    free_dictionary(&c_table->c_mktsegment_dict);
 }
 
 int
-load_part_from_csv(PartTable *p, uint8_t scale) {
+load_part_from_csv(PartTable *p, uint8_t scale, uint32_t num_threads) {
     logger(INFO, "Loading Parts");
 
-    const std::string PATH = getPath(scale, PART_TBL);
-
-    const uint64_t num_tuples = getNumberOfLines(PATH);
-
+    TblFile file;
+    if (file.open(getPath(scale, PART_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
     p->numTuples = num_tuples;
-    int rv = posix_memalign((void **) &(p->p_partkey), 64, sizeof(tuple_t) * num_tuples);
+    int rv = 0;
+    rv |= posix_memalign((void **) &(p->p_partkey), 64, sizeof(tuple_t) * num_tuples);
     rv |= posix_memalign((void **) &(p->p_brand), 64, sizeof(uint8_t) * num_tuples);
     rv |= posix_memalign((void **) &(p->p_size), 64, sizeof(uint32_t) * num_tuples);
     rv |= posix_memalign((void **) &(p->p_container), 64, sizeof(uint8_t) * num_tuples);
+    rv |= posix_memalign((void **) &(p->p_name), 64, sizeof(uint8_t) * num_tuples);
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
-    csv::CSVFormat format{};
-
-    format.delimiter('|');
-    format.no_header();
-    format.quote(false);
-
-    csv::CSVReader reader{PATH, format};
-    csv::CSVRow row;
-
-    for (uint64_t i = 0; i < num_tuples; i++) {
-        reader.read_row(row);
-
-        if ((i & (1 << 20) - 1) == 0) {
-            logger(INFO, "Processed %lld rows of part", i);
-        }
-
-        try {
-            p->p_partkey[i].key = row[0].get<type_key>();
-            p->p_partkey[i].payload = static_cast<type_value>(i);
-            p->p_brand[i] = parsePartBrand(row[3].get());
-            p->p_size[i] = row[5].get<uint32_t>();
-            p->p_container[i] = parsePartContainer(row[6].get());
-        } catch (std::runtime_error &error) { handle_parse_error(row, i, error); }
-    }
+    DictionaryBuilder brands;
+    DictionaryBuilder containers;
+    file.parse([&](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, p->p_partkey[i].key);
+        p->p_partkey[i].payload = static_cast<type_value>(i);
+        p->p_name[i] = parsePartName(row[1]);
+        p->p_brand[i] = static_cast<uint8_t>(brands.code(row[3]));
+        row.number(5, p->p_size[i]);
+        p->p_container[i] = static_cast<uint8_t>(containers.code(row[6]));
+    });
     logger(INFO, "part table parsed");
-    return 0;
+    if (brands.finish("p_brand", p->p_brand, num_tuples, &p->p_brand_dict) != 0) {
+        return 1;
+    }
+    return containers.finish("p_container", p->p_container, num_tuples, &p->p_container_dict);
 }
 
 int
 load_parts_from_binary(PartTable *p, uint8_t query, uint8_t scale) {
-    if (query != 19) {
+    if (query != 9 && query != 19) {
         return 0;
     }
 
+    const std::string COLUMN_PATH = getPath(scale, PART_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_parts(p, query, COLUMN_PATH);
+    }
+
     const std::string PATH = getPath(scale, PART_TBL) + ".dir";
     uint64_t numTuples = read_size_file(PATH);
 
@@ -606,6 +944,8 @@ load_parts_from_binary(PartTable *p, uint8_t query, uint8_t scale) {
         rv |= posix_memalign((void **) &(p->p_brand), 64, sizeof(uint8_t) * numTuples);
         rv |= posix_memalign((void **) &(p->p_container), 64, sizeof(uint8_t) * numTuples);
         rv |= posix_memalign((void **) &(p->p_size), 64, sizeof(uint32_t) * numTuples);
+    } else if (query == 9) {
+        rv |= posix_memalign((void **) &(p->p_name), 64, sizeof(uint8_t) * numTuples);
     }
     if (rv != 0) {
         logger(ERROR, "memalign error");
@@ -617,49 +957,19 @@ load_parts_from_binary(PartTable *p, uint8_t query, uint8_t scale) {
         read_binary(reinterpret_cast<char *>(p->p_brand), numTuples * sizeof(uint8_t), PATH + "/p_brand.bin");
         read_binary(reinterpret_cast<char *>(p->p_container), numTuples * sizeof(uint8_t), PATH + "/p_container.bin");
         read_binary(reinterpret_cast<char *>(p->p_size), numTuples * sizeof(uint32_t), PATH + "/p_size.bin");
+        rv |= legacy_dictionary("p_brand", &p->p_brand_dict);
+        rv |= legacy_dictionary("p_container", &p->p_container_dict);
+    } else if (query == 9) {
+        read_binary(reinterpret_cast<char *>(p->p_name), numTuples * sizeof(uint8_t), PATH + "/p_name.bin");
     }
 
-    return 0;
+    return rv;
 }
 
 uint8_t
-parsePartContainer(const std::string &value) {
-    if (value == "SM CASE")
-        return P_CONTAINER_SM_CASE;
-    else if (value == "SM BOX")
-        return P_CONTAINER_SM_BOX;
-    else if (value == "SM PACK")
-        return P_CONTAINER_SM_PACK;
-    else if (value == "SM PKG")
-        return P_CONTAINER_SM_PKG;
-    else if (value == "MED BAG")
-        return P_CONTAINER_MED_BAG;
-    else if (value == "MED BOX")
-        return P_CONTAINER_MED_BOX;
-    else if (value == "MED PKG")
-        return P_CONTAINER_MED_PKG;
-    else if (value == "MED PACK")
-        return P_CONTAINER_MED_PACK;
-    else if (value == "LG CASE")
-        return P_CONTAINER_LG_CASE;
-    else if (value == "LG BOX")
-        return P_CONTAINER_LG_BOX;
-    else if (value == "LG PACK")
-        return P_CONTAINER_LG_PACK;
-    else if (value == "LG PKG")
-        return P_CONTAINER_LG_PKG;
-    else
-        return 0;
-}
-
-uint8_t
-parsePartBrand(const std::string &value) {
-    if (value == "Brand#12")
-        return P_BRAND_12;
-    else if (value == "Brand#23")
-        return P_BRAND_23;
-    else if (value == "Brand#34")
-        return P_BRAND_34;
+parsePartName(std::string_view value) {
+    if (value.find("green") != std::string_view::npos)
+        return P_NAME_GREEN;
     else
         return 0;
 }
@@ -671,65 +981,68 @@ free_part(PartTable *p) {
     checked_free(p->p_brand);
     checked_free(p->p_size);
     checked_free(p->p_container);
+    checked_free(p->p_name);
+    free_dictionary(&p->p_brand_dict);
+    free_dictionary(&p->p_container_dict);
 }
 
 int
-load_nation_from_csv(NationTable *n, uint8_t scale) {
+load_nation_from_csv(NationTable *n, uint8_t scale, uint32_t num_threads) {
     logger(INFO, "Loading Nation");
 
-    const std::string PATH = getPath(scale, NATION_TBL);
-
-    const uint64_t num_tuples = getNumberOfLines(PATH);
-
+    TblFile file;
+    if (file.open(getPath(scale, NATION_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
     n->numTuples = num_tuples;
-    int rv = posix_memalign((void **) &(n->n_nationkey), 64, sizeof(tuple_t) * num_tuples);
+    int rv = 0;
+    rv |= posix_memalign((void **) &(n->n_nationkey), 64, sizeof(tuple_t) * num_tuples);
+    rv |= posix_memalign((void **) &(n->n_regionkey), 64, sizeof(type_key) * num_tuples);
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
-    csv::CSVFormat format{};
-
-    format.delimiter('|');
-    format.no_header();
-    format.quote(false);
-
-    csv::CSVReader reader{PATH, format};
-    csv::CSVRow row;
-
-    for (uint64_t i = 0; i < num_tuples; i++) {
-        reader.read_row(row);
-
-        if ((i & (1 << 20) - 1) == 0) {
-            logger(INFO, "Processed %lld rows of nation", i);
-        }
-        try {
-            n->n_nationkey[i].key = row[0].get<type_key>();
-            n->n_nationkey[i].payload = static_cast<type_value>(i);
-        } catch (std::runtime_error &error) { handle_parse_error(row, i, error); }
-    }
+    file.parse([n](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, n->n_nationkey[i].key);
+        n->n_nationkey[i].payload = static_cast<type_value>(i);
+        row.number(2, n->n_regionkey[i]);
+    });
     logger(INFO, "nation table parsed");
     return 0;
 }
 
 int
 load_nations_from_binary(NationTable *n, uint8_t query, uint8_t scale) {
-    if (query != 10) {
+    if (query != 5 && query != 9 && query != 10) {
         return 0;
     }
 
+    const std::string COLUMN_PATH = getPath(scale, NATION_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_nations(n, query, COLUMN_PATH);
+    }
+
     const std::string PATH = getPath(scale, NATION_TBL) + ".dir";
     uint64_t numTuples = read_size_file(PATH);
 
     n->numTuples = numTuples;
 
     int rv = posix_memalign((void **) &(n->n_nationkey), 64, sizeof(tuple_t) * numTuples);
+    if (query == 5) {
+        rv |= posix_memalign((void **) &(n->n_regionkey), 64, sizeof(type_key) * numTuples);
+    }
     if (rv != 0) {
         logger(ERROR, "memalign error");
         return 1;
     }
 
     read_binary(reinterpret_cast<char *>(n->n_nationkey), numTuples * sizeof(tuple_t), PATH + "/n_nationkey.bin");
+    if (query == 5) {
+        read_binary(reinterpret_cast<char *>(n->n_regionkey), numTuples * sizeof(type_key), PATH + "/n_regionkey.bin");
+    }
 
     return 0;
 }
@@ -738,4 +1051,232 @@ void
 free_nation(NationTable *n) {
     n->numTuples = 0;
     checked_free(n->n_nationkey);
+    checked_free(n->n_regionkey);
+}
+
+int
+load_supplier_from_csv(SupplierTable *s, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Loading Supplier");
+
+    TblFile file;
+    if (file.open(getPath(scale, SUPPLIER_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
+    s->numTuples = num_tuples;
+    int rv = 0;
+    rv |= posix_memalign((void **) &(s->s_suppkey), 64, sizeof(tuple_t) * num_tuples);
+    rv |= posix_memalign((void **) &(s->s_nationkey), 64, sizeof(type_key) * num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    file.parse([s](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, s->s_suppkey[i].key);
+        s->s_suppkey[i].payload = static_cast<type_value>(i);
+        row.number(3, s->s_nationkey[i]);
+    });
+    logger(INFO, "supplier table parsed");
+    return 0;
+}
+
+int
+load_suppliers_from_binary(SupplierTable *s, uint8_t query, uint8_t scale) {
+    if (query != 5 && query != 9) {
+        return 0;
+    }
+
+    const std::string COLUMN_PATH = getPath(scale, SUPPLIER_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_suppliers(s, COLUMN_PATH);
+    }
+
+    const std::string PATH = getPath(scale, SUPPLIER_TBL) + ".dir";
+    uint64_t numTuples = read_size_file(PATH);
+
+    s->numTuples = numTuples;
+
+    int rv = posix_memalign((void **) &(s->s_suppkey), 64, sizeof(tuple_t) * numTuples);
+    rv |= posix_memalign((void **) &(s->s_nationkey), 64, sizeof(type_key) * numTuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    read_binary(reinterpret_cast<char *>(s->s_suppkey), numTuples * sizeof(tuple_t), PATH + "/s_suppkey.bin");
+    read_binary(reinterpret_cast<char *>(s->s_nationkey), numTuples * sizeof(type_key), PATH + "/s_nationkey.bin");
+
+    return 0;
+}
+
+void
+free_supplier(SupplierTable *s) {
+    s->numTuples = 0;
+    checked_free(s->s_suppkey);
+    checked_free(s->s_nationkey);
+}
+
+int
+load_region_from_csv(RegionTable *r, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Loading Region");
+
+    TblFile file;
+    if (file.open(getPath(scale, REGION_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
+    r->numTuples = num_tuples;
+    int rv = 0;
+    rv |= posix_memalign((void **) &(r->r_regionkey), 64, sizeof(tuple_t) * num_tuples);
+    rv |= posix_memalign((void **) &(r->r_name), 64, sizeof(uint8_t) * num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    DictionaryBuilder names;
+    file.parse([&](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, r->r_regionkey[i].key);
+        r->r_regionkey[i].payload = static_cast<type_value>(i);
+        r->r_name[i] = static_cast<uint8_t>(names.code(row[1]));
+    });
+    logger(INFO, "region table parsed");
+    return names.finish("r_name", r->r_name, num_tuples, &r->r_name_dict);
+}
+
+int
+load_regions_from_binary(RegionTable *r, uint8_t query, uint8_t scale) {
+    if (query != 5) {
+        return 0;
+    }
+
+    const std::string COLUMN_PATH = getPath(scale, REGION_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_regions(r, COLUMN_PATH);
+    }
+
+    const std::string PATH = getPath(scale, REGION_TBL) + ".dir";
+    uint64_t numTuples = read_size_file(PATH);
+
+    r->numTuples = numTuples;
+
+    int rv = posix_memalign((void **) &(r->r_regionkey), 64, sizeof(tuple_t) * numTuples);
+    rv |= posix_memalign((void **) &(r->r_name), 64, sizeof(uint8_t) * numTuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    read_binary(reinterpret_cast<char *>(r->r_regionkey), numTuples * sizeof(tuple_t), PATH + "/r_regionkey.bin");
+    read_binary(reinterpret_cast<char *>(r->r_name), numTuples * sizeof(uint8_t), PATH + "/r_name.bin");
+
+    return legacy_dictionary("r_name", &r->r_name_dict);
+}
+
+void
+free_region(RegionTable *r) {
+    r->numTuples = 0;
+    checked_free(r->r_regionkey);
+    checked_free(r->r_name);
+    free_dictionary(&r->r_name_dict);
+}
+
+int
+load_partsupp_from_csv(PartSuppTable *ps, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Loading PartSupp");
+
+    TblFile file;
+    if (file.open(getPath(scale, PARTSUPP_TBL), num_threads) != 0) {
+        return 1;
+    }
+    const uint64_t num_tuples = file.num_rows();
+    ps->numTuples = num_tuples;
+    int rv = 0;
+    rv |= posix_memalign((void **) &(ps->ps_partkey), 64, sizeof(tuple_t) * num_tuples);
+    rv |= posix_memalign((void **) &(ps->ps_suppkey), 64, sizeof(type_key) * num_tuples);
+    rv |= posix_memalign((void **) &(ps->ps_supplycost), 64, sizeof(float) * num_tuples);
+    rv |= posix_memalign((void **) &(ps->ps_supplycost_dec), 64, sizeof(decimal_t) * num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    file.parse([ps](const TblRow &row) {
+        const uint64_t i = row.index;
+        row.number(0, ps->ps_partkey[i].key);
+        ps->ps_partkey[i].payload = static_cast<type_value>(i);
+        row.number(1, ps->ps_suppkey[i]);
+        row.number(3, ps->ps_supplycost[i]);
+        row.decimal(3, ps->ps_supplycost_dec[i]);
+    });
+    logger(INFO, "partsupp table parsed");
+    return 0;
+}
+
+int
+load_partsupps_from_binary(PartSuppTable *ps, uint8_t query, uint8_t scale) {
+    if (query != 9) {
+        return 0;
+    }
+
+    const std::string COLUMN_PATH = getPath(scale, PARTSUPP_TBL) + COLUMN_FILE_SUFFIX;
+    if (ColumnFile::exists(COLUMN_PATH)) {
+        return map_partsupps(ps, COLUMN_PATH);
+    }
+
+    const std::string PATH = getPath(scale, PARTSUPP_TBL) + ".dir";
+    uint64_t numTuples = read_size_file(PATH);
+
+    ps->numTuples = numTuples;
+
+    int rv = posix_memalign((void **) &(ps->ps_partkey), 64, sizeof(tuple_t) * numTuples);
+    rv |= posix_memalign((void **) &(ps->ps_suppkey), 64, sizeof(type_key) * numTuples);
+    rv |= posix_memalign((void **) &(ps->ps_supplycost), 64, sizeof(float) * numTuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    read_binary(reinterpret_cast<char *>(ps->ps_partkey), numTuples * sizeof(tuple_t), PATH + "/ps_partkey.bin");
+    read_binary(reinterpret_cast<char *>(ps->ps_suppkey), numTuples * sizeof(type_key), PATH + "/ps_suppkey.bin");
+    read_binary(reinterpret_cast<char *>(ps->ps_supplycost), numTuples * sizeof(float),
+                PATH + "/ps_supplycost.bin");
+
+    return 0;
+}
+
+void
+free_partsupp(PartSuppTable *ps) {
+    ps->numTuples = 0;
+    checked_free(ps->ps_partkey);
+    checked_free(ps->ps_suppkey);
+    checked_free(ps->ps_supplycost);
+    checked_free(ps->ps_supplycost_dec);
+}
+
+int
+load_all_tables(uint8_t scale, uint32_t num_threads, LineItemTable *l, OrdersTable *o, CustomerTable *c, PartTable *p,
+                NationTable *n, SupplierTable *s, RegionTable *r, PartSuppTable *ps) {
+    auto column_path = [scale](const std::string &tbl) { return getPath(scale, tbl) + COLUMN_FILE_SUFFIX; };
+    int rv = 0;
+    rv |= ColumnFile::exists(column_path(LINEITEM_TBL)) ? map_lineitems(l, ALL_QUERIES, column_path(LINEITEM_TBL))
+                                                         : load_lineitem_from_csv(l, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(ORDERS_TBL)) ? map_orders(o, ALL_QUERIES, column_path(ORDERS_TBL))
+                                                       : load_orders_from_csv(o, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(CUSTOMER_TBL)) ? map_customers(c, ALL_QUERIES, column_path(CUSTOMER_TBL))
+                                                         : load_customer_from_csv(c, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(PART_TBL)) ? map_parts(p, ALL_QUERIES, column_path(PART_TBL))
+                                                     : load_part_from_csv(p, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(NATION_TBL)) ? map_nations(n, ALL_QUERIES, column_path(NATION_TBL))
+                                                       : load_nation_from_csv(n, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(SUPPLIER_TBL)) ? map_suppliers(s, column_path(SUPPLIER_TBL))
+                                                         : load_supplier_from_csv(s, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(REGION_TBL)) ? map_regions(r, column_path(REGION_TBL))
+                                                       : load_region_from_csv(r, scale, num_threads);
+    rv |= ColumnFile::exists(column_path(PARTSUPP_TBL)) ? map_partsupps(ps, column_path(PARTSUPP_TBL))
+                                                         : load_partsupp_from_csv(ps, scale, num_threads);
+    return rv;
 }
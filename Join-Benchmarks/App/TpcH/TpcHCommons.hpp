@@ -10,6 +10,12 @@ const std::string ORDERS_TBL = "orders.tbl";
 const std::string CUSTOMER_TBL = "customer.tbl";
 const std::string PART_TBL = "part.tbl";
 const std::string NATION_TBL = "nation.tbl";
+const std::string SUPPLIER_TBL = "supplier.tbl";
+const std::string REGION_TBL = "region.tbl";
+const std::string PARTSUPP_TBL = "partsupp.tbl";
+
+/** Query number under which the loaders map every column of a column file */
+constexpr uint8_t ALL_QUERIES = 0;
 
 struct tcph_args_t {
     //    algorithm_t *algorithm;
@@ -19,6 +25,15 @@ struct tcph_args_t {
     uint8_t bits{13};
     uint8_t scale{1};
     bool parallel;
+    bool generate{false}; // generate the tables instead of reading them from .tbl or column files
+    bool enclave_tables{false}; // copy the tables into the enclave once and run the queries on the copies
+    bool encrypt_tables{false}; // load the tables encrypted and decrypt them in the enclave, implies enclave_tables
+    uint8_t runs{1}; // number of times the query runs
+    bool serve{false}; // keep the tables in the enclave and run the queries requested on stdin or socket_path
+    char socket_path[108]{}; // Unix socket of the query server, stdin if empty
+    uint8_t streams{0}; // concurrent query streams of the throughput test, 0 runs the single query of -q
+    uint32_t refresh_rounds{0}; // rounds of refresh functions and queries of the refresh test, 0 runs no refreshes
+    uint32_t merge_percent{1}; // changed orders, in percent of the merged ones, at which the refresh test merges
 
     tcph_args_t() = default;
 };
@@ -26,44 +41,101 @@ struct tcph_args_t {
 std::string
 getPath(int scale, const std::string &tbl);
 
+/** Number of zones of ZONE_ROWS rows of a column with num_tuples rows */
+uint64_t
+num_zones(uint64_t num_tuples);
+
+/** Computes the zone map of a date column, nullptr if the allocation fails */
+zone_t *
+build_zone_map(const uint64_t *column, uint64_t num_tuples);
+
+/** Computes the zone map of a date column in days, nullptr if the allocation fails */
+zone_t *
+build_zone_map(const uint16_t *column, uint64_t num_tuples);
+
+/**
+ * Derives the narrow encodings of the columns the lineitem filters scan from the loaded columns: the dates as 16-bit
+ * day numbers with zone maps and l_quantity as 8-bit integer. A column that does not fit stays nullptr and the queries
+ * scan the plain column. Returns 0 on success.
+ */
+int
+encode_narrow_lineitem(LineItemTable *l_table);
+
+/** Derives o_orderdate_days and its zone map from o_orderdate, see encode_narrow_lineitem() */
+int
+encode_narrow_orders(OrdersTable *o_table);
+
+/** Reads the zone map of a column stored next to it by csv_convert, or builds it if the file does not exist */
+int
+load_zone_map(zone_t **zones, const uint64_t *column, uint64_t num_tuples, const std::string &path);
+
 void
 tpch_parse_args(int argc, char **argv, tcph_args_t *params);
 
 int
 load_lineitems_from_binary(LineItemTable *l_table, uint8_t query, uint8_t scale);
 int
-load_lineitem_from_csv(LineItemTable *l_table, uint8_t scale);
+load_lineitem_from_csv(LineItemTable *l_table, uint8_t scale, uint32_t num_threads);
 void
 free_lineitem(LineItemTable *l_table);
 
 int
 load_orders_from_binary(OrdersTable *o_table, uint8_t query, uint8_t scale);
 int
-load_orders_from_csv(OrdersTable *o_table, uint8_t scale);
+load_orders_from_csv(OrdersTable *o_table, uint8_t scale, uint32_t num_threads);
 void
 free_orders(OrdersTable *o_table);
 
 int
 load_customers_from_binary(CustomerTable *c_table, uint8_t query, uint8_t scale);
 int
-load_customer_from_csv(CustomerTable *c_table, uint8_t scale);
+load_customer_from_csv(CustomerTable *c_table, uint8_t scale, uint32_t num_threads);
 void
 free_customer(CustomerTable *c_table);
 
 int
 load_parts_from_binary(PartTable *p, uint8_t query, uint8_t scale);
 int
-load_part_from_csv(PartTable *p, uint8_t scale);
+load_part_from_csv(PartTable *p, uint8_t scale, uint32_t num_threads);
 void
 free_part(PartTable *p);
 
 int
 load_nations_from_binary(NationTable *n_table, uint8_t query, uint8_t scale);
 int
-load_nation_from_csv(NationTable *n, uint8_t scale);
+load_nation_from_csv(NationTable *n, uint8_t scale, uint32_t num_threads);
 void
 free_nation(NationTable *n);
 
+int
+load_suppliers_from_binary(SupplierTable *s, uint8_t query, uint8_t scale);
+int
+load_supplier_from_csv(SupplierTable *s, uint8_t scale, uint32_t num_threads);
+void
+free_supplier(SupplierTable *s);
+
+int
+load_regions_from_binary(RegionTable *r, uint8_t query, uint8_t scale);
+int
+load_region_from_csv(RegionTable *r, uint8_t scale, uint32_t num_threads);
+void
+free_region(RegionTable *r);
+
+int
+load_partsupps_from_binary(PartSuppTable *ps, uint8_t query, uint8_t scale);
+int
+load_partsupp_from_csv(PartSuppTable *ps, uint8_t scale, uint32_t num_threads);
+void
+free_partsupp(PartSuppTable *ps);
+
+/**
+ * Loads all columns of all tables, for the query server that runs any query on them: from the column files where they
+ * exist, otherwise from the .tbl files. Returns 0 on success.
+ */
+int
+load_all_tables(uint8_t scale, uint32_t num_threads, LineItemTable *l, OrdersTable *o, CustomerTable *c, PartTable *p,
+                NationTable *n, SupplierTable *s, RegionTable *r, PartSuppTable *ps);
+
 void
 print_query_results(uint64_t totalTime, uint64_t filterTime, uint64_t joinTime);
 #endif//TPCH_COMMONS_HPP
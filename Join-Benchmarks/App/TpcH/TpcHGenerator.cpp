@@ -0,0 +1,532 @@
+#include "TpcHGenerator.hpp"
+#include "Dictionary.hpp"
+#include "Logger.hpp"
+#include "TpcHCommons.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// dates of dbgen in days since 1970-01-01
+constexpr int64_t START_DATE = 8035;    // 1992-01-01
+constexpr int64_t END_DATE = 10591;     // 1998-12-31
+constexpr int64_t CURRENT_DATE = 9298;  // 1995-06-17, lineitems received until then are returned or accepted
+constexpr int64_t LAST_ORDER_DATE = END_DATE - 151;
+
+constexpr uint64_t CUSTOMERS_PER_SCALE = 150000;
+constexpr uint64_t ORDERS_PER_CUSTOMER = 10;
+constexpr uint64_t PARTS_PER_SCALE = 200000;
+constexpr uint64_t SUPPLIERS_PER_SCALE = 10000;
+constexpr uint64_t SUPPLIERS_PER_PART = 4;
+constexpr uint64_t NUM_NATIONS = 25;
+constexpr uint64_t NUM_REGIONS = 5;
+
+/** Region of every nation in the order of dbgen (ALGERIA, ARGENTINA, ..., UNITED STATES) */
+constexpr type_key NATION_REGIONS[NUM_NATIONS] = {0, 1, 1, 1, 4, 0, 3, 3, 2, 2, 4, 4, 2,
+                                                  4, 0, 0, 0, 1, 2, 3, 4, 2, 3, 3, 1};
+
+/**
+ * Values of a string column in the order of the lists of dbgen, which the generator draws indices into. The columns
+ * store the codes of the sorted dictionary, so code(index) maps a drawn index to the rank of its value.
+ */
+class ValueList {
+public:
+    explicit ValueList(std::vector<std::string> list) : sorted(std::move(list)), codes(sorted.size()) {
+        std::vector<std::string> values = sorted;
+        std::sort(sorted.begin(), sorted.end());
+        for (size_t i = 0; i < values.size(); ++i) {
+            codes[i] = static_cast<uint8_t>(std::lower_bound(sorted.begin(), sorted.end(), values[i]) - sorted.begin());
+        }
+    }
+
+    [[nodiscard]] uint8_t
+    code(int64_t index) const {
+        return codes[static_cast<size_t>(index)];
+    }
+
+    [[nodiscard]] int64_t
+    size() const {
+        return static_cast<int64_t>(codes.size());
+    }
+
+    /** Stores the sorted dictionary of the values, returns 0 on success */
+    int
+    dictionary(dictionary_t *dictionary) const {
+        return make_dictionary(sorted, dictionary);
+    }
+
+private:
+    std::vector<std::string> sorted;
+    std::vector<uint8_t> codes;
+};
+
+const ValueList REGION_NAMES{{"AFRICA", "AMERICA", "ASIA", "EUROPE", "MIDDLE EAST"}};
+const ValueList SEGMENTS{{"AUTOMOBILE", "BUILDING", "FURNITURE", "MACHINERY", "HOUSEHOLD"}};
+const ValueList PRIORITIES{{"1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED", "5-LOW"}};
+const ValueList SHIP_MODES{{"REG AIR", "AIR", "RAIL", "SHIP", "TRUCK", "MAIL", "FOB"}};
+const ValueList SHIP_INSTRUCTS{{"DELIVER IN PERSON", "COLLECT COD", "NONE", "TAKE BACK RETURN"}};
+
+/** Brand#MN with manufacturer M and brand N in [1, 5], at index (M - 1) * 5 + N - 1 */
+const ValueList BRANDS{[] {
+    std::vector<std::string> brands;
+    for (int manufacturer = 1; manufacturer <= 5; ++manufacturer) {
+        for (int brand = 1; brand <= 5; ++brand) {
+            brands.push_back("Brand#" + std::to_string(manufacturer * 10 + brand));
+        }
+    }
+    return brands;
+}()};
+
+/** The containers {SM, LG, MED, JUMBO, WRAP} x {CASE, BOX, BAG, JAR, PKG, PACK, CAN, DRUM}, 8 per size */
+constexpr int64_t CONTAINER_TYPES = 8;
+const ValueList CONTAINERS{[] {
+    std::vector<std::string> containers;
+    for (const char *size: {"SM", "LG", "MED", "JUMBO", "WRAP"}) {
+        for (const char *type: {"CASE", "BOX", "BAG", "JAR", "PKG", "PACK", "CAN", "DRUM"}) {
+            containers.push_back(std::string{size} + " " + type);
+        }
+    }
+    return containers;
+}()};
+
+/** p_name consists of 5 distinct of 92 colors, one of them is green */
+constexpr int64_t NAME_WORDS = 5;
+constexpr int64_t NUM_COLORS = 92;
+
+constexpr uint64_t GENERATOR_SEED = 0x5450432d48ULL;
+
+enum Stream : uint64_t {
+    STREAM_LINE_COUNTS, // number of lineitems of every order, drawn again when the lineitems are generated
+    STREAM_ORDERS,
+    STREAM_CUSTOMERS,
+    STREAM_PARTS,
+    STREAM_PARTSUPPS,
+    STREAM_SUPPLIERS,
+    STREAM_REFRESH, // orders and lineitems of the refresh sets, the chunk is the set
+};
+
+/** SplitMix64, a small generator that can be seeded for every chunk without a warm-up */
+class Random {
+public:
+    Random(Stream stream, uint64_t chunk) : state(mix(GENERATOR_SEED ^ static_cast<uint64_t>(stream) << 48 ^ chunk)) {}
+
+    uint64_t
+    next() {
+        return mix(state += 0x9e3779b97f4a7c15ULL);
+    }
+
+    /** Uniform in [low, high] */
+    int64_t
+    uniform(int64_t low, int64_t high) {
+        const auto range = static_cast<uint64_t>(high - low + 1);
+        return low + static_cast<int64_t>((static_cast<unsigned __int128>(next()) * range) >> 64);
+    }
+
+private:
+    static uint64_t
+    mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t state;
+};
+
+uint64_t
+num_chunks(uint64_t num_rows) {
+    return (num_rows + GENERATOR_CHUNK_ROWS - 1) / GENERATOR_CHUNK_ROWS;
+}
+
+/** Calls function(chunk, begin, end) for the chunks of num_rows rows, chunks are taken by the next free thread */
+template<typename Function>
+void
+for_each_chunk(uint64_t num_rows, uint32_t num_threads, const Function &function) {
+    std::atomic<uint64_t> next_chunk{0};
+    const auto worker = [&]() {
+        for (uint64_t chunk = next_chunk++; chunk < num_chunks(num_rows); chunk = next_chunk++) {
+            const uint64_t begin = chunk * GENERATOR_CHUNK_ROWS;
+            function(chunk, begin, std::min(begin + GENERATOR_CHUNK_ROWS, num_rows));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+template<typename T>
+int
+allocate(T **column, uint64_t num_tuples) {
+    return posix_memalign(reinterpret_cast<void **>(column), 64, std::max<uint64_t>(num_tuples, 1) * sizeof(T));
+}
+
+/** Orderkeys are sparse, only the first 8 of every 32 keys are used */
+type_key
+order_key(uint64_t row) {
+    return static_cast<type_key>(row / 8 * 32 + row % 8 + 1);
+}
+
+/** Orderkeys of the orders RF1 inserts, the second 8 of every 32 keys like in dbgen */
+type_key
+refresh_order_key(uint64_t row) {
+    return static_cast<type_key>(row / 8 * 32 + 8 + row % 8 + 1);
+}
+
+/** Retail price of a part in cents */
+int64_t
+retail_price(int64_t partkey) {
+    return 90000 + partkey / 10 % 20001 + 100 * (partkey % 1000);
+}
+
+/** Supplier i in [0, 4) of a part, the same function defines partsupp */
+type_key
+part_supplier(int64_t partkey, int64_t i, int64_t num_suppliers) {
+    const int64_t offset = i * (num_suppliers / 4 + (partkey - 1) / num_suppliers);
+    return static_cast<type_key>((partkey + offset) % num_suppliers + 1);
+}
+
+/** Keys the orders and lineitems of a scale factor refer to */
+struct order_keys_t {
+    int64_t num_customers;
+    int64_t num_parts;
+    int64_t num_suppliers;
+};
+
+order_keys_t
+order_keys(uint8_t scale) {
+    return {static_cast<int64_t>(scale * CUSTOMERS_PER_SCALE), static_cast<int64_t>(scale * PARTS_PER_SCALE),
+            static_cast<int64_t>(scale * SUPPLIERS_PER_SCALE)};
+}
+
+/** Generates the order at row with orderkey and its num_lines lineitems from row line on */
+void
+generate_order(OrdersTable *o, LineItemTable *l, uint64_t row, type_key orderkey, uint64_t line, int64_t num_lines,
+               const order_keys_t &keys, Random &random) {
+    o->o_orderkey[row] = {orderkey, static_cast<type_value>(row)};
+    // every third customer places no orders
+    const int64_t customer = random.uniform(0, keys.num_customers / 3 * 2 - 1);
+    o->o_custkey[row] = static_cast<type_key>(customer / 2 * 3 + customer % 2 + 1);
+    const int64_t orderdate = random.uniform(START_DATE, LAST_ORDER_DATE);
+    o->o_orderdate[row] = static_cast<uint64_t>(orderdate) * SECONDS_PER_DAY;
+    o->o_orderpriority[row] = PRIORITIES.code(random.uniform(0, PRIORITIES.size() - 1));
+    o->o_shippriority[row] = 0;
+
+    for (; num_lines > 0; --num_lines, ++line) {
+        const int64_t partkey = random.uniform(1, keys.num_parts);
+        const int64_t quantity = random.uniform(1, 50);
+        const int64_t shipdate = orderdate + random.uniform(1, 121);
+        const int64_t commitdate = orderdate + random.uniform(30, 90);
+        const int64_t receiptdate = shipdate + random.uniform(1, 30);
+        l->l_orderkey[line] = {orderkey, static_cast<type_value>(line)};
+        l->l_partkey[line] = static_cast<type_key>(partkey);
+        l->l_suppkey[line] = part_supplier(partkey, random.uniform(0, 3), keys.num_suppliers);
+        const int64_t extendedprice = quantity * retail_price(partkey);
+        const int64_t discount = random.uniform(0, 10);
+        const int64_t tax = random.uniform(0, 8);
+        l->l_quantity[line] = static_cast<float>(quantity);
+        l->l_extendedprice[line] = static_cast<float>(extendedprice) / 100.0f;
+        l->l_discount[line] = static_cast<float>(discount) / 100.0f;
+        l->l_tax[line] = static_cast<float>(tax) / 100.0f;
+        l->l_quantity_dec[line] = quantity * DECIMAL_ONE;
+        l->l_extendedprice_dec[line] = extendedprice;
+        l->l_discount_dec[line] = discount;
+        l->l_tax_dec[line] = tax;
+        l->l_shipdate[line] = static_cast<uint64_t>(shipdate) * SECONDS_PER_DAY;
+        l->l_commitdate[line] = static_cast<uint64_t>(commitdate) * SECONDS_PER_DAY;
+        l->l_receiptdate[line] = static_cast<uint64_t>(receiptdate) * SECONDS_PER_DAY;
+        const bool returned = random.uniform(0, 1) == 0;
+        l->l_returnflag[line] = receiptdate <= CURRENT_DATE ? (returned ? L_RETURNFLAG_R : L_RETURNFLAG_A)
+                                                            : L_RETURNFLAG_N;
+        l->l_linestatus[line] = shipdate > CURRENT_DATE ? L_LINESTATUS_O : L_LINESTATUS_F;
+        l->l_shipinstruct[line] = SHIP_INSTRUCTS.code(random.uniform(0, SHIP_INSTRUCTS.size() - 1));
+        l->l_shipmode[line] = SHIP_MODES.code(random.uniform(0, SHIP_MODES.size() - 1));
+    }
+}
+
+/** Allocates the columns the generator fills for num_orders orders and num_lineitems lineitems and the dictionaries */
+int
+allocate_orders_and_lineitems(OrdersTable *o, LineItemTable *l, uint64_t num_orders, uint64_t num_lineitems) {
+    int rv = allocate(&o->o_orderkey, num_orders);
+    rv |= allocate(&o->o_orderdate, num_orders);
+    rv |= allocate(&o->o_custkey, num_orders);
+    rv |= allocate(&o->o_orderpriority, num_orders);
+    rv |= allocate(&o->o_shippriority, num_orders);
+    rv |= allocate(&l->l_orderkey, num_lineitems);
+    rv |= allocate(&l->l_shipdate, num_lineitems);
+    rv |= allocate(&l->l_returnflag, num_lineitems);
+    rv |= allocate(&l->l_commitdate, num_lineitems);
+    rv |= allocate(&l->l_receiptdate, num_lineitems);
+    rv |= allocate(&l->l_shipmode, num_lineitems);
+    rv |= allocate(&l->l_partkey, num_lineitems);
+    rv |= allocate(&l->l_quantity, num_lineitems);
+    rv |= allocate(&l->l_shipinstruct, num_lineitems);
+    rv |= allocate(&l->l_extendedprice, num_lineitems);
+    rv |= allocate(&l->l_discount, num_lineitems);
+    rv |= allocate(&l->l_tax, num_lineitems);
+    rv |= allocate(&l->l_linestatus, num_lineitems);
+    rv |= allocate(&l->l_suppkey, num_lineitems);
+    rv |= allocate(&l->l_quantity_dec, num_lineitems);
+    rv |= allocate(&l->l_extendedprice_dec, num_lineitems);
+    rv |= allocate(&l->l_discount_dec, num_lineitems);
+    rv |= allocate(&l->l_tax_dec, num_lineitems);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+    return PRIORITIES.dictionary(&o->o_orderpriority_dict) | SHIP_MODES.dictionary(&l->l_shipmode_dict) |
+           SHIP_INSTRUCTS.dictionary(&l->l_shipinstruct_dict);
+}
+
+} // namespace
+
+int
+generate_orders_and_lineitems(OrdersTable *o, LineItemTable *l, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Generating Orders and Lineitem");
+    const uint64_t num_orders = scale * CUSTOMERS_PER_SCALE * ORDERS_PER_CUSTOMER;
+    const order_keys_t keys = order_keys(scale);
+
+    // the first lineitem of every chunk of orders
+    std::vector<uint64_t> first_lineitem(num_chunks(num_orders) + 1, 0);
+    for_each_chunk(num_orders, num_threads, [&](uint64_t chunk, uint64_t begin, uint64_t end) {
+        Random lines{STREAM_LINE_COUNTS, chunk};
+        uint64_t count = 0;
+        for (uint64_t row = begin; row < end; ++row) {
+            count += static_cast<uint64_t>(lines.uniform(1, 7));
+        }
+        first_lineitem[chunk + 1] = count;
+    });
+    for (uint64_t chunk = 1; chunk < first_lineitem.size(); ++chunk) {
+        first_lineitem[chunk] += first_lineitem[chunk - 1];
+    }
+    const uint64_t num_lineitems = first_lineitem.back();
+
+    o->numTuples = num_orders;
+    l->numTuples = num_lineitems;
+    if (allocate_orders_and_lineitems(o, l, num_orders, num_lineitems) != 0) {
+        return 1;
+    }
+
+    for_each_chunk(num_orders, num_threads, [&](uint64_t chunk, uint64_t begin, uint64_t end) {
+        Random lines{STREAM_LINE_COUNTS, chunk};
+        Random random{STREAM_ORDERS, chunk};
+        uint64_t line = first_lineitem[chunk];
+        for (uint64_t row = begin; row < end; ++row) {
+            const int64_t num_lines = lines.uniform(1, 7);
+            generate_order(o, l, row, order_key(row), line, num_lines, keys, random);
+            line += static_cast<uint64_t>(num_lines);
+        }
+    });
+    logger(INFO, "Generated %lu orders and %lu lineitems", num_orders, num_lineitems);
+
+    o->o_orderdate_zones = build_zone_map(o->o_orderdate, num_orders);
+    l->l_shipdate_zones = build_zone_map(l->l_shipdate, num_lineitems);
+    l->l_commitdate_zones = build_zone_map(l->l_commitdate, num_lineitems);
+    l->l_receiptdate_zones = build_zone_map(l->l_receiptdate, num_lineitems);
+    if (o->o_orderdate_zones == nullptr || l->l_shipdate_zones == nullptr || l->l_commitdate_zones == nullptr ||
+        l->l_receiptdate_zones == nullptr) {
+        logger(ERROR, "malloc error");
+        return 1;
+    }
+    return encode_narrow_orders(o) | encode_narrow_lineitem(l);
+}
+
+int
+generate_refresh_orders(OrdersTable *o, LineItemTable *l, uint8_t scale, uint64_t set) {
+    const uint64_t num_orders = scale * REFRESH_ORDERS_PER_SCALE;
+    const uint64_t first = set * num_orders;
+    o->numTuples = num_orders;
+    if (allocate_orders_and_lineitems(o, l, num_orders, num_orders * 7) != 0) {
+        return 1;
+    }
+    // the orderkeys of a set are in the gaps of the generated keys, the rows count the refreshed orders
+    Random random{STREAM_REFRESH, set};
+    const order_keys_t keys = order_keys(scale);
+    uint64_t line = 0;
+    for (uint64_t row = 0; row < num_orders; ++row) {
+        const int64_t num_lines = random.uniform(1, 7);
+        generate_order(o, l, row, refresh_order_key(first + row), line, num_lines, keys, random);
+        line += static_cast<uint64_t>(num_lines);
+    }
+    l->numTuples = line;
+    return 0;
+}
+
+void
+refresh_delete_keys(type_key *orderkeys, uint8_t scale, uint64_t set) {
+    const uint64_t num_orders = scale * REFRESH_ORDERS_PER_SCALE;
+    for (uint64_t i = 0; i < num_orders; ++i) {
+        orderkeys[i] = order_key(set * num_orders + i);
+    }
+}
+
+int
+generate_customers(CustomerTable *c, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Generating Customers");
+    const uint64_t num_tuples = scale * CUSTOMERS_PER_SCALE;
+    c->numTuples = num_tuples;
+    int rv = allocate(&c->c_custkey, num_tuples);
+    rv |= allocate(&c->c_mktsegment, num_tuples);
+    rv |= allocate(&c->c_nationkey, num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+    if (SEGMENTS.dictionary(&c->c_mktsegment_dict) != 0) {
+        return 1;
+    }
+
+    for_each_chunk(num_tuples, num_threads, [c](uint64_t chunk, uint64_t begin, uint64_t end) {
+        Random random{STREAM_CUSTOMERS, chunk};
+        for (uint64_t row = begin; row < end; ++row) {
+            c->c_custkey[row] = {static_cast<type_key>(row + 1), static_cast<type_value>(row)};
+            c->c_nationkey[row] = static_cast<type_key>(random.uniform(0, NUM_NATIONS - 1));
+            c->c_mktsegment[row] = SEGMENTS.code(random.uniform(0, SEGMENTS.size() - 1));
+        }
+    });
+    return 0;
+}
+
+int
+generate_parts(PartTable *p, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Generating Parts");
+    const uint64_t num_tuples = scale * PARTS_PER_SCALE;
+    p->numTuples = num_tuples;
+    int rv = allocate(&p->p_partkey, num_tuples);
+    rv |= allocate(&p->p_brand, num_tuples);
+    rv |= allocate(&p->p_size, num_tuples);
+    rv |= allocate(&p->p_container, num_tuples);
+    rv |= allocate(&p->p_name, num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+    if (BRANDS.dictionary(&p->p_brand_dict) != 0 || CONTAINERS.dictionary(&p->p_container_dict) != 0) {
+        return 1;
+    }
+
+    for_each_chunk(num_tuples, num_threads, [p](uint64_t chunk, uint64_t begin, uint64_t end) {
+        Random random{STREAM_PARTS, chunk};
+        for (uint64_t row = begin; row < end; ++row) {
+            p->p_partkey[row] = {static_cast<type_key>(row + 1), static_cast<type_value>(row)};
+            // green is one of the 5 colors with probability 5/92
+            p->p_name[row] = random.uniform(1, NUM_COLORS) <= NAME_WORDS ? P_NAME_GREEN : 0;
+            const int64_t manufacturer = random.uniform(1, 5);
+            p->p_brand[row] = BRANDS.code((manufacturer - 1) * 5 + random.uniform(1, 5) - 1);
+            p->p_size[row] = static_cast<uint32_t>(random.uniform(1, 50));
+            const int64_t size_syllable = random.uniform(0, 4);
+            p->p_container[row] = CONTAINERS.code(size_syllable * CONTAINER_TYPES +
+                                                  random.uniform(0, CONTAINER_TYPES - 1));
+        }
+    });
+    return 0;
+}
+
+int
+generate_partsupps(PartSuppTable *ps, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Generating PartSupp");
+    const uint64_t num_tuples = scale * PARTS_PER_SCALE * SUPPLIERS_PER_PART;
+    const int64_t num_suppliers = scale * SUPPLIERS_PER_SCALE;
+    ps->numTuples = num_tuples;
+    int rv = allocate(&ps->ps_partkey, num_tuples);
+    rv |= allocate(&ps->ps_suppkey, num_tuples);
+    rv |= allocate(&ps->ps_supplycost, num_tuples);
+    rv |= allocate(&ps->ps_supplycost_dec, num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    for_each_chunk(num_tuples, num_threads, [ps, num_suppliers](uint64_t chunk, uint64_t begin, uint64_t end) {
+        Random random{STREAM_PARTSUPPS, chunk};
+        for (uint64_t row = begin; row < end; ++row) {
+            const auto partkey = static_cast<int64_t>(row / SUPPLIERS_PER_PART + 1);
+            ps->ps_partkey[row] = {static_cast<type_key>(partkey), static_cast<type_value>(row)};
+            ps->ps_suppkey[row] = part_supplier(partkey, static_cast<int64_t>(row % SUPPLIERS_PER_PART),
+                                                num_suppliers);
+            const int64_t supplycost = random.uniform(100, 100000);
+            ps->ps_supplycost[row] = static_cast<float>(supplycost) / 100.0f;
+            ps->ps_supplycost_dec[row] = supplycost;
+        }
+    });
+    return 0;
+}
+
+int
+generate_suppliers(SupplierTable *s, uint8_t scale, uint32_t num_threads) {
+    logger(INFO, "Generating Suppliers");
+    const uint64_t num_tuples = scale * SUPPLIERS_PER_SCALE;
+    s->numTuples = num_tuples;
+    int rv = allocate(&s->s_suppkey, num_tuples);
+    rv |= allocate(&s->s_nationkey, num_tuples);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+
+    for_each_chunk(num_tuples, num_threads, [s](uint64_t chunk, uint64_t begin, uint64_t end) {
+        Random random{STREAM_SUPPLIERS, chunk};
+        for (uint64_t row = begin; row < end; ++row) {
+            s->s_suppkey[row] = {static_cast<type_key>(row + 1), static_cast<type_value>(row)};
+            s->s_nationkey[row] = static_cast<type_key>(random.uniform(0, NUM_NATIONS - 1));
+        }
+    });
+    return 0;
+}
+
+int
+generate_nations(NationTable *n) {
+    n->numTuples = NUM_NATIONS;
+    int rv = allocate(&n->n_nationkey, NUM_NATIONS);
+    rv |= allocate(&n->n_regionkey, NUM_NATIONS);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+    for (uint64_t row = 0; row < NUM_NATIONS; ++row) {
+        n->n_nationkey[row] = {static_cast<type_key>(row), static_cast<type_value>(row)};
+        n->n_regionkey[row] = NATION_REGIONS[row];
+    }
+    return 0;
+}
+
+int
+generate_regions(RegionTable *r) {
+    r->numTuples = NUM_REGIONS;
+    int rv = allocate(&r->r_regionkey, NUM_REGIONS);
+    rv |= allocate(&r->r_name, NUM_REGIONS);
+    if (rv != 0) {
+        logger(ERROR, "memalign error");
+        return 1;
+    }
+    if (REGION_NAMES.dictionary(&r->r_name_dict) != 0) {
+        return 1;
+    }
+    for (uint64_t row = 0; row < NUM_REGIONS; ++row) {
+        r->r_regionkey[row] = {static_cast<type_key>(row), static_cast<type_value>(row)};
+        r->r_name[row] = REGION_NAMES.code(static_cast<int64_t>(row));
+    }
+    return 0;
+}
+
+int
+generate_tables(uint8_t scale, uint32_t num_threads, LineItemTable *l, OrdersTable *o, CustomerTable *c, PartTable *p,
+                NationTable *n, SupplierTable *s, RegionTable *r, PartSuppTable *ps) {
+    int rv = generate_orders_and_lineitems(o, l, scale, num_threads);
+    rv |= generate_customers(c, scale, num_threads);
+    rv |= generate_parts(p, scale, num_threads);
+    rv |= generate_partsupps(ps, scale, num_threads);
+    rv |= generate_suppliers(s, scale, num_threads);
+    rv |= generate_nations(n);
+    rv |= generate_regions(r);
+    return rv;
+}
@@ -0,0 +1,65 @@
+#ifndef TPCH_GENERATOR_HPP
+#define TPCH_GENERATOR_HPP
+
+#include "TpcHTypes.hpp"
+#include <cstdint>
+
+/*
+ * Generator of the TPC-H columns the queries read, following the distributions of dbgen (TPC-H specification 4.2.3)
+ * without the text stage. The rows of a table are generated in chunks of GENERATOR_CHUNK_ROWS rows, every chunk draws
+ * from its own random stream seeded with the table and the index of the chunk. Threads take chunks one after another,
+ * so the tables are the same for any number of threads. The values are not the ones of dbgen, which draws from one
+ * sequential stream per column, but follow the same distributions and keep its key relations.
+ *
+ * The generated tables are allocated like the tables parsed from .tbl files and released with the free_* functions.
+ * Every function returns 0 on success.
+ */
+
+/** Rows of the driving table of a chunk, orders for lineitem */
+constexpr uint64_t GENERATOR_CHUNK_ROWS = 64 * 1024;
+
+/** Orders and their 1 to 7 lineitems each, both with zone maps of their date columns */
+int
+generate_orders_and_lineitems(OrdersTable *o, LineItemTable *l, uint8_t scale, uint32_t num_threads);
+
+/** Orders of a refresh set, 0.1% of the orders like in the TPC-H refresh functions */
+constexpr uint64_t REFRESH_ORDERS_PER_SCALE = 1500;
+
+/**
+ * Orders of the RF1 refresh set with their lineitems, without zone maps and narrow encodings. The orderkeys of the
+ * sets are unused by generate_orders_and_lineitems and unique across sets.
+ */
+int
+generate_refresh_orders(OrdersTable *o, LineItemTable *l, uint8_t scale, uint64_t set);
+
+/** Orderkeys of the RF2 refresh set, generated orders from the first ones on, REFRESH_ORDERS_PER_SCALE per set */
+void
+refresh_delete_keys(type_key *orderkeys, uint8_t scale, uint64_t set);
+
+int
+generate_customers(CustomerTable *c, uint8_t scale, uint32_t num_threads);
+
+int
+generate_parts(PartTable *p, uint8_t scale, uint32_t num_threads);
+
+/** Four suppliers of every part */
+int
+generate_partsupps(PartSuppTable *ps, uint8_t scale, uint32_t num_threads);
+
+int
+generate_suppliers(SupplierTable *s, uint8_t scale, uint32_t num_threads);
+
+/** The 25 nations of dbgen */
+int
+generate_nations(NationTable *n);
+
+/** The 5 regions of dbgen */
+int
+generate_regions(RegionTable *r);
+
+/** Generates all tables of the scale factor */
+int
+generate_tables(uint8_t scale, uint32_t num_threads, LineItemTable *l, OrdersTable *o, CustomerTable *c, PartTable *p,
+                NationTable *n, SupplierTable *s, RegionTable *r, PartSuppTable *ps);
+
+#endif//TPCH_GENERATOR_HPP
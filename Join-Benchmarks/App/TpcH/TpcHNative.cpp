@@ -1,6 +1,10 @@
 #include "Logger.hpp"
 #include "TpcHCommons.hpp"
+#include "TpcHGenerator.hpp"
+#include "TpcHRefresh.hpp"
+#include "TpcHThroughput.hpp"
 #include "tpch.hpp"
+#include "tpch_refresh.hpp"
 #include "Barrier.hpp"
 #include <thread>
 #include <vector>
@@ -9,10 +13,91 @@
 char experiment_filename[512];
 int write_to_file = 0;
 
+static void
+run_query(uint8_t query, result_t *result, const LineItemTable *l, const OrdersTable *o, const CustomerTable *c,
+          const PartTable *p, const NationTable *n, const SupplierTable *s, const RegionTable *r,
+          const PartSuppTable *ps, const char *algorithm, joinconfig_t *joinconfig) {
+    switch (query) {
+        case 1:
+            tpch_q1(result, l, joinconfig);
+            break;
+        case 3:
+            tpch_q3(result, c, o, l, algorithm, joinconfig);
+            break;
+        case 5:
+            tpch_q5(result, c, o, l, s, n, r, algorithm, joinconfig);
+            break;
+        case 6:
+            tpch_q6(result, l, joinconfig);
+            break;
+        case 9:
+            tpch_q9(result, p, s, l, ps, o, n, algorithm, joinconfig);
+            break;
+        case 10:
+            tpch_q10(result, c, o, l, n, algorithm, joinconfig);
+            break;
+        case 12:
+            tpch_q12(result, l, o, algorithm, joinconfig);
+            break;
+        case 19:
+            tpch_q19(result, l, p, algorithm, joinconfig);
+            break;
+        default:
+            logger(ERROR, "TPC-H Q%d is not supported", query);
+    }
+}
+
+/** Runs the refresh test of -f on a refresh store that takes over orders and lineitem */
+static int
+run_native_refresh_test(const tcph_args_t &params, const joinconfig_t &joinconfig, LineItemTable *l, OrdersTable *o,
+                        const CustomerTable *c, const PartTable *p, const NationTable *n, const SupplierTable *s,
+                        const RegionTable *r, const PartSuppTable *ps) {
+    refresh_store_t *store = nullptr;
+    refresh_target_t target;
+    target.start = [&](uint32_t delta_percent) {
+        store = refresh_store_create(o, l, o->numTuples * delta_percent / 100, params.nthreads);
+        free_orders(o);
+        free_lineitem(l);
+        return true;
+    };
+    target.query = [&](uint8_t query, int nthreads) {
+        joinconfig_t query_config = joinconfig;
+        query_config.NTHREADS = nthreads;
+        result_t result{};
+        OrdersTable orders{};
+        LineItemTable lineitem{};
+        refresh_store_acquire(store, &orders, &lineitem);
+        run_query(query, &result, &lineitem, &orders, c, p, n, s, r, ps, params.algorithm_name, &query_config);
+        refresh_store_release(store);
+        return true;
+    };
+    target.insert = [&](const OrdersTable *orders, const LineItemTable *lineitem, uint64_t *inserted) {
+        *inserted = refresh_insert(store, orders, lineitem);
+        return true;
+    };
+    target.remove = [&](const type_key *orderkeys, uint64_t num_keys, uint64_t *deleted) {
+        *deleted = refresh_delete(store, orderkeys, num_keys);
+        return true;
+    };
+    target.merge = [&](int nthreads, bool *merged) {
+        *merged = refresh_merge(store, nthreads);
+        return true;
+    };
+    target.stats = [&](refresh_stats_t *stats) {
+        refresh_store_stats(store, stats);
+        return true;
+    };
+    int rv = run_refresh_test(params.refresh_rounds, params.nthreads, params.scale, params.merge_percent, target);
+    if (store != nullptr) {
+        refresh_store_free(store);
+    }
+    return rv;
+}
+
 int
 main(int argc, char *argv[]) {
     initLogger();
-    joinconfig_t joinconfig;
+    joinconfig_t joinconfig{};
     logger(INFO, "************* TPC-H APP *************");
     // 1. Parse args
     tcph_args_t params;
@@ -28,7 +113,10 @@ main(int argc, char *argv[]) {
     OrdersTable o {0, nullptr, nullptr, nullptr};
     CustomerTable c {0, nullptr, nullptr, nullptr};
     PartTable p {0, nullptr, nullptr, nullptr, nullptr};
-    NationTable n {0, nullptr};
+    NationTable n {0, nullptr, nullptr};
+    SupplierTable s {0, nullptr, nullptr};
+    RegionTable r {0, nullptr, nullptr};
+    PartSuppTable ps {0, nullptr, nullptr, nullptr};
 
     constexpr uint64_t num_threads = 16;
 
@@ -66,32 +154,50 @@ main(int argc, char *argv[]) {
     logger(INFO, "Done.");
 
     logger(INFO, "Loading tables from storage.");
-    load_orders_from_binary(&o, query, params.scale);
-    load_customers_from_binary(&c, query, params.scale);
-    load_parts_from_binary(&p, query, params.scale);
-    load_nations_from_binary(&n, query, params.scale);
-    load_lineitems_from_binary(&l, query, params.scale);
+    if (params.generate) {
+        generate_tables(params.scale, params.nthreads, &l, &o, &c, &p, &n, &s, &r, &ps);
+    } else if (params.streams > 0 || params.refresh_rounds > 0) {
+        if (load_all_tables(params.scale, params.nthreads, &l, &o, &c, &p, &n, &s, &r, &ps) != 0) {
+            logger(ERROR, "Loading the tables failed");
+            return 1;
+        }
+    } else {
+        load_orders_from_binary(&o, query, params.scale);
+        load_customers_from_binary(&c, query, params.scale);
+        load_parts_from_binary(&p, query, params.scale);
+        load_nations_from_binary(&n, query, params.scale);
+        load_suppliers_from_binary(&s, query, params.scale);
+        load_regions_from_binary(&r, query, params.scale);
+        load_partsupps_from_binary(&ps, query, params.scale);
+        load_lineitems_from_binary(&l, query, params.scale);
+    }
     logger(INFO, "Done.");
 
-    // 4. execute specified query
-    result_t result{};
-    switch (query) {
-        case 3:
-            tpch_q3(&result, &c, &o, &l, params.algorithm_name, &joinconfig);
-            break;
-        case 10:
-            tpch_q10(&result, &c, &o, &l, &n, params.algorithm_name, &joinconfig);
-            break;
-        case 12:
-            tpch_q12(&result, &l, &o, params.algorithm_name, &joinconfig);
-            break;
-        case 19:
-            tpch_q19(&result, &l, &p, params.algorithm_name, &joinconfig);
-            break;
-        default:
-            logger(ERROR, "TPC-H Q%d is not supported", query);
+    // 4. execute specified query, or the query streams of the throughput test, or the refresh test
+    if (params.refresh_rounds > 0) {
+        if (run_native_refresh_test(params, joinconfig, &l, &o, &c, &p, &n, &s, &r, &ps) != 0) {
+            logger(ERROR, "Refresh test failed");
+        }
+    } else if (params.streams > 0) {
+        // the streams share the tables and the thread budget of -n
+        int rv = run_throughput_test(params.streams, params.nthreads, params.runs, params.scale,
+                                     [&](uint8_t stream_query, int nthreads) {
+            joinconfig_t stream_config = joinconfig;
+            stream_config.NTHREADS = nthreads;
+            result_t stream_result{};
+            run_query(stream_query, &stream_result, &l, &o, &c, &p, &n, &s, &r, &ps, params.algorithm_name,
+                      &stream_config);
+            return true;
+        });
+        if (rv != 0) {
+            logger(ERROR, "Throughput test failed");
+        }
+    } else {
+        result_t result{};
+        run_query(query, &result, &l, &o, &c, &p, &n, &s, &r, &ps, params.algorithm_name, &joinconfig);
     }
-    // 4. report and clean up
+
+    // 5. report and clean up
     logger(INFO, "Query completed");
 
     free_orders(&o);
@@ -99,4 +205,7 @@ main(int argc, char *argv[]) {
     free_customer(&c);
     free_lineitem(&l);
     free_nation(&n);
+    free_supplier(&s);
+    free_region(&r);
+    free_partsupp(&ps);
 }
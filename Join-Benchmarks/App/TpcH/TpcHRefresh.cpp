@@ -0,0 +1,164 @@
+#include "TpcHRefresh.hpp"
+#include "Logger.hpp"
+#include "TpcHCommons.hpp"
+#include "TpcHGenerator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+/** Queries the TPC-H library implements, every round runs each of them once */
+static const std::vector<uint8_t> REFRESH_QUERIES{1, 3, 5, 6, 9, 10, 12, 19};
+
+static double
+now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/** Runs every query once, logs its time and returns the time of all, a negative time if a query failed */
+static double
+run_queries(const refresh_target_t &target, uint32_t round, int nthreads) {
+    double total = 0;
+    for (uint8_t query : REFRESH_QUERIES) {
+        const double start = now_s();
+        if (!target.query(query, nthreads)) {
+            return -1;
+        }
+        const double seconds = now_s() - start;
+        logger(INFO, "Round %u Q%d: %.4fs", round, query, seconds);
+        total += seconds;
+    }
+    return total;
+}
+
+/** Applies RF1 and RF2 with the refresh set of a round, returns false if one of them failed */
+static bool
+run_refresh_functions(const refresh_target_t &target, uint8_t scale, uint32_t set, double *rf1_seconds,
+                      double *rf2_seconds) {
+    OrdersTable o{};
+    LineItemTable l{};
+    if (generate_refresh_orders(&o, &l, scale, set) != 0) {
+        free_orders(&o);
+        free_lineitem(&l);
+        return false;
+    }
+    uint64_t inserted = 0;
+    double start = now_s();
+    bool ok = target.insert(&o, &l, &inserted);
+    *rf1_seconds = now_s() - start;
+    const uint64_t num_orders = o.numTuples;
+    free_orders(&o);
+    free_lineitem(&l);
+    if (!ok) {
+        return false;
+    }
+
+    std::vector<type_key> orderkeys(num_orders);
+    refresh_delete_keys(orderkeys.data(), scale, set);
+    uint64_t deleted = 0;
+    start = now_s();
+    ok = target.remove(orderkeys.data(), orderkeys.size(), &deleted);
+    *rf2_seconds = now_s() - start;
+    if (ok && (inserted != num_orders || deleted != num_orders)) {
+        logger(WARN, "Refresh set %u: inserted %lu and deleted %lu of %lu orders", set, inserted, deleted,
+               num_orders);
+    }
+    return ok;
+}
+
+int
+run_refresh_test(uint32_t rounds, uint32_t nthreads, uint8_t scale, uint32_t merge_percent,
+                 const refresh_target_t &target) {
+    merge_percent = std::max(1U, merge_percent);
+    if (!target.start(3 * merge_percent)) {
+        logger(ERROR, "Starting the refresh store failed");
+        return 1;
+    }
+    logger(INFO, "Refresh test: %u rounds of %lu orders, merging at %u%% of the orders, %u threads", rounds,
+           scale * REFRESH_ORDERS_PER_SCALE, merge_percent, nthreads);
+
+    const double baseline = run_queries(target, 0, (int) nthreads);
+    if (baseline < 0) {
+        logger(ERROR, "Refresh test aborted, a query failed");
+        return 1;
+    }
+    logger(INFO, "Round 0: queries %.4fs", baseline);
+
+    std::thread merger;
+    std::atomic<bool> merging{false};
+    std::atomic<bool> merge_failed{false};
+    bool failed = false;
+    double rf1_total = 0;
+    double rf2_total = 0;
+    double query_total = 0;
+    for (uint32_t round = 1; round <= rounds && !failed; ++round) {
+        double rf1_seconds = 0;
+        double rf2_seconds = 0;
+        if (!run_refresh_functions(target, scale, round - 1, &rf1_seconds, &rf2_seconds)) {
+            logger(ERROR, "Refresh test aborted, a refresh function failed");
+            failed = true;
+            break;
+        }
+
+        refresh_stats_t stats{};
+        if (!target.stats(&stats)) {
+            failed = true;
+            break;
+        }
+        const uint64_t changed = stats.orders_delta + stats.orders_deleted;
+        if (!merging.load() && changed * 100 >= stats.orders_main * merge_percent) {
+            if (merger.joinable()) {
+                merger.join();
+            }
+            logger(INFO, "Round %u: merging %lu inserted and %lu deleted orders in the background", round,
+                   stats.orders_delta, stats.orders_deleted);
+            merging.store(true);
+            // the merge takes the threads of the queries, which wait for it only while it replaces the tables
+            merger = std::thread([&target, &merging, &merge_failed, nthreads]() {
+                bool merged = false;
+                if (!target.merge((int) nthreads, &merged)) {
+                    merge_failed.store(true);
+                }
+                merging.store(false);
+            });
+        }
+
+        const double query_seconds = run_queries(target, round, (int) nthreads);
+        if (query_seconds < 0) {
+            logger(ERROR, "Refresh test aborted, a query failed");
+            failed = true;
+            break;
+        }
+        logger(INFO, "Round %u: RF1 %.4fs, RF2 %.4fs, queries %.4fs (%+.1f%% of round 0)", round, rf1_seconds,
+               rf2_seconds, query_seconds, (query_seconds / baseline - 1) * 100);
+        rf1_total += rf1_seconds;
+        rf2_total += rf2_seconds;
+        query_total += query_seconds;
+    }
+    if (merger.joinable()) {
+        merger.join();
+    }
+    if (failed || merge_failed.load()) {
+        logger(ERROR, "Refresh test failed");
+        return 1;
+    }
+
+    refresh_stats_t stats{};
+    if (!target.stats(&stats)) {
+        return 1;
+    }
+    if (rounds > 0) {
+        logger(INFO, "Refresh: RF1 mean %.4fs, RF2 mean %.4fs, queries mean %.4fs per round, %.4fs in round 0",
+               rf1_total / rounds, rf2_total / rounds, query_total / rounds, baseline);
+    }
+    logger(INFO, "Merges: %lu in the background, %lu forced by RF1, %lu cycles building and %lu cycles installing "
+                 "after waiting %lu cycles for the queries", stats.merges, stats.forced_merges, stats.merge_cycles,
+           stats.install_cycles, stats.wait_cycles);
+    logger(INFO, "Orders: %lu main, %lu delta, %lu deleted; lineitems: %lu main, %lu delta, %lu deleted",
+           stats.orders_main, stats.orders_delta, stats.orders_deleted, stats.lineitems_main, stats.lineitems_delta,
+           stats.lineitems_deleted);
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef TPCH_REFRESH_HPP
+#define TPCH_REFRESH_HPP
+
+#include "TpcHTypes.hpp"
+#include "data-types.h"
+#include <cstdint>
+#include <functional>
+
+/**
+ * The delta store of orders and lineitem the refresh test runs against, in the enclave or natively. Every function
+ * returns false if it failed, which ends the test.
+ */
+struct refresh_target_t {
+    /** Moves orders and lineitem into the store, with a delta of delta_percent percent of the orders */
+    std::function<bool(uint32_t delta_percent)> start;
+    /** Runs a query with nthreads threads, on the tables of the store */
+    std::function<bool(uint8_t query, int nthreads)> query;
+    /** RF1 */
+    std::function<bool(const OrdersTable *o, const LineItemTable *l, uint64_t *inserted)> insert;
+    /** RF2 */
+    std::function<bool(const type_key *orderkeys, uint64_t num_keys, uint64_t *deleted)> remove;
+    /** Merges the delta and the deletes, called on a thread of its own */
+    std::function<bool(int nthreads, bool *merged)> merge;
+    std::function<bool(refresh_stats_t *stats)> stats;
+};
+
+/**
+ * Refresh test in the manner of the TPC-H power test: after a round of queries on the loaded tables, every round
+ * applies RF1 with a new set of orders, RF2 with a set of the loaded orders and runs the queries. A merge starts in the
+ * background once the inserted and deleted orders reach merge_percent percent of the merged ones, the delta has room
+ * for three times as many. Logs the times of the refresh functions and queries of every round and the merges.
+ * @return 0 on success
+ */
+int
+run_refresh_test(uint32_t rounds, uint32_t nthreads, uint8_t scale, uint32_t merge_percent,
+                 const refresh_target_t &target);
+
+#endif//TPCH_REFRESH_HPP
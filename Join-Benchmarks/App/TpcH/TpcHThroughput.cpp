@@ -0,0 +1,140 @@
+#include "TpcHThroughput.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+/** Queries the TPC-H library implements, every stream runs each of them once per pass */
+static const std::vector<uint8_t> STREAM_QUERIES{1, 3, 5, 6, 9, 10, 12, 19};
+
+struct query_time_t {
+    uint8_t query;
+    double seconds;
+};
+
+struct stream_t {
+    int nthreads;
+    std::vector<uint8_t> queries;
+    std::vector<query_time_t> times;
+    double seconds;
+};
+
+static double
+now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/** Nearest-rank percentile of sorted latencies */
+static double
+percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto rank = (size_t) std::max(1.0, std::ceil(p / 100.0 * (double) sorted.size()));
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+static std::vector<double>
+sorted_latencies(const std::vector<query_time_t> &times) {
+    std::vector<double> latencies;
+    latencies.reserve(times.size());
+    for (const auto &time : times) {
+        latencies.push_back(time.seconds);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+int
+run_throughput_test(uint32_t streams, uint32_t nthreads, uint32_t passes, uint8_t scale,
+                    const stream_query_t &run_query) {
+    streams = std::max(1U, streams);
+    passes = std::max(1U, passes);
+    std::vector<stream_t> stream_states(streams);
+    for (uint32_t i = 0; i < streams; ++i) {
+        stream_t &stream = stream_states[i];
+        // the streams share the threads, the first ones get the remainder
+        stream.nthreads = (int) std::max(1U, nthreads / streams + (i < nthreads % streams ? 1 : 0));
+        // fixed seeds, so that every run of the test issues the same query orders
+        std::mt19937 generator(i + 1);
+        for (uint32_t pass = 0; pass < passes; ++pass) {
+            std::vector<uint8_t> order = STREAM_QUERIES;
+            std::shuffle(order.begin(), order.end(), generator);
+            stream.queries.insert(stream.queries.end(), order.begin(), order.end());
+        }
+    }
+    logger(INFO, "Throughput test: %u streams of %lu queries, %u threads", streams,
+           stream_states[0].queries.size(), nthreads);
+
+    std::atomic<bool> failed{false};
+    auto stream_main = [&](stream_t &stream) {
+        const double start = now_s();
+        for (uint8_t query : stream.queries) {
+            if (failed.load()) {
+                break;
+            }
+            const double query_start = now_s();
+            if (!run_query(query, stream.nthreads)) {
+                failed.store(true);
+                break;
+            }
+            stream.times.push_back({query, now_s() - query_start});
+        }
+        stream.seconds = now_s() - start;
+    };
+
+    const double start = now_s();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < streams; ++i) {
+        threads.emplace_back(stream_main, std::ref(stream_states[i]));
+    }
+    stream_main(stream_states[0]);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const double total_seconds = now_s() - start;
+    if (failed.load()) {
+        logger(ERROR, "Throughput test aborted, a query failed");
+        return 1;
+    }
+
+    std::vector<query_time_t> all_times;
+    for (uint32_t i = 0; i < streams; ++i) {
+        const stream_t &stream = stream_states[i];
+        const std::vector<double> latencies = sorted_latencies(stream.times);
+        logger(INFO, "Stream %u (%d threads): %lu queries in %.3fs, %.1f Qph@SF%d, latency p50 %.4fs p95 %.4fs "
+                     "max %.4fs", i, stream.nthreads, stream.times.size(), stream.seconds,
+               (double) stream.times.size() * 3600.0 / stream.seconds * scale, scale, percentile(latencies, 50),
+               percentile(latencies, 95), latencies.back());
+        all_times.insert(all_times.end(), stream.times.begin(), stream.times.end());
+    }
+
+    std::map<uint8_t, std::vector<query_time_t>> times_of_query;
+    for (const auto &time : all_times) {
+        times_of_query[time.query].push_back(time);
+    }
+    for (const auto &[query, times] : times_of_query) {
+        const std::vector<double> latencies = sorted_latencies(times);
+        double sum = 0;
+        for (double latency : latencies) {
+            sum += latency;
+        }
+        logger(INFO, "Q%d: %lu runs, latency mean %.4fs p50 %.4fs p95 %.4fs max %.4fs", query, latencies.size(),
+               sum / (double) latencies.size(), percentile(latencies, 50), percentile(latencies, 95),
+               latencies.back());
+    }
+
+    const std::vector<double> latencies = sorted_latencies(all_times);
+    logger(INFO, "Throughput: %lu queries in %.3fs, %.1f Qph@SF%d", all_times.size(), total_seconds,
+           (double) all_times.size() * 3600.0 / total_seconds * scale, scale);
+    logger(INFO, "Latency: p50 %.4fs p90 %.4fs p95 %.4fs p99 %.4fs max %.4fs", percentile(latencies, 50),
+           percentile(latencies, 90), percentile(latencies, 95), percentile(latencies, 99), latencies.back());
+    return 0;
+}
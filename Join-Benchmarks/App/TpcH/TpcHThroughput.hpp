@@ -0,0 +1,23 @@
+#ifndef TPCH_THROUGHPUT_HPP
+#define TPCH_THROUGHPUT_HPP
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * Runs one query of a stream with nthreads threads. Called concurrently by all streams, on the same tables.
+ * @return false if the query failed, which ends the test
+ */
+using stream_query_t = std::function<bool(uint8_t query, int nthreads)>;
+
+/**
+ * Throughput test in the manner of the TPC-H throughput test: streams run concurrently, each one runs every supported
+ * query passes times in its own random order. The nthreads threads are split evenly across the streams. Logs the
+ * queries per hour and the latency percentiles of every stream and of all streams together.
+ * @return 0 on success
+ */
+int
+run_throughput_test(uint32_t streams, uint32_t nthreads, uint32_t passes, uint8_t scale,
+                    const stream_query_t &run_query);
+
+#endif//TPCH_THROUGHPUT_HPP
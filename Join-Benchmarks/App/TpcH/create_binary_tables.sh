@@ -2,5 +2,5 @@
 
 for scale in 1 10 100
 do
-  ./csv_convert -s ${scale}
+  ./csv_convert -s ${scale} -n "$(nproc)"
 done
@@ -0,0 +1,289 @@
+#include "ResultExport.hpp"
+#include "Enclave_t.h"
+#include "JoinInput.hpp"
+#include "Logger.hpp"
+#include "joins.hpp"
+#include "rdtscpWrapper.h"
+#include "util.hpp"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+/** Rows of a linked list result that are gathered in the enclave before they are written out at once */
+constexpr uint64_t EXPORT_STAGING_TUPLES = 4096;
+
+/** One chunk of the export, a chunk of a chunked or columnar result or the list of one join thread */
+struct export_segment_t {
+    const output_list_t *list;
+    const output_triple_t *triples;
+    const column_chunk_t *columns;
+    uint64_t num_tuples;
+    uint64_t offset;
+};
+
+struct export_thread_arg_t {
+    std::atomic<uint64_t> *next_segment;
+    const std::vector<export_segment_t> *segments;
+    uint8_t *buffer;
+    uint32_t columns;
+    bool encrypt;
+    const uint8_t *nonce;
+};
+
+static result_t *export_result = nullptr;
+static sgx_aes_ctr_128bit_key_t export_key;
+static bool export_key_set = false;
+
+[[nodiscard]] static inline uint64_t
+round_up_64(uint64_t bytes) {
+    return (bytes + 63) & ~uint64_t{63};
+}
+
+[[nodiscard]] static uint32_t
+exported_columns(const result_t *result) {
+    if (result->result_type == 2) {
+        return static_cast<const columnar_table_t *>(result->result)->columns;
+    }
+    return COLUMN_ALL;
+}
+
+[[nodiscard]] static uint64_t
+segment_size(uint64_t num_tuples, int result_type, uint32_t columns) {
+    if (result_type == 2) {
+        return __builtin_popcount(columns) * round_up_64(num_tuples * sizeof(type_key));
+    }
+    return round_up_64(num_tuples * sizeof(output_triple_t));
+}
+
+/**
+ * Collects the segments of the result and assigns each one its offset in the buffer.
+ * @param segments [out]
+ * @return total number of bytes of the export
+ */
+static uint64_t
+collect_segments(const result_t *result, std::vector<export_segment_t> &segments) {
+    segments.clear();
+    switch (result->result_type) {
+        case 0: {
+            auto thread_results = static_cast<const threadresult_t *>(result->result);
+            for (int i = 0; i < result->nthreads; ++i) {
+                segments.push_back({thread_results[i].results, nullptr, nullptr,
+                                    static_cast<uint64_t>(thread_results[i].nresults), 0});
+            }
+            break;
+        }
+        case 1: {
+            auto table = static_cast<const chunked_table_t *>(result->result);
+            for (uint64_t c = 0; c < table->num_chunks; ++c) {
+                segments.push_back({nullptr, table->chunks[c]->tuples, nullptr, table->chunks[c]->num_tuples, 0});
+            }
+            break;
+        }
+        case 2: {
+            auto table = static_cast<const columnar_table_t *>(result->result);
+            for (uint64_t c = 0; c < table->num_chunks; ++c) {
+                segments.push_back({nullptr, nullptr, &table->chunks[c], table->chunks[c].num_tuples, 0});
+            }
+            break;
+        }
+        default:
+            logger(ERROR, "Unknown result type %d", result->result_type);
+            ocall_exit(EXIT_FAILURE);
+    }
+
+    const uint32_t columns = exported_columns(result);
+    uint64_t offset = round_up_64(segments.size() * sizeof(export_chunk_t));
+    for (auto &segment : segments) {
+        segment.offset = offset;
+        offset += segment_size(segment.num_tuples, result->result_type, columns);
+    }
+    return offset;
+}
+
+/**
+ * Writes bytes to offset in the host buffer. Encrypted data uses the counter block nonce || offset / 16, so every
+ * thread can encrypt its part of the buffer independently. offset has to be a multiple of 16.
+ */
+static void
+write_out(const export_thread_arg_t *arg, uint64_t offset, const void *source, uint64_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    if (!arg->encrypt) {
+        memcpy(arg->buffer + offset, source, bytes);
+        return;
+    }
+    uint8_t counter[16];
+    memcpy(counter, arg->nonce, 8);
+    const uint64_t block = offset / 16;
+    for (int i = 0; i < 8; ++i) {
+        counter[15 - i] = static_cast<uint8_t>(block >> (8 * i));
+    }
+    auto status = sgx_aes_ctr_encrypt(&export_key, static_cast<const uint8_t *>(source), static_cast<uint32_t>(bytes),
+                                      counter, 64, arg->buffer + offset);
+    if (status != SGX_SUCCESS) {
+        logger(ERROR, "Encrypting the exported join result failed with %d", status);
+        ocall_exit(EXIT_FAILURE);
+    }
+}
+
+static void
+export_segment(const export_thread_arg_t *arg, const export_segment_t &segment) {
+    if (segment.triples != nullptr) {
+        write_out(arg, segment.offset, segment.triples, segment.num_tuples * sizeof(output_triple_t));
+    } else if (segment.columns != nullptr) {
+        const type_key *columns[3] = {segment.columns->keys, segment.columns->Rpayloads, segment.columns->Spayloads};
+        const uint64_t column_size = round_up_64(segment.num_tuples * sizeof(type_key));
+        uint64_t offset = segment.offset;
+        for (int c = 0; c < 3; ++c) {
+            if (arg->columns & (1u << c)) {
+                write_out(arg, offset, columns[c], segment.num_tuples * sizeof(type_key));
+                offset += column_size;
+            }
+        }
+    } else {
+        // Linked lists are gathered into the staging buffer. Its size is a multiple of 16 bytes, so every part starts
+        // at a new counter block.
+        static_assert(EXPORT_STAGING_TUPLES * sizeof(output_triple_t) % 16 == 0);
+        std::vector<output_triple_t> staging(std::min(segment.num_tuples, EXPORT_STAGING_TUPLES));
+        const output_list_t *node = segment.list;
+        uint64_t offset = segment.offset;
+        uint64_t remaining = segment.num_tuples;
+        while (remaining > 0) {
+            const uint64_t part = std::min(remaining, EXPORT_STAGING_TUPLES);
+            for (uint64_t i = 0; i < part; ++i) {
+                staging[i] = {node->key, node->Rpayload, node->Spayload};
+                node = node->next;
+            }
+            write_out(arg, offset, staging.data(), part * sizeof(output_triple_t));
+            offset += part * sizeof(output_triple_t);
+            remaining -= part;
+        }
+    }
+}
+
+static void *
+export_thread(void *param) {
+    auto arg = static_cast<const export_thread_arg_t *>(param);
+    uint64_t segment;
+    while ((segment = arg->next_segment->fetch_add(1, std::memory_order_relaxed)) < arg->segments->size()) {
+        export_segment(arg, (*arg->segments)[segment]);
+    }
+    return nullptr;
+}
+
+uint64_t
+set_export_result(result_t *result) {
+    if (export_result != nullptr) {
+        logger(WARN, "Dropping a join result that was never exported");
+        destroy_join_result(export_result);
+        free(export_result);
+    }
+    if (!result->materialized) {
+        logger(ERROR, "Only materialized join results can be exported");
+        ocall_exit(EXIT_FAILURE);
+    }
+    export_result = result;
+    std::vector<export_segment_t> segments;
+    return collect_segments(result, segments);
+}
+
+extern "C" {
+
+void
+ecall_join_export(uint64_t *export_size, const struct table_t *relR, const struct table_t *relS,
+                  const char *algorithm_name, const struct joinconfig_t *config) {
+    auto materialize_config = *config;
+    materialize_config.MATERIALIZE = true;
+    auto result = static_cast<result_t *>(malloc(sizeof(result_t)));
+    malloc_check(result)
+    run_join(result, relR, relS, algorithm_name, &materialize_config);
+    *export_size = set_export_result(result);
+}
+
+/**
+ * Sets the key used for encrypted exports. Stands in for a key exchange with the consumer of the join results, e.g.
+ * after remote attestation.
+ */
+void
+ecall_set_export_key(const uint8_t *key) {
+    memcpy(export_key, key, sizeof(export_key));
+    export_key_set = true;
+}
+
+/**
+ * Writes the join result kept by the last join for export into the host buffer with nthreads threads and frees it.
+ * @param buffer host memory of at least the export size returned by the join, checked to be outside the enclave
+ * @param buffer_size
+ * @param encrypt encrypt the chunk data with the export key
+ * @param nthreads
+ * @param descriptor [out] chunk count and encryption parameters, the chunk offsets are at the start of the buffer
+ * @return SGX_ERROR_INVALID_PARAMETER if there is no result to export or the buffer is not suitable
+ */
+sgx_status_t
+ecall_export_join_result(uint8_t *buffer, uint64_t buffer_size, int encrypt, int nthreads,
+                         export_descriptor_t *descriptor) {
+    if (export_result == nullptr) {
+        logger(ERROR, "There is no join result to export");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    if (encrypt && !export_key_set) {
+        logger(ERROR, "Encrypted export requested, but no export key was set");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    std::vector<export_segment_t> segments;
+    const uint64_t export_size = collect_segments(export_result, segments);
+    if (buffer == nullptr || buffer_size < export_size || !sgx_is_outside_enclave(buffer, buffer_size)) {
+        logger(ERROR, "Export buffer must be outside the enclave and hold at least %lu bytes", export_size);
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+
+    uint64_t start = rdtscp_s();
+    memset(descriptor, 0, sizeof(export_descriptor_t));
+    descriptor->num_chunks = segments.size();
+    descriptor->bytes_written = export_size;
+    descriptor->result_type = export_result->result_type;
+    descriptor->columns = exported_columns(export_result);
+    descriptor->encrypted = encrypt != 0;
+    if (encrypt && sgx_read_rand(descriptor->nonce, sizeof(descriptor->nonce)) != SGX_SUCCESS) {
+        logger(ERROR, "Could not generate a nonce for the export");
+        return SGX_ERROR_UNEXPECTED;
+    }
+
+    // The chunk table is metadata and always written in plain text
+    std::vector<export_chunk_t> chunk_table(segments.size());
+    for (uint64_t i = 0; i < segments.size(); ++i) {
+        chunk_table[i] = {segments[i].offset, segments[i].num_tuples};
+        descriptor->num_tuples += segments[i].num_tuples;
+    }
+    memcpy(buffer, chunk_table.data(), chunk_table.size() * sizeof(export_chunk_t));
+
+    std::atomic<uint64_t> next_segment{0};
+    export_thread_arg_t arg{&next_segment, &segments, buffer, descriptor->columns, encrypt != 0, descriptor->nonce};
+    nthreads = std::max(1, std::min<int>(nthreads, static_cast<int>(segments.size())));
+    std::vector<pthread_t> tid(nthreads);
+    int rv;
+    for (int i = 0; i < nthreads; ++i) {
+        rv = pthread_create(&tid[i], nullptr, export_thread, (void *) &arg);
+        if (rv) {
+            logger(ERROR, "return code from pthread_create() is %d\n", rv);
+            ocall_exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < nthreads; ++i) {
+        pthread_join(tid[i], nullptr);
+    }
+    logger(INFO, "Exported %lu tuples in %lu chunks (%lu bytes) in %lu cycles", descriptor->num_tuples,
+           descriptor->num_chunks, export_size, rdtscp_s() - start);
+
+    destroy_join_result(export_result);
+    free(export_result);
+    export_result = nullptr;
+    return SGX_SUCCESS;
+}
+
+}
@@ -0,0 +1,15 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_RESULTEXPORT_HPP
+#define SGXV2_JOIN_BENCHMARKS_RESULTEXPORT_HPP
+
+#include "data-types.h"
+
+/**
+ * Keeps a materialized join result in the enclave until ecall_export_join_result ships it to the host. Replaces and
+ * frees a result that was not exported yet.
+ * @param result heap allocated, ownership moves to the export
+ * @return size of the host buffer required for the export in bytes
+ */
+uint64_t
+set_export_result(result_t *result);
+
+#endif//SGXV2_JOIN_BENCHMARKS_RESULTEXPORT_HPP
@@ -1,11 +1,19 @@
 #include "Enclave_t.h"
+#include "TpcHTables.hpp"
 #include "TpcHTypes.hpp"
+#include "Logger.hpp"
 #include "data-types.h"
 #include "tpch.hpp"
 #include "sgx_error.h"
 
 extern "C" {
 
+sgx_status_t
+ecall_tpch_q1(result_t *result, const LineItemTable *l, joinconfig_t *config) {
+    tpch_q1(result, l, config);
+    return SGX_SUCCESS;
+}
+
 sgx_status_t
 ecall_tpch_q3(result_t *result, const struct CustomerTable *c, const struct OrdersTable *o,
               const struct LineItemTable *l, const char *algorithm, struct joinconfig_t *config) {
@@ -13,6 +21,28 @@ ecall_tpch_q3(result_t *result, const struct CustomerTable *c, const struct Orde
     return SGX_SUCCESS;
 }
 
+sgx_status_t
+ecall_tpch_q5(result_t *result, const CustomerTable *c, const OrdersTable *o, const LineItemTable *l,
+              const SupplierTable *s, const NationTable *n, const RegionTable *r, const char *algorithm,
+              joinconfig_t *config) {
+    tpch_q5(result, c, o, l, s, n, r, algorithm, config);
+    return SGX_SUCCESS;
+}
+
+sgx_status_t
+ecall_tpch_q6(result_t *result, const LineItemTable *l, joinconfig_t *config) {
+    tpch_q6(result, l, config);
+    return SGX_SUCCESS;
+}
+
+sgx_status_t
+ecall_tpch_q9(result_t *result, const PartTable *p, const SupplierTable *s, const LineItemTable *l,
+              const PartSuppTable *ps, const OrdersTable *o, const NationTable *n, const char *algorithm,
+              joinconfig_t *config) {
+    tpch_q9(result, p, s, l, ps, o, n, algorithm, config);
+    return SGX_SUCCESS;
+}
+
 sgx_status_t
 ecall_tpch_q10(result_t *result, const CustomerTable *c, const OrdersTable *o, const LineItemTable *l,
                const NationTable *n, const char *algorithm, joinconfig_t *config) {
@@ -34,4 +64,59 @@ ecall_tpch_q19(result_t *result, const LineItemTable *l, const PartTable *p, con
     return SGX_SUCCESS;
 }
 
+/**
+ * Runs a query on the tables loaded by ecall_tpch_load_tables, so repeated queries do not copy them into the enclave
+ * again. Once the refresh store is started, orders and lineitem come from the store, as of the last refresh.
+ */
+sgx_status_t
+ecall_tpch_query(result_t *result, uint8_t query, const char *algorithm, joinconfig_t *config) {
+    const resident_tables_t *tables = resident_tables();
+    if (tables == nullptr) {
+        logger(ERROR, "No TPC-H tables are loaded into the enclave");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    resident_tables_t refreshed;
+    refresh_store_t *store = resident_refresh_store();
+    if (store != nullptr) {
+        refreshed = *tables;
+        refresh_store_acquire(store, &refreshed.o, &refreshed.l);
+        tables = &refreshed;
+    }
+    sgx_status_t status = SGX_SUCCESS;
+    switch (query) {
+        case 1:
+            tpch_q1(result, &tables->l, config);
+            break;
+        case 3:
+            tpch_q3(result, &tables->c, &tables->o, &tables->l, algorithm, config);
+            break;
+        case 5:
+            tpch_q5(result, &tables->c, &tables->o, &tables->l, &tables->s, &tables->n, &tables->r, algorithm, config);
+            break;
+        case 6:
+            tpch_q6(result, &tables->l, config);
+            break;
+        case 9:
+            tpch_q9(result, &tables->p, &tables->s, &tables->l, &tables->ps, &tables->o, &tables->n, algorithm,
+                    config);
+            break;
+        case 10:
+            tpch_q10(result, &tables->c, &tables->o, &tables->l, &tables->n, algorithm, config);
+            break;
+        case 12:
+            tpch_q12(result, &tables->l, &tables->o, algorithm, config);
+            break;
+        case 19:
+            tpch_q19(result, &tables->l, &tables->p, algorithm, config);
+            break;
+        default:
+            logger(ERROR, "TPC-H query %d is not supported", query);
+            status = SGX_ERROR_INVALID_PARAMETER;
+    }
+    if (store != nullptr) {
+        refresh_store_release(store);
+    }
+    return status;
+}
+
 }
@@ -0,0 +1,466 @@
+#include "TpcHTables.hpp"
+#include "Enclave_t.h"
+#include "Logger.hpp"
+#include "data-types.h"
+#include "rdtscpWrapper.h"
+#include "util.hpp"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <cstring>
+#include <vector>
+
+/** Bytes copied or decrypted at once by one thread, a multiple of the AES block size */
+constexpr uint64_t LOAD_PIECE_BYTES = 1024 * 1024;
+
+/** A column of a host table and its copy in the enclave, target == source for in-place encryption */
+struct load_column_t {
+    const uint8_t *source;
+    uint8_t *target;
+    uint64_t size;
+    uint64_t nonce; // position of the column among all columns of the tables
+};
+
+struct load_piece_t {
+    const load_column_t *column;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct load_thread_arg_t {
+    std::atomic<uint64_t> *next_piece;
+    const std::vector<load_piece_t> *pieces;
+    bool crypt;
+};
+
+static resident_tables_t resident{};
+static bool resident_loaded = false;
+static sgx_aes_ctr_128bit_key_t load_key;
+static bool load_key_set = false;
+static refresh_store_t *refresh_store = nullptr;
+
+/* Calls column(pointer, count) for every column, zone map and dictionary of a table, in the order of the struct */
+
+template<typename Function>
+static void
+visit_columns(LineItemTable &t, Function &&column) {
+    const uint64_t n = t.numTuples;
+    const uint64_t zones = (n + ZONE_ROWS - 1) / ZONE_ROWS;
+    column(t.l_orderkey, n);
+    column(t.l_shipdate, n);
+    column(t.l_commitdate, n);
+    column(t.l_receiptdate, n);
+    column(t.l_shipmode, n);
+    column(t.l_partkey, n);
+    column(t.l_quantity, n);
+    column(t.l_shipinstruct, n);
+    column(t.l_returnflag, n);
+    column(t.l_extendedprice, n);
+    column(t.l_discount, n);
+    column(t.l_tax, n);
+    column(t.l_linestatus, n);
+    column(t.l_suppkey, n);
+    column(t.l_shipdate_zones, zones);
+    column(t.l_commitdate_zones, zones);
+    column(t.l_receiptdate_zones, zones);
+    column(t.l_shipdate_days, n);
+    column(t.l_commitdate_days, n);
+    column(t.l_receiptdate_days, n);
+    column(t.l_quantity_u8, n);
+    column(t.l_quantity_dec, n);
+    column(t.l_extendedprice_dec, n);
+    column(t.l_discount_dec, n);
+    column(t.l_tax_dec, n);
+    column(t.l_shipdate_days_zones, zones);
+    column(t.l_commitdate_days_zones, zones);
+    column(t.l_receiptdate_days_zones, zones);
+    column(t.l_shipmode_dict.values, t.l_shipmode_dict.size);
+    column(t.l_shipinstruct_dict.values, t.l_shipinstruct_dict.size);
+}
+
+template<typename Function>
+static void
+visit_columns(OrdersTable &t, Function &&column) {
+    const uint64_t n = t.numTuples;
+    const uint64_t zones = (n + ZONE_ROWS - 1) / ZONE_ROWS;
+    column(t.o_orderkey, n);
+    column(t.o_orderdate, n);
+    column(t.o_custkey, n);
+    column(t.o_orderpriority, n);
+    column(t.o_shippriority, n);
+    column(t.o_orderdate_zones, zones);
+    column(t.o_orderdate_days, n);
+    column(t.o_orderdate_days_zones, zones);
+    column(t.o_orderpriority_dict.values, t.o_orderpriority_dict.size);
+}
+
+template<typename Function>
+static void
+visit_columns(CustomerTable &t, Function &&column) {
+    column(t.c_custkey, t.numTuples);
+    column(t.c_mktsegment, t.numTuples);
+    column(t.c_nationkey, t.numTuples);
+    column(t.c_mktsegment_dict.values, t.c_mktsegment_dict.size);
+}
+
+template<typename Function>
+static void
+visit_columns(PartTable &t, Function &&column) {
+    column(t.p_partkey, t.numTuples);
+    column(t.p_brand, t.numTuples);
+    column(t.p_size, t.numTuples);
+    column(t.p_container, t.numTuples);
+    column(t.p_name, t.numTuples);
+    column(t.p_brand_dict.values, t.p_brand_dict.size);
+    column(t.p_container_dict.values, t.p_container_dict.size);
+}
+
+template<typename Function>
+static void
+visit_columns(NationTable &t, Function &&column) {
+    column(t.n_nationkey, t.numTuples);
+    column(t.n_regionkey, t.numTuples);
+}
+
+template<typename Function>
+static void
+visit_columns(SupplierTable &t, Function &&column) {
+    column(t.s_suppkey, t.numTuples);
+    column(t.s_nationkey, t.numTuples);
+}
+
+template<typename Function>
+static void
+visit_columns(RegionTable &t, Function &&column) {
+    column(t.r_regionkey, t.numTuples);
+    column(t.r_name, t.numTuples);
+    column(t.r_name_dict.values, t.r_name_dict.size);
+}
+
+template<typename Function>
+static void
+visit_columns(PartSuppTable &t, Function &&column) {
+    column(t.ps_partkey, t.numTuples);
+    column(t.ps_suppkey, t.numTuples);
+    column(t.ps_supplycost, t.numTuples);
+    column(t.ps_supplycost_dec, t.numTuples);
+}
+
+template<typename Function>
+static void
+visit_columns(resident_tables_t &tables, Function &&column) {
+    visit_columns(tables.l, column);
+    visit_columns(tables.o, column);
+    visit_columns(tables.c, column);
+    visit_columns(tables.p, column);
+    visit_columns(tables.n, column);
+    visit_columns(tables.s, column);
+    visit_columns(tables.r, column);
+    visit_columns(tables.ps, column);
+}
+
+template<typename Tables>
+static void
+free_tables(Tables &tables) {
+    visit_columns(tables, [](auto *&column, uint64_t) {
+        free(column);
+        column = nullptr;
+    });
+}
+
+/**
+ * Lists the columns of the host tables in tables. With allocate, every column gets a copy in enclave memory and
+ * tables points to the copies afterwards, otherwise the columns are their own targets.
+ * @return false if a column is not entirely outside the enclave
+ */
+static bool
+collect_columns(resident_tables_t &tables, bool allocate, std::vector<load_column_t> &columns) {
+    bool outside = true;
+    uint64_t nonce = 0;
+    visit_columns(tables, [&](auto *&column, uint64_t count) {
+        const uint64_t size = count * sizeof(*column);
+        const auto source = reinterpret_cast<uint8_t *>(column);
+        ++nonce;
+        if (column == nullptr || !outside) {
+            column = nullptr;
+            return;
+        }
+        if (!sgx_is_outside_enclave(source, size)) {
+            outside = false;
+            column = nullptr;
+            return;
+        }
+        if (allocate) {
+            column = static_cast<std::remove_reference_t<decltype(column)>>(
+                    aligned_alloc(64, std::max<uint64_t>((size + 63) / 64 * 64, 64)));
+            malloc_check(column)
+        }
+        columns.push_back({source, reinterpret_cast<uint8_t *>(column), size, nonce});
+    });
+    return outside;
+}
+
+/**
+ * Copies a piece of a column, or runs AES-128-CTR over it. The counter block is the nonce of the column followed by
+ * the index of the 16-byte block in the column, so every thread can process its pieces independently.
+ */
+static void
+load_piece(const load_piece_t &piece, bool crypt) {
+    const load_column_t &column = *piece.column;
+    if (!crypt) {
+        memcpy(column.target + piece.offset, column.source + piece.offset, piece.size);
+        return;
+    }
+    uint8_t counter[16];
+    const uint64_t block = piece.offset / 16;
+    for (int i = 0; i < 8; ++i) {
+        counter[7 - i] = static_cast<uint8_t>(column.nonce >> (8 * i));
+        counter[15 - i] = static_cast<uint8_t>(block >> (8 * i));
+    }
+    auto status = sgx_aes_ctr_decrypt(&load_key, column.source + piece.offset, static_cast<uint32_t>(piece.size),
+                                      counter, 64, column.target + piece.offset);
+    if (status != SGX_SUCCESS) {
+        logger(ERROR, "Decrypting a TPC-H column failed with %d", status);
+        ocall_exit(EXIT_FAILURE);
+    }
+}
+
+static void *
+load_thread(void *param) {
+    auto arg = static_cast<const load_thread_arg_t *>(param);
+    uint64_t piece;
+    while ((piece = arg->next_piece->fetch_add(1, std::memory_order_relaxed)) < arg->pieces->size()) {
+        load_piece((*arg->pieces)[piece], arg->crypt);
+    }
+    return nullptr;
+}
+
+/** Processes the columns in pieces of LOAD_PIECE_BYTES with nthreads threads, returns the number of bytes */
+static uint64_t
+load_columns(const std::vector<load_column_t> &columns, bool crypt, int nthreads) {
+    std::vector<load_piece_t> pieces;
+    uint64_t bytes = 0;
+    for (const auto &column : columns) {
+        for (uint64_t offset = 0; offset < column.size; offset += LOAD_PIECE_BYTES) {
+            pieces.push_back({&column, offset, std::min(LOAD_PIECE_BYTES, column.size - offset)});
+        }
+        bytes += column.size;
+    }
+
+    std::atomic<uint64_t> next_piece{0};
+    load_thread_arg_t arg{&next_piece, &pieces, crypt};
+    nthreads = std::max(1, std::min<int>(nthreads, static_cast<int>(pieces.size())));
+    std::vector<pthread_t> tid(nthreads);
+    int rv;
+    for (int i = 0; i < nthreads; ++i) {
+        rv = pthread_create(&tid[i], nullptr, load_thread, (void *) &arg);
+        if (rv) {
+            logger(ERROR, "return code from pthread_create() is %d\n", rv);
+            ocall_exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < nthreads; ++i) {
+        pthread_join(tid[i], nullptr);
+    }
+    return bytes;
+}
+
+static resident_tables_t
+tables_of(const LineItemTable *l, const OrdersTable *o, const CustomerTable *c, const PartTable *p,
+          const NationTable *n, const SupplierTable *s, const RegionTable *r, const PartSuppTable *ps) {
+    resident_tables_t tables{*l, *o, *c, *p, *n, *s, *r, *ps};
+    // only the refresh functions delete rows
+    tables.l.l_deleted = nullptr;
+    tables.l.l_deleted_zones = nullptr;
+    tables.o.o_deleted = nullptr;
+    tables.o.o_deleted_zones = nullptr;
+    return tables;
+}
+
+/** @return true if every column of a host table is entirely outside the enclave */
+template<typename Table>
+static bool
+outside_enclave(Table table) {
+    bool outside = true;
+    visit_columns(table, [&](auto *&column, uint64_t count) {
+        outside &= column == nullptr || sgx_is_outside_enclave(column, count * sizeof(*column));
+    });
+    return outside;
+}
+
+static void
+free_refresh_store() {
+    if (refresh_store != nullptr) {
+        refresh_store_free(refresh_store);
+        refresh_store = nullptr;
+    }
+}
+
+const resident_tables_t *
+resident_tables() {
+    return resident_loaded ? &resident : nullptr;
+}
+
+refresh_store_t *
+resident_refresh_store() {
+    return refresh_store;
+}
+
+extern "C" {
+
+/**
+ * Sets the key of encrypted table loads. Stands in for a key exchange with the owner of the data, e.g. after remote
+ * attestation.
+ */
+void
+ecall_set_load_key(const uint8_t *key) {
+    memcpy(load_key, key, sizeof(load_key));
+    load_key_set = true;
+}
+
+/**
+ * Encrypts the columns of the host tables in place with the load key. Stands in for the owner of the data, who ships
+ * the tables encrypted, so that ecall_tpch_load_tables can measure the decryption.
+ */
+sgx_status_t
+ecall_tpch_encrypt_tables(const LineItemTable *l, const OrdersTable *o, const CustomerTable *c, const PartTable *p,
+                          const NationTable *n, const SupplierTable *s, const RegionTable *r, const PartSuppTable *ps,
+                          int nthreads) {
+    if (!load_key_set) {
+        logger(ERROR, "Encryption requested, but no load key was set");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    resident_tables_t tables = tables_of(l, o, c, p, n, s, r, ps);
+    std::vector<load_column_t> columns;
+    if (!collect_columns(tables, false, columns)) {
+        logger(ERROR, "TPC-H columns must be outside the enclave");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    load_columns(columns, true, nthreads);
+    return SGX_SUCCESS;
+}
+
+/**
+ * Copies the columns of the host tables into enclave memory with nthreads threads, decrypting them with the load key
+ * if encrypted is set. The copies replace the tables loaded before and stay resident for ecall_tpch_query until
+ * ecall_tpch_free_tables.
+ * @param bytes_loaded [out] bytes copied into the enclave
+ */
+sgx_status_t
+ecall_tpch_load_tables(const LineItemTable *l, const OrdersTable *o, const CustomerTable *c, const PartTable *p,
+                       const NationTable *n, const SupplierTable *s, const RegionTable *r, const PartSuppTable *ps,
+                       int encrypted, int nthreads, uint64_t *bytes_loaded) {
+    *bytes_loaded = 0;
+    if (encrypted && !load_key_set) {
+        logger(ERROR, "Encrypted load requested, but no load key was set");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    free_refresh_store();
+    if (resident_loaded) {
+        free_tables(resident);
+        resident_loaded = false;
+    }
+
+    uint64_t start = rdtscp_s();
+    resident = tables_of(l, o, c, p, n, s, r, ps);
+    std::vector<load_column_t> columns;
+    if (!collect_columns(resident, true, columns)) {
+        logger(ERROR, "TPC-H columns must be outside the enclave");
+        free_tables(resident);
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    *bytes_loaded = load_columns(columns, encrypted != 0, nthreads);
+    resident_loaded = true;
+    logger(INFO, "Loaded %lu columns (%lu bytes%s) into the enclave in %lu cycles", columns.size(), *bytes_loaded,
+           encrypted ? ", decrypted" : "", rdtscp_s() - start);
+    return SGX_SUCCESS;
+}
+
+void
+ecall_tpch_free_tables() {
+    free_refresh_store();
+    if (resident_loaded) {
+        free_tables(resident);
+        resident_loaded = false;
+    }
+}
+
+/**
+ * Moves the resident orders and lineitem tables into a delta store for the TPC-H refresh functions, whose delta has
+ * room for delta_percent percent of the orders. ecall_tpch_query reads both tables from the store afterwards.
+ */
+sgx_status_t
+ecall_tpch_refresh_start(uint32_t delta_percent, int nthreads) {
+    if (!resident_loaded || resident.o.o_orderkey == nullptr || resident.l.l_orderkey == nullptr) {
+        logger(ERROR, "The refresh functions need orders and lineitem loaded into the enclave");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    if (refresh_store != nullptr) {
+        logger(ERROR, "The refresh store was started before");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    const uint64_t delta_orders = resident.o.numTuples * delta_percent / 100;
+    refresh_store = refresh_store_create(&resident.o, &resident.l, delta_orders, nthreads);
+    free_tables(resident.o);
+    free_tables(resident.l);
+    return SGX_SUCCESS;
+}
+
+/** RF1: copies the orders and lineitems of the host tables into the delta of the refresh store */
+sgx_status_t
+ecall_tpch_refresh_insert(const OrdersTable *o, const LineItemTable *l, uint64_t *inserted) {
+    *inserted = 0;
+    if (refresh_store == nullptr) {
+        logger(ERROR, "The refresh store was not started");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    if (!outside_enclave(*o) || !outside_enclave(*l)) {
+        logger(ERROR, "Refreshed columns must be outside the enclave");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    *inserted = refresh_insert(refresh_store, o, l);
+    return SGX_SUCCESS;
+}
+
+/** RF2: deletes the orders with the given orderkeys and their lineitems from the refresh store */
+sgx_status_t
+ecall_tpch_refresh_delete(const uint32_t *orderkeys, uint64_t num_keys, uint64_t *deleted) {
+    *deleted = 0;
+    if (refresh_store == nullptr) {
+        logger(ERROR, "The refresh store was not started");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    *deleted = refresh_delete(refresh_store, orderkeys, num_keys);
+    return SGX_SUCCESS;
+}
+
+/**
+ * Merges the delta and the deletes of the refresh store into its main tables with nthreads threads. Queries and
+ * refreshes on other threads go on during the merge.
+ * @param merged [out] 0 if another merge was running
+ */
+sgx_status_t
+ecall_tpch_refresh_merge(int nthreads, int *merged) {
+    *merged = 0;
+    if (refresh_store == nullptr) {
+        logger(ERROR, "The refresh store was not started");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    *merged = refresh_merge(refresh_store, nthreads);
+    return SGX_SUCCESS;
+}
+
+sgx_status_t
+ecall_tpch_refresh_stats(refresh_stats_t *stats) {
+    if (refresh_store == nullptr) {
+        logger(ERROR, "The refresh store was not started");
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    refresh_store_stats(refresh_store, stats);
+    return SGX_SUCCESS;
+}
+
+}
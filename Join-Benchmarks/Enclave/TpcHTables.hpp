@@ -0,0 +1,27 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_TPCHTABLES_HPP
+#define SGXV2_JOIN_BENCHMARKS_TPCHTABLES_HPP
+
+#include "TpcHTypes.hpp"
+#include "tpch_refresh.hpp"
+
+/** TPC-H tables whose columns live in enclave memory, copied in by ecall_tpch_load_tables */
+struct resident_tables_t {
+    LineItemTable l;
+    OrdersTable o;
+    CustomerTable c;
+    PartTable p;
+    NationTable n;
+    SupplierTable s;
+    RegionTable r;
+    PartSuppTable ps;
+};
+
+/** The resident tables, nullptr if none are loaded */
+const resident_tables_t *
+resident_tables();
+
+/** The delta store that holds the resident orders and lineitem, nullptr until ecall_tpch_refresh_start */
+refresh_store_t *
+resident_refresh_store();
+
+#endif//SGXV2_JOIN_BENCHMARKS_TPCHTABLES_HPP
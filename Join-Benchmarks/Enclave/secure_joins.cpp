@@ -1,4 +1,5 @@
 #include "Enclave_t.h"
+#include "ResultExport.hpp"
 #include "Logger.hpp"
 #include "data-types.h"
 #include "joins.hpp"
@@ -48,12 +49,26 @@ void ecall_preload_relations(struct table_t *relR, struct table_t *relS) {
     preload = true;
 }
 
-void ecall_join_preload(const char *algorithm_name, const joinconfig_t *config) {
+void ecall_join_preload(const char *algorithm_name, const joinconfig_t *config, int64_t *matches) {
     logger(INFO, "Preload num-tuples r: %lu", preload_relR.num_tuples);
     logger(INFO, "Preload num-tuples s: %lu", preload_relS.num_tuples);
     auto res = std::make_unique<result_t>();
     if (preload)
         ecall_join(res.get(), &preload_relR, &preload_relS, algorithm_name, config);
+    *matches = res->totalresults;
+}
+
+void ecall_join_preload_export(const char *algorithm_name, const joinconfig_t *config, uint64_t *export_size) {
+    *export_size = 0;
+    if (!preload) {
+        return;
+    }
+    auto materialize_config = *config;
+    materialize_config.MATERIALIZE = true;
+    auto res = (result_t *) malloc(sizeof(result_t));
+    malloc_check(res)
+    ecall_join(res, &preload_relR, &preload_relS, algorithm_name, &materialize_config);
+    *export_size = set_export_result(res);
 }
 
 }
@@ -22,10 +22,20 @@ struct args_t {
     int s_from_path;
     int materialize;
     int mitigation;
+    int export_result;
+    int encrypt_export;
+    int serve;
+    char socket_path[108];
 };
 
 void parse_args(int argc, char **argv, args_t *params, const struct algorithm_t algorithms[]);
 
 void print_relation(relation_t *rel, uint32_t num, uint32_t offset);
 
+/**
+ * Whether name is one of the join algorithms of run_join. The hosts check the names of requests with it before they
+ * pass them into the enclave, which exits on an unknown name.
+ */
+bool is_join_algorithm(const char *name);
+
 #endif // _COMMONS_H_
@@ -0,0 +1,40 @@
+#ifndef REQUEST_CHANNEL_H
+#define REQUEST_CHANNEL_H
+
+#include <cstddef>
+#include <cstdio>
+
+/**
+ * Control channel of the query servers: one request per line, read from stdin or from the clients of a Unix socket.
+ * Socket clients are served one after the other, the replies go back to the client that sent the request.
+ */
+struct request_channel_t {
+    int listen_fd{-1};
+    FILE *in{nullptr};
+    FILE *out{nullptr};
+    char socket_path[108]{};
+};
+
+/**
+ * Opens the channel on the Unix socket at socket_path, or on stdin and stdout if socket_path is nullptr.
+ * @return 0 on success
+ */
+int
+open_request_channel(request_channel_t *channel, const char *socket_path);
+
+/**
+ * Reads the next non-empty request into line without the line break. On a socket, waits for the next client when the
+ * current one disconnects.
+ * @return 1 if a request was read, 0 at the end of stdin or when the channel failed
+ */
+int
+next_request(request_channel_t *channel, char *line, size_t size);
+
+/** Writes one line of the reply to the sender of the current request */
+void
+reply(request_channel_t *channel, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+void
+close_request_channel(request_channel_t *channel);
+
+#endif // REQUEST_CHANNEL_H
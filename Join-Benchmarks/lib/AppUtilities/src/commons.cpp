@@ -16,6 +16,9 @@ void parse_args(int argc, char **argv, args_t *params, const struct algorithm_t
     static int sort_r;
     static int sort_s;
     static int mitigation;
+    static int export_result;
+    static int encrypt_export;
+    static int serve;
     char *ptr;
     char *eptr;
     uint64_t ret;
@@ -27,9 +30,14 @@ void parse_args(int argc, char **argv, args_t *params, const struct algorithm_t
             {"sort-r", no_argument, &sort_r, 1},
             {"sort-s", no_argument, &sort_s, 1},
             {"mitigation", no_argument, &mitigation, 1},
+            {"export", no_argument, &export_result, 1},
+            {"encrypt-export", no_argument, &encrypt_export, 1},
+            {"serve", no_argument, &serve, 1},
 
             {"r-path", required_argument, 0, 't'},
-            {"s-path", required_argument, 0, 'u'}
+            {"s-path", required_argument, 0, 'u'},
+            {"socket", required_argument, 0, 'k'},
+            {0, 0, 0, 0}
         };
 
         int option_index = 0;
@@ -171,6 +179,11 @@ void parse_args(int argc, char **argv, args_t *params, const struct algorithm_t
                 params->skew = atof(optarg);
                 break;
 
+            case 'k':
+                serve = 1;
+                strncpy(params->socket_path, optarg, sizeof(params->socket_path) - 1);
+                break;
+
             default:
                 break;
         }
@@ -179,6 +192,9 @@ void parse_args(int argc, char **argv, args_t *params, const struct algorithm_t
     params->sort_r = sort_r;
     params->sort_s = sort_s;
     params->mitigation = mitigation;
+    params->export_result = export_result || encrypt_export;
+    params->encrypt_export = encrypt_export;
+    params->serve = serve;
 
     /* Print remaining command line arguments */
     if (optind < argc) {
@@ -196,3 +212,16 @@ void print_relation(relation_t *rel, uint32_t num, uint32_t offset) {
     }
     logger(DBG, "******************************************************");
 }
+
+bool is_join_algorithm(const char *name) {
+    // the names of sgx_algorithms in lib/Joins/src/joins.cpp
+    static const char *const algorithms[] = {"PHT", "PHT_no", "PHT_un", "PHT_o", "NPO_st", "NPO_no", "NL", "INL",
+                                             "RHO", "RHT", "PSM", "RSM", "CHT", "MWAY", "CRKJ", "CrkJoin", "CRKJF",
+                                             "CRKJS", "NPBC_st"};
+    for (const char *algorithm : algorithms) {
+        if (strcmp(name, algorithm) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,123 @@
+#include "request_channel.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdarg>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Logger.hpp"
+
+int
+open_request_channel(request_channel_t *channel, const char *socket_path) {
+    if (socket_path == nullptr) {
+        channel->in = stdin;
+        channel->out = stdout;
+        return 0;
+    }
+
+    sockaddr_un address{};
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        logger(ERROR, "Socket path too long: %s", socket_path);
+        return 1;
+    }
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    strcpy(channel->socket_path, socket_path);
+
+    channel->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (channel->listen_fd < 0) {
+        logger(ERROR, "socket failed: %s", strerror(errno));
+        return 1;
+    }
+    unlink(socket_path);
+    if (bind(channel->listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(channel->listen_fd, 1) != 0) {
+        logger(ERROR, "Listening on %s failed: %s", socket_path, strerror(errno));
+        close(channel->listen_fd);
+        channel->listen_fd = -1;
+        return 1;
+    }
+    // a client that disconnects before its reply must not terminate the server
+    signal(SIGPIPE, SIG_IGN);
+    logger(INFO, "Waiting for requests on %s", socket_path);
+    return 0;
+}
+
+static void
+close_client(request_channel_t *channel) {
+    if (channel->listen_fd < 0) {
+        return;
+    }
+    if (channel->in != nullptr) {
+        fclose(channel->in);
+        channel->in = nullptr;
+    }
+    if (channel->out != nullptr) {
+        fclose(channel->out);
+        channel->out = nullptr;
+    }
+}
+
+int
+next_request(request_channel_t *channel, char *line, size_t size) {
+    while (true) {
+        if (channel->in == nullptr) {
+            int fd = accept(channel->listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                logger(ERROR, "accept failed: %s", strerror(errno));
+                return 0;
+            }
+            int out_fd = dup(fd);
+            channel->in = fdopen(fd, "r");
+            channel->out = out_fd < 0 ? nullptr : fdopen(out_fd, "w");
+            if (channel->in == nullptr || channel->out == nullptr) {
+                logger(ERROR, "fdopen failed: %s", strerror(errno));
+                close_client(channel);
+                return 0;
+            }
+            logger(INFO, "Client connected");
+        }
+        if (fgets(line, (int) size, channel->in) == nullptr) {
+            if (channel->listen_fd < 0) {
+                return 0;
+            }
+            logger(INFO, "Client disconnected");
+            close_client(channel);
+            continue;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '\0') {
+            return 1;
+        }
+    }
+}
+
+void
+reply(request_channel_t *channel, const char *format, ...) {
+    if (channel->out == nullptr) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(channel->out, format, args);
+    va_end(args);
+    fputc('\n', channel->out);
+    fflush(channel->out);
+}
+
+void
+close_request_channel(request_channel_t *channel) {
+    if (channel->listen_fd < 0) {
+        return;
+    }
+    close_client(channel);
+    close(channel->listen_fd);
+    channel->listen_fd = -1;
+    unlink(channel->socket_path);
+}
@@ -0,0 +1,40 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_COLUMNARTABLE_HPP
+#define SGXV2_JOIN_BENCHMARKS_COLUMNARTABLE_HPP
+
+#include "data-types.h"
+#include <vector>
+
+void
+init_columnar_table(columnar_table_t *table, uint32_t columns);
+
+void
+init_columnar_table_prealloc(columnar_table_t *table, uint32_t columns, uint64_t num_chunks);
+
+void
+flush_wc_buffer(columnar_table_t *table);
+
+/**
+ * Appends one join result to the write-combining buffer of the table. All three values are written to the buffer
+ * unconditionally, the projection is applied when a full cache line is flushed to the chunks.
+ */
+[[gnu::always_inline]] inline void
+insert_output(columnar_table_t *table, type_key key, type_value Rpayload, type_value Spayload) {
+    const uint64_t slot = table->buffered_tuples;
+    table->buffer.keys[slot] = key;
+    table->buffer.Rpayloads[slot] = Rpayload;
+    table->buffer.Spayloads[slot] = Spayload;
+    if (++table->buffered_tuples == TUPLES_PER_WC_BUFFER) [[unlikely]] {
+        flush_wc_buffer(table);
+    }
+}
+
+void
+finish_columnar_table(columnar_table_t *table);
+
+void
+destroy_table(columnar_table_t *table);
+
+columnar_table_t *
+concatenate(const std::vector<columnar_table_t> &tables);
+
+#endif//SGXV2_JOIN_BENCHMARKS_COLUMNARTABLE_HPP
@@ -0,0 +1,129 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_JOININPUT_HPP
+#define SGXV2_JOIN_BENCHMARKS_JOININPUT_HPP
+
+#include "PartitionedTable.hpp"
+#include "data-types.h"
+#include <vector>
+
+/**
+ * Transforms one tuple of a materialized join result into a tuple of the next join's input. Columns that were not
+ * projected by a columnar join result are passed as 0.
+ */
+using ProjectionFunction = row_t (*)(type_key key, type_value Rpayload, type_value Spayload, const void *context);
+
+/**
+ * Input relation of a join. Either a contiguous table, the materialized result of a previous join that is read in
+ * place, with the projection applied to every tuple on the fly, or a table that is radix partitioned already.
+ */
+struct join_input_t {
+    const table_t *table;          // contiguous input, nullptr if the input is a join result
+    const result_t *join_result;   // materialized join result, used if table and partitioned are nullptr
+    ProjectionFunction projection; // maps join result tuples to input tuples
+    const void *context;           // second argument of projection, e.g. a lookup column
+    const partitioned_table_t *partitioned; // partitioned input, its blocks are read like chunks
+};
+
+/** A range of chunks of a chunked join input assigned to one thread */
+struct input_range_t {
+    const join_input_t *input;
+    uint64_t first_chunk;
+    uint64_t end_chunk;
+    uint64_t num_tuples;
+};
+
+[[nodiscard]] inline join_input_t
+table_input(const table_t *table) {
+    return {table, nullptr, nullptr, nullptr, nullptr};
+}
+
+[[nodiscard]] inline join_input_t
+join_result_input(const result_t *join_result, ProjectionFunction projection, const void *context = nullptr) {
+    return {nullptr, join_result, projection, context, nullptr};
+}
+
+/**
+ * Input that was partitioned for the first pass of a radix join. RHO, RHT, and RSM skip that pass if it is the probe
+ * side S, everywhere else its blocks are read like the chunks of a join result.
+ */
+[[nodiscard]] inline join_input_t
+partitioned_input(const partitioned_table_t *table) {
+    return {nullptr, nullptr, nullptr, nullptr, table};
+}
+
+/**
+ * True if the input can be partitioned directly from its chunks, i.e. it is a chunked or columnar join result or a
+ * partitioned table.
+ */
+[[nodiscard]] inline bool
+is_chunked_input(const join_input_t *input) {
+    return input->partitioned != nullptr ||
+           (input->table == nullptr && input->join_result->materialized &&
+            (input->join_result->result_type == 1 || input->join_result->result_type == 2));
+}
+
+[[nodiscard]] uint64_t
+input_num_tuples(const join_input_t *input);
+
+/**
+ * Splits the chunks of a chunked input into nthreads consecutive ranges holding roughly the same number of tuples.
+ * @param input chunked input
+ * @param nthreads number of ranges
+ * @return one range per thread, some ranges may be empty
+ */
+[[nodiscard]] std::vector<input_range_t>
+split_input(const join_input_t *input, int nthreads);
+
+/**
+ * Copies any join input into a contiguous table. Used by join algorithms that cannot read chunked inputs.
+ * @param output table that receives a newly allocated tuple array
+ * @param input
+ */
+void
+materialize_input(table_t *output, const join_input_t *input);
+
+/**
+ * Frees the chunks of a chunked or columnar join result after it has been consumed. Linked list results are left
+ * untouched.
+ */
+void
+destroy_join_result(result_t *join_result);
+
+/**
+ * Calls visit(row_t) for every tuple in the given chunk range, for join results after applying the projection of the
+ * input.
+ */
+template<typename Visitor>
+[[gnu::always_inline]] inline void
+for_each_input_tuple(const input_range_t *range, Visitor &&visit) {
+    const auto input = range->input;
+    const auto projection = input->projection;
+    const auto context = input->context;
+    if (input->partitioned != nullptr) {
+        for (uint64_t b = range->first_chunk; b < range->end_chunk; ++b) {
+            const partition_block_t &block = input->partitioned->blocks[b];
+            for (uint64_t i = 0; i < block.num_tuples; ++i) {
+                visit(block.tuples[i]);
+            }
+        }
+    } else if (input->join_result->result_type == 1) {
+        const auto table = static_cast<const chunked_table_t *>(input->join_result->result);
+        for (uint64_t c = range->first_chunk; c < range->end_chunk; ++c) {
+            const table_chunk_t *chunk = table->chunks[c];
+            for (uint64_t i = 0; i < chunk->num_tuples; ++i) {
+                const output_triple_t &t = chunk->tuples[i];
+                visit(projection(t.key, t.Rpayload, t.Spayload, context));
+            }
+        }
+    } else {
+        const auto table = static_cast<const columnar_table_t *>(input->join_result->result);
+        for (uint64_t c = range->first_chunk; c < range->end_chunk; ++c) {
+            const column_chunk_t &chunk = table->chunks[c];
+            for (uint64_t i = 0; i < chunk.num_tuples; ++i) {
+                visit(projection(chunk.keys ? chunk.keys[i] : 0, chunk.Rpayloads ? chunk.Rpayloads[i] : 0,
+                                 chunk.Spayloads ? chunk.Spayloads[i] : 0, context));
+            }
+        }
+    }
+}
+
+#endif//SGXV2_JOIN_BENCHMARKS_JOININPUT_HPP
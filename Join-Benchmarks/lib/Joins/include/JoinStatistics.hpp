@@ -0,0 +1,49 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_JOINSTATISTICS_HPP
+#define SGXV2_JOIN_BENCHMARKS_JOINSTATISTICS_HPP
+
+#include "JoinInput.hpp"
+#include "data-types.h"
+
+/** Number of index bits of the HyperLogLog sketches, i.e. 4096 one byte registers per sketch */
+constexpr uint32_t HLL_INDEX_BITS = 12;
+/** The hash sample of the larger input is kept below roughly this number of keys */
+constexpr uint64_t JOIN_SAMPLE_TARGET = 1 << 16;
+
+/**
+ * Estimates of a join computed before the join runs. All values are estimates except num_R and num_S.
+ */
+struct join_statistics_t {
+    uint64_t num_R;
+    uint64_t num_S;
+    uint64_t distinct_R;        // HyperLogLog estimate of the distinct keys in R
+    uint64_t distinct_S;        // HyperLogLog estimate of the distinct keys in S
+    uint64_t estimated_matches; // estimated join cardinality
+    uint64_t max_key_matches;   // largest number of matches of a single sampled key, hints at skew
+    uint32_t sample_shift;      // keys were sampled with probability 2^-sample_shift
+};
+
+/**
+ * Estimates distinct keys and join cardinality of R and S in one pass over both inputs using nthreads threads.
+ * Every key is hashed once. The hash feeds a HyperLogLog sketch per input and selects the key for a correlated sample:
+ * a key is sampled on both sides or on none, so joining the samples and scaling the matches by 2^sample_shift
+ * estimates the size of the join.
+ * @param relR
+ * @param relS
+ * @param nthreads
+ * @return
+ */
+[[nodiscard]] join_statistics_t
+estimate_join_statistics(const join_input_t *relR, const join_input_t *relS, int nthreads);
+
+[[nodiscard]] join_statistics_t
+estimate_join_statistics(const table_t *relR, const table_t *relS, int nthreads);
+
+/**
+ * Expected number of result tuples of the thread with the largest output, including a 20 % margin for light skew.
+ * Partitions are joined as a whole, so a thread may have to join ceil(num_partitions / nthreads) of them, and a single
+ * key that produces more matches than that share ends up in one thread completely.
+ */
+[[nodiscard]] uint64_t
+expected_matches_per_thread(const join_statistics_t *statistics, int nthreads, uint64_t num_partitions);
+
+#endif//SGXV2_JOIN_BENCHMARKS_JOINSTATISTICS_HPP
@@ -0,0 +1,107 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_PARTITIONEDTABLE_HPP
+#define SGXV2_JOIN_BENCHMARKS_PARTITIONEDTABLE_HPP
+
+#include "data-types.h"
+#include <vector>
+
+/** Size of the first block of a partition, one block holds at least one cache line of tuples */
+constexpr uint32_t MIN_PARTITION_BLOCK_TUPLES = 64;
+/** Blocks of a partition double in size up to this number of tuples */
+constexpr uint32_t MAX_PARTITION_BLOCK_TUPLES = 4096;
+
+/** Tuples of one partition written by one thread, the tuples are 64 byte aligned */
+struct partition_block_t {
+    row_t *tuples;
+    uint64_t num_tuples;
+};
+
+/**
+ * Relation that was radix partitioned while it was produced, e.g. by a filter, so that the radix joins can skip their
+ * first partitioning pass for it. Tuple t belongs to partition t.key & (fanout - 1), the partition of the first pass
+ * of a radix join with num_radix_bits radix bits. The blocks of partition p are blocks[partition_blocks[p]] up to
+ * blocks[partition_blocks[p + 1]].
+ */
+struct partitioned_table_t {
+    uint64_t num_tuples;
+    uint32_t num_radix_bits;     // radix bits of the join the table is partitioned for
+    uint32_t fanout;             // number of partitions
+    uint64_t num_blocks;
+    partition_block_t *blocks;   // blocks of partition 0, then the ones of partition 1, ...
+    uint64_t *partition_blocks;  // index of the first block of every partition, fanout + 1 entries
+    uint64_t *partition_tuples;  // histogram, number of tuples of every partition
+};
+
+/**
+ * Radix partitions the tuples one thread produces into blocks. Every partition has a software write-combining buffer
+ * of one cache line, full lines are written to the current block of the partition with a non-temporal store. The
+ * first block of a partition holds MIN_PARTITION_BLOCK_TUPLES and every further block twice as many as the previous
+ * one up to MAX_PARTITION_BLOCK_TUPLES, so small partitions waste little memory and large ones need few blocks.
+ */
+class alignas(64) PartitionWriter {
+public:
+    explicit PartitionWriter(uint32_t fanout);
+    PartitionWriter(PartitionWriter &&other) noexcept;
+    PartitionWriter(const PartitionWriter &) = delete;
+    PartitionWriter &operator=(const PartitionWriter &) = delete;
+    ~PartitionWriter();
+
+    [[gnu::always_inline]] inline void
+    write(const row_t &tuple) {
+        const uint32_t partition = tuple.key & mask;
+        Partition &target = partitions[partition];
+        row_t *line = lines[partition].tuples;
+        line[target.buffered++] = tuple;
+        if (target.buffered == TUPLES_PER_LINE) [[unlikely]] {
+            flush_line(target, line);
+        }
+    }
+
+    void
+    write(const row_t *tuples, uint64_t num_tuples);
+
+    /** Writes the tuples left in the write-combining buffers to the blocks, call before merge_partitions() */
+    void
+    finish();
+
+private:
+    static constexpr uint32_t TUPLES_PER_LINE = 64 / sizeof(row_t);
+
+    struct alignas(64) Line {
+        row_t tuples[TUPLES_PER_LINE];
+    };
+
+    struct Partition {
+        row_t *block;            // current block, nullptr before the first line is flushed
+        uint32_t block_tuples;   // tuples written to the current block
+        uint32_t block_capacity;
+        uint32_t buffered;       // tuples in the write-combining buffer
+    };
+
+    void
+    flush_line(Partition &partition, const row_t *line);
+
+    void
+    next_block(Partition &partition);
+
+    uint32_t fanout;
+    uint32_t mask;
+    Line *lines;
+    std::vector<Partition> partitions;
+    std::vector<std::vector<partition_block_t>> blocks; // completed blocks of every partition
+
+    friend partitioned_table_t *
+    merge_partitions(std::vector<PartitionWriter> &writers, uint32_t num_radix_bits);
+};
+
+/**
+ * Collects the blocks of all writers into one partitioned table, the writers keep no reference to the blocks.
+ * @param writers one writer per thread, all with the fanout of the first partitioning pass for num_radix_bits
+ * @param num_radix_bits radix bits of the join the table is partitioned for
+ */
+[[nodiscard]] partitioned_table_t *
+merge_partitions(std::vector<PartitionWriter> &writers, uint32_t num_radix_bits);
+
+void
+destroy_table(partitioned_table_t *table);
+
+#endif//SGXV2_JOIN_BENCHMARKS_PARTITIONEDTABLE_HPP
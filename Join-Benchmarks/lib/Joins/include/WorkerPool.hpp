@@ -0,0 +1,109 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_WORKERPOOL_HPP
+#define SGXV2_JOIN_BENCHMARKS_WORKERPOOL_HPP
+
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Rows a thread takes from the shared cursor of a morsel-driven loop at once. A multiple of 64, so morsels of 64-byte
+ * aligned columns stay aligned for the SIMD filters.
+ */
+constexpr uint64_t MORSEL_TUPLES = 64 * 1024;
+
+/**
+ * Persistent worker threads for the parallel operators around the joins. Creating threads is expensive, in an enclave
+ * even more so, so the workers are started once and sleep between tasks. Every worker keeps its TCS while it sleeps,
+ * so the enclave needs TCSNum of at least 2 * NTHREADS when the joins run their own threads next to the pool.
+ *
+ * The workers form crews that run one task at a time. Every submitter takes an idle crew, so concurrent query streams
+ * and tasks submitted from inside another task each run on persistent workers of their own. A crew is only added when
+ * all crews are busy, and crews are kept for the next submitter.
+ */
+class WorkerPool {
+public:
+    using Task = void (*)(const void *context, int thread_id);
+
+    /** The pool of the process or enclave. Workers are added when a task asks for more threads than there are. */
+    [[nodiscard]] static WorkerPool &
+    global();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * Runs task(context, thread_id) for every thread_id in [0, nthreads) and returns once all of them are done. Thread
+     * 0 is the calling thread.
+     */
+    void
+    run(int nthreads, Task task, const void *context);
+
+    /** Runs function(thread_id) on nthreads threads */
+    template<typename Function>
+    void
+    run(int nthreads, const Function &function) {
+        run(nthreads, [](const void *context, int thread_id) {
+            (*static_cast<const Function *>(context))(thread_id);
+        }, &function);
+    }
+
+    /**
+     * Morsel-driven loop over [0, num_items). The threads take morsels of morsel_size items from a shared cursor and
+     * call function(thread_id, begin, end) for each, so threads that hit expensive parts of the input take fewer
+     * morsels.
+     */
+    template<typename Function>
+    void
+    for_each_morsel(int nthreads, uint64_t num_items, uint64_t morsel_size, const Function &function) {
+        std::atomic<uint64_t> cursor{0};
+        run(nthreads, [&](int thread_id) {
+            uint64_t begin;
+            while ((begin = cursor.fetch_add(morsel_size, std::memory_order_relaxed)) < num_items) {
+                function(thread_id, begin, std::min(begin + morsel_size, num_items));
+            }
+        });
+    }
+
+private:
+    /** Workers of one submitter. Worker i runs thread ID i + 1, the submitter is thread 0. */
+    struct Crew {
+        Crew();
+
+        pthread_mutex_t mutex;
+        pthread_cond_t task_ready;
+        pthread_cond_t task_done;
+        std::vector<pthread_t> workers;
+        uint64_t generation = 0;  // incremented for every task
+        int active_threads = 0;   // threads of the current task, including the submitter
+        int pending_workers = 0;  // workers that did not finish the current task yet
+        Task task = nullptr;
+        const void *context = nullptr;
+        bool busy = false;        // guarded by the mutex of the pool
+    };
+
+    WorkerPool();
+
+    static void *
+    worker_main(void *param);
+
+    static void
+    add_workers(Crew *crew, int num_workers);
+
+    static void
+    run_on_crew(Crew *crew, int nthreads, Task task, const void *context);
+
+    [[nodiscard]] Crew *
+    acquire_crew();
+
+    void
+    release_crew(Crew *crew);
+
+    friend struct worker_arg_t;
+
+    pthread_mutex_t mutex;
+    std::vector<Crew *> crews; // never freed, like the pool
+};
+
+#endif//SGXV2_JOIN_BENCHMARKS_WORKERPOOL_HPP
@@ -5,4 +5,12 @@ void
 run_join(struct result_t *res, const struct table_t *relR, const struct table_t *relS, const char *algorithm_name,
            const struct joinconfig_t *config);
 
+/**
+ * Runs a join whose inputs may be materialized results of previous joins. RHO, RHT, and RSM partition chunked inputs
+ * directly from their chunks. All other algorithms receive a contiguous copy of such inputs.
+ */
+void
+run_join_chunked(struct result_t *res, const struct join_input_t *relR, const struct join_input_t *relS,
+                 const char *algorithm_name, const struct joinconfig_t *config);
+
 #endif//SGXV2_JOIN_BENCHMARKS_JOINS_HPP
@@ -115,4 +115,41 @@ void get_new_bucket(bucket_t **result, bucket_buffer_t **buf);
 /** De-allocates all the bucket_buffer_t */
 void free_bucket_buffer(bucket_buffer_t *buf);
 
+/**
+ * Multi-thread insert of one tuple, writes to the bucket are synchronized via its latch. Overflow buckets are taken
+ * from the overflow buffer of the calling thread.
+ */
+[[gnu::always_inline]] inline void
+insert_hashtable_mt(hashtable_t *ht, const row_t &tuple, bucket_buffer_t **overflow_buffer) {
+    struct row_t *dest;
+
+    int32_t idx = HASH(tuple.key, ht->hash_mask, ht->skip_bits);
+    /* copy the tuple to appropriate hash bucket */
+    /* if full, follow nxt pointer to find correct place */
+    bucket_t *curr = ht->buckets + idx;
+    lock(&curr->latch);
+    bucket_t *nxt = curr->next;
+
+    if (curr->count == BUCKET_SIZE) {
+        if (!nxt || nxt->count == BUCKET_SIZE) {
+            bucket_t *b;
+            /* instead of calloc() everytime, we pre-allocate */
+            get_new_bucket(&b, overflow_buffer);
+            curr->next = b;
+            b->next = nxt;
+            b->count = 1;
+            dest = b->tuples;
+        } else {
+            dest = nxt->tuples + nxt->count;
+            nxt->count++;
+        }
+    } else {
+        dest = curr->tuples + curr->count;
+        curr->count++;
+    }
+
+    *dest = tuple;
+    unlock(&curr->latch);
+}
+
 #endif //JOIN_BENCH_MATTHIAS_HASHLINKTABLE_HPP
@@ -0,0 +1,31 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_MULTIWAY_PROBE_JOIN_HPP
+#define SGXV2_JOIN_BENCHMARKS_MULTIWAY_PROBE_JOIN_HPP
+
+#include "data-types.h"
+
+/**
+ * Maps a build tuple of a probe stage to {key the hash table is built on, key probed in the next stage}. For the last
+ * stage, the second column is the R payload of the join result.
+ */
+using StageMapping = row_t (*)(row_t tuple, const void *context);
+
+/** One build side of a multi-way probe join */
+struct probe_stage_t {
+    const table_t *table;
+    StageMapping mapping;   // nullptr keeps the tuple as it is
+    const void *context;    // second argument of mapping, e.g. a lookup column
+};
+
+/**
+ * Joins probe with a chain of build sides without materializing any intermediate result. The hash tables of all
+ * stages are built up front. Every probe tuple then looks up its key in the first stage, every match continues with
+ * its second column as key in the next stage, and only matches in the last stage are results, so
+ * probe ⋈ stages[0] ⋈ ... ⋈ stages[num_stages - 1] runs as one pass over probe.
+ *
+ * Build and probe run morsel-driven on config->NTHREADS threads of the worker pool. If config->MATERIALIZE is set,
+ * the results are returned as linked lists per thread (key of probe, R payload of the last stage, payload of probe).
+ */
+[[nodiscard]] result_t *
+multiway_probe_join(const table_t *probe, const probe_stage_t *stages, int num_stages, const joinconfig_t *config);
+
+#endif//SGXV2_JOIN_BENCHMARKS_MULTIWAY_PROBE_JOIN_HPP
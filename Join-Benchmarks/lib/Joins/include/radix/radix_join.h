@@ -3,12 +3,15 @@
 
 #include <stdlib.h>
 #include "data-types.h"
+#include "JoinInput.hpp"
 
 using JoinFunction = int64_t (*)(const struct table_t *const,
                                  const struct table_t *const,
                                  struct table_t *const,
                                  uint32_t,
-                                 #ifdef CHUNKED_TABLE
+                                 #if defined(COLUMNAR_TABLE)
+                                 columnar_table_t *output,
+                                 #elif defined(CHUNKED_TABLE)
                                  chunked_table_t *output,
                                  #else
                                  output_list_t **output,
@@ -32,7 +35,38 @@ RHO(const table_t *relR, const table_t *relS, const joinconfig_t *config);
 result_t *
 RHT(const table_t *relR, const table_t *relS, const joinconfig_t *config);
 
+result_t *
+RHO_chunked(const join_input_t *relR, const join_input_t *relS, const joinconfig_t *config);
+
+result_t *
+RHT_chunked(const join_input_t *relR, const join_input_t *relS, const joinconfig_t *config);
+
 result_t *
 join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const joinconfig_t *config);
 
+result_t *
+join_init_run(const join_input_t *inputR, const join_input_t *inputS, JoinFunction jf, const joinconfig_t *config);
+
+/**
+ * Radix bits RHO, RHT, and RSM use for a build side of num_r tuples. A probe side that is partitioned with
+ * radix_join_fanout() partitions of these bits before the join skips the first partitioning pass.
+ */
+[[nodiscard]] uint32_t
+radix_join_bits(uint64_t num_r, int nthreads);
+
+/** Fanout of the first partitioning pass of a radix join with num_radix_bits radix bits */
+[[nodiscard]] uint32_t
+radix_join_fanout(uint32_t num_radix_bits);
+
+/**
+ * Radix partitioning primitives of the RHO partitioning passes, also used by the partitioned merge of the TPC-H hash
+ * aggregation. A tuple belongs to partition (key & MASK) >> R.
+ */
+void
+partition_hist(const row_t *rel, uint32_t size, uint32_t *my_hist, uint32_t MASK, int32_t R);
+
+/** Scatters rel into tmp. dst holds the next write index of every partition and is advanced. */
+void
+partition_copy(const row_t *rel, uint32_t size, uint32_t *dst, row_t *tmp, uint32_t MASK, int32_t R);
+
 #endif  //_RADIX_JOIN_H_
\ No newline at end of file
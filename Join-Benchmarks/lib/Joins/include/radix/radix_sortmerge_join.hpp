@@ -3,4 +3,6 @@
 
 result_t* RSM (const table_t * relR, const table_t * relS, const joinconfig_t *config);
 
+result_t* RSM_chunked (const join_input_t * relR, const join_input_t * relS, const joinconfig_t *config);
+
 #endif //RADIX_SORTMERGE_JOIN_H
@@ -0,0 +1,257 @@
+#include "ColumnarTable.hpp"
+#include "Logger.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef ENCLAVE
+#include "ocalls_t.h"
+#include "emmintrin.h"
+#include "xmmintrin.h"
+#include "avxintrin.h"
+#include "avx2intrin.h"
+#include "avx512fintrin.h"
+#else
+#include "ocalls.hpp"
+#include <immintrin.h>
+#endif
+
+/**
+ * Returns the pointer to the memory block holding all columns of a chunk. The columns are stored in the order key,
+ * Rpayload, Spayload inside one allocation, so the first projected column is the start of the block.
+ */
+static void *
+chunk_memory(const column_chunk_t *chunk) {
+    if (chunk->keys != nullptr) {
+        return chunk->keys;
+    }
+    if (chunk->Rpayloads != nullptr) {
+        return chunk->Rpayloads;
+    }
+    return chunk->Spayloads;
+}
+
+/**
+ * Allocates the column memory for one chunk. Only the columns set in the mask are allocated. Each column occupies
+ * CHUNK_SIZE bytes and starts at a cache line boundary, so full write-combining buffers can be written with aligned
+ * non-temporal stores.
+ * @param chunk
+ * @param columns COLUMN_* mask
+ */
+static void
+allocate_chunk(column_chunk_t *chunk, const uint32_t columns) {
+    const uint64_t num_columns = __builtin_popcount(columns);
+    auto memory = static_cast<uint8_t *>(aligned_alloc(64, CHUNK_SIZE * num_columns));
+    malloc_check(memory)
+
+    chunk->num_tuples = 0;
+    chunk->keys = nullptr;
+    chunk->Rpayloads = nullptr;
+    chunk->Spayloads = nullptr;
+    // Memory of tuples not written to is undefined. No memset!
+    if (columns & COLUMN_KEY) {
+        chunk->keys = reinterpret_cast<type_key *>(memory);
+        memory += CHUNK_SIZE;
+    }
+    if (columns & COLUMN_RPAYLOAD) {
+        chunk->Rpayloads = reinterpret_cast<type_value *>(memory);
+        memory += CHUNK_SIZE;
+    }
+    if (columns & COLUMN_SPAYLOAD) {
+        chunk->Spayloads = reinterpret_cast<type_value *>(memory);
+    }
+}
+
+/**
+ * Add a chunk to a columnar table. Increases num_chunks by 1 and doubles chunk_capacity if num_chunks ==
+ * chunk_capacity at time of the call.
+ * @param table
+ */
+static void
+add_chunk(columnar_table_t *table) {
+#ifdef CHUNKED_TABLE_PREALLOC
+    logger(WARN, "add_chunk called although preallocation compiler flag is set.");
+#endif
+
+    if (table->num_chunks == table->chunk_capacity) [[unlikely]] {
+        table->chunks = static_cast<column_chunk_t *>(
+                realloc(table->chunks, table->chunk_capacity * sizeof(column_chunk_t) * 2));
+        malloc_check(table->chunks);
+        table->chunk_capacity <<= 1;
+    }
+    allocate_chunk(&table->chunks[table->num_chunks], table->columns);
+    table->num_chunks++;
+}
+
+static void
+init_empty_table(columnar_table_t *table, uint32_t columns, uint64_t chunk_capacity) {
+    table->columns = (columns & COLUMN_ALL) == 0 ? COLUMN_ALL : (columns & COLUMN_ALL);
+    table->buffered_tuples = 0;
+    table->num_tuples = 0;
+    table->num_chunks = 0;
+    table->current_chunk = 0;
+    table->chunk_capacity = chunk_capacity;
+    table->chunks = static_cast<column_chunk_t *>(malloc(sizeof(column_chunk_t) * chunk_capacity));
+    malloc_check(table->chunks)
+}
+
+/**
+ * Initialize a columnar table with exactly one allocated chunk. Only the columns in the mask are materialized.
+ * @param table
+ * @param columns COLUMN_* mask. 0 selects all columns.
+ */
+void
+init_columnar_table(columnar_table_t *table, const uint32_t columns) {
+    if (table->chunk_capacity > 0) [[unlikely]] {
+        logger(ERROR, "Trying to initialize a columnar table that is already initialized!");
+        return;
+    }
+    init_empty_table(table, columns, 8);
+    add_chunk(table);
+}
+
+/**
+ * Initialize a columnar table with exactly num_chunks allocated chunks.
+ * @param table
+ * @param columns COLUMN_* mask. 0 selects all columns.
+ * @param num_chunks
+ */
+void
+init_columnar_table_prealloc(columnar_table_t *table, const uint32_t columns, const uint64_t num_chunks) {
+    if (table->chunk_capacity > 0) [[unlikely]] {
+        logger(ERROR, "Trying to initialize a columnar table that is already initialized!");
+        return;
+    }
+    init_empty_table(table, columns, std::max<uint64_t>(num_chunks, 1));
+    for (uint64_t i = 0; i < table->chunk_capacity; ++i) {
+        allocate_chunk(&table->chunks[i], table->columns);
+    }
+    table->num_chunks = table->chunk_capacity;
+}
+
+/**
+ * Returns the chunk the next cache line of tuples has to be written to. Moves to the next chunk or allocates a new
+ * one if the current chunk is full.
+ */
+static column_chunk_t *
+writable_chunk(columnar_table_t *table) {
+    auto chunk = &table->chunks[table->current_chunk];
+    if (chunk->num_tuples >= TUPLES_PER_COLUMN_CHUNK) [[unlikely]] {
+        if (table->current_chunk == table->num_chunks - 1) {
+            add_chunk(table);
+        }
+        ++table->current_chunk;
+        chunk = &table->chunks[table->current_chunk];
+    }
+    return chunk;
+}
+
+/**
+ * Writes the full write-combining buffer of every projected column to the current chunk with non-temporal stores.
+ * TUPLES_PER_COLUMN_CHUNK is a multiple of TUPLES_PER_WC_BUFFER, so a flush never crosses a chunk boundary and the
+ * destination is always cache line aligned.
+ * @param table
+ */
+void
+flush_wc_buffer(columnar_table_t *table) {
+    auto chunk = writable_chunk(table);
+    const uint64_t offset = chunk->num_tuples;
+    if (chunk->keys != nullptr) {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(chunk->keys + offset),
+                            _mm512_load_si512(table->buffer.keys));
+    }
+    if (chunk->Rpayloads != nullptr) {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(chunk->Rpayloads + offset),
+                            _mm512_load_si512(table->buffer.Rpayloads));
+    }
+    if (chunk->Spayloads != nullptr) {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(chunk->Spayloads + offset),
+                            _mm512_load_si512(table->buffer.Spayloads));
+    }
+    chunk->num_tuples += TUPLES_PER_WC_BUFFER;
+    table->buffered_tuples = 0;
+}
+
+/**
+ * Writes the remaining buffered tuples with regular stores, fences the non-temporal stores, and sums up the number of
+ * tuples. Must be called by the thread that filled the table before any other thread reads it.
+ * @param table
+ */
+void
+finish_columnar_table(columnar_table_t *table) {
+    if (table->buffered_tuples > 0) {
+        auto chunk = writable_chunk(table);
+        const uint64_t offset = chunk->num_tuples;
+        const uint64_t count = table->buffered_tuples;
+        if (chunk->keys != nullptr) {
+            std::copy_n(table->buffer.keys, count, chunk->keys + offset);
+        }
+        if (chunk->Rpayloads != nullptr) {
+            std::copy_n(table->buffer.Rpayloads, count, chunk->Rpayloads + offset);
+        }
+        if (chunk->Spayloads != nullptr) {
+            std::copy_n(table->buffer.Spayloads, count, chunk->Spayloads + offset);
+        }
+        chunk->num_tuples += count;
+        table->buffered_tuples = 0;
+    }
+    _mm_sfence();
+
+    table->num_tuples = 0;
+    for (uint64_t i = 0; i < table->num_chunks; ++i) {
+        table->num_tuples += table->chunks[i].num_tuples;
+    }
+}
+
+/**
+ * Frees the memory of all chunks and the chunk descriptor array. Does not free the table itself.
+ * @param table
+ */
+void
+destroy_table(columnar_table_t *table) {
+    for (uint64_t i = 0; i < table->num_chunks; ++i) {
+        free(chunk_memory(&table->chunks[i]));
+    }
+    free(table->chunks);
+    table->chunk_capacity = 0;
+    table->num_chunks = 0;
+    table->current_chunk = 0;
+}
+
+/**
+ * Concatenates multiple columnar tables by copying their chunk descriptors. All tables must have the same projection
+ * and must be finished.
+ * @param tables vector of columnar_table_t
+ * @return Pointer to a columnar table that references all chunks of the input tables.
+ */
+columnar_table_t *
+concatenate(const std::vector<columnar_table_t> &tables) {
+    auto result_table = static_cast<columnar_table_t *>(aligned_alloc(64, sizeof(columnar_table_t)));
+    malloc_check(result_table)
+
+    result_table->num_chunks = 0;
+    result_table->num_tuples = 0;
+    result_table->buffered_tuples = 0;
+    result_table->columns = tables.empty() ? COLUMN_ALL : tables.front().columns;
+    for (const columnar_table_t &table: tables) {
+        result_table->num_chunks += table.num_chunks;
+        result_table->num_tuples += table.num_tuples;
+        if (table.columns != result_table->columns) {
+            logger(ERROR, "Concatenating columnar tables with different projections!");
+        }
+    }
+
+    // at least one slot, so an empty result (no inputs or empty joins) is still a valid table for add_chunk()
+    result_table->chunk_capacity = std::max<uint64_t>(result_table->num_chunks, 1);
+    result_table->chunks = static_cast<column_chunk_t *>(malloc(sizeof(column_chunk_t) *
+                                                                 result_table->chunk_capacity));
+    malloc_check(result_table->chunks)
+
+    uint64_t start = 0;
+    for (const columnar_table_t &table: tables) {
+        std::copy_n(table.chunks, table.num_chunks, result_table->chunks + start);
+        start += table.num_chunks;
+    }
+    result_table->current_chunk = result_table->num_chunks == 0 ? 0 : result_table->num_chunks - 1;
+    return result_table;
+}
@@ -0,0 +1,127 @@
+#include "JoinInput.hpp"
+#include "ChunkedTable.hpp"
+#include "ColumnarTable.hpp"
+#include "Logger.hpp"
+#include "util.hpp"
+#include <cstdlib>
+
+#ifdef ENCLAVE
+#include "ocalls_t.h"
+#else
+#include "ocalls.hpp"
+#endif
+
+static uint64_t
+chunk_num_tuples(const join_input_t *input, uint64_t chunk) {
+    if (input->partitioned != nullptr) {
+        return input->partitioned->blocks[chunk].num_tuples;
+    }
+    if (input->join_result->result_type == 1) {
+        return static_cast<const chunked_table_t *>(input->join_result->result)->chunks[chunk]->num_tuples;
+    }
+    return static_cast<const columnar_table_t *>(input->join_result->result)->chunks[chunk].num_tuples;
+}
+
+static uint64_t
+num_chunks(const join_input_t *input) {
+    if (input->partitioned != nullptr) {
+        return input->partitioned->num_blocks;
+    }
+    if (input->join_result->result_type == 1) {
+        return static_cast<const chunked_table_t *>(input->join_result->result)->num_chunks;
+    }
+    return static_cast<const columnar_table_t *>(input->join_result->result)->num_chunks;
+}
+
+uint64_t
+input_num_tuples(const join_input_t *input) {
+    if (input->table != nullptr) {
+        return input->table->num_tuples;
+    }
+    if (input->partitioned != nullptr) {
+        return input->partitioned->num_tuples;
+    }
+    switch (input->join_result->result_type) {
+        case 1:
+            return static_cast<const chunked_table_t *>(input->join_result->result)->num_tuples;
+        case 2:
+            return static_cast<const columnar_table_t *>(input->join_result->result)->num_tuples;
+        default:
+            return input->join_result->totalresults;
+    }
+}
+
+std::vector<input_range_t>
+split_input(const join_input_t *input, const int nthreads) {
+    std::vector<input_range_t> ranges(nthreads);
+    const uint64_t total_chunks = num_chunks(input);
+    const uint64_t total_tuples = input_num_tuples(input);
+
+    // Close a range as soon as it reaches its share of all tuples seen so far. The last range takes the rest.
+    uint64_t chunk = 0;
+    uint64_t assigned_tuples = 0;
+    for (int i = 0; i < nthreads; ++i) {
+        const uint64_t target = total_tuples * (i + 1) / nthreads;
+        ranges[i] = {input, chunk, chunk, 0};
+        while (chunk < total_chunks && (assigned_tuples < target || i == nthreads - 1)) {
+            const uint64_t chunk_tuples = chunk_num_tuples(input, chunk);
+            assigned_tuples += chunk_tuples;
+            ranges[i].num_tuples += chunk_tuples;
+            ++chunk;
+        }
+        ranges[i].end_chunk = chunk;
+    }
+    return ranges;
+}
+
+void
+materialize_input(table_t *output, const join_input_t *input) {
+    if (input->table != nullptr || (input->partitioned == nullptr && !input->join_result->materialized)) {
+        logger(ERROR, "Only materialized join results can be copied into a table");
+        ocall_exit(EXIT_FAILURE);
+    }
+
+    const uint64_t num_tuples = input_num_tuples(input);
+    output->num_tuples = num_tuples;
+    output->tuples = static_cast<row_t *>(malloc(sizeof(row_t) * num_tuples));
+    malloc_check(output->tuples)
+    output->ratio_holes = 0;
+    output->sorted = 0;
+
+    uint64_t index = 0;
+    if (is_chunked_input(input)) {
+        const input_range_t range{input, 0, num_chunks(input), num_tuples};
+        for_each_input_tuple(&range, [output, &index](const row_t tuple) { output->tuples[index++] = tuple; });
+    } else {
+        const auto thread_results = static_cast<const threadresult_t *>(input->join_result->result);
+        for (int t = 0; t < input->join_result->nthreads; ++t) {
+            // The lists are not guaranteed to be null-terminated, nresults is authoritative
+            auto node = thread_results[t].results;
+            for (int64_t i = 0; i < thread_results[t].nresults && index < num_tuples; ++i, node = node->next) {
+                output->tuples[index++] = input->projection(node->key, node->Rpayload, node->Spayload, input->context);
+            }
+        }
+    }
+
+    if (index != num_tuples) {
+        logger(ERROR, "Copying the join result into a table failed!");
+    }
+}
+
+void
+destroy_join_result(result_t *join_result) {
+    if (!join_result->materialized || join_result->result == nullptr) {
+        return;
+    }
+    if (join_result->result_type == 1) {
+        auto table = static_cast<chunked_table_t *>(join_result->result);
+        destroy_table(table);
+        free(table);
+        join_result->result = nullptr;
+    } else if (join_result->result_type == 2) {
+        auto table = static_cast<columnar_table_t *>(join_result->result);
+        destroy_table(table);
+        free(table);
+        join_result->result = nullptr;
+    }
+}
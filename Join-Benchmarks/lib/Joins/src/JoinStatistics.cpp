@@ -0,0 +1,240 @@
+#include "JoinStatistics.hpp"
+#include "Logger.hpp"
+#include "WorkerPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#ifdef ENCLAVE
+#include "ocalls_t.h"
+#include "avx512fintrin.h"
+#include "avx512cdintrin.h"
+#else
+#include "ocalls.hpp"
+#include <immintrin.h>
+#endif
+
+constexpr uint32_t HLL_REGISTERS = 1 << HLL_INDEX_BITS;
+
+/** HyperLogLog registers and the hash sample of the keys of one input, filled by one thread */
+struct input_sketch_t {
+    uint8_t registers[HLL_REGISTERS];
+    std::vector<type_key> sample;
+};
+
+struct statistics_arg_t {
+    const join_input_t *inputs[2];
+    const row_t *tuples[2];     // slice of a table input
+    uint64_t num_tuples[2];
+    input_range_t ranges[2];    // chunk range of a chunked input
+    uint32_t sample_mask;
+    input_sketch_t sketches[2];
+};
+
+/** Murmur3 finalizer. Bijective on 32 bit, so distinct keys never collide. */
+[[gnu::always_inline]] static inline uint32_t
+hash_key(uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6b;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35;
+    key ^= key >> 16;
+    return key;
+}
+
+[[gnu::always_inline]] static inline void
+add_key(input_sketch_t *sketch, type_key key, uint32_t sample_mask) {
+    const uint32_t hash = hash_key(key);
+    // The guard bit bounds the rank to 32 - HLL_INDEX_BITS + 1
+    const auto rank = static_cast<uint8_t>(
+            __builtin_clz((hash << HLL_INDEX_BITS) | (1u << (HLL_INDEX_BITS - 1))) + 1);
+    auto &reg = sketch->registers[hash >> (32 - HLL_INDEX_BITS)];
+    reg = std::max(reg, rank);
+    if ((hash & sample_mask) == 0) {
+        sketch->sample.push_back(key);
+    }
+}
+
+/**
+ * Hashes 16 keys per iteration. The register updates stay scalar because lanes may hit the same register, the sampled
+ * keys are compressed into the sample directly.
+ */
+static void
+sketch_tuples(input_sketch_t *sketch, const row_t *tuples, uint64_t num_tuples, uint32_t sample_mask) {
+    static_assert(sizeof(row_t) == 8 && offsetof(row_t, key) == 0, "keys are extracted from the low half of a row");
+    alignas(64) uint32_t indexes[16];
+    alignas(64) uint32_t ranks[16];
+    const __m512i c1 = _mm512_set1_epi32(static_cast<int>(0x85ebca6b));
+    const __m512i c2 = _mm512_set1_epi32(static_cast<int>(0xc2b2ae35));
+    const __m512i mask = _mm512_set1_epi32(static_cast<int>(sample_mask));
+    const __m512i guard = _mm512_set1_epi32(1 << (HLL_INDEX_BITS - 1));
+    const __m512i one = _mm512_set1_epi32(1);
+
+    uint64_t i = 0;
+    for (; i + 16 <= num_tuples; i += 16) {
+        const __m512i lo = _mm512_loadu_si512(tuples + i);
+        const __m512i hi = _mm512_loadu_si512(tuples + i + 8);
+        const __m512i keys = _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvtepi64_epi32(lo)),
+                                                _mm512_cvtepi64_epi32(hi), 1);
+        __m512i hash = _mm512_xor_si512(keys, _mm512_srli_epi32(keys, 16));
+        hash = _mm512_mullo_epi32(hash, c1);
+        hash = _mm512_xor_si512(hash, _mm512_srli_epi32(hash, 13));
+        hash = _mm512_mullo_epi32(hash, c2);
+        hash = _mm512_xor_si512(hash, _mm512_srli_epi32(hash, 16));
+
+        _mm512_store_si512(indexes, _mm512_srli_epi32(hash, 32 - HLL_INDEX_BITS));
+        _mm512_store_si512(ranks, _mm512_add_epi32(
+                _mm512_lzcnt_epi32(_mm512_or_si512(_mm512_slli_epi32(hash, HLL_INDEX_BITS), guard)), one));
+        for (int j = 0; j < 16; ++j) {
+            auto &reg = sketch->registers[indexes[j]];
+            reg = std::max(reg, static_cast<uint8_t>(ranks[j]));
+        }
+
+        const __mmask16 sampled = _mm512_testn_epi32_mask(hash, mask);
+        if (sampled) {
+            const auto sample_size = sketch->sample.size();
+            sketch->sample.resize(sample_size + 16);
+            _mm512_mask_compressstoreu_epi32(sketch->sample.data() + sample_size, sampled, keys);
+            sketch->sample.resize(sample_size + __builtin_popcount(sampled));
+        }
+    }
+    for (; i < num_tuples; ++i) {
+        add_key(sketch, tuples[i].key, sample_mask);
+    }
+}
+
+static void *
+statistics_thread(void *param) {
+    auto arg = static_cast<statistics_arg_t *>(param);
+    for (int side = 0; side < 2; ++side) {
+        auto sketch = &arg->sketches[side];
+        std::fill_n(sketch->registers, HLL_REGISTERS, 0);
+        if (arg->inputs[side]->table != nullptr) {
+            sketch_tuples(sketch, arg->tuples[side], arg->num_tuples[side], arg->sample_mask);
+        } else {
+            for_each_input_tuple(&arg->ranges[side], [sketch, sample_mask = arg->sample_mask](const row_t &row) {
+                add_key(sketch, row.key, sample_mask);
+            });
+        }
+    }
+    return nullptr;
+}
+
+static uint64_t
+hll_estimate(const uint8_t *registers) {
+    constexpr double m = HLL_REGISTERS;
+    double sum = 0;
+    uint32_t zeros = 0;
+    for (uint32_t j = 0; j < HLL_REGISTERS; ++j) {
+        sum += std::ldexp(1.0, -registers[j]);
+        zeros += registers[j] == 0;
+    }
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        // linear counting for small cardinalities
+        estimate = m * std::log(m / zeros);
+    }
+    return static_cast<uint64_t>(estimate);
+}
+
+join_statistics_t
+estimate_join_statistics(const join_input_t *relR, const join_input_t *relS, int nthreads) {
+    const join_input_t *inputs[2] = {relR, relS};
+    join_statistics_t statistics{};
+    statistics.num_R = input_num_tuples(relR);
+    statistics.num_S = input_num_tuples(relS);
+    for (auto input : inputs) {
+        if (input->table == nullptr && !is_chunked_input(input)) {
+            logger(ERROR, "Join statistics can only be computed for tables and chunked join results");
+            ocall_exit(EXIT_FAILURE);
+        }
+    }
+
+    const uint64_t max_tuples = std::max(statistics.num_R, statistics.num_S);
+    while ((max_tuples >> statistics.sample_shift) > JOIN_SAMPLE_TARGET) {
+        ++statistics.sample_shift;
+    }
+
+    std::vector<statistics_arg_t> args(nthreads);
+    for (int side = 0; side < 2; ++side) {
+        const auto input = inputs[side];
+        std::vector<input_range_t> ranges;
+        if (input->table == nullptr) {
+            ranges = split_input(input, nthreads);
+        }
+        const uint64_t per_thread = input->table != nullptr ? input->table->num_tuples / nthreads : 0;
+        for (int i = 0; i < nthreads; ++i) {
+            args[i].inputs[side] = input;
+            if (input->table != nullptr) {
+                args[i].tuples[side] = input->table->tuples + i * per_thread;
+                args[i].num_tuples[side] = (i == nthreads - 1) ? input->table->num_tuples - i * per_thread
+                                                               : per_thread;
+            } else {
+                args[i].ranges[side] = ranges[i];
+            }
+        }
+    }
+
+    for (int i = 0; i < nthreads; ++i) {
+        args[i].sample_mask = (1u << statistics.sample_shift) - 1;
+    }
+    WorkerPool::global().run(nthreads, [&args](int thread_id) { statistics_thread(&args[thread_id]); });
+
+    // Merge the sketches of all threads into the ones of thread 0
+    for (int side = 0; side < 2; ++side) {
+        auto &merged = args[0].sketches[side];
+        for (int i = 1; i < nthreads; ++i) {
+            const auto &sketch = args[i].sketches[side];
+            for (uint32_t j = 0; j < HLL_REGISTERS; ++j) {
+                merged.registers[j] = std::max(merged.registers[j], sketch.registers[j]);
+            }
+            merged.sample.insert(merged.sample.end(), sketch.sample.begin(), sketch.sample.end());
+        }
+        std::sort(merged.sample.begin(), merged.sample.end());
+    }
+    statistics.distinct_R = std::min(hll_estimate(args[0].sketches[0].registers), statistics.num_R);
+    statistics.distinct_S = std::min(hll_estimate(args[0].sketches[1].registers), statistics.num_S);
+
+    // Join the samples. Every sampled key carries all of its occurrences, so the matches per key are exact.
+    const auto &sampleR = args[0].sketches[0].sample;
+    const auto &sampleS = args[0].sketches[1].sample;
+    uint64_t sample_matches = 0;
+    auto r = sampleR.begin();
+    auto s = sampleS.begin();
+    while (r != sampleR.end() && s != sampleS.end()) {
+        if (*r < *s) {
+            ++r;
+        } else if (*s < *r) {
+            ++s;
+        } else {
+            const auto r_end = std::upper_bound(r, sampleR.end(), *r);
+            const auto s_end = std::upper_bound(s, sampleS.end(), *s);
+            const auto key_matches = static_cast<uint64_t>(r_end - r) * static_cast<uint64_t>(s_end - s);
+            sample_matches += key_matches;
+            statistics.max_key_matches = std::max(statistics.max_key_matches, key_matches);
+            r = r_end;
+            s = s_end;
+        }
+    }
+    statistics.estimated_matches = sample_matches << statistics.sample_shift;
+
+    logger(INFO, "Estimated distinct keys R=%lu S=%lu, join cardinality=%lu (max matches per key %lu, sample 2^-%u)",
+           statistics.distinct_R, statistics.distinct_S, statistics.estimated_matches, statistics.max_key_matches,
+           statistics.sample_shift);
+    return statistics;
+}
+
+join_statistics_t
+estimate_join_statistics(const table_t *relR, const table_t *relS, int nthreads) {
+    const join_input_t inputR = table_input(relR);
+    const join_input_t inputS = table_input(relS);
+    return estimate_join_statistics(&inputR, &inputS, nthreads);
+}
+
+uint64_t
+expected_matches_per_thread(const join_statistics_t *statistics, int nthreads, uint64_t num_partitions) {
+    const uint64_t partitions_per_thread = (num_partitions + nthreads - 1) / nthreads;
+    const uint64_t share = statistics->estimated_matches * partitions_per_thread / num_partitions;
+    return std::max(share, statistics->max_key_matches) * 6 / 5 + 1;
+}
@@ -0,0 +1,146 @@
+#include "PartitionedTable.hpp"
+#include "Logger.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#ifndef ENCLAVE
+#include <immintrin.h>
+#include "ocalls.hpp"
+#else
+#include "ocalls_t.h"
+#include "xmmintrin.h"
+#include "avx512fintrin.h"
+#endif
+
+PartitionWriter::PartitionWriter(uint32_t fanout)
+    : fanout(fanout), mask(fanout - 1), partitions(fanout, Partition{nullptr, 0, 0, 0}), blocks(fanout) {
+    lines = static_cast<Line *>(aligned_alloc(64, fanout * sizeof(Line)));
+    malloc_check(lines)
+}
+
+PartitionWriter::PartitionWriter(PartitionWriter &&other) noexcept
+    : fanout(other.fanout), mask(other.mask), lines(std::exchange(other.lines, nullptr)),
+      partitions(std::move(other.partitions)), blocks(std::move(other.blocks)) {}
+
+PartitionWriter::~PartitionWriter() {
+    free(lines);
+    // blocks that were not handed to a table by merge_partitions()
+    for (uint32_t p = 0; p < partitions.size(); ++p) {
+        for (const auto &block: blocks[p]) {
+            free(block.tuples);
+        }
+        free(partitions[p].block);
+    }
+}
+
+void
+PartitionWriter::next_block(Partition &partition) {
+    if (partition.block != nullptr) {
+        blocks[&partition - partitions.data()].push_back({partition.block, partition.block_tuples});
+    }
+    partition.block_capacity = partition.block == nullptr
+                                       ? MIN_PARTITION_BLOCK_TUPLES
+                                       : std::min(2 * partition.block_capacity, MAX_PARTITION_BLOCK_TUPLES);
+    partition.block = static_cast<row_t *>(aligned_alloc(64, partition.block_capacity * sizeof(row_t)));
+    malloc_check(partition.block)
+    partition.block_tuples = 0;
+}
+
+void
+PartitionWriter::flush_line(Partition &partition, const row_t *line) {
+    if (partition.block_tuples == partition.block_capacity) {
+        next_block(partition);
+    }
+    _mm512_stream_si512(reinterpret_cast<__m512i *>(partition.block + partition.block_tuples),
+                        _mm512_load_si512(line));
+    partition.block_tuples += TUPLES_PER_LINE;
+    partition.buffered = 0;
+}
+
+void
+PartitionWriter::write(const row_t *tuples, uint64_t num_tuples) {
+    for (uint64_t i = 0; i < num_tuples; ++i) {
+        write(tuples[i]);
+    }
+}
+
+void
+PartitionWriter::finish() {
+    _mm_sfence();
+    for (uint32_t p = 0; p < fanout; ++p) {
+        Partition &partition = partitions[p];
+        if (partition.buffered > 0) {
+            if (partition.block_tuples == partition.block_capacity) {
+                next_block(partition);
+            }
+            std::copy_n(lines[p].tuples, partition.buffered, partition.block + partition.block_tuples);
+            partition.block_tuples += partition.buffered;
+            partition.buffered = 0;
+        }
+        if (partition.block != nullptr) {
+            blocks[p].push_back({partition.block, partition.block_tuples});
+            partition.block = nullptr;
+            partition.block_tuples = 0;
+            partition.block_capacity = 0;
+        }
+    }
+}
+
+partitioned_table_t *
+merge_partitions(std::vector<PartitionWriter> &writers, uint32_t num_radix_bits) {
+    const uint32_t fanout = writers.empty() ? 1 : writers[0].fanout;
+    auto table = static_cast<partitioned_table_t *>(malloc(sizeof(partitioned_table_t)));
+    malloc_check(table)
+    table->num_radix_bits = num_radix_bits;
+    table->fanout = fanout;
+    table->num_tuples = 0;
+    table->num_blocks = 0;
+    for (const auto &writer: writers) {
+        if (writer.fanout != fanout) {
+            logger(ERROR, "Cannot merge partitions of writers with different fanouts");
+            ocall_exit(EXIT_FAILURE);
+        }
+        for (const auto &partition_blocks: writer.blocks) {
+            table->num_blocks += partition_blocks.size();
+        }
+    }
+
+    table->blocks = static_cast<partition_block_t *>(malloc(std::max<uint64_t>(table->num_blocks, 1) *
+                                                            sizeof(partition_block_t)));
+    table->partition_blocks = static_cast<uint64_t *>(malloc((fanout + 1) * sizeof(uint64_t)));
+    table->partition_tuples = static_cast<uint64_t *>(malloc(fanout * sizeof(uint64_t)));
+    malloc_check((void *) (table->blocks && table->partition_blocks && table->partition_tuples))
+
+    uint64_t block = 0;
+    for (uint32_t p = 0; p < fanout; ++p) {
+        table->partition_blocks[p] = block;
+        table->partition_tuples[p] = 0;
+        for (auto &writer: writers) {
+            for (const auto &partition_block: writer.blocks[p]) {
+                table->blocks[block++] = partition_block;
+                table->partition_tuples[p] += partition_block.num_tuples;
+            }
+            writer.blocks[p].clear();
+        }
+        table->num_tuples += table->partition_tuples[p];
+    }
+    table->partition_blocks[fanout] = block;
+    return table;
+}
+
+void
+destroy_table(partitioned_table_t *table) {
+    for (uint64_t i = 0; i < table->num_blocks; ++i) {
+        free(table->blocks[i].tuples);
+    }
+    free(table->blocks);
+    free(table->partition_blocks);
+    free(table->partition_tuples);
+    table->blocks = nullptr;
+    table->partition_blocks = nullptr;
+    table->partition_tuples = nullptr;
+    table->num_blocks = 0;
+    table->num_tuples = 0;
+}
@@ -0,0 +1,134 @@
+#include "WorkerPool.hpp"
+#include "Logger.hpp"
+
+#ifdef ENCLAVE
+#include "ocalls_t.h"
+#else
+#include "ocalls.hpp"
+#endif
+
+struct worker_arg_t {
+    WorkerPool::Crew *crew;
+    int thread_id;
+    uint64_t generation; // last task generation the worker must not run
+};
+
+WorkerPool &
+WorkerPool::global() {
+    // Never destroyed: the workers sleep in the pool until the process or enclave goes away
+    static auto *pool = new WorkerPool();
+    return *pool;
+}
+
+WorkerPool::WorkerPool() {
+    pthread_mutex_init(&mutex, nullptr);
+}
+
+WorkerPool::Crew::Crew() {
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&task_ready, nullptr);
+    pthread_cond_init(&task_done, nullptr);
+}
+
+void *
+WorkerPool::worker_main(void *param) {
+    auto arg = static_cast<worker_arg_t *>(param);
+    Crew *crew = arg->crew;
+    const int thread_id = arg->thread_id;
+    uint64_t seen_generation = arg->generation;
+    delete arg;
+
+    pthread_mutex_lock(&crew->mutex);
+    while (true) {
+        while (crew->generation == seen_generation) {
+            pthread_cond_wait(&crew->task_ready, &crew->mutex);
+        }
+        seen_generation = crew->generation;
+        if (thread_id >= crew->active_threads) {
+            continue;
+        }
+        const Task task = crew->task;
+        const void *context = crew->context;
+        pthread_mutex_unlock(&crew->mutex);
+
+        task(context, thread_id);
+
+        pthread_mutex_lock(&crew->mutex);
+        if (--crew->pending_workers == 0) {
+            pthread_cond_signal(&crew->task_done);
+        }
+    }
+}
+
+/** Requires the mutex of the crew */
+void
+WorkerPool::add_workers(Crew *crew, int num_workers) {
+    while (static_cast<int>(crew->workers.size()) < num_workers) {
+        auto arg = new worker_arg_t{crew, static_cast<int>(crew->workers.size()) + 1, crew->generation};
+        pthread_t thread;
+        int rv = pthread_create(&thread, nullptr, worker_main, arg);
+        if (rv) {
+            logger(ERROR, "return code from pthread_create() is %d\n", rv);
+            ocall_exit(EXIT_FAILURE);
+        }
+        crew->workers.push_back(thread);
+    }
+}
+
+WorkerPool::Crew *
+WorkerPool::acquire_crew() {
+    pthread_mutex_lock(&mutex);
+    Crew *idle = nullptr;
+    for (Crew *crew: crews) {
+        if (!crew->busy) {
+            idle = crew;
+            break;
+        }
+    }
+    if (idle == nullptr) {
+        idle = new Crew();
+        crews.push_back(idle);
+    }
+    idle->busy = true;
+    pthread_mutex_unlock(&mutex);
+    return idle;
+}
+
+void
+WorkerPool::release_crew(Crew *crew) {
+    pthread_mutex_lock(&mutex);
+    crew->busy = false;
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+WorkerPool::run(int nthreads, Task task, const void *context) {
+    if (nthreads <= 1) {
+        task(context, 0);
+        return;
+    }
+    Crew *crew = acquire_crew();
+    run_on_crew(crew, nthreads, task, context);
+    release_crew(crew);
+}
+
+void
+WorkerPool::run_on_crew(Crew *crew, int nthreads, Task task, const void *context) {
+    pthread_mutex_lock(&crew->mutex);
+    add_workers(crew, nthreads - 1);
+    crew->task = task;
+    crew->context = context;
+    crew->active_threads = nthreads;
+    crew->pending_workers = nthreads - 1;
+    ++crew->generation;
+    pthread_cond_broadcast(&crew->task_ready);
+    pthread_mutex_unlock(&crew->mutex);
+
+    task(context, 0);
+
+    pthread_mutex_lock(&crew->mutex);
+    while (crew->pending_workers > 0) {
+        pthread_cond_wait(&crew->task_done, &crew->mutex);
+    }
+    pthread_mutex_unlock(&crew->mutex);
+}
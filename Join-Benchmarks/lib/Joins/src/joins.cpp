@@ -18,6 +18,7 @@
 #endif
 
 #include "joins.hpp"
+#include "JoinInput.hpp"
 #include <cstring>
 
 result_t *
@@ -30,6 +31,7 @@ CHT(const table_t *relR, const table_t *relS, const joinconfig_t *config) {
     return joinresult;
 }
 
+// the hosts check requested names with is_join_algorithm() of lib/AppUtilities, which lists the same names
 const static algorithm_t sgx_algorithms[] = {
         {"PHT",     PHT},
         {"PHT_no",  PHT_no_overflow},
@@ -75,4 +77,49 @@ run_join(result_t *res, const struct table_t *relR, const struct table_t *relS,
     if (tmp) {
         memcpy(res, tmp, sizeof(result_t));
     }
-}
\ No newline at end of file
+}
+struct chunked_algorithm_t {
+    char name[128];
+    result_t *(*join)(const join_input_t *, const join_input_t *, const joinconfig_t *);
+};
+
+const static chunked_algorithm_t chunked_algorithms[] = {
+        {"RHO", RHO_chunked},
+        {"RHT", RHT_chunked},
+        {"RSM", RSM_chunked},
+};
+
+/**
+ * Copies the input into a contiguous table if it is a join result. Returns the table that can be passed to run_join.
+ */
+static const table_t *
+contiguous_input(const join_input_t *input, table_t *copy) {
+    if (input->table != nullptr) {
+        return input->table;
+    }
+    materialize_input(copy, input);
+    return copy;
+}
+
+void
+run_join_chunked(result_t *res, const join_input_t *relR, const join_input_t *relS, const char *algorithm_name,
+                 const joinconfig_t *config) {
+    for (const auto &algorithm : chunked_algorithms) {
+        if (strcmp(algorithm_name, algorithm.name) == 0
+            && (relR->table != nullptr || is_chunked_input(relR))
+            && (relS->table != nullptr || is_chunked_input(relS))) {
+            result_t *tmp = algorithm.join(relR, relS, config);
+            if (tmp) {
+                memcpy(res, tmp, sizeof(result_t));
+            }
+            return;
+        }
+    }
+
+    logger(INFO, "%s cannot read chunked inputs. Copying them into tables.", algorithm_name);
+    table_t copyR{};
+    table_t copyS{};
+    run_join(res, contiguous_input(relR, &copyR), contiguous_input(relS, &copyS), algorithm_name, config);
+    free(copyR.tuples);
+    free(copyS.tuples);
+}
@@ -0,0 +1,123 @@
+#include "npj/multiway_probe_join.hpp"
+#include "npj/HashLinkTableCommon.hpp"
+#include "WorkerPool.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <vector>
+
+#ifdef ENCLAVE
+#include "ocalls_t.h"
+#else
+#include "ocalls.hpp"
+#endif
+
+/** Number of matches of key in the hash tables from stage on, following every match into the next stage */
+static int64_t
+probe_stages(const std::vector<hashtable_t *> &tables, size_t stage, type_key key, const row_t &probe_tuple,
+             output_list_t **output, int materialize) {
+    int64_t matches = 0;
+    const hashtable_t *ht = tables[stage];
+    const bucket_t *b = ht->buckets + HASH(key, ht->hash_mask, ht->skip_bits);
+    const bool last_stage = stage + 1 == tables.size();
+    do {
+        for (uint32_t j = 0; j < b->count; j++) {
+            if (b->tuples[j].key != key) {
+                continue;
+            }
+            if (!last_stage) {
+                matches += probe_stages(tables, stage + 1, b->tuples[j].payload, probe_tuple, output, materialize);
+            } else {
+                matches++;
+                if (materialize) {
+                    insert_output(output, probe_tuple.key, b->tuples[j].payload, probe_tuple.payload);
+                }
+            }
+        }
+        b = b->next; /* follow overflow pointer */
+    } while (b);
+    return matches;
+}
+
+result_t *
+multiway_probe_join(const table_t *probe, const probe_stage_t *stages, int num_stages, const joinconfig_t *config) {
+    if (num_stages < 1) {
+        logger(ERROR, "A multi-way probe join needs at least one build side");
+        ocall_exit(EXIT_FAILURE);
+    }
+    auto &pool = WorkerPool::global();
+    const int nthreads = config->NTHREADS;
+    uint64_t start_micros;
+    uint64_t end_micros;
+    ocall_get_system_micros(&start_micros);
+    const uint64_t start_time = rdtscp_s();
+
+    /* overflow buckets of all stages, one buffer per thread */
+    std::vector<bucket_buffer_t *> overflow_buffers(nthreads);
+    for (auto &buffer: overflow_buffers) {
+        init_bucket_buffer(&buffer);
+    }
+
+    uint64_t total_tuples = probe->num_tuples;
+    std::vector<hashtable_t *> tables(num_stages);
+    for (int s = 0; s < num_stages; ++s) {
+        const probe_stage_t &stage = stages[s];
+        total_tuples += stage.table->num_tuples;
+        allocate_hashtable(&tables[s], std::max<uint64_t>(stage.table->num_tuples / BUCKET_SIZE, 1));
+        hashtable_t *ht = tables[s];
+        pool.for_each_morsel(nthreads, stage.table->num_tuples, MORSEL_TUPLES,
+                             [&](int thread_id, uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; ++i) {
+                const row_t &tuple = stage.table->tuples[i];
+                insert_hashtable_mt(ht, stage.mapping ? stage.mapping(tuple, stage.context) : tuple,
+                                    &overflow_buffers[thread_id]);
+            }
+        });
+    }
+    const uint64_t build_end_time = rdtscp_s();
+
+    const int materialize = config->MATERIALIZE;
+    auto joinresult = (result_t *) malloc(sizeof(result_t));
+    malloc_check(joinresult)
+    auto thread_results = (threadresult_t *) calloc(nthreads, sizeof(threadresult_t));
+    malloc_check(thread_results)
+    pool.for_each_morsel(nthreads, probe->num_tuples, MORSEL_TUPLES, [&](int thread_id, uint64_t begin, uint64_t end) {
+        threadresult_t &thread_result = thread_results[thread_id];
+        int64_t matches = 0;
+        for (uint64_t i = begin; i < end; ++i) {
+            const row_t &tuple = probe->tuples[i];
+            matches += probe_stages(tables, 0, tuple.key, tuple, &thread_result.results, materialize);
+        }
+        thread_result.nresults += matches;
+    });
+    const uint64_t end_time = rdtscp_s();
+    ocall_get_system_micros(&end_micros);
+
+    int64_t result = 0;
+    for (int t = 0; t < nthreads; ++t) {
+        thread_results[t].threadid = t;
+        result += thread_results[t].nresults;
+    }
+    for (auto ht: tables) {
+        destroy_hashtable(ht);
+    }
+    for (auto buffer: overflow_buffers) {
+        free_bucket_buffer(buffer);
+    }
+
+    joinresult->totalresults = result;
+    joinresult->nthreads = nthreads;
+    joinresult->materialized = materialize;
+    joinresult->result_type = 0;
+    if (materialize) {
+        joinresult->result = thread_results;
+    } else {
+        joinresult->result = nullptr;
+        free(thread_results);
+    }
+
+#ifndef NO_TIMING
+    print_timing(start_micros, end_micros, end_time - start_time, build_end_time - start_time,
+                 end_time - build_end_time, total_tuples, result);
+#endif
+    return joinresult;
+}
@@ -1,5 +1,6 @@
 #include "npj/no_partitioning_hash_join.hpp"
 #include "npj/HashLinkTableCommon.hpp"
+#include "JoinStatistics.hpp"
 #include "pthread.h"
 #include "Barrier.hpp"
 
@@ -50,40 +51,8 @@ struct arg_t {
  */
 void build_hashtable_mt(hashtable_t *ht, const table_t *rel,
                         bucket_buffer_t **overflow_buffer) {
-    const uint32_t hash_mask = ht->hash_mask;
-    const uint32_t skip_bits = ht->skip_bits;
-
     for (uint64_t i = 0; i < rel->num_tuples; i++) {
-        struct row_t *dest;
-
-        int32_t idx = HASH(rel->tuples[i].key, hash_mask, skip_bits);
-        /* copy the tuple to appropriate hash bucket */
-        /* if full, follow nxt pointer to find correct place */
-        bucket_t *curr = ht->buckets + idx;
-        lock(&curr->latch);
-        bucket_t *nxt = curr->next;
-
-        if (curr->count == BUCKET_SIZE) {
-            if (!nxt || nxt->count == BUCKET_SIZE) {
-                bucket_t *b;
-                /* b = (bucket_t*) calloc(1, sizeof(bucket_t)); */
-                /* instead of calloc() everytime, we pre-allocate */
-                get_new_bucket(&b, overflow_buffer);
-                curr->next = b;
-                b->next = nxt;
-                b->count = 1;
-                dest = b->tuples;
-            } else {
-                dest = nxt->tuples + nxt->count;
-                nxt->count++;
-            }
-        } else {
-            dest = curr->tuples + curr->count;
-            curr->count++;
-        }
-
-        *dest = rel->tuples[i];
-        unlock(&curr->latch);
+        insert_hashtable_mt(ht, rel->tuples[i], overflow_buffer);
     }
 }
 
@@ -179,7 +148,13 @@ PHT_int(const table_t *relR, const table_t *relS, const joinconfig_t *config) {
     //    pthread_attr_t attr;
     Barrier barrier{static_cast<size_t>(nthreads)};
 
+#ifdef CARDINALITY_ESTIMATION
+    // Full buckets chain overflow buckets, so an estimate that comes in low only makes the chains longer
+    const join_statistics_t statistics = estimate_join_statistics(relR, relS, nthreads);
+    uint32_t nbuckets = (statistics.distinct_R + BUCKET_SIZE - 1) / BUCKET_SIZE;
+#else
     uint32_t nbuckets = (relR->num_tuples / BUCKET_SIZE);
+#endif
     allocate_hashtable(&ht, nbuckets);
 
     numR = relR->num_tuples;
@@ -433,6 +408,7 @@ PHT_no_overflow_template(const table_t *relR, const table_t *relS, const joincon
     //    pthread_attr_t attr;
     Barrier barrier{static_cast<size_t>(nthreads)};
 
+    // Buckets without overflow chains must hold every tuple of R, an estimate of its distinct keys could undercount
     uint32_t nbuckets = (relR->num_tuples / BUCKET_SIZE);
     allocate_hashtable(&ht, nbuckets);
 
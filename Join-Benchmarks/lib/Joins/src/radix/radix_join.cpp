@@ -1,5 +1,7 @@
 #include "radix/radix_join.h"
 #include "radix/prj_params.h"
+#include "JoinInput.hpp"
+#include "JoinStatistics.hpp"
 #include "util.hpp"
 #include "Logger.hpp"
 #include "data-types.h"
@@ -34,7 +36,9 @@
 
 #endif
 
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+#include "ColumnarTable.hpp"
+#elif defined(CHUNKED_TABLE)
 #include "ChunkedTable.hpp"
 #endif
 
@@ -88,6 +92,9 @@ struct task_t {
     struct table_t tmpR;
     struct table_t relS;
     struct table_t tmpS;
+    /* blocks of S if S was partitioned before the join, relS then only reserves space for its tuples */
+    const partition_block_t *blocksS;
+    uint64_t num_blocksS;
 };
 #endif
 
@@ -119,9 +126,14 @@ struct arg_t_radix {
     const row_t *relS;
     row_t *tmpS;
     row_t *tmpS2;
+    /* S was partitioned for the first pass already, nullptr otherwise */
+    const partitioned_table_t *partitionedS;
 
     uint64_t numR;
     uint64_t numS;
+    /* chunks of a chunked input assigned to this thread, input is nullptr for contiguous inputs */
+    input_range_t rangeR;
+    input_range_t rangeS;
     uint64_t totalR;
     uint64_t totalS;
 
@@ -148,7 +160,10 @@ struct arg_t_radix {
 
     /* results of the thread */
     int materialize;
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+    columnar_table_t *thread_result_table;
+    uint32_t output_columns;
+#elif defined(CHUNKED_TABLE)
     chunked_table_t *thread_result_table;
 #else
     threadresult_t *threadresult;
@@ -158,6 +173,7 @@ struct arg_t_radix {
 /** holds arguments passed for partitioning */
 struct part_t {
     const row_t *rel;
+    const input_range_t *range; /* read from the chunks of a join result instead of rel if set */
     row_t *tmp;
     uint32_t **hist;
     uint32_t *output;
@@ -316,6 +332,23 @@ void print_timing(const radix_timers_t &timers,
     return radix_bits;
 }
 
+/**
+ * Duplicates of a key always end up in the same partition. With D distinct keys in R, more than D partitions only add
+ * empty partitions and larger histograms, so the radix bits are capped at ceil(log2(D)), but never below what the
+ * threads need.
+ */
+[[nodiscard]] uint32_t cap_num_radix_bits(uint32_t radix_bits, uint64_t distinct_r, size_t nthreads) {
+    uint32_t min_bits = 0;
+    while ((1ul << min_bits) < nthreads) {
+        ++min_bits;
+    }
+    uint32_t distinct_bits = 0;
+    while ((1ul << distinct_bits) < distinct_r) {
+        ++distinct_bits;
+    }
+    return std::min(radix_bits, std::max(distinct_bits, min_bits));
+}
+
 [[nodiscard]] uint32_t calc_num_passes(uint32_t num_radix_bits) {
     // make sure that the histogram used for partitioning fits into the L1 cache
     constexpr auto space_in_l1 = 15 - 2; // 32 KB cache divided by 4 byte integers, if bigger integers are used to index
@@ -344,32 +377,87 @@ void print_timing(const radix_timers_t &timers,
     return padding_tuples(radix_bits, num_passes) * fanout_pass_1(radix_bits, num_passes) * sizeof(struct row_t);
 }
 
+uint32_t
+radix_join_bits(uint64_t num_r, int nthreads) {
+#ifndef CONSTANT_RADIX_BITS
+    return calc_num_radix_bits(num_r, 0, nthreads);
+#else
+    return 14;
+#endif
+}
+
+uint32_t
+radix_join_fanout(uint32_t num_radix_bits) {
+#ifndef FORCE_2_PHASES
+    return fanout_pass_1(num_radix_bits, calc_num_passes(num_radix_bits));
+#else
+    return fanout_pass_1(num_radix_bits, 2);
+#endif
+}
+
 /**
- *  This algorithm builds the hashtable using the bucket chaining idea and used
- *  in PRO implementation. Join between given two relations is evaluated using
- *  the "bucket chaining" algorithm proposed by Manegold et al. It is used after
- *  the partitioning phase, which is common for all algorithms. Moreover, R and
- *  S typically fit into L2 or at least R and |R|*sizeof(int) fits into L2 cache.
- *
- * @param R input relation R (build)
- * @param S input relation S (probe)
- *
- * @return number of result tuples
+ * Probe loop of bucket_chaining_join(): joins the numS tuples of S with the hash table of R given by bucket and next.
  */
-int64_t
-bucket_chaining_join(const table_t *const R,
-                     const table_t *const S,
-                     table_t *const tmpR,
-                     uint32_t num_radix_bits,
-#ifdef CHUNKED_TABLE
-                     chunked_table_t *output,
+[[gnu::always_inline]] static inline int64_t
+bucket_chaining_probe(const row_t *const Rtuples,
+                      const uint32_t *const bucket,
+                      const uint32_t *const next,
+                      const uint32_t MASK,
+                      const uint32_t num_radix_bits,
+                      const row_t *const Stuples,
+                      const uint64_t numS,
+#if defined(COLUMNAR_TABLE)
+                      columnar_table_t *output,
+#elif defined(CHUNKED_TABLE)
+                      chunked_table_t *output,
 #else
-                     output_list_t **output,
+                      output_list_t **output,
 #endif
-                     uint64_t *build_timer,
-                     uint64_t *join_timer,
-                     int materialize) {
-    (void) (tmpR);
+                      int materialize) {
+    int64_t matches = 0;
+    // materialize checked first to prevent additional branch in loop
+    if (!materialize) {
+        for (uint32_t i = 0; i < numS; i++) {
+            uint32_t idx = HASH_BIT_MODULO(Stuples[i].key, MASK, num_radix_bits);
+            for (uint32_t hit = bucket[idx]; hit > 0; hit = next[hit - 1]) {
+                if (Stuples[i].key == Rtuples[hit - 1].key) {
+                    matches++;
+                }
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < numS; i++) {
+            uint32_t idx = HASH_BIT_MODULO(Stuples[i].key, MASK, num_radix_bits);
+            for (uint32_t hit = bucket[idx]; hit > 0; hit = next[hit - 1]) {
+                if (Stuples[i].key == Rtuples[hit - 1].key) {
+                    matches++;
+                    insert_output(output, Stuples[i].key, Rtuples[hit - 1].payload, Stuples[i].payload);
+                }
+            }
+        }
+    }
+    return matches;
+}
+
+/**
+ * bucket_chaining_join() with S in blocks, e.g. a partition of a partitioned_table_t. The hash table of R is built once
+ * and probed with every block.
+ */
+static int64_t
+bucket_chaining_join_blocks(const table_t *const R,
+                            const partition_block_t *const Sblocks,
+                            const uint64_t num_Sblocks,
+                            uint32_t num_radix_bits,
+#if defined(COLUMNAR_TABLE)
+                            columnar_table_t *output,
+#elif defined(CHUNKED_TABLE)
+                            chunked_table_t *output,
+#else
+                            output_list_t **output,
+#endif
+                            uint64_t *build_timer,
+                            uint64_t *join_timer,
+                            int materialize) {
     const uint64_t numR = R->num_tuples;
     uint32_t N = numR;
     NEXT_POW_2(N);
@@ -420,30 +508,9 @@ bucket_chaining_join(const table_t *const R,
 
     /* Disable the following loop for no-probe for the break-down experiments */
     /* PROBE-LOOP */
-    const uint64_t numS = S->num_tuples;
-    const struct row_t *const Stuples = S->tuples;
-    const struct row_t *const Rtuples = R->tuples;
-
-    // materialize checked first to prevent additional branch in loop
-    if (!materialize) {
-        for (uint32_t i = 0; i < numS; i++) {
-            uint32_t idx = HASH_BIT_MODULO(Stuples[i].key, MASK, num_radix_bits);
-            for (uint32_t hit = bucket[idx]; hit > 0; hit = next[hit - 1]) {
-                if (Stuples[i].key == Rtuples[hit - 1].key) {
-                    matches++;
-                }
-            }
-        }
-    } else {
-        for (uint32_t i = 0; i < numS; i++) {
-            uint32_t idx = HASH_BIT_MODULO(Stuples[i].key, MASK, num_radix_bits);
-            for (uint32_t hit = bucket[idx]; hit > 0; hit = next[hit - 1]) {
-                if (Stuples[i].key == Rtuples[hit - 1].key) {
-                    matches++;
-                    insert_output(output, Stuples[i].key, Rtuples[hit - 1].payload, Stuples[i].payload);
-                }
-            }
-        }
+    for (uint64_t block = 0; block < num_Sblocks; ++block) {
+        matches += bucket_chaining_probe(R->tuples, bucket, next, MASK, num_radix_bits, Sblocks[block].tuples,
+                                         Sblocks[block].num_tuples, output, materialize);
     }
     if (join_timer != nullptr) {
         *join_timer += rdtscp_s() - in_between_time;
@@ -457,6 +524,38 @@ bucket_chaining_join(const table_t *const R,
     return matches;
 }
 
+/**
+ *  This algorithm builds the hashtable using the bucket chaining idea and used
+ *  in PRO implementation. Join between given two relations is evaluated using
+ *  the "bucket chaining" algorithm proposed by Manegold et al. It is used after
+ *  the partitioning phase, which is common for all algorithms. Moreover, R and
+ *  S typically fit into L2 or at least R and |R|*sizeof(int) fits into L2 cache.
+ *
+ * @param R input relation R (build)
+ * @param S input relation S (probe)
+ *
+ * @return number of result tuples
+ */
+int64_t
+bucket_chaining_join(const table_t *const R,
+                     const table_t *const S,
+                     table_t *const tmpR,
+                     uint32_t num_radix_bits,
+#if defined(COLUMNAR_TABLE)
+                     columnar_table_t *output,
+#elif defined(CHUNKED_TABLE)
+                     chunked_table_t *output,
+#else
+                     output_list_t **output,
+#endif
+                     uint64_t *build_timer,
+                     uint64_t *join_timer,
+                     int materialize) {
+    (void) (tmpR);
+    const partition_block_t block{S->tuples, S->num_tuples};
+    return bucket_chaining_join_blocks(R, &block, 1, num_radix_bits, output, build_timer, join_timer, materialize);
+}
+
 /** computes and returns the histogram size for join */
 [[nodiscard]] inline uint32_t get_hist_size(uint32_t relSize) __attribute__((always_inline));
 
@@ -478,7 +577,9 @@ histogram_join(const table_t *const R,
                const table_t *const S,
                table_t *const tmpR,
                uint32_t num_radix_bits,
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+                columnar_table_t *output,
+#elif defined(CHUNKED_TABLE)
                 chunked_table_t *output,
 #else
                output_list_t **output,
@@ -696,6 +797,26 @@ partition_copy_unrolled(const row_t *rel, const uint32_t size, uint32_t *dst, ro
     }
 }
 
+void __attribute__((noinline))
+partition_hist_chunked(const input_range_t *range, uint32_t *my_hist, uint32_t MASK, int32_t R);
+
+void
+partition_hist_chunked(const input_range_t *range, uint32_t *my_hist, const uint32_t MASK, const int32_t R) {
+    for_each_input_tuple(range, [my_hist, MASK, R](const row_t tuple) { ++my_hist[HASH_BIT_MODULO(tuple.key, MASK, R)]; });
+}
+
+void __attribute__((noinline))
+partition_copy_chunked(const input_range_t *range, uint32_t *dst, row_t *tmp, uint32_t MASK, int32_t R);
+
+void
+partition_copy_chunked(const input_range_t *range, uint32_t *dst, row_t *tmp, const uint32_t MASK, const int32_t R) {
+    for_each_input_tuple(range, [dst, tmp, MASK, R](const row_t tuple) {
+        const uint32_t idx = HASH_BIT_MODULO(tuple.key, MASK, R);
+        tmp[dst[idx]] = tuple;
+        ++dst[idx];
+    });
+}
+
 /**
  * Radix clustering algorithm (originally described by Manegold et al)
  * The algorithm mimics the 2-pass radix clustering algorithm from
@@ -761,6 +882,43 @@ radix_cluster(struct table_t *outRel,
 }
 
 
+/** radix_cluster() for an input relation that consists of the blocks of one partition of a partitioned_table_t */
+void
+radix_cluster_blocks(struct table_t *outRel,
+                     const partition_block_t *blocks,
+                     uint64_t num_blocks,
+                     uint32_t *hist,
+                     int R,
+                     int D,
+                     uint64_t *hist_timer,
+                     uint64_t *copy_timer) {
+    uint32_t M = ((1U << D) - 1) << R;
+    uint32_t offset;
+    uint32_t fanOut = 1 << D;
+    uint32_t dst[fanOut];
+
+    {
+        rdtscpWrapper w{hist_timer};
+        for (uint64_t b = 0; b < num_blocks; ++b) {
+            partition_hist(blocks[b].tuples, blocks[b].num_tuples, hist, M, R);
+        }
+    }
+
+    offset = 0;
+    for (uint64_t i = 0; i < fanOut; i++) {
+        dst[i] = (uint32_t) (offset + i * SMALL_PADDING_TUPLES);
+        offset += hist[i];
+    }
+
+    {
+        rdtscpWrapper w{copy_timer};
+        for (uint64_t b = 0; b < num_blocks; ++b) {
+            partition_copy(blocks[b].tuples, blocks[b].num_tuples, dst, outRel->tuples, M, R);
+        }
+    }
+}
+
+
 /**
  * This function implements the radix clustering of a given input
  * relations. The relations to be clustered are defined in task_t and after
@@ -791,7 +949,11 @@ void serial_radix_partition(task_t *const task,
 
     radix_cluster(&task->tmpR, &task->relR, outputR, R, D, hist_timer, copy_timer);
 
-    radix_cluster(&task->tmpS, &task->relS, outputS, R, D, hist_timer, copy_timer);
+    if (task->blocksS != nullptr) {
+        radix_cluster_blocks(&task->tmpS, task->blocksS, task->num_blocksS, outputS, R, D, hist_timer, copy_timer);
+    } else {
+        radix_cluster(&task->tmpS, &task->relS, outputS, R, D, hist_timer, copy_timer);
+    }
 
 #ifdef MUTEX_QUEUE
     for (int i = 0; i < fanOut; i++) {
@@ -805,6 +967,8 @@ void serial_radix_partition(task_t *const task,
             t->relS.num_tuples = outputS[i];
             t->relS.tuples = task->tmpS.tuples + offsetS + i * SMALL_PADDING_TUPLES;
             t->tmpS.tuples = task->relS.tuples + offsetS + i * SMALL_PADDING_TUPLES;
+            t->blocksS = nullptr;
+            t->num_blocksS = 0;
             offsetS += outputS[i];
 
             /* task_queue_copy_atomic(join_queue, &t); */
@@ -816,6 +980,8 @@ void serial_radix_partition(task_t *const task,
     }
 #else
     task_t t {};
+    t.blocksS = nullptr;
+    t.num_blocksS = 0;
     for (int i = 0; i < fanOut; i++) {
         if (outputR[i] > 0 && outputS[i] > 0) {
             t.relR.num_tuples = outputR[i];
@@ -877,11 +1043,15 @@ parallel_radix_partition(part_t *const part) {
 
     uint64_t internal_hist_timer = rdtscp_s();
 
+    if (part->range != nullptr) {
+        partition_hist_chunked(part->range, my_hist, MASK, R);
+    } else {
 #ifndef UNROLL
-    partition_hist(rel, size, my_hist, MASK, R);
+        partition_hist(rel, size, my_hist, MASK, R);
 #else
-    partition_hist_unrolled(rel, size, my_hist, MASK, R);
+        partition_hist_unrolled(rel, size, my_hist, MASK, R);
 #endif
+    }
 
     uint32_t sum = 0;
     /* compute local prefix sum on hist */
@@ -919,11 +1089,15 @@ parallel_radix_partition(part_t *const part) {
     struct row_t *tmp = part->tmp;
 
     /* Copy tuples to their corresponding clusters */
+    if (part->range != nullptr) {
+        partition_copy_chunked(part->range, dst, tmp, MASK, R);
+    } else {
 #ifndef UNROLL
-    partition_copy(rel, size, dst, tmp, MASK, R);
+        partition_copy(rel, size, dst, tmp, MASK, R);
 #else
-    partition_copy_unrolled(rel, size, dst, tmp, MASK, R);
+        partition_copy_unrolled(rel, size, dst, tmp, MASK, R);
 #endif
+    }
     internal_copy_timer = rdtscp_s() - internal_copy_timer;
 
     *part->hist_timer += internal_hist_timer;
@@ -980,7 +1154,11 @@ parallel_radix_partition_optimized(part_t *const part) {
 
     *part->hist_timer = rdtscp_s();
 
-    partition_hist(rel, num_tuples, my_hist, MASK, R);
+    if (part->range != nullptr) {
+        partition_hist_chunked(part->range, my_hist, MASK, R);
+    } else {
+        partition_hist(rel, num_tuples, my_hist, MASK, R);
+    }
 
     /* compute local prefix sum on hist */
     uint32_t sum = 0;
@@ -1022,12 +1200,12 @@ parallel_radix_partition_optimized(part_t *const part) {
     output[fanOut] = part->total_tuples + fanOut * padding;
 
     /* Copy tuples to their corresponding clusters */
-    for (uint32_t i = 0; i < num_tuples; i++) {
-        uint32_t idx = HASH_BIT_MODULO(rel[i].key, MASK, R);
+    auto scatter = [buffer = &buffer[0], tmp, MASK, R](const row_t tuple) {
+        uint32_t idx = HASH_BIT_MODULO(tuple.key, MASK, R);
         uint32_t slot = buffer[idx].data.slot;
         tuple_t *tup = (tuple_t *) (buffer + idx);
         uint32_t slotMod = (slot) & (TUPLESPERCACHELINE - 1);
-        tup[slotMod] = rel[i];
+        tup[slotMod] = tuple;
 
         if (slotMod == (TUPLESPERCACHELINE - 1)) {
             /* write out 64-Bytes with non-temporal store */
@@ -1038,6 +1216,13 @@ parallel_radix_partition_optimized(part_t *const part) {
         }
 
         buffer[idx].data.slot = slot + 1;
+    };
+    if (part->range != nullptr) {
+        for_each_input_tuple(part->range, scatter);
+    } else {
+        for (uint32_t i = 0; i < num_tuples; i++) {
+            scatter(rel[i]);
+        }
     }
     _mm_sfence();
 
@@ -1055,6 +1240,49 @@ parallel_radix_partition_optimized(part_t *const part) {
     *part->copy_timer = rdtscp_s() - *part->copy_timer;
 }
 
+/** Hands the blocks of partition i of a partitioned S to the task, or none if S is not partitioned */
+static inline void
+set_partition_blocks(task_t *task, const partitioned_table_t *partitionedS, int i) {
+    if (partitionedS != nullptr) {
+        task->blocksS = partitionedS->blocks + partitionedS->partition_blocks[i];
+        task->num_blocksS = partitionedS->partition_blocks[i + 1] - partitionedS->partition_blocks[i];
+    } else {
+        task->blocksS = nullptr;
+        task->num_blocksS = 0;
+    }
+}
+
+/**
+ * Joins the partitions of one task with the join function of the thread. If S of the task is still in blocks, RHO
+ * probes the blocks directly, the other join functions get the blocks gathered into the space reserved in relS.
+ */
+static int64_t
+join_task(arg_t_radix *args,
+          task_t *task,
+#if defined(COLUMNAR_TABLE)
+          columnar_table_t *output
+#elif defined(CHUNKED_TABLE)
+          chunked_table_t *output
+#else
+          output_list_t **output
+#endif
+) {
+    if (task->blocksS != nullptr) {
+        if (args->join_function == &bucket_chaining_join) {
+            return bucket_chaining_join_blocks(&task->relR, task->blocksS, task->num_blocksS, args->num_radix_bits,
+                                               output, &args->timers.build_in_depth_timer,
+                                               &args->timers.join_in_depth_timer, args->materialize);
+        }
+        row_t *dst = task->relS.tuples;
+        for (uint64_t b = 0; b < task->num_blocksS; ++b) {
+            dst = std::copy_n(task->blocksS[b].tuples, task->blocksS[b].num_tuples, dst);
+        }
+    }
+    return args->join_function(&task->relR, &task->relS, &task->tmpR, args->num_radix_bits, output,
+                               &args->timers.build_in_depth_timer, &args->timers.join_in_depth_timer,
+                               args->materialize);
+}
+
 /**
  * The main thread of parallel radix join. It does partitioning in parallel with
  * other threads and during the join phase, picks up join tasks from the task
@@ -1122,6 +1350,7 @@ prj_thread(void *param) {
 
     /* 1. partitioning for relation R */
     part.rel = args->relR;
+    part.range = args->rangeR.input != nullptr ? &args->rangeR : nullptr;
     part.tmp = args->tmpR;
     part.hist = args->histR;
     part.output = outputR;
@@ -1143,22 +1372,30 @@ prj_thread(void *param) {
     args->timers.partitioning_pass_1_r_timer = current_time - args->timers.partitioning_pass_1_r_timer;
     args->timers.partitioning_pass_1_s_timer = current_time;
 
-    /* 2. partitioning for relation S */
-    part.rel = args->relS;
-    part.tmp = args->tmpS;
-    part.hist = args->histS;
-    part.output = outputS;
-    part.num_tuples = args->numS;
-    part.total_tuples = args->totalS;
-    part.relidx = 1;
-    part.hist_timer = &args->timers.partitioning_pass_1_hist_timer;
-    part.copy_timer = &args->timers.partitioning_pass_1_copy_timer;
+    /* 2. partitioning for relation S, only the output offsets of its partitions if it is partitioned already */
+    if (args->partitionedS != nullptr) {
+        outputS[0] = 0;
+        for (int i = 0; i < fanOut; i++) {
+            outputS[i + 1] = outputS[i] + args->partitionedS->partition_tuples[i] + num_padding_tuples;
+        }
+    } else {
+        part.rel = args->relS;
+        part.range = args->rangeS.input != nullptr ? &args->rangeS : nullptr;
+        part.tmp = args->tmpS;
+        part.hist = args->histS;
+        part.output = outputS;
+        part.num_tuples = args->numS;
+        part.total_tuples = args->totalS;
+        part.relidx = 1;
+        part.hist_timer = &args->timers.partitioning_pass_1_hist_timer;
+        part.copy_timer = &args->timers.partitioning_pass_1_copy_timer;
 
 #ifdef USE_SWWC_OPTIMIZED_PART
-    parallel_radix_partition_optimized(&part);
+        parallel_radix_partition_optimized(&part);
 #else
-    parallel_radix_partition(&part);
+        parallel_radix_partition(&part);
 #endif
+    }
 
 
     /* wait at a barrier until each thread copies out */
@@ -1188,6 +1425,7 @@ prj_thread(void *param) {
                 t->relS.num_tuples = t->tmpS.num_tuples = ntupS;
                 t->relS.tuples = args->tmpS + outputS[i];
                 t->tmpS.tuples = args->tmpS2 + outputS[i];
+                set_partition_blocks(t, args->partitionedS, i);
 
                 task_queue_add(part_queue, t);
                 counter++;
@@ -1203,6 +1441,7 @@ prj_thread(void *param) {
                 t.relS.num_tuples = t.tmpS.num_tuples = ntupS;
                 t.relS.tuples = args->tmpS + outputS[i];
                 t.tmpS.tuples = args->tmpS2 + outputS[i];
+                set_partition_blocks(&t, args->partitionedS, i);
 
                 //logger(WARN, "Partition size: %d %d", ntupR, ntupS);
 
@@ -1290,7 +1529,13 @@ prj_thread(void *param) {
     );
     args->timers.join_total_timer = rdtscp_s();
 
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+#ifndef CHUNKED_TABLE_PREALLOC
+    if (args->materialize) {
+        init_columnar_table(args->thread_result_table, args->output_columns);
+    }
+#endif
+#elif defined(CHUNKED_TABLE)
 #ifndef CHUNKED_TABLE_PREALLOC
     if (args->materialize) {
         init_chunked_table(args->thread_result_table);
@@ -1306,12 +1551,10 @@ prj_thread(void *param) {
         /* do the actual join. join method differs for different algorithms,
            i.e. bucket chaining, histogram-based, histogram-based with simd &
            prefetching  */
-#ifdef CHUNKED_TABLE
-        results += args->join_function(&task->relR, &task->relS, &task->tmpR, args->num_radix_bits, args->thread_result_table,
-                                       &args->build_in_depth_timer, &args->join_in_depth_timer, args->materialize);
+#if defined(CHUNKED_TABLE) || defined(COLUMNAR_TABLE)
+        results += join_task(args, task, args->thread_result_table);
 #else
-        results += args->join_function(&task->relR, &task->relS, &task->tmpR, args->num_radix_bits, &output,
-                                       &args->timers.build_in_depth_timer, &args->timers.join_in_depth_timer, args->materialize);
+        results += join_task(args, task, &output);
 #endif
 
         args->parts_joined++;
@@ -1322,13 +1565,10 @@ prj_thread(void *param) {
         /* do the actual join. join method differs for different algorithms,
            i.e. bucket chaining, histogram-based, histogram-based with simd &
            prefetching  */
-#ifdef CHUNKED_TABLE
-        results += args->join_function(&task.relR, &task.relS, &task.tmpR, args->num_radix_bits, args->thread_result_table,
-                                       &args->timers.build_in_depth_timer, &args->timers.join_in_depth_timer, args->materialize);
+#if defined(CHUNKED_TABLE) || defined(COLUMNAR_TABLE)
+        results += join_task(args, &task, args->thread_result_table);
 #else
-        results += args->join_function(&task.relR, &task.relS, &task.tmpR, args->num_radix_bits, &output,
-                                       &args->timers.build_in_depth_timer, &args->timers.join_in_depth_timer,
-                                       args->materialize);
+        results += join_task(args, &task, &output);
 #endif
         args->parts_joined++;
     }
@@ -1336,7 +1576,9 @@ prj_thread(void *param) {
 
     args->result = results;
     if (args->materialize) {
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+        finish_columnar_table(args->thread_result_table);
+#elif defined(CHUNKED_TABLE)
         finish_chunked_table(args->thread_result_table);
 #else
         args->threadresult->nresults = results;
@@ -1368,7 +1610,21 @@ prj_thread(void *param) {
  */
 result_t *
 join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const joinconfig_t *config) {
+    const join_input_t inputR = table_input(relR);
+    const join_input_t inputS = table_input(relS);
+    return join_init_run(&inputR, &inputS, jf, config);
+}
+
+/**
+ * Same as join_init_run for tables, but each input may also be the chunked or columnar result of a previous join. The
+ * first partitioning pass then reads the chunks in place and applies the projection of the input, so the previous
+ * result never has to be copied into a contiguous table.
+ */
+result_t *
+join_init_run(const join_input_t *inputR, const join_input_t *inputS, JoinFunction jf, const joinconfig_t *config) {
     uint64_t start_time = rdtscp_s();
+    const uint64_t totalR = input_num_tuples(inputR);
+    const uint64_t totalS = input_num_tuples(inputS);
     auto nthreads = config->NTHREADS;
     Barrier barrier{static_cast<size_t>(nthreads)};
     pthread_t tid[nthreads];
@@ -1377,12 +1633,27 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
 
     ocall_pin_thread(config->ALLOC_CORE);
 
+#ifdef CARDINALITY_ESTIMATION
+    const join_statistics_t statistics = estimate_join_statistics(inputR, inputS, nthreads);
+#endif
+    if (inputR->partitioned != nullptr) {
+        logger(ERROR, "Only the probe side S of a radix join can be partitioned before the join");
+        ocall_exit(EXIT_FAILURE);
+    }
+    const partitioned_table_t *partitionedS = inputS->partitioned;
 #ifndef CONSTANT_RADIX_BITS
-    uint32_t num_radix_bits = calc_num_radix_bits(relR->num_tuples, relS->num_tuples, nthreads);
+    uint32_t num_radix_bits = calc_num_radix_bits(totalR, totalS, nthreads);
+#ifdef CARDINALITY_ESTIMATION
+    num_radix_bits = cap_num_radix_bits(num_radix_bits, statistics.distinct_R, nthreads);
+#endif
 #else
     uint32_t num_radix_bits = 14;
     logger(INFO, "Forcing 14 radix bits.");
 #endif
+    if (partitionedS != nullptr) {
+        // S decided the first partitioning pass already
+        num_radix_bits = partitionedS->num_radix_bits;
+    }
 #ifndef FORCE_2_PHASES
     uint32_t num_passes = calc_num_passes(num_radix_bits);
 #else
@@ -1390,6 +1661,11 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
     logger(INFO, "Forcing 2 join phases.");
 #endif
     auto fanout_pass_1 = 1 << (num_radix_bits / num_passes);
+    if (partitionedS != nullptr && partitionedS->fanout != static_cast<uint32_t>(fanout_pass_1)) {
+        logger(ERROR, "S is partitioned with fanout %u, but the first pass of the join has fanout %d",
+               partitionedS->fanout, fanout_pass_1);
+        ocall_exit(EXIT_FAILURE);
+    }
     auto rel_padding = relation_padding(num_radix_bits, num_passes);
 
     logger(INFO, "Running RHO with %d passes and %d radix bits", num_passes,
@@ -1418,8 +1694,8 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
 
     /* allocate temporary space for partitioning */
 
-    uint64_t r_buf_size = relR->num_tuples * sizeof(struct row_t) + rel_padding;
-    uint64_t s_buf_size = relS->num_tuples * sizeof(struct row_t) + rel_padding;
+    uint64_t r_buf_size = totalR * sizeof(struct row_t) + rel_padding;
+    uint64_t s_buf_size = totalS * sizeof(struct row_t) + rel_padding;
 
     auto tmpRelR = (struct row_t *) alloc_aligned(r_buf_size);
     auto tmpRelS = (struct row_t *) alloc_aligned(s_buf_size);
@@ -1455,21 +1731,52 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
 
     /* first assign chunks of relR & relS for each thread */
     uint64_t numperthr[2];
-    numperthr[0] = relR->num_tuples / nthreads;
-    numperthr[1] = relS->num_tuples / nthreads;
+    numperthr[0] = totalR / nthreads;
+    numperthr[1] = totalS / nthreads;
+
+    /* chunked inputs are split at chunk boundaries instead */
+    std::vector<input_range_t> rangesR;
+    std::vector<input_range_t> rangesS;
+    if (inputR->table == nullptr) {
+        rangesR = split_input(inputR, nthreads);
+    }
+    if (inputS->table == nullptr) {
+        rangesS = split_input(inputS, nthreads);
+    }
 
     auto joinresult = (result_t *) malloc(sizeof(result_t));
     joinresult->nthreads = nthreads;
     joinresult->materialized = config->MATERIALIZE;
 
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+    joinresult->result_type = 2;
+    std::vector<columnar_table_t> thread_result_tables(nthreads);
+#ifdef CHUNKED_TABLE_PREALLOC
+#ifdef CARDINALITY_ESTIMATION
+    size_t num_chunks_prealloc_per_thread =
+            expected_matches_per_thread(&statistics, nthreads, 1 << num_radix_bits) / TUPLES_PER_COLUMN_CHUNK + 1;
+#else
+    // Same security margin as for the chunked table, but columnar chunks hold more tuples.
+    size_t num_chunks_prealloc = (totalS / TUPLES_PER_COLUMN_CHUNK + 1) * 6 / 5;
+    size_t num_chunks_prealloc_per_thread = num_chunks_prealloc / nthreads + 1;
+#endif
+    for (auto &table : thread_result_tables) {
+        init_columnar_table_prealloc(&table, config->OUTPUT_COLUMNS, num_chunks_prealloc_per_thread);
+    }
+#endif
+#elif defined(CHUNKED_TABLE)
     joinresult->result_type = 1;
     std::vector<chunked_table_t> thread_result_tables(nthreads);
 #ifdef CHUNKED_TABLE_PREALLOC
+#ifdef CARDINALITY_ESTIMATION
+    size_t num_chunks_prealloc_per_thread =
+            expected_matches_per_thread(&statistics, nthreads, 1 << num_radix_bits) / TUPLES_PER_CHUNK + 1;
+#else
     // Round up so that there will be enough chunks.
     // Add in 20 % more chunks for the case of light skew between the threads.
-    size_t num_chunks_prealloc = (relS->num_tuples / TUPLES_PER_CHUNK + 1) * 6 / 5; // 20 % scew security
+    size_t num_chunks_prealloc = (totalS / TUPLES_PER_CHUNK + 1) * 6 / 5; // 20 % scew security
     size_t num_chunks_prealloc_per_thread = num_chunks_prealloc / nthreads + 1;
+#endif
     for (auto & table : thread_result_tables) {
         init_chunked_table_prealloc(&table, num_chunks_prealloc_per_thread);
     }
@@ -1485,20 +1792,35 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
     auto preparation_time = rdtscp_s();
 
     for (int i = 0; i < nthreads; i++) {
-        args[i].relR = relR->tuples + i * numperthr[0];
+        if (inputR->table != nullptr) {
+            args[i].relR = inputR->table->tuples + i * numperthr[0];
+            args[i].numR = (i == (nthreads - 1)) ? (totalR - i * numperthr[0]) : numperthr[0];
+            args[i].rangeR = {};
+        } else {
+            args[i].relR = nullptr;
+            args[i].numR = rangesR[i].num_tuples;
+            args[i].rangeR = rangesR[i];
+        }
         args[i].tmpR = tmpRelR;
         args[i].tmpR2 = tmpRelR2;
         args[i].histR = histR;
 
-        args[i].relS = relS->tuples + i * numperthr[1];
+        if (inputS->table != nullptr) {
+            args[i].relS = inputS->table->tuples + i * numperthr[1];
+            args[i].numS = (i == (nthreads - 1)) ? (totalS - i * numperthr[1]) : numperthr[1];
+            args[i].rangeS = {};
+        } else {
+            args[i].relS = nullptr;
+            args[i].numS = rangesS[i].num_tuples;
+            args[i].rangeS = rangesS[i];
+        }
         args[i].tmpS = tmpRelS;
         args[i].tmpS2 = tmpRelS2;
         args[i].histS = histS;
+        args[i].partitionedS = partitionedS;
 
-        args[i].numR = (i == (nthreads - 1)) ? (relR->num_tuples - i * numperthr[0]) : numperthr[0];
-        args[i].numS = (i == (nthreads - 1)) ? (relS->num_tuples - i * numperthr[1]) : numperthr[1];
-        args[i].totalR = relR->num_tuples;
-        args[i].totalS = relS->num_tuples;
+        args[i].totalR = totalR;
+        args[i].totalS = totalS;
 
         args[i].num_radix_bits = num_radix_bits;
         args[i].num_passes = num_passes;
@@ -1519,7 +1841,10 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
 
         args[i].parts_joined = 0;
         args[i].parts_partitioned = 0;
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+        args[i].thread_result_table = &(thread_result_tables[i]);
+        args[i].output_columns = config->OUTPUT_COLUMNS;
+#elif defined(CHUNKED_TABLE)
         args[i].thread_result_table = &(thread_result_tables[i]);
 #else
         args[i].threadresult = ((threadresult_t *) joinresult->result) + i;
@@ -1551,7 +1876,13 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
 
     joinresult->totalresults = result;
 
-#ifdef CHUNKED_TABLE
+#if defined(COLUMNAR_TABLE)
+    // link results of all columnar tables together by copying the chunk descriptors
+    joinresult->result = concatenate(thread_result_tables);
+    for (auto &table : thread_result_tables) {
+        free(table.chunks);
+    }
+#elif defined(CHUNKED_TABLE)
     // link results of all chunked tables together by copying the chunk pointers
     joinresult->result = concatenate(thread_result_tables);
 #endif
@@ -1630,7 +1961,7 @@ join_init_run(const table_t *relR, const table_t *relS, JoinFunction jf, const j
     print_timing(max_timers,
                  start_time,
                  end_time,
-                 relR->num_tuples + relS->num_tuples,
+                 totalR + totalS,
                  result, preparation_time - start_time, join_time - preparation_time, free_time - join_time);
 #endif
 
@@ -1645,4 +1976,14 @@ RHO(const table_t *relR, const table_t *relS, const joinconfig_t *config) {
 result_t *
 RHT(const table_t *relR, const table_t *relS, const joinconfig_t *config) {
     return join_init_run(relR, relS, histogram_join, config);
+}
+
+result_t *
+RHO_chunked(const join_input_t *relR, const join_input_t *relS, const joinconfig_t *config) {
+    return join_init_run(relR, relS, bucket_chaining_join, config);
+}
+
+result_t *
+RHT_chunked(const join_input_t *relR, const join_input_t *relS, const joinconfig_t *config) {
+    return join_init_run(relR, relS, histogram_join, config);
 }
\ No newline at end of file
@@ -48,32 +48,35 @@ static int64_t merge(const relation_t *relR, const relation_t *relS)
 {
     int64_t matches = 0;
     const row_t *tr = relR->tuples;
-    const row_t *ts;
     const row_t *gs = relS->tuples;
-    int64_t tr_s = 0;
-    int64_t gs_s = 0;
-    while ( tr_s < relR->num_tuples && gs_s < relS->num_tuples)
+    const row_t *const tr_end = relR->tuples + relR->num_tuples;
+    const row_t *const gs_end = relS->tuples + relS->num_tuples;
+    while (tr < tr_end && gs < gs_end)
     {
-        while (tr->key < gs->key)
+        if (tr->key < gs->key)
         {
-            tr++; tr_s++;
+            tr++;
         }
-        while (tr->key > gs->key)
+        else if (tr->key > gs->key)
         {
-            gs++; gs_s++;
+            gs++;
         }
-        ts = gs;
-        while (tr->key == gs->key)
+        else
         {
-            ts = gs;
-            while (ts->key == tr->key)
+            /* every tuple of R with this key matches the whole group of S tuples with it */
+            const row_t *ts = gs;
+            while (ts < gs_end && ts->key == gs->key)
             {
-                matches++;
                 ts++;
             }
-            tr++; tr_s++;
+            const intkey_t key = gs->key;
+            while (tr < tr_end && tr->key == key)
+            {
+                matches += ts - gs;
+                tr++;
+            }
+            gs = ts;
         }
-        gs = ts;
     }
     return matches;
 }
@@ -83,7 +86,9 @@ int64_t sortmerge_join(const struct table_t * const R,
                        const struct table_t * const S,
                        struct table_t * const tmpR,
                        uint32_t num_radix_bits,
-                       #ifdef CHUNKED_TABLE
+                       #if defined(COLUMNAR_TABLE)
+                       columnar_table_t *output,
+                       #elif defined(CHUNKED_TABLE)
                        chunked_table_t *output,
                        #else
                        output_list_t **output,
@@ -135,3 +140,8 @@ result_t* RSM (const table_t * relR, const table_t * relS, const joinconfig_t *c
 {
     return join_init_run(relR, relS, sortmerge_join, config);
 }
+
+result_t* RSM_chunked (const join_input_t * relR, const join_input_t * relS, const joinconfig_t *config)
+{
+    return join_init_run(relR, relS, sortmerge_join, config);
+}
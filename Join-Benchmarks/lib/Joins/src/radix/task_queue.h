@@ -15,6 +15,7 @@
 #include "rdtscpWrapper.h"
 
 #include "data-types.h" /* relation_t, int32_t */
+#include "PartitionedTable.hpp" /* partition_block_t */
 
 /** 
  * @defgroup TaskQueue Task Queue Implementation 
@@ -30,6 +31,8 @@ struct task_t {
     struct table_t tmpR;
     struct table_t relS;
     struct table_t tmpS;
+    const partition_block_t *blocksS;
+    uint64_t num_blocksS;
     task_t *next;
 };
 
@@ -0,0 +1,107 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_DECIMAL_HPP
+#define SGXV2_JOIN_BENCHMARKS_DECIMAL_HPP
+
+#include "TpcHTypes.hpp"
+#include <cstdint>
+
+/*
+ * Arithmetic on the fixed-point decimals of TpcHTypes.hpp. A product of decimals has the sum of the scales of its
+ * factors, e.g. l_extendedprice * (1 - l_discount) has scale 4, which keeps it exact in 64 bits. Sums of many rows go
+ * into 128-bit integers. Only additions, comparisons and multiplications of 64-bit factors are done on them, which
+ * compile to a few instructions: a division or a float conversion of an __int128 would call into libgcc, which the
+ * enclave does not link.
+ */
+
+/** Characters format_decimal writes at most, 39 digits of an __int128, its sign, the point and the terminator */
+constexpr unsigned DECIMAL_CHARS = 42;
+
+/**
+ * Rows after which the SIMD kernels add their 64-bit lane sums to the 128-bit sums. A lane sums 1/8 of them, so its
+ * sum is exact for products below 2^63 / 8192, e.g. l_extendedprice * (1 - l_discount) * (1 + l_tax) at scale 6 of
+ * prices up to 10^8.
+ */
+constexpr uint64_t DECIMAL_FLUSH_ROWS = 64 * 1024;
+
+/** 10^scale */
+constexpr int64_t
+decimal_unit(int scale) {
+    int64_t unit = 1;
+    for (int i = 0; i < scale; ++i) {
+        unit *= 10;
+    }
+    return unit;
+}
+
+/** Nearest decimal of a float column value, exact for the values of TPC-H, which have DECIMAL_SCALE digits */
+constexpr decimal_t
+to_decimal(float value) {
+    const double scaled = static_cast<double>(value) * DECIMAL_ONE;
+    return static_cast<decimal_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+/** Sum of decimals of one scale, the state of HashAggregation for the revenues of the queries */
+struct DecimalSum {
+    __int128 value = 0;
+
+    DecimalSum &
+    operator+=(const DecimalSum &other) {
+        value += other.value;
+        return *this;
+    }
+};
+
+/** value / 10^scale, the halves of value are converted separately */
+inline double
+decimal_to_double(__int128 value, int scale) {
+    const auto high = static_cast<int64_t>(value >> 64);
+    const auto low = static_cast<uint64_t>(value);
+    return (static_cast<double>(high) * 18446744073709551616.0 + static_cast<double>(low)) /
+           static_cast<double>(decimal_unit(scale));
+}
+
+/**
+ * Writes value / 10^scale with all scale digits to buffer, e.g. 12345 with scale 2 as "123.45". Digits are split off
+ * by short division of 32-bit limbs, which needs only 64-bit divisions.
+ * @return buffer
+ */
+inline const char *
+format_decimal(char (&buffer)[DECIMAL_CHARS], __int128 value, int scale) {
+    auto magnitude = static_cast<unsigned __int128>(value);
+    if (value < 0) {
+        magnitude = ~magnitude + 1;
+    }
+    uint32_t limbs[4];
+    for (int i = 0; i < 4; ++i) {
+        limbs[i] = static_cast<uint32_t>(magnitude >> (32 * i));
+    }
+    // digits from the least significant one, at least one before the point
+    char digits[DECIMAL_CHARS];
+    int num_digits = 0;
+    bool zero;
+    do {
+        uint64_t remainder = 0;
+        zero = true;
+        for (int i = 3; i >= 0; --i) {
+            const uint64_t current = (remainder << 32) | limbs[i];
+            limbs[i] = static_cast<uint32_t>(current / 10);
+            remainder = current % 10;
+            zero &= limbs[i] == 0;
+        }
+        digits[num_digits++] = static_cast<char>('0' + remainder);
+    } while (!zero || num_digits <= scale);
+
+    unsigned length = 0;
+    if (value < 0) {
+        buffer[length++] = '-';
+    }
+    for (int i = num_digits - 1; i >= 0; --i) {
+        buffer[length++] = digits[i];
+        if (i == scale && scale > 0) {
+            buffer[length++] = '.';
+        }
+    }
+    buffer[length] = '\0';
+    return buffer;
+}
+
+#endif//SGXV2_JOIN_BENCHMARKS_DECIMAL_HPP
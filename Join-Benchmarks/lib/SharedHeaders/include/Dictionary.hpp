@@ -0,0 +1,76 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_DICTIONARY_HPP
+#define SGXV2_JOIN_BENCHMARKS_DICTIONARY_HPP
+
+#include "TpcHTypes.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/*
+ * Lookups in the dictionaries of the string columns of TpcHTypes.hpp. String predicates are evaluated once on the
+ * values of a dictionary, which yields the set of matching codes, and then on the codes of the column, see CodeSet in
+ * Predicates.hpp. The dictionaries hold a few dozen values, so they are searched linearly.
+ */
+
+/** The num_values + 1 offsets at the start of the values of a dictionary */
+inline const uint32_t *
+dictionary_offsets(const dictionary_t &dictionary) {
+    return reinterpret_cast<const uint32_t *>(dictionary.values);
+}
+
+/** Value of code, which must be below num_values */
+inline std::string_view
+dictionary_value(const dictionary_t &dictionary, uint32_t code) {
+    const uint32_t *offsets = dictionary_offsets(dictionary);
+    return {dictionary.values + offsets[code], offsets[code + 1] - offsets[code]};
+}
+
+/** Code of value, num_values if the dictionary does not hold it */
+inline uint32_t
+dictionary_code(const dictionary_t &dictionary, std::string_view value) {
+    for (uint32_t code = 0; code < dictionary.num_values; ++code) {
+        if (dictionary_value(dictionary, code) == value) {
+            return code;
+        }
+    }
+    return dictionary.num_values;
+}
+
+/** True if both dictionaries hold the same values in the same order, so their codes are interchangeable */
+inline bool
+dictionary_equal(const dictionary_t &a, const dictionary_t &b) {
+    return a.num_values == b.num_values && a.size == b.size &&
+           (a.size == 0 || std::memcmp(a.values, b.values, a.size) == 0);
+}
+
+/**
+ * SQL LIKE: % in pattern matches any sequence of characters, _ any single character. Backtracks only to the last %,
+ * which suffices because a later % can match everything an earlier one could.
+ */
+inline bool
+like_match(std::string_view value, std::string_view pattern) {
+    size_t v = 0;
+    size_t p = 0;
+    size_t star = std::string_view::npos;
+    size_t star_value = 0;
+    while (v < value.size()) {
+        if (p < pattern.size() && (pattern[p] == '_' || (pattern[p] != '%' && pattern[p] == value[v]))) {
+            ++v;
+            ++p;
+        } else if (p < pattern.size() && pattern[p] == '%') {
+            star = p++;
+            star_value = v;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            v = ++star_value;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+#endif//SGXV2_JOIN_BENCHMARKS_DICTIONARY_HPP
@@ -5,29 +5,18 @@
 #include <stdint.h>
 
 //Lineitem Table
-const uint8_t L_SHIPMODE_MAIL = 1;
-const uint8_t L_SHIPMODE_SHIP = 2;
-const uint8_t L_SHIPMODE_AIR     = 3;
-const uint8_t L_SHIPMODE_AIR_REG = 4;
-const uint8_t L_SHIPINSTRUCT_DELIVER_IN_PERSON = 1;
-// Customer Table
-const uint8_t MKT_BUILDING = 1;
+const char L_RETURNFLAG_A = 'A';
+const char L_RETURNFLAG_N = 'N';
+const char L_LINESTATUS_F = 'F';
+const char L_LINESTATUS_O = 'O';
 //Part Table
-const uint8_t P_BRAND_12 = 1;
-const uint8_t P_BRAND_23 = 2;
-const uint8_t P_BRAND_34 = 3;
-const uint8_t P_CONTAINER_SM_CASE  = 1;
-const uint8_t P_CONTAINER_SM_BOX   = 2;
-const uint8_t P_CONTAINER_SM_PACK  = 3;
-const uint8_t P_CONTAINER_SM_PKG   = 4;
-const uint8_t P_CONTAINER_MED_BAG  = 5;
-const uint8_t P_CONTAINER_MED_BOX  = 6;
-const uint8_t P_CONTAINER_MED_PKG  = 7;
-const uint8_t P_CONTAINER_MED_PACK = 8;
-const uint8_t P_CONTAINER_LG_CASE  = 9;
-const uint8_t P_CONTAINER_LG_BOX   = 10;
-const uint8_t P_CONTAINER_LG_PACK  = 11;
-const uint8_t P_CONTAINER_LG_PKG   = 12;
+const uint8_t P_NAME_GREEN = 1; // p_name contains "green"
+
+/** Dates are seconds since the epoch at UTC midnight, their narrow encoding is the day number (seconds / 86400) */
+const uint64_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+// Query 1
+const uint64_t TIMESTAMP_1998_09_02_SECONDS = 904694400;
 
 // Query 12
 const uint64_t TIMESTAMP_1995_01_01_SECONDS = 788918400;
@@ -41,11 +30,47 @@ const uint64_t TIMESTAMP_1993_10_01_SECONDS = 749433600;
 const uint64_t TIMESTAMP_1994_01_01_SECONDS = 757382400;
 const char L_RETURNFLAG_R = 'R';
 
+/**
+ * Fixed-point decimal of the price, rate and quantity columns: the value times 10^DECIMAL_SCALE, e.g. 1234 for 12.34.
+ * The arithmetic on decimals is in Decimal.hpp.
+ */
+typedef int64_t decimal_t;
+const int DECIMAL_SCALE = 2;
+const int64_t DECIMAL_ONE = 100;
+
+/** Rows summarized by one entry of a zone map, equal to the morsel size of the scans */
+const uint64_t ZONE_ROWS = 64 * 1024;
+
+typedef struct zone_t zone_t;
+
+/** Smallest and largest value of ZONE_ROWS consecutive rows of a column, the last zone may have fewer rows */
+struct zone_t {
+    uint64_t min;
+    uint64_t max;
+};
+
+typedef struct dictionary_t dictionary_t;
+
+/**
+ * Dictionary of a string column, whose rows hold the codes of their values. values starts with num_values + 1 offsets
+ * of type uint32_t, which count the bytes from the start of values, followed by the characters: value i is the bytes
+ * [offsets[i], offsets[i + 1]). The dictionaries built from the data are sorted, so the order of the codes is the
+ * order of the values. The functions on dictionaries are in Dictionary.hpp.
+ */
+struct dictionary_t {
+    uint32_t num_values;
+    uint32_t size; // bytes of values
+    char *values;  // nullptr if the column has no dictionary
+};
+
 typedef struct LineItemTable LineItemTable;
 typedef struct OrdersTable OrdersTable;
 typedef struct CustomerTable CustomerTable;
 typedef struct PartTable PartTable;
 typedef struct NationTable NationTable;
+typedef struct SupplierTable SupplierTable;
+typedef struct RegionTable RegionTable;
+typedef struct PartSuppTable PartSuppTable;
 
 struct LineItemTable {
     uint64_t numTuples;
@@ -58,6 +83,34 @@ struct LineItemTable {
     float *l_quantity;
     uint8_t *l_shipinstruct;
     char *l_returnflag;
+    float *l_extendedprice;
+    float *l_discount;
+    float *l_tax;
+    char *l_linestatus;
+    type_key *l_suppkey;
+    // zone maps of the date columns, nullptr if the column has none
+    zone_t *l_shipdate_zones;
+    zone_t *l_commitdate_zones;
+    zone_t *l_receiptdate_zones;
+    // narrow encodings of the columns above for the filters, nullptr if the table has none
+    uint16_t *l_shipdate_days; // days since 1970-01-01
+    uint16_t *l_commitdate_days;
+    uint16_t *l_receiptdate_days;
+    uint8_t *l_quantity_u8; // l_quantity is an integer from 1 to 50
+    zone_t *l_shipdate_days_zones;
+    zone_t *l_commitdate_days_zones;
+    zone_t *l_receiptdate_days_zones;
+    // fixed-point decimal encodings of the columns above, nullptr if the table has none
+    decimal_t *l_quantity_dec;
+    decimal_t *l_extendedprice_dec;
+    decimal_t *l_discount_dec;
+    decimal_t *l_tax_dec;
+    // dictionaries of the string columns above
+    dictionary_t l_shipmode_dict;
+    dictionary_t l_shipinstruct_dict;
+    // rows deleted by refresh function RF2, bit row % 64 of word row / 64, nullptr if no row is deleted
+    uint64_t *l_deleted;
+    uint32_t *l_deleted_zones; // deleted rows of every zone of ZONE_ROWS rows
 };
 
 struct OrdersTable {
@@ -65,6 +118,14 @@ struct OrdersTable {
     tuple_t *o_orderkey; //key->orderkey, value->rowID
     uint64_t *o_orderdate;
     type_key *o_custkey;
+    uint8_t *o_orderpriority;
+    uint32_t *o_shippriority;
+    zone_t *o_orderdate_zones; // nullptr if o_orderdate has no zone map
+    uint16_t *o_orderdate_days; // o_orderdate in days since 1970-01-01, nullptr if the table has no narrow encoding
+    zone_t *o_orderdate_days_zones;
+    dictionary_t o_orderpriority_dict;
+    uint64_t *o_deleted; // rows deleted by refresh function RF2 like l_deleted, nullptr if no row is deleted
+    uint32_t *o_deleted_zones;
 };
 
 struct CustomerTable {
@@ -72,6 +133,7 @@ struct CustomerTable {
     tuple_t *c_custkey; //key->custkey, value->rowID
     uint8_t *c_mktsegment;
     type_key *c_nationkey;
+    dictionary_t c_mktsegment_dict;
 };
 
 struct PartTable {
@@ -80,10 +142,52 @@ struct PartTable {
     uint8_t *p_brand;
     uint32_t *p_size;
     uint8_t *p_container;
+    uint8_t *p_name; // P_NAME_GREEN if the name contains green, 0 otherwise
+    dictionary_t p_brand_dict;
+    dictionary_t p_container_dict;
 };
 
 struct NationTable {
     uint64_t numTuples;
     tuple_t *n_nationkey; //key->nationkey, value->rowID
+    type_key *n_regionkey;
+};
+
+struct SupplierTable {
+    uint64_t numTuples;
+    tuple_t *s_suppkey; //key->suppkey, value->rowID
+    type_key *s_nationkey;
+};
+
+struct RegionTable {
+    uint64_t numTuples;
+    tuple_t *r_regionkey; //key->regionkey, value->rowID
+    uint8_t *r_name;
+    dictionary_t r_name_dict;
+};
+
+struct PartSuppTable {
+    uint64_t numTuples;
+    tuple_t *ps_partkey; //key->partkey, value->rowID
+    type_key *ps_suppkey;
+    float *ps_supplycost;
+    decimal_t *ps_supplycost_dec; // fixed-point decimal encoding of ps_supplycost, nullptr if the table has none
+};
+
+typedef struct refresh_stats_t refresh_stats_t;
+
+/** State of the delta store that applies the refresh functions to orders and lineitem, see tpch_refresh.hpp */
+struct refresh_stats_t {
+    uint64_t orders_main;      // rows of the last merge
+    uint64_t orders_delta;     // rows inserted since the last merge
+    uint64_t orders_deleted;   // main and delta rows deleted since the last merge
+    uint64_t lineitems_main;
+    uint64_t lineitems_delta;
+    uint64_t lineitems_deleted;
+    uint64_t merges;           // merges run in the background
+    uint64_t forced_merges;    // merges run by an insert that did not fit into the delta
+    uint64_t merge_cycles;     // building the merged tables, concurrently with queries and refreshes
+    uint64_t install_cycles;   // catching up with the refreshes during the build and replacing the tables
+    uint64_t wait_cycles;      // waiting for the running queries before the install, not part of install_cycles
 };
 #endif //TPCTYPES_HPP
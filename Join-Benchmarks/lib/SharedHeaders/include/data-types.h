@@ -91,6 +91,41 @@ struct chunked_table_t {
     uint64_t num_tuples; // Total number of tuples over all chunks
 };
 
+/* Bit mask of the output columns a join writes into a columnar table */
+#define COLUMN_KEY 0x1
+#define COLUMN_RPAYLOAD 0x2
+#define COLUMN_SPAYLOAD 0x4
+#define COLUMN_ALL (COLUMN_KEY | COLUMN_RPAYLOAD | COLUMN_SPAYLOAD)
+
+#define TUPLES_PER_COLUMN_CHUNK (CHUNK_SIZE / sizeof(type_key))
+#define TUPLES_PER_WC_BUFFER (64 / sizeof(type_key))
+
+/** One chunk of a columnar table. Columns that are not part of the projection are nullptr. */
+struct column_chunk_t {
+    uint64_t num_tuples;
+    type_key *keys;
+    type_value *Rpayloads;
+    type_value *Spayloads;
+};
+
+/** Software write-combining buffer holding one cache line per column */
+struct __attribute__((aligned(64))) column_wc_buffer_t {
+    type_key keys[TUPLES_PER_WC_BUFFER];
+    type_value Rpayloads[TUPLES_PER_WC_BUFFER];
+    type_value Spayloads[TUPLES_PER_WC_BUFFER];
+};
+
+struct __attribute__((aligned(64))) columnar_table_t {
+    struct column_wc_buffer_t buffer; // Tuples not yet written to the current chunk
+    uint64_t buffered_tuples; // Number of valid tuples in buffer
+    struct column_chunk_t *chunks; // Chunk descriptors
+    uint64_t current_chunk; // The chunk that is currently being filled
+    uint64_t num_chunks; // The number of allocated chunks
+    uint64_t chunk_capacity; // The number of chunk descriptors that fit into chunks
+    uint64_t num_tuples; // Total number of tuples over all chunks
+    uint32_t columns; // COLUMN_* mask of the materialized columns
+};
+
 struct algorithm_t {
     char name[128];
     result_t *  (*join)(const struct table_t*, const struct table_t*, const struct joinconfig_t*);
@@ -110,7 +145,29 @@ struct result_t {
     double                  throughput;
     int                     materialized;
     void *                  result;
-    int                     result_type; // 0 = threadresult_t*, 1 = chunked_table_t*
+    int                     result_type; // 0 = threadresult_t*, 1 = chunked_table_t*, 2 = columnar_table_t*
+};
+
+/**
+ * Layout of a join result exported into a host buffer, see ecall_export_join_result. The buffer starts with
+ * num_chunks export_chunk_t entries, followed by the data of the chunks, each starting at a multiple of 64 bytes.
+ * Chunks of result type 0 and 1 hold output_triple_t rows. Chunks of type 2 hold the materialized columns one after
+ * another, each one padded to a multiple of 64 bytes. If encrypted, all chunk data is encrypted with AES-128-CTR, the
+ * counter block of a chunk is the nonce followed by the big endian chunk offset divided by 16.
+ */
+struct export_chunk_t {
+    uint64_t offset; // byte offset of the chunk data in the buffer
+    uint64_t num_tuples;
+};
+
+struct export_descriptor_t {
+    uint64_t num_chunks;
+    uint64_t num_tuples;
+    uint64_t bytes_written; // from the beginning of the buffer
+    int      result_type;
+    uint32_t columns;       // COLUMN_* mask of the exported columns
+    int      encrypted;
+    uint8_t  nonce[8];
 };
 
 struct join_result_t {
@@ -173,6 +230,7 @@ struct joinconfig_t {
     int PRINT;
     int CRACKING_THRESHOLD;
     int ALLOC_CORE;
+    int OUTPUT_COLUMNS; // COLUMN_* mask for columnar output, 0 = all columns
 };
 
 typedef struct __attribute__((aligned(64))) {
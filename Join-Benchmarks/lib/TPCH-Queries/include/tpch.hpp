@@ -4,10 +4,24 @@
 #include "TpcHTypes.hpp"
 #include "data-types.h"
 
+void
+tpch_q1(result_t *result, const LineItemTable *l, joinconfig_t *config);
+
 void
 tpch_q3(result_t *result, const struct CustomerTable *c, const struct OrdersTable *o,
               const struct LineItemTable *l, const char *algorithm, struct joinconfig_t *config);
 
+void
+tpch_q5(result_t *result, const CustomerTable *c, const OrdersTable *o, const LineItemTable *l, const SupplierTable *s,
+        const NationTable *n, const RegionTable *r, const char *algorithm, joinconfig_t *config);
+
+void
+tpch_q6(result_t *result, const LineItemTable *l, joinconfig_t *config);
+
+void
+tpch_q9(result_t *result, const PartTable *p, const SupplierTable *s, const LineItemTable *l, const PartSuppTable *ps,
+        const OrdersTable *o, const NationTable *n, const char *algorithm, joinconfig_t *config);
+
 void
 tpch_q10(result_t *result, const CustomerTable *c, const OrdersTable *o, const LineItemTable *l,
                const NationTable *n, const char *algorithm, joinconfig_t *config);
@@ -0,0 +1,80 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_TPCH_REFRESH_HPP
+#define SGXV2_JOIN_BENCHMARKS_TPCH_REFRESH_HPP
+
+#include "TpcHTypes.hpp"
+#include "data-types.h"
+
+/*
+ * Delta store of orders and lineitem for the TPC-H refresh functions. RF1 inserts new orders with their lineitems,
+ * RF2 deletes orders with their lineitems by orderkey.
+ *
+ * The store keeps every table in one set of column arrays: the main rows of the last merge, followed by the delta of
+ * the rows inserted since. Inserts only append behind the last row, so the queries scan main and delta as one table
+ * and the row IDs in the payloads of l_orderkey and o_orderkey stay valid for the joins. Deletes set the row in the
+ * delete bitmap of the table, which the filters of the queries conjoin with their predicates, see NotDeleted in
+ * Predicates.hpp. The zone maps widen with the inserted rows, the delete counts per zone let the filters skip the
+ * bitmap in zones without deletes.
+ *
+ * A merge builds new main arrays without the deleted rows and with tight zone maps, in parallel and while queries
+ * and refreshes go on. It then catches up with the refreshes applied during the build and replaces the tables,
+ * which blocks queries and refreshes only for the catch up.
+ *
+ * Queries see consistent tables between refresh_store_acquire and refresh_store_release: refreshes and the
+ * replacement by a merge wait for the queries, and queries wait for pending refreshes, so a stream of queries
+ * cannot starve them.
+ */
+
+struct refresh_store_t;
+
+/**
+ * Creates a store from copies of the orders and lineitem tables, which the caller keeps. The delta has room for
+ * delta_orders orders and 7 lineitems per order, the most TPC-H generates for an order. The lineitems of every order
+ * are found by l_orderkey.
+ */
+refresh_store_t *
+refresh_store_create(const OrdersTable *o, const LineItemTable *l, uint64_t delta_orders, int nthreads);
+
+/** Frees the store, there must not be any query or refresh running on it */
+void
+refresh_store_free(refresh_store_t *store);
+
+/**
+ * RF1: appends the orders of o and the lineitems of l to the delta. The columns the store has must be present in
+ * o and l, their narrow encodings and zone maps are derived. Orders whose orderkey is in the store already, even as
+ * a deleted order that was not merged yet, are skipped with their lineitems. An orderkey repeated within o is
+ * inserted once and keeps all its lineitems. If the delta is full, the insert merges first.
+ * @return the number of orders inserted
+ */
+uint64_t
+refresh_insert(refresh_store_t *store, const OrdersTable *o, const LineItemTable *l);
+
+/**
+ * RF2: deletes the orders with the given orderkeys and their lineitems. Orderkeys that are not in the store or were
+ * deleted before are skipped.
+ * @return the number of orders deleted
+ */
+uint64_t
+refresh_delete(refresh_store_t *store, const type_key *orderkeys, uint64_t num_keys);
+
+/**
+ * Merges the delta and the deletes into new main arrays with nthreads threads. Meant to run on a thread of its own,
+ * queries and refreshes go on during the merge.
+ * @return false if another merge was running, which leaves the tables to that merge
+ */
+bool
+refresh_merge(refresh_store_t *store, int nthreads);
+
+/**
+ * Points o and l to the current tables of the store, which stay valid and unchanged until refresh_store_release.
+ * The delete bitmaps are nullptr if no row is deleted.
+ */
+void
+refresh_store_acquire(refresh_store_t *store, OrdersTable *o, LineItemTable *l);
+
+void
+refresh_store_release(refresh_store_t *store);
+
+void
+refresh_store_stats(refresh_store_t *store, refresh_stats_t *stats);
+
+#endif//SGXV2_JOIN_BENCHMARKS_TPCH_REFRESH_HPP
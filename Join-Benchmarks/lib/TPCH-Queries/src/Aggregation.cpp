@@ -0,0 +1,38 @@
+#include "Aggregation.hpp"
+#include "radix/radix_join.h"
+
+RadixPartitions
+radix_partition_groups(int nthreads, std::vector<std::vector<row_t> *> &thread_rows, int radix_bits) {
+    const uint64_t num_partitions = 1ULL << radix_bits;
+    const auto mask = static_cast<uint32_t>(num_partitions - 1);
+    auto &pool = WorkerPool::global();
+
+    std::vector<std::vector<uint32_t>> histograms(nthreads, std::vector<uint32_t>(num_partitions, 0));
+    pool.run(nthreads, [&](int thread_id) {
+        const auto &rows = *thread_rows[thread_id];
+        partition_hist(rows.data(), static_cast<uint32_t>(rows.size()), histograms[thread_id].data(), mask, 0);
+    });
+
+    // partitions are contiguous, inside a partition the rows of thread 0 come first
+    RadixPartitions partitions;
+    partitions.begin.resize(num_partitions + 1);
+    std::vector<std::vector<uint32_t>> dst(nthreads, std::vector<uint32_t>(num_partitions));
+    uint64_t offset = 0;
+    for (uint64_t p = 0; p < num_partitions; ++p) {
+        partitions.begin[p] = offset;
+        for (int t = 0; t < nthreads; ++t) {
+            dst[t][p] = static_cast<uint32_t>(offset);
+            offset += histograms[t][p];
+        }
+    }
+    partitions.begin[num_partitions] = offset;
+
+    partitions.rows.resize(offset);
+    pool.run(nthreads, [&](int thread_id) {
+        auto &rows = *thread_rows[thread_id];
+        partition_copy(rows.data(), static_cast<uint32_t>(rows.size()), dst[thread_id].data(), partitions.rows.data(),
+                       mask, 0);
+        std::vector<row_t>().swap(rows);
+    });
+    return partitions;
+}
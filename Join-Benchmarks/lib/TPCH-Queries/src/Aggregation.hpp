@@ -0,0 +1,390 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_AGGREGATION_HPP
+#define SGXV2_JOIN_BENCHMARKS_AGGREGATION_HPP
+
+#include "Decimal.hpp"
+#include "Pipeline.hpp"
+#include "TpcHTypes.hpp"
+#include "WorkerPool.hpp"
+#include "data-types.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#ifdef ENCLAVE
+#include "avx512fintrin.h"
+#include "avxintrin.h"
+#else
+#include <immintrin.h>
+#endif
+
+/*
+ * Operators for the GROUP BY and ORDER BY ... LIMIT parts of the TPC-H queries.
+ *
+ * The hash aggregation is a sink of the operator pipelines. Every thread pre-aggregates into a small hash table that
+ * stays in the L2 cache. When it fills up, the groups are spilled and the table starts over, so groups that occur
+ * close to each other are combined without any synchronization. The spilled groups of all threads are radix
+ * partitioned with the partitioning code of RHO and the partitions are merged independently, one per thread at a time.
+ *
+ * Aggregate states are combined with +=, e.g. a DecimalSum for SUM or a struct of counters.
+ */
+
+/** Slots of a thread-local pre-aggregation table. It is spilled once half of them are used. */
+constexpr uint64_t PREAGGREGATION_SLOTS = 4096;
+
+/** Spilled groups per partition of the merge, the merge table of a partition stays in the L2 cache */
+constexpr uint64_t AGGREGATION_PARTITION_GROUPS = 8192;
+
+constexpr int AGGREGATION_MAX_RADIX_BITS = 12;
+
+/**
+ * l_extendedprice * (1 - l_discount), the revenue the TPC-H queries aggregate, as decimal at scale 4. Tables without
+ * the decimal columns are rounded from the float columns, which hold the prices and rates of TPC-H to the cent.
+ */
+[[gnu::always_inline]] inline int64_t
+lineitem_revenue(const LineItemTable *l, uint64_t row) {
+    const decimal_t price = l->l_extendedprice_dec != nullptr ? l->l_extendedprice_dec[row]
+                                                              : to_decimal(l->l_extendedprice[row]);
+    const decimal_t discount = l->l_discount_dec != nullptr ? l->l_discount_dec[row] : to_decimal(l->l_discount[row]);
+    return price * (DECIMAL_ONE - discount);
+}
+
+/** ps_supplycost * l_quantity of a partsupp and a lineitem row, the cost Q9 subtracts, at scale 4 */
+[[gnu::always_inline]] inline int64_t
+lineitem_supplycost(const PartSuppTable *ps, uint64_t partsupp, const LineItemTable *l, uint64_t row) {
+    const decimal_t cost = ps->ps_supplycost_dec != nullptr ? ps->ps_supplycost_dec[partsupp]
+                                                            : to_decimal(ps->ps_supplycost[partsupp]);
+    const decimal_t quantity = l->l_quantity_dec != nullptr ? l->l_quantity_dec[row] : to_decimal(l->l_quantity[row]);
+    return cost * quantity;
+}
+
+/** Groups of an aggregation, column-wise so that top_k() scans the aggregates with SIMD */
+template<typename State>
+struct Groups {
+    std::vector<type_key> keys;
+    std::vector<State> states;
+
+    [[nodiscard]] uint64_t size() const { return keys.size(); }
+};
+
+/** Open addressing table with linear probing. The slot is taken from the high bits of a multiplicative hash. */
+template<typename State>
+class GroupHashTable {
+public:
+    /** Empties the table and resizes it to the next power of two of at least min_slots */
+    void
+    reset(uint64_t min_slots) {
+        uint32_t bits = 1;
+        while ((1ULL << bits) < min_slots) {
+            ++bits;
+        }
+        slots.assign(1ULL << bits, Slot{});
+        shift = 64 - bits;
+        mask = (1ULL << bits) - 1;
+        num_groups = 0;
+    }
+
+    /**
+     * Adds value to the group of key. A new group is only created while less than half of the slots are used.
+     * @return false if key is a new group and the table is half full
+     */
+    [[gnu::always_inline]] inline bool
+    add(type_key key, const State &value) {
+        for (uint64_t i = (key * 0x9E3779B97F4A7C15ULL) >> shift;; i = (i + 1) & mask) {
+            Slot &slot = slots[i];
+            if (slot.used && slot.key == key) {
+                slot.state += value;
+                return true;
+            }
+            if (!slot.used) {
+                if (2 * num_groups >= slots.size()) {
+                    return false;
+                }
+                slot = Slot{key, true, value};
+                ++num_groups;
+                return true;
+            }
+        }
+    }
+
+    template<typename Function>
+    void
+    for_each_group(const Function &function) const {
+        for (const Slot &slot: slots) {
+            if (slot.used) {
+                function(slot.key, slot.state);
+            }
+        }
+    }
+
+    [[nodiscard]] uint64_t size() const { return num_groups; }
+
+private:
+    struct Slot {
+        type_key key;
+        bool used;
+        State state;
+    };
+
+    std::vector<Slot> slots;
+    uint32_t shift = 0;
+    uint64_t mask = 0;
+    uint64_t num_groups = 0;
+};
+
+/** Groups a thread spilled from its pre-aggregation table, as (key, index into states) rows for the partitioning */
+template<typename State>
+struct alignas(64) PreAggregation {
+    GroupHashTable<State> table;
+    std::vector<row_t> rows;
+    std::vector<State> states;
+
+    [[gnu::always_inline]] inline void
+    add(type_key key, const State &value) {
+        if (!table.add(key, value)) {
+            spill();
+            table.add(key, value);
+        }
+    }
+
+    void
+    spill() {
+        table.for_each_group([this](type_key key, const State &state) {
+            rows.push_back(row_t{key, static_cast<type_value>(states.size())});
+            states.push_back(state);
+        });
+        table.reset(PREAGGREGATION_SLOTS);
+    }
+};
+
+/**
+ * Pipeline sink that adds every input value to its group. function maps a row ID or a value of the input vector to a
+ * std::pair of group key and aggregate state.
+ */
+template<typename State, typename Function>
+class Aggregate {
+public:
+    Aggregate(PreAggregation<State> *aggregation, Function function) : aggregation(aggregation), function(function) {}
+
+    void consume(DenseRange range) {
+        for (uint64_t row = range.begin; row < range.begin + range.size; ++row) {
+            add(function(row));
+        }
+    }
+
+    void consume(SelectionVector &input) {
+        for (uint32_t i = 0; i < input.size; ++i) {
+            add(function(input.rows[i]));
+        }
+    }
+
+    template<typename T>
+    void consume(Vector<T> &input) {
+        for (uint32_t i = 0; i < input.size; ++i) {
+            add(function(input.values[i]));
+        }
+    }
+
+    void finish() {}
+
+private:
+    [[gnu::always_inline]] inline void
+    add(const std::pair<type_key, State> &group) {
+        aggregation->add(group.first, group.second);
+    }
+
+    PreAggregation<State> *aggregation;
+    Function function;
+};
+
+/** Spilled group rows radix partitioned by their key, partition p is rows[begin[p], begin[p + 1]) */
+struct RadixPartitions {
+    std::vector<row_t> rows;
+    std::vector<uint64_t> begin;
+};
+
+/**
+ * Radix partitions the rows of all threads on the low radix_bits of the key with partition_hist and partition_copy
+ * of RHO. Thread t partitions thread_rows[t] and releases it.
+ */
+[[nodiscard]] RadixPartitions
+radix_partition_groups(int nthreads, std::vector<std::vector<row_t> *> &thread_rows, int radix_bits);
+
+template<typename State>
+class HashAggregation {
+public:
+    explicit HashAggregation(int nthreads) : nthreads(nthreads), threads(nthreads) {
+        for (auto &thread: threads) {
+            thread.table.reset(PREAGGREGATION_SLOTS);
+        }
+    }
+
+    template<typename Function>
+    [[nodiscard]] Aggregate<State, Function>
+    sink(int thread_id, Function function) {
+        return Aggregate<State, Function>(&threads[thread_id], function);
+    }
+
+    /** Merges the pre-aggregated groups of all threads once the pipelines feeding the sinks are done */
+    [[nodiscard]] Groups<State>
+    finish() {
+        auto &pool = WorkerPool::global();
+        pool.run(nthreads, [this](int thread_id) { threads[thread_id].spill(); });
+
+        // the rows of every thread point to the states of that thread, rebase them onto the concatenated states
+        std::vector<uint64_t> state_offsets(nthreads + 1, 0);
+        for (int t = 0; t < nthreads; ++t) {
+            state_offsets[t + 1] = state_offsets[t] + threads[t].states.size();
+        }
+        const uint64_t num_spilled = state_offsets[nthreads];
+        std::vector<State> states(num_spilled);
+        std::vector<std::vector<row_t> *> thread_rows(nthreads);
+        pool.run(nthreads, [&](int thread_id) {
+            auto &thread = threads[thread_id];
+            const auto offset = static_cast<type_value>(state_offsets[thread_id]);
+            for (auto &row: thread.rows) {
+                row.payload += offset;
+            }
+            std::copy(thread.states.begin(), thread.states.end(), states.begin() + offset);
+            std::vector<State>().swap(thread.states);
+            thread_rows[thread_id] = &thread.rows;
+        });
+
+        int radix_bits = 0;
+        while ((num_spilled >> radix_bits) > AGGREGATION_PARTITION_GROUPS && radix_bits < AGGREGATION_MAX_RADIX_BITS) {
+            ++radix_bits;
+        }
+        const RadixPartitions partitions = radix_partition_groups(nthreads, thread_rows, radix_bits);
+        const uint64_t num_partitions = 1ULL << radix_bits;
+
+        // merge every partition into the range of its rows, a partition has at most as many groups as rows
+        Groups<State> merged;
+        merged.keys.resize(num_spilled);
+        merged.states.resize(num_spilled);
+        std::vector<uint64_t> partition_groups(num_partitions);
+        std::vector<GroupHashTable<State>> tables(nthreads);
+        pool.for_each_morsel(nthreads, num_partitions, 1, [&](int thread_id, uint64_t begin, uint64_t end) {
+            for (uint64_t p = begin; p < end; ++p) {
+                auto &table = tables[thread_id];
+                const uint64_t rows_begin = partitions.begin[p];
+                const uint64_t rows_end = partitions.begin[p + 1];
+                table.reset(2 * (rows_end - rows_begin));
+                for (uint64_t i = rows_begin; i < rows_end; ++i) {
+                    table.add(partitions.rows[i].key, states[partitions.rows[i].payload]);
+                }
+                uint64_t out = rows_begin;
+                table.for_each_group([&merged, &out](type_key key, const State &state) {
+                    merged.keys[out] = key;
+                    merged.states[out] = state;
+                    ++out;
+                });
+                partition_groups[p] = table.size();
+            }
+        });
+
+        std::vector<uint64_t> group_offsets(num_partitions + 1, 0);
+        for (uint64_t p = 0; p < num_partitions; ++p) {
+            group_offsets[p + 1] = group_offsets[p] + partition_groups[p];
+        }
+        Groups<State> groups;
+        groups.keys.resize(group_offsets[num_partitions]);
+        groups.states.resize(group_offsets[num_partitions]);
+        pool.for_each_morsel(nthreads, num_partitions, 1, [&](int, uint64_t begin, uint64_t end) {
+            for (uint64_t p = begin; p < end; ++p) {
+                const uint64_t from = partitions.begin[p];
+                std::copy_n(merged.keys.begin() + from, partition_groups[p], groups.keys.begin() + group_offsets[p]);
+                std::copy_n(merged.states.begin() + from, partition_groups[p],
+                            groups.states.begin() + group_offsets[p]);
+            }
+        });
+        logger(INFO, "Aggregated %lu spilled groups in %lu partitions into %lu groups", num_spilled, num_partitions,
+               groups.size());
+        return groups;
+    }
+
+private:
+    int nthreads;
+    std::vector<PreAggregation<State>> threads;
+};
+
+/**
+ * The sums as scores for top_k(). Rounding to double keeps their order apart from ties, which better() breaks on the
+ * exact sums.
+ */
+[[nodiscard]] inline std::vector<double>
+decimal_scores(int nthreads, const std::vector<DecimalSum> &sums) {
+    std::vector<double> scores(sums.size());
+    WorkerPool::global().for_each_morsel(nthreads, sums.size(), MORSEL_TUPLES, [&](int, uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i) {
+            scores[i] = decimal_to_double(sums[i].value, 0);
+        }
+    });
+    return scores;
+}
+
+/**
+ * Indexes of the k best values, best first. better(a, b) has to order by scores[] descending and may break ties on
+ * other columns.
+ *
+ * Every thread keeps a heap of its k best values. The scores are compared 8 at a time against the score of the k-th
+ * best value seen so far, only the values that reach it go through better() and the heap. The heaps of all threads
+ * are merged at the end.
+ */
+template<typename Better>
+[[nodiscard]] std::vector<uint64_t>
+top_k(int nthreads, const double *scores, uint64_t num_values, uint32_t k, const Better &better) {
+    if (k == 0) {
+        return {};
+    }
+    struct alignas(64) Heap {
+        std::vector<uint64_t> indexes; // heap ordered by better(), the front is the worst of the k best
+    };
+    std::vector<Heap> heaps(nthreads);
+
+    WorkerPool::global().for_each_morsel(nthreads, num_values, MORSEL_TUPLES,
+                                         [&](int thread_id, uint64_t begin, uint64_t end) {
+        auto &heap = heaps[thread_id].indexes;
+        auto offer = [&heap, k, &better](uint64_t index) {
+            if (heap.size() < k) {
+                heap.push_back(index);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(index, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = index;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        };
+        auto threshold = [&heap, k, scores]() {
+            return heap.size() < k ? -std::numeric_limits<double>::infinity() : scores[heap.front()];
+        };
+
+        __m512d minimum = _mm512_set1_pd(threshold());
+        uint64_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(scores + i), minimum, _CMP_GE_OQ);
+            if (mask == 0) {
+                continue;
+            }
+            for (; mask != 0; mask &= mask - 1) {
+                offer(i + __builtin_ctz(mask));
+            }
+            minimum = _mm512_set1_pd(threshold());
+        }
+        for (; i < end; ++i) {
+            offer(i);
+        }
+    });
+
+    std::vector<uint64_t> best;
+    for (const auto &heap: heaps) {
+        best.insert(best.end(), heap.indexes.begin(), heap.indexes.end());
+    }
+    std::sort(best.begin(), best.end(), better);
+    if (best.size() > k) {
+        best.resize(k);
+    }
+    return best;
+}
+
+#endif//SGXV2_JOIN_BENCHMARKS_AGGREGATION_HPP
@@ -0,0 +1,240 @@
+#include "JoinGraph.hpp"
+#include "JoinInput.hpp"
+#include "rdtscpWrapper.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+std::vector<type_value>
+SelectSink::rows() {
+    uint64_t num_rows = 0;
+    for (const auto &buffer: buffers) {
+        num_rows += buffer.rows.size();
+    }
+    std::vector<type_value> rows;
+    rows.reserve(num_rows);
+    for (auto &buffer: buffers) {
+        rows.insert(rows.end(), buffer.rows.begin(), buffer.rows.end());
+        std::vector<type_value>().swap(buffer.rows);
+    }
+    return rows;
+}
+
+JoinGraph::JoinGraph(int nthreads, const char *algorithm, joinconfig_t *config)
+    : nthreads(nthreads), algorithm(algorithm), config(config) {}
+
+int
+JoinGraph::add_table(const char *name, uint64_t num_rows) {
+    tables.push_back(Table{name, num_rows, false, {}});
+    return static_cast<int>(tables.size() - 1);
+}
+
+int
+JoinGraph::add_table(const char *name, uint64_t num_rows, std::vector<type_value> selected) {
+    logger(INFO, "%s: %lu of %lu rows selected", name, selected.size(), num_rows);
+    tables.push_back(Table{name, num_rows, true, std::move(selected)});
+    return static_cast<int>(tables.size() - 1);
+}
+
+void
+JoinGraph::add_join(int left, KeyColumn left_key, int right, KeyColumn right_key, uint64_t domain) {
+    edges.push_back(Edge{left, left_key, right, right_key, std::max<uint64_t>(domain, 1), false});
+}
+
+JoinedRows
+JoinGraph::run(TPCHTimers &timers) {
+    JoinedRows joined;
+    joined.rows.resize(tables.size());
+    if (tables.empty()) {
+        return joined;
+    }
+
+    std::vector<bool> is_joined(tables.size(), false);
+    std::vector<int> joined_tables;
+    const auto first = static_cast<int>(std::min_element(tables.begin(), tables.end(),
+                                                         [](const Table &a, const Table &b) {
+                                                             return a.size() < b.size();
+                                                         }) - tables.begin());
+    Table &first_table = tables[first];
+    if (first_table.filtered) {
+        joined.rows[first] = std::move(first_table.selected);
+    } else {
+        joined.rows[first].resize(first_table.num_rows);
+        std::iota(joined.rows[first].begin(), joined.rows[first].end(), 0);
+    }
+    joined.size = joined.rows[first].size();
+    is_joined[first] = true;
+    joined_tables.push_back(first);
+    logger(INFO, "Start with %s (%lu rows)", first_table.name, joined.size);
+
+    for (size_t step = 1; step < tables.size(); ++step) {
+        Edge *best = nullptr;
+        int best_table = -1;
+        double best_estimate = std::numeric_limits<double>::infinity();
+        for (auto &edge: edges) {
+            if (edge.applied || is_joined[edge.left] == is_joined[edge.right]) {
+                continue;
+            }
+            const int table = is_joined[edge.left] ? edge.right : edge.left;
+            const double estimate = static_cast<double>(joined.size) * static_cast<double>(tables[table].size()) /
+                                    static_cast<double>(edge.domain);
+            if (estimate < best_estimate) {
+                best = &edge;
+                best_table = table;
+                best_estimate = estimate;
+            }
+        }
+        if (best == nullptr) {
+            logger(ERROR, "The join graph is not connected");
+            ocall_exit(EXIT_FAILURE);
+            return joined;
+        }
+
+        // every other predicate between the joined tables and the new one is evaluated on the join result
+        best->applied = true;
+        std::vector<const Edge *> residual;
+        for (auto &edge: edges) {
+            const bool left = is_joined[edge.left] || edge.left == best_table;
+            const bool right = is_joined[edge.right] || edge.right == best_table;
+            if (!edge.applied && left && right) {
+                edge.applied = true;
+                residual.push_back(&edge);
+            }
+        }
+
+        logger(INFO, "Join %lu: %s (%lu rows), estimated %.0lf rows, %lu residual predicates", step,
+               tables[best_table].name, tables[best_table].size(), best_estimate, residual.size());
+        uint64_t &join_time = step == 1 ? timers.join_1 : step == 2 ? timers.join_2 : timers.join_3;
+        join(joined, joined_tables, best_table, *best, residual, join_time, timers.copy);
+        is_joined[best_table] = true;
+        joined_tables.push_back(best_table);
+        logger(INFO, "Join %lu: %lu rows", step, joined.size);
+    }
+    return joined;
+}
+
+/** Predicate between two tables of the join result, rows == nullptr for the table that is joined */
+struct ResidualPredicate {
+    KeyColumn left_key;
+    const type_value *left_rows;
+    KeyColumn right_key;
+    const type_value *right_rows;
+};
+
+void
+JoinGraph::join(JoinedRows &joined, const std::vector<int> &joined_tables, int table, const Edge &edge,
+                const std::vector<const Edge *> &residual, uint64_t &join_time, uint64_t &copy_time) {
+    auto timer_start = rdtscp_s();
+    Table &new_table = tables[table];
+    const bool table_is_left = edge.left == table;
+    const KeyColumn table_key = table_is_left ? edge.left_key : edge.right_key;
+    const KeyColumn joined_key = table_is_left ? edge.right_key : edge.left_key;
+    const type_value *joined_rows = joined.rows[table_is_left ? edge.right : edge.left].data();
+
+    if (joined.size == 0 || new_table.size() == 0) {
+        for (auto &rows: joined.rows) {
+            std::vector<type_value>().swap(rows);
+        }
+        joined.size = 0;
+        return;
+    }
+
+    // the smaller input is the build side
+    const bool build_joined = joined.size <= new_table.size();
+    JoinOperator join_operator(nthreads);
+    auto input = [&join_operator](bool build, int thread_id) {
+        return build ? join_operator.build(thread_id) : join_operator.probe(thread_id);
+    };
+
+    scan_table(nthreads, joined.size, [&](int thread_id) {
+        return Project{[joined_rows, joined_key](uint64_t i) {
+                           return row_t{joined_key[joined_rows[i]], static_cast<type_value>(i)};
+                       },
+                       input(build_joined, thread_id)};
+    });
+    if (!new_table.filtered && !build_joined && table_key.tuples != nullptr) {
+        join_operator.use_build_table(table_t{table_key.tuples, new_table.num_rows, 0, 0});
+    } else if (new_table.filtered) {
+        const type_value *selected = new_table.selected.data();
+        scan_table(nthreads, new_table.size(), [&](int thread_id) {
+            return Project{[selected, table_key](uint64_t i) { return row_t{table_key[selected[i]], selected[i]}; },
+                           input(!build_joined, thread_id)};
+        });
+    } else {
+        scan_table(nthreads, new_table.num_rows, [&](int thread_id) {
+            return Project{[table_key](uint64_t row) {
+                               return row_t{table_key[row], static_cast<type_value>(row)};
+                           },
+                           input(!build_joined, thread_id)};
+        });
+    }
+    join_operator.finish_build();
+    join_operator.finish_probe();
+    std::vector<type_value>().swap(new_table.selected);
+    auto timer_inputs_end = rdtscp_s();
+
+    result_t join_result;
+    join_operator.run(&join_result, algorithm, config, true, COLUMN_RPAYLOAD | COLUMN_SPAYLOAD);
+    auto timer_join_end = rdtscp_s();
+    join_time += timer_join_end - timer_inputs_end;
+
+    std::vector<ResidualPredicate> predicates;
+    for (const Edge *predicate: residual) {
+        predicates.push_back({predicate->left_key,
+                              predicate->left == table ? nullptr : joined.rows[predicate->left].data(),
+                              predicate->right_key,
+                              predicate->right == table ? nullptr : joined.rows[predicate->right].data()});
+    }
+
+    // (position in the intermediate result, row of the new table) of the join results that satisfy the residuals
+    CollectSink matches(nthreads);
+    scan_join_result(nthreads, &join_result, [&](int thread_id) {
+        return Project{[build_joined](const output_triple_t &triple) {
+                           return build_joined ? row_t{triple.Rpayload, triple.Spayload}
+                                               : row_t{triple.Spayload, triple.Rpayload};
+                       },
+                       Filter{[&predicates](const row_t &match) {
+                                  for (const auto &predicate: predicates) {
+                                      const type_value left = predicate.left_rows ? predicate.left_rows[match.key]
+                                                                                  : match.payload;
+                                      const type_value right = predicate.right_rows ? predicate.right_rows[match.key]
+                                                                                    : match.payload;
+                                      if (predicate.left_key[left] != predicate.right_key[right]) {
+                                          return false;
+                                      }
+                                  }
+                                  return true;
+                              },
+                              matches.sink(thread_id)}};
+    });
+    destroy_join_result(&join_result);
+    table_t match_table = matches.to_table(nthreads);
+
+    JoinedRows next;
+    next.rows.resize(tables.size());
+    next.size = match_table.num_tuples;
+    for (const int t: joined_tables) {
+        next.rows[t].resize(next.size);
+    }
+    next.rows[table].resize(next.size);
+    WorkerPool::global().for_each_morsel(nthreads, next.size, MORSEL_TUPLES,
+                                         [&](int, uint64_t begin, uint64_t end) {
+        const row_t *match = match_table.tuples;
+        for (const int t: joined_tables) {
+            const type_value *from = joined.rows[t].data();
+            type_value *to = next.rows[t].data();
+            for (uint64_t i = begin; i < end; ++i) {
+                to[i] = from[match[i].key];
+            }
+        }
+        type_value *to = next.rows[table].data();
+        for (uint64_t i = begin; i < end; ++i) {
+            to[i] = match[i].payload;
+        }
+    });
+    free(match_table.tuples);
+    joined = std::move(next);
+    copy_time += (timer_inputs_end - timer_start) + (rdtscp_s() - timer_join_end);
+}
@@ -0,0 +1,158 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_JOINGRAPH_HPP
+#define SGXV2_JOIN_BENCHMARKS_JOINGRAPH_HPP
+
+#include "Pipeline.hpp"
+#include "time_print.hpp"
+#include "data-types.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * Join ordering for the queries that join more than three tables. The query registers its filtered tables and the
+ * equi-join predicates between them, the graph picks the order of the joins from the cardinalities of the filtered
+ * tables and runs them with the JoinOperator.
+ *
+ * The order is greedy: start with the smallest filtered table and always join the connected table that gives the
+ * smallest estimated intermediate result next, |I| * |T| / domain of the join key. Predicates between tables that are
+ * both joined already, e.g. the cycle customer - nation - supplier of Q5, are evaluated on the result of the join that
+ * closes the cycle.
+ *
+ * Intermediate results are one column of row IDs per joined table. The joins read their keys through the row IDs and
+ * only pass the position in the intermediate result and the row ID of the new table, the columns are gathered after
+ * every join.
+ */
+
+/** Join key column of a table, either a column of keys or the keys of a (key, row ID) column */
+struct KeyColumn {
+    const type_key *keys;
+    uint32_t stride; // distance of two keys in type_keys
+    tuple_t *tuples; // set for (key, row ID) columns, which can be the build side as they are
+
+    [[gnu::always_inline, nodiscard]] type_key operator[](uint64_t row) const { return keys[row * stride]; }
+};
+
+[[nodiscard]] inline KeyColumn
+key_column(const type_key *keys) {
+    return KeyColumn{keys, 1, nullptr};
+}
+
+[[nodiscard]] inline KeyColumn
+key_column(tuple_t *tuples) {
+    return KeyColumn{&tuples->key, sizeof(tuple_t) / sizeof(type_key), tuples};
+}
+
+/** Output of JoinGraph::run(), row i of the join result consists of rows[t][i] of every table t */
+struct JoinedRows {
+    std::vector<std::vector<type_value>> rows;
+    uint64_t size = 0;
+};
+
+/** Row IDs of the selected rows of a base table, appended by the Select sinks of all threads */
+class SelectSink {
+public:
+    explicit SelectSink(int nthreads) : buffers(nthreads) {}
+
+    class Select {
+    public:
+        explicit Select(std::vector<type_value> *rows) : rows(rows) {}
+
+        void consume(DenseRange range) {
+            for (uint64_t row = range.begin; row < range.begin + range.size; ++row) {
+                rows->push_back(static_cast<type_value>(row));
+            }
+        }
+
+        void consume(SelectionVector &input) {
+            for (uint32_t i = 0; i < input.size; ++i) {
+                rows->push_back(static_cast<type_value>(input.rows[i]));
+            }
+        }
+
+        void finish() {}
+
+    private:
+        std::vector<type_value> *rows;
+    };
+
+    [[nodiscard]] Select sink(int thread_id) { return Select(&buffers[thread_id].rows); }
+
+    /** Concatenates the row IDs of all threads and releases the thread buffers */
+    [[nodiscard]] std::vector<type_value>
+    rows();
+
+private:
+    struct alignas(64) Buffer {
+        std::vector<type_value> rows;
+    };
+    std::vector<Buffer> buffers;
+};
+
+/** Row IDs of the rows of a base table that satisfy predicate, evaluated 8 rows at a time by a Filter */
+template<typename Predicate>
+[[nodiscard]] std::vector<type_value>
+select_rows(int nthreads, uint64_t num_rows, const Predicate &predicate) {
+    SelectSink selected(nthreads);
+    scan_table(nthreads, num_rows,
+               [&](int thread_id) { return Filter{predicate, selected.sink(thread_id)}; });
+    return selected.rows();
+}
+
+class JoinGraph {
+public:
+    JoinGraph(int nthreads, const char *algorithm, joinconfig_t *config);
+
+    /**
+     * Adds a table of which all rows take part in the joins.
+     * @return ID of the table, the index of its row IDs in JoinedRows::rows
+     */
+    int add_table(const char *name, uint64_t num_rows);
+
+    /** Adds a table of which only the rows in selected take part in the joins */
+    int add_table(const char *name, uint64_t num_rows, std::vector<type_value> selected);
+
+    /**
+     * Adds the predicate left_key = right_key.
+     * @param domain number of distinct values of the join key, e.g. the size of the table with the primary key
+     */
+    void add_join(int left, KeyColumn left_key, int right, KeyColumn right_key, uint64_t domain);
+
+    /**
+     * Joins all tables. The join times are added to join_1, join_2 and join_3, which sums up the third and all later
+     * joins, gathering the intermediate results to copy.
+     */
+    [[nodiscard]] JoinedRows run(TPCHTimers &timers);
+
+private:
+    struct Table {
+        const char *name;
+        uint64_t num_rows;
+        bool filtered;
+        std::vector<type_value> selected;
+
+        [[nodiscard]] uint64_t size() const { return filtered ? selected.size() : num_rows; }
+    };
+
+    struct Edge {
+        int left;
+        KeyColumn left_key;
+        int right;
+        KeyColumn right_key;
+        uint64_t domain;
+        bool applied;
+    };
+
+    /**
+     * Joins table into the intermediate result of the tables in joined_tables over edge and evaluates residual, the
+     * other edges the join closes.
+     */
+    void join(JoinedRows &joined, const std::vector<int> &joined_tables, int table, const Edge &edge,
+              const std::vector<const Edge *> &residual, uint64_t &join_time, uint64_t &copy_time);
+
+    int nthreads;
+    const char *algorithm;
+    joinconfig_t *config;
+    std::vector<Table> tables;
+    std::vector<Edge> edges;
+};
+
+#endif//SGXV2_JOIN_BENCHMARKS_JOINGRAPH_HPP
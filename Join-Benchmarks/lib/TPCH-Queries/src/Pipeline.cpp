@@ -0,0 +1,92 @@
+#include "Pipeline.hpp"
+#include "joins.hpp"
+#include "util.hpp"
+#include <cstdlib>
+
+void
+CollectBuffer::add_block() {
+    const uint64_t capacity = blocks.empty() ? VECTOR_SIZE : std::min<uint64_t>(2 * blocks.back().capacity,
+                                                                                 MORSEL_TUPLES);
+    auto rows = static_cast<row_t *>(malloc(capacity * sizeof(row_t)));
+    malloc_check(rows)
+    blocks.push_back({rows, 0, capacity});
+}
+
+CollectSink::~CollectSink() {
+    for (auto &buffer: buffers) {
+        for (auto &block: buffer.blocks) {
+            free(block.rows);
+        }
+    }
+}
+
+table_t
+CollectSink::to_table(int nthreads) {
+    std::vector<CollectBuffer::Block *> blocks;
+    for (auto &buffer: buffers) {
+        for (auto &block: buffer.blocks) {
+            blocks.push_back(&block);
+        }
+    }
+    std::vector<uint64_t> offsets(blocks.size() + 1, 0);
+    for (uint64_t i = 0; i < blocks.size(); ++i) {
+        offsets[i + 1] = offsets[i] + blocks[i]->size;
+    }
+
+    table_t table{};
+    table.num_tuples = offsets.back();
+    table.tuples = static_cast<row_t *>(malloc(std::max<uint64_t>(table.num_tuples, 1) * sizeof(row_t)));
+    malloc_check(table.tuples)
+    WorkerPool::global().for_each_morsel(nthreads, blocks.size(), 1, [&](int, uint64_t block, uint64_t) {
+        std::copy_n(blocks[block]->rows, blocks[block]->size, table.tuples + offsets[block]);
+        // Release the block right away, the enclave heap is limited
+        free(blocks[block]->rows);
+        blocks[block]->rows = nullptr;
+    });
+    for (auto &buffer: buffers) {
+        buffer.blocks.clear();
+    }
+    return table;
+}
+
+JoinOperator::~JoinOperator() {
+    release_inputs();
+}
+
+void
+JoinOperator::use_build_table(const table_t &table) {
+    build_table = table;
+    owns_build_table = false;
+}
+
+void
+JoinOperator::finish_build() {
+    if (owns_build_table) {
+        build_table = build_rows.to_table(nthreads);
+    }
+}
+
+void
+JoinOperator::finish_probe() {
+    probe_table = probe_rows.to_table(nthreads);
+}
+
+void
+JoinOperator::run(result_t *result, const char *algorithm, joinconfig_t *config, bool materialize,
+                  uint32_t output_columns) {
+    logger(INFO, "Join build=%lu with probe=%lu tuples", build_table.num_tuples, probe_table.num_tuples);
+    config->MATERIALIZE = materialize;
+    config->OUTPUT_COLUMNS = output_columns;
+    run_join(result, &build_table, &probe_table, algorithm, config);
+    release_inputs();
+}
+
+void
+JoinOperator::release_inputs() {
+    if (owns_build_table) {
+        free(build_table.tuples);
+    }
+    free(probe_table.tuples);
+    build_table = {};
+    probe_table = {};
+}
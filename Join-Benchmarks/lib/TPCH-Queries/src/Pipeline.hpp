@@ -0,0 +1,444 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_PIPELINE_HPP
+#define SGXV2_JOIN_BENCHMARKS_PIPELINE_HPP
+
+#include "Logger.hpp"
+#include "Predicates.hpp"
+#include "WorkerPool.hpp"
+#include "data-types.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef ENCLAVE
+#include "ocalls_t.h"
+#include "avx512bwintrin.h"
+#include "avx512fintrin.h"
+#include "avx512vlbwintrin.h"
+#include "avx512vlintrin.h"
+#include "avxintrin.h"
+#include "emmintrin.h"
+#else
+#include "ocalls.hpp"
+#include <immintrin.h>
+#endif
+
+/*
+ * Push-based operator pipelines for the TPC-H queries. A source pushes vectors of at most VECTOR_SIZE rows into the
+ * first operator of a chain, every operator processes the whole vector and pushes its output into the next one. Each
+ * thread owns one instance of the chain, so operators keep their output vectors as members and need no
+ * synchronization. The sinks at the end of the chain are the only state shared by the threads.
+ *
+ * Operators implement consume() for the vector types they accept and finish(), which flushes buffered rows and is
+ * forwarded down the chain once the source is exhausted.
+ */
+
+/** Rows per vector passed between operators. A vector of rows or row IDs stays in the L1 cache. */
+constexpr uint32_t VECTOR_SIZE = 1024;
+
+/** Consecutive rows [begin, begin + size) of a base table, produced by table scans */
+struct DenseRange {
+    uint64_t begin;
+    uint32_t size;
+};
+
+/** Row IDs of the selected rows of a base table */
+struct SelectionVector {
+    uint32_t size;
+    uint64_t rows[VECTOR_SIZE];
+};
+
+template<typename T>
+struct Vector {
+    uint32_t size;
+    T values[VECTOR_SIZE];
+};
+
+using RowVector = Vector<row_t>;
+using TripleVector = Vector<output_triple_t>;
+
+/* Operators */
+
+/**
+ * Selection. Dense ranges of base table rows are evaluated 8 rows at a time and turned into a selection vector, sparse
+ * input is compacted in place without branches. Empty vectors are not passed on. Dense ranges in a zone that the zone
+ * maps of the predicate rule out are dropped, ranges in a zone in which every row matches are passed on unchanged.
+ */
+template<typename Predicate, typename Next>
+class Filter {
+public:
+    Filter(Predicate predicate, Next next) : predicate(predicate), next(std::move(next)) {}
+
+    void consume(DenseRange range) {
+        const uint64_t end = range.begin + range.size;
+        switch (zone_match(predicate, range.begin, end)) {
+            case ZoneMatch::NONE:
+                return;
+            case ZoneMatch::ALL:
+                next.consume(range);
+                return;
+            case ZoneMatch::SOME:
+                break;
+        }
+        const __m512i lanes = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+        uint32_t selected = 0;
+        uint64_t row = range.begin;
+        for (; row + 8 <= end; row += 8) {
+            const __mmask8 mask = predicate.mask8(row);
+            _mm512_mask_compressstoreu_epi64(selection.rows + selected, mask,
+                                             _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(row)), lanes));
+            selected += __builtin_popcount(mask);
+        }
+        for (; row < end; ++row) {
+            selection.rows[selected] = row;
+            selected += predicate(row);
+        }
+        selection.size = selected;
+        if (selected > 0) {
+            next.consume(selection);
+        }
+    }
+
+    void consume(SelectionVector &input) {
+        uint32_t selected = 0;
+        for (uint32_t i = 0; i < input.size; ++i) {
+            input.rows[selected] = input.rows[i];
+            selected += predicate(input.rows[i]);
+        }
+        input.size = selected;
+        if (selected > 0) {
+            next.consume(input);
+        }
+    }
+
+    template<typename T>
+    void consume(Vector<T> &input) {
+        uint32_t selected = 0;
+        for (uint32_t i = 0; i < input.size; ++i) {
+            input.values[selected] = input.values[i];
+            selected += predicate(input.values[i]);
+        }
+        input.size = selected;
+        if (selected > 0) {
+            next.consume(input);
+        }
+    }
+
+    void finish() { next.finish(); }
+
+private:
+    Predicate predicate;
+    Next next;
+    SelectionVector selection;
+};
+
+/**
+ * Projection into join input rows. function maps a base table row ID or a value of the input vector to a row_t.
+ * Output rows are buffered until a full vector is available.
+ */
+template<typename Function, typename Next>
+class Project {
+public:
+    Project(Function function, Next next) : function(function), next(std::move(next)) { output.size = 0; }
+
+    void consume(DenseRange range) {
+        for (uint64_t row = range.begin; row < range.begin + range.size; ++row) {
+            emit(function(row));
+        }
+    }
+
+    void consume(SelectionVector &input) {
+        for (uint32_t i = 0; i < input.size; ++i) {
+            emit(function(input.rows[i]));
+        }
+    }
+
+    template<typename T>
+    void consume(Vector<T> &input) {
+        for (uint32_t i = 0; i < input.size; ++i) {
+            emit(function(input.values[i]));
+        }
+    }
+
+    void finish() {
+        if (output.size > 0) {
+            next.consume(output);
+            output.size = 0;
+        }
+        next.finish();
+    }
+
+private:
+    [[gnu::always_inline]] inline void
+    emit(row_t row) {
+        output.values[output.size++] = row;
+        if (output.size == VECTOR_SIZE) {
+            next.consume(output);
+            output.size = 0;
+        }
+    }
+
+    Function function;
+    Next next;
+    RowVector output;
+};
+
+/* Sinks */
+
+/** Rows of one thread in a CollectSink, a list of blocks that grows with the rows and never moves them */
+struct alignas(64) CollectBuffer {
+    struct Block {
+        row_t *rows;
+        uint64_t size;
+        uint64_t capacity;
+    };
+    std::vector<Block> blocks;
+
+    void
+    append(const row_t *rows, uint32_t count) {
+        if (blocks.empty() || blocks.back().capacity - blocks.back().size < count) [[unlikely]] {
+            add_block();
+        }
+        Block &block = blocks.back();
+        std::copy_n(rows, count, block.rows + block.size);
+        block.size += count;
+    }
+
+private:
+    /** Blocks double from VECTOR_SIZE up to MORSEL_TUPLES rows, so small outputs stay small */
+    void
+    add_block();
+};
+
+/** Appends the rows pushed by one thread to the buffer of that thread in a CollectSink */
+class Collect {
+public:
+    explicit Collect(CollectBuffer *buffer) : buffer(buffer) {}
+
+    void consume(RowVector &input) { buffer->append(input.values, input.size); }
+
+    void finish() {}
+
+private:
+    CollectBuffer *buffer;
+};
+
+/**
+ * Materializes the rows of a pipeline as a table, e.g. as the input of a join. Every thread appends to blocks of its
+ * own, which grow with its rows like the outputs of parallel_filter_morsels(), and to_table() copies the blocks into
+ * the table once.
+ */
+class CollectSink {
+public:
+    explicit CollectSink(int nthreads) : buffers(nthreads) {}
+
+    ~CollectSink();
+
+    CollectSink(const CollectSink &) = delete;
+    CollectSink &operator=(const CollectSink &) = delete;
+
+    [[nodiscard]] Collect sink(int thread_id) { return Collect(&buffers[thread_id]); }
+
+    /**
+     * Concatenates the blocks of all threads into a newly allocated table and releases them.
+     * @param nthreads threads that copy the blocks
+     * @return table owning its tuples, to be freed by the caller
+     */
+    [[nodiscard]] table_t
+    to_table(int nthreads);
+
+private:
+    std::vector<CollectBuffer> buffers;
+};
+
+/** Counts the rows pushed by one thread */
+class Count {
+public:
+    explicit Count(uint64_t *count) : count(count) {}
+
+    template<typename VectorType>
+    void consume(VectorType &input) {
+        *count += input.size;
+    }
+
+    void finish() {}
+
+private:
+    uint64_t *count;
+};
+
+class CountSink {
+public:
+    explicit CountSink(int nthreads) : counters(nthreads) {}
+
+    [[nodiscard]] Count sink(int thread_id) { return Count(&counters[thread_id].count); }
+
+    [[nodiscard]] uint64_t
+    total() const {
+        uint64_t total = 0;
+        for (const auto &counter: counters) {
+            total += counter.count;
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) Counter {
+        uint64_t count = 0;
+    };
+    std::vector<Counter> counters;
+};
+
+/**
+ * Pipeline breaker around run_join. The build and probe pipelines push their rows into the two collect sinks, which are
+ * turned into the join inputs once the pipelines are done. A base table column can be used as build side as it is.
+ */
+class JoinOperator {
+public:
+    explicit JoinOperator(int nthreads) : nthreads(nthreads), build_rows(nthreads), probe_rows(nthreads) {}
+
+    ~JoinOperator();
+
+    JoinOperator(const JoinOperator &) = delete;
+    JoinOperator &operator=(const JoinOperator &) = delete;
+
+    [[nodiscard]] Collect build(int thread_id) { return build_rows.sink(thread_id); }
+
+    [[nodiscard]] Collect probe(int thread_id) { return probe_rows.sink(thread_id); }
+
+    /** Uses table as build side without copying it. The table is not freed by the operator. */
+    void use_build_table(const table_t &table);
+
+    /** Has to be called once the build pipeline finished */
+    void finish_build();
+
+    /** Has to be called once the probe pipeline finished */
+    void finish_probe();
+
+    /**
+     * Joins the build with the probe side and frees both inputs afterwards.
+     * @param materialize
+     * @param output_columns COLUMN_* mask of the result columns the next pipeline reads
+     */
+    void run(result_t *result, const char *algorithm, joinconfig_t *config, bool materialize,
+             uint32_t output_columns);
+
+    [[nodiscard]] uint64_t build_size() const { return build_table.num_tuples; }
+
+    [[nodiscard]] uint64_t probe_size() const { return probe_table.num_tuples; }
+
+private:
+    void release_inputs();
+
+    int nthreads;
+    CollectSink build_rows;
+    CollectSink probe_rows;
+    table_t build_table{};
+    table_t probe_table{};
+    bool owns_build_table = true;
+};
+
+/* Sources */
+
+/**
+ * Scans rows [0, num_rows) of a base table on the worker pool. Threads take morsels of MORSEL_TUPLES rows from a shared
+ * counter and push them as dense ranges of VECTOR_SIZE rows into their chain.
+ * @param make_chain called once per thread with the thread ID, returns the operator chain of that thread
+ */
+template<typename ChainFactory>
+void
+scan_table(int nthreads, uint64_t num_rows, const ChainFactory &make_chain) {
+    std::atomic<uint64_t> next_morsel{0};
+    WorkerPool::global().run(nthreads, [&](int thread_id) {
+        auto chain = make_chain(thread_id);
+        uint64_t begin;
+        while ((begin = next_morsel.fetch_add(MORSEL_TUPLES, std::memory_order_relaxed)) < num_rows) {
+            const uint64_t end = std::min(begin + MORSEL_TUPLES, num_rows);
+            for (uint64_t row = begin; row < end; row += VECTOR_SIZE) {
+                chain.consume(DenseRange{row, static_cast<uint32_t>(std::min<uint64_t>(VECTOR_SIZE, end - row))});
+            }
+        }
+        chain.finish();
+    });
+}
+
+/**
+ * Scans a materialized join result of any result type and pushes its rows as vectors of output triples. Threads take
+ * the chunks, or the result list of one join thread, from a shared counter. Columns that were not materialized are 0.
+ */
+template<typename ChainFactory>
+void
+scan_join_result(int nthreads, const result_t *result, const ChainFactory &make_chain) {
+    if (!result->materialized) {
+        logger(ERROR, "Pipelines can only scan materialized join results");
+        ocall_exit(EXIT_FAILURE);
+    }
+    uint64_t num_segments;
+    switch (result->result_type) {
+        case 0:
+            num_segments = result->nthreads;
+            break;
+        case 1:
+            num_segments = static_cast<const chunked_table_t *>(result->result)->num_chunks;
+            break;
+        case 2:
+            num_segments = static_cast<const columnar_table_t *>(result->result)->num_chunks;
+            break;
+        default:
+            logger(ERROR, "Unknown result type %d", result->result_type);
+            ocall_exit(EXIT_FAILURE);
+            return;
+    }
+
+    std::atomic<uint64_t> next_segment{0};
+    WorkerPool::global().run(nthreads, [&](int thread_id) {
+        auto chain = make_chain(thread_id);
+        TripleVector vector;
+        vector.size = 0;
+        auto push = [&chain, &vector]() {
+            chain.consume(vector);
+            vector.size = 0;
+        };
+
+        uint64_t segment;
+        while ((segment = next_segment.fetch_add(1, std::memory_order_relaxed)) < num_segments) {
+            if (result->result_type == 0) {
+                const auto &thread_result = static_cast<const threadresult_t *>(result->result)[segment];
+                const output_list_t *node = thread_result.results;
+                for (int64_t i = 0; i < thread_result.nresults; ++i, node = node->next) {
+                    vector.values[vector.size++] = {node->key, node->Rpayload, node->Spayload};
+                    if (vector.size == VECTOR_SIZE) {
+                        push();
+                    }
+                }
+            } else if (result->result_type == 1) {
+                const auto chunk = static_cast<const chunked_table_t *>(result->result)->chunks[segment];
+                for (uint64_t begin = 0; begin < chunk->num_tuples; begin += VECTOR_SIZE) {
+                    vector.size = static_cast<uint32_t>(std::min<uint64_t>(VECTOR_SIZE, chunk->num_tuples - begin));
+                    std::copy_n(chunk->tuples + begin, vector.size, vector.values);
+                    push();
+                }
+            } else {
+                const auto &chunk = static_cast<const columnar_table_t *>(result->result)->chunks[segment];
+                for (uint64_t begin = 0; begin < chunk.num_tuples; begin += VECTOR_SIZE) {
+                    vector.size = static_cast<uint32_t>(std::min<uint64_t>(VECTOR_SIZE, chunk.num_tuples - begin));
+                    for (uint32_t i = 0; i < vector.size; ++i) {
+                        vector.values[i] = {chunk.keys ? chunk.keys[begin + i] : 0,
+                                            chunk.Rpayloads ? chunk.Rpayloads[begin + i] : 0,
+                                            chunk.Spayloads ? chunk.Spayloads[begin + i] : 0};
+                    }
+                    push();
+                }
+            }
+        }
+        if (vector.size > 0) {
+            push();
+        }
+        chain.finish();
+    });
+}
+
+#endif//SGXV2_JOIN_BENCHMARKS_PIPELINE_HPP
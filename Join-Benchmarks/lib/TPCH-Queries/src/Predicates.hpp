@@ -0,0 +1,955 @@
+#ifndef SGXV2_JOIN_BENCHMARKS_PREDICATES_HPP
+#define SGXV2_JOIN_BENCHMARKS_PREDICATES_HPP
+
+#include "Dictionary.hpp"
+#include "TpcHTypes.hpp"
+#include "data-types.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef ENCLAVE
+#include "avx512bitalgintrin.h"
+#include "avx512bwintrin.h"
+#include "avx512fintrin.h"
+#include "avx512vlbwintrin.h"
+#include "avx512vlintrin.h"
+#include "avxintrin.h"
+#include "emmintrin.h"
+#else
+#include <immintrin.h>
+#endif
+
+/*
+ * Column predicates of the TPC-H filters. Every predicate evaluates a single row ID, 8 consecutive row IDs into a bit
+ * mask for the operator pipelines, and 64 consecutive row IDs into a bit mask for the filter kernels in filters.hpp.
+ *
+ * Predicates are written as expressions over columns, e.g.
+ *
+ *     col(l->l_shipdate) >= TIMESTAMP_1995_03_16_SECONDS &&
+ *         in(col(l->l_shipmode, l->l_shipmode_dict), {"MAIL", "SHIP"})
+ *
+ * which builds And<ValueCompare<Compare::GE, uint64_t>, CodeSet<uint8_t>>. The type of the expression is the
+ * predicate, so the compiler inlines the whole expression into the kernel that evaluates it. && and || evaluate their
+ * operands in the order they are written, all_of() and any_of() reorder them at runtime, see Adaptive.
+ *
+ * Every predicate also states its cost, the instructions it needs for 64 rows, which Adaptive weighs against the
+ * rows it decides.
+ *
+ * Comparisons of a column with constants consult the zone map of the column if it has one, col(values, zones), so the
+ * filters skip zones in which no row can match and take every row of a zone in which all rows match without
+ * evaluating the predicate.
+ *
+ * String columns hold the codes of a dictionary, col(codes, dictionary). Comparisons of them with strings, in() and
+ * like() evaluate the strings once on the dictionary when the predicate is built, see CodeSet.
+ */
+
+enum class Compare { EQ, LT, LE, GT, GE, NE };
+
+template<Compare op, typename T>
+[[gnu::always_inline, nodiscard]] inline bool
+compare(T a, T b) {
+    if constexpr (op == Compare::EQ) {
+        return a == b;
+    } else if constexpr (op == Compare::LT) {
+        return a < b;
+    } else if constexpr (op == Compare::LE) {
+        return a <= b;
+    } else if constexpr (op == Compare::GT) {
+        return a > b;
+    } else if constexpr (op == Compare::GE) {
+        return a >= b;
+    } else {
+        return a != b;
+    }
+}
+
+template<Compare op>
+[[nodiscard]] constexpr int
+int_compare_predicate() {
+    constexpr int predicates[] = {_MM_CMPINT_EQ, _MM_CMPINT_LT, _MM_CMPINT_LE, _MM_CMPINT_NLE, _MM_CMPINT_NLT,
+                                  _MM_CMPINT_NE};
+    return predicates[static_cast<int>(op)];
+}
+
+template<Compare op>
+[[nodiscard]] constexpr int
+float_compare_predicate() {
+    constexpr int predicates[] = {_CMP_EQ_OQ, _CMP_LT_OQ, _CMP_LE_OQ, _CMP_GT_OQ, _CMP_GE_OQ, _CMP_NEQ_UQ};
+    return predicates[static_cast<int>(op)];
+}
+
+/** Loads and compares 8 values of a column of type T in the narrowest register that holds them */
+template<typename T, typename Enable = void>
+struct Lanes8;
+
+template<typename T>
+struct Lanes8<T, std::enable_if_t<std::is_integral_v<T> && sizeof(T) == 1>> {
+    using vector = __m128i;
+    [[gnu::always_inline]] static vector load(const T *values) {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(values));
+    }
+    [[gnu::always_inline]] static vector broadcast(T value) { return _mm_set1_epi8(static_cast<char>(value)); }
+    template<Compare op>
+    [[gnu::always_inline]] static __mmask8 compare(vector a, vector b) {
+        if constexpr (std::is_signed_v<T>) {
+            return static_cast<__mmask8>(_mm_cmp_epi8_mask(a, b, int_compare_predicate<op>()));
+        } else {
+            return static_cast<__mmask8>(_mm_cmp_epu8_mask(a, b, int_compare_predicate<op>()));
+        }
+    }
+};
+
+template<typename T>
+struct Lanes8<T, std::enable_if_t<std::is_integral_v<T> && sizeof(T) == 2>> {
+    using vector = __m128i;
+    [[gnu::always_inline]] static vector load(const T *values) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+    }
+    [[gnu::always_inline]] static vector broadcast(T value) { return _mm_set1_epi16(static_cast<short>(value)); }
+    template<Compare op>
+    [[gnu::always_inline]] static __mmask8 compare(vector a, vector b) {
+        if constexpr (std::is_signed_v<T>) {
+            return _mm_cmp_epi16_mask(a, b, int_compare_predicate<op>());
+        } else {
+            return _mm_cmp_epu16_mask(a, b, int_compare_predicate<op>());
+        }
+    }
+};
+
+template<typename T>
+struct Lanes8<T, std::enable_if_t<std::is_integral_v<T> && sizeof(T) == 4>> {
+    using vector = __m256i;
+    [[gnu::always_inline]] static vector load(const T *values) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values));
+    }
+    [[gnu::always_inline]] static vector broadcast(T value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+    template<Compare op>
+    [[gnu::always_inline]] static __mmask8 compare(vector a, vector b) {
+        if constexpr (std::is_signed_v<T>) {
+            return _mm256_cmp_epi32_mask(a, b, int_compare_predicate<op>());
+        } else {
+            return _mm256_cmp_epu32_mask(a, b, int_compare_predicate<op>());
+        }
+    }
+};
+
+template<typename T>
+struct Lanes8<T, std::enable_if_t<std::is_integral_v<T> && sizeof(T) == 8>> {
+    using vector = __m512i;
+    [[gnu::always_inline]] static vector load(const T *values) { return _mm512_loadu_si512(values); }
+    [[gnu::always_inline]] static vector broadcast(T value) { return _mm512_set1_epi64(static_cast<long long>(value)); }
+    template<Compare op>
+    [[gnu::always_inline]] static __mmask8 compare(vector a, vector b) {
+        if constexpr (std::is_signed_v<T>) {
+            return _mm512_cmp_epi64_mask(a, b, int_compare_predicate<op>());
+        } else {
+            return _mm512_cmp_epu64_mask(a, b, int_compare_predicate<op>());
+        }
+    }
+};
+
+template<>
+struct Lanes8<float> {
+    using vector = __m256;
+    [[gnu::always_inline]] static vector load(const float *values) { return _mm256_loadu_ps(values); }
+    [[gnu::always_inline]] static vector broadcast(float value) { return _mm256_set1_ps(value); }
+    template<Compare op>
+    [[gnu::always_inline]] static __mmask8 compare(vector a, vector b) {
+        return _mm256_cmp_ps_mask(a, b, float_compare_predicate<op>());
+    }
+};
+
+/** Loads and compares a full 512-bit register of a column of type T, which holds 64 / sizeof(T) values */
+template<typename T, typename Enable = void>
+struct Lanes512;
+
+template<typename T>
+struct Lanes512<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using vector = __m512i;
+    static constexpr unsigned count = 64 / sizeof(T);
+    [[gnu::always_inline]] static vector load(const T *values) { return _mm512_loadu_si512(values); }
+    [[gnu::always_inline]] static vector broadcast(T value) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm512_set1_epi8(static_cast<char>(value));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_set1_epi16(static_cast<short>(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_set1_epi32(static_cast<int>(value));
+        } else {
+            return _mm512_set1_epi64(static_cast<long long>(value));
+        }
+    }
+    template<Compare op>
+    [[gnu::always_inline]] static uint64_t compare(vector a, vector b) {
+        constexpr int predicate = int_compare_predicate<op>();
+        if constexpr (sizeof(T) == 1) {
+            return std::is_signed_v<T> ? _mm512_cmp_epi8_mask(a, b, predicate) : _mm512_cmp_epu8_mask(a, b, predicate);
+        } else if constexpr (sizeof(T) == 2) {
+            return std::is_signed_v<T> ? _mm512_cmp_epi16_mask(a, b, predicate)
+                                       : _mm512_cmp_epu16_mask(a, b, predicate);
+        } else if constexpr (sizeof(T) == 4) {
+            return std::is_signed_v<T> ? _mm512_cmp_epi32_mask(a, b, predicate)
+                                       : _mm512_cmp_epu32_mask(a, b, predicate);
+        } else {
+            return std::is_signed_v<T> ? _mm512_cmp_epi64_mask(a, b, predicate)
+                                       : _mm512_cmp_epu64_mask(a, b, predicate);
+        }
+    }
+};
+
+template<>
+struct Lanes512<float> {
+    using vector = __m512;
+    static constexpr unsigned count = 16;
+    [[gnu::always_inline]] static vector load(const float *values) { return _mm512_loadu_ps(values); }
+    [[gnu::always_inline]] static vector broadcast(float value) { return _mm512_set1_ps(value); }
+    template<Compare op>
+    [[gnu::always_inline]] static uint64_t compare(vector a, vector b) {
+        return _mm512_cmp_ps_mask(a, b, float_compare_predicate<op>());
+    }
+};
+
+template<>
+struct Lanes512<double> {
+    using vector = __m512d;
+    static constexpr unsigned count = 8;
+    [[gnu::always_inline]] static vector load(const double *values) { return _mm512_loadu_pd(values); }
+    [[gnu::always_inline]] static vector broadcast(double value) { return _mm512_set1_pd(value); }
+    template<Compare op>
+    [[gnu::always_inline]] static uint64_t compare(vector a, vector b) {
+        return _mm512_cmp_pd_mask(a, b, float_compare_predicate<op>());
+    }
+};
+
+/**
+ * Evaluates 64 rows of a column of type T with the sizeof(T) registers that hold them. compare_register(offset)
+ * returns the mask of the register starting at row offset. Registers without a live row are neither loaded nor
+ * compared, so a selective predicate on a narrow column spares the loads of wide columns. Returns the mask of all 64
+ * rows restricted to live.
+ */
+template<typename T, typename Function>
+[[gnu::always_inline, nodiscard]] inline uint64_t
+combine_registers(uint64_t live, const Function &compare_register) {
+    constexpr unsigned count = Lanes512<T>::count;
+    if constexpr (count == 64) {
+        return compare_register(0) & live;
+    } else {
+        constexpr uint64_t register_rows = (uint64_t{1} << count) - 1;
+        uint64_t mask = 0;
+        for (unsigned offset = 0; offset < 64; offset += count) {
+            if ((live >> offset) & register_rows) {
+                mask |= compare_register(offset) << offset;
+            }
+        }
+        return mask & live;
+    }
+}
+
+/** Rows of a zone that can satisfy a predicate. The order allows combining them with min (and) and max (or). */
+enum class ZoneMatch { NONE, SOME, ALL };
+
+/** Rows of a zone with the bounds zone that satisfy column op value */
+template<Compare op>
+[[nodiscard]] ZoneMatch
+zone_compare(const zone_t &zone, uint64_t value) {
+    bool all = false;
+    bool none = false;
+    switch (op) {
+        case Compare::EQ:
+            all = zone.min == value && zone.max == value;
+            none = value < zone.min || value > zone.max;
+            break;
+        case Compare::NE:
+            all = value < zone.min || value > zone.max;
+            none = zone.min == value && zone.max == value;
+            break;
+        case Compare::LT:
+            all = zone.max < value;
+            none = zone.min >= value;
+            break;
+        case Compare::LE:
+            all = zone.max <= value;
+            none = zone.min > value;
+            break;
+        case Compare::GT:
+            all = zone.min > value;
+            none = zone.max <= value;
+            break;
+        case Compare::GE:
+            all = zone.min >= value;
+            none = zone.max < value;
+            break;
+    }
+    return all ? ZoneMatch::ALL : none ? ZoneMatch::NONE : ZoneMatch::SOME;
+}
+
+/** column[row] op value */
+template<Compare op, typename T>
+struct ValueCompare {
+    static constexpr unsigned cost = 2 * sizeof(T);
+
+    const T *column;
+    T value;
+    const zone_t *zones = nullptr;
+
+    [[nodiscard]] ZoneMatch zone(uint64_t zone) const {
+        return zones == nullptr ? ZoneMatch::SOME : zone_compare<op>(zones[zone], value);
+    }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const { return compare<op>(column[row], value); }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        return Lanes8<T>::template compare<op>(Lanes8<T>::load(column + row), Lanes8<T>::broadcast(value));
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        const auto values = Lanes512<T>::broadcast(value);
+        return combine_registers<T>(live, [&](unsigned offset) {
+            return Lanes512<T>::template compare<op>(Lanes512<T>::load(column + row + offset), values);
+        });
+    }
+};
+
+/** left[row] op right[row] */
+template<Compare op, typename T>
+struct ColumnCompare {
+    static constexpr unsigned cost = 3 * sizeof(T);
+
+    const T *left;
+    const T *right;
+
+    [[nodiscard]] ZoneMatch zone(uint64_t) const { return ZoneMatch::SOME; }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const { return compare<op>(left[row], right[row]); }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        return Lanes8<T>::template compare<op>(Lanes8<T>::load(left + row), Lanes8<T>::load(right + row));
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        return combine_registers<T>(live, [&](unsigned offset) {
+            return Lanes512<T>::template compare<op>(Lanes512<T>::load(left + row + offset),
+                                                     Lanes512<T>::load(right + row + offset));
+        });
+    }
+};
+
+/** low <= column[row] <= high */
+template<typename T>
+struct Between {
+    static constexpr unsigned cost = 3 * sizeof(T);
+
+    const T *column;
+    T low;
+    T high;
+    const zone_t *zones = nullptr;
+
+    [[nodiscard]] ZoneMatch zone(uint64_t zone) const {
+        if (zones == nullptr) {
+            return ZoneMatch::SOME;
+        }
+        const ZoneMatch above_low = zone_compare<Compare::GE>(zones[zone], low);
+        const ZoneMatch below_high = zone_compare<Compare::LE>(zones[zone], high);
+        return std::min(above_low, below_high);
+    }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const {
+        return (column[row] >= low) & (column[row] <= high);
+    }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        const auto values = Lanes8<T>::load(column + row);
+        return Lanes8<T>::template compare<Compare::GE>(values, Lanes8<T>::broadcast(low)) &
+               Lanes8<T>::template compare<Compare::LE>(values, Lanes8<T>::broadcast(high));
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        const auto lows = Lanes512<T>::broadcast(low);
+        const auto highs = Lanes512<T>::broadcast(high);
+        return combine_registers<T>(live, [&](unsigned offset) {
+            const auto values = Lanes512<T>::load(column + row + offset);
+            return Lanes512<T>::template compare<Compare::GE>(values, lows) &
+                   Lanes512<T>::template compare<Compare::LE>(values, highs);
+        });
+    }
+};
+
+/** column[row] is one of N values */
+template<typename T, size_t N>
+struct OneOf {
+    static constexpr unsigned cost = (1 + N) * sizeof(T);
+
+    const T *column;
+    std::array<T, N> values;
+
+    [[nodiscard]] ZoneMatch zone(uint64_t) const { return ZoneMatch::SOME; }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const {
+        bool match = false;
+        for (const T value : values) {
+            match |= column[row] == value;
+        }
+        return match;
+    }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        const auto loaded = Lanes8<T>::load(column + row);
+        __mmask8 mask = 0;
+        for (const T value : values) {
+            mask |= Lanes8<T>::template compare<Compare::EQ>(loaded, Lanes8<T>::broadcast(value));
+        }
+        return mask;
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        return combine_registers<T>(live, [&](unsigned offset) {
+            const auto loaded = Lanes512<T>::load(column + row + offset);
+            uint64_t mask = 0;
+            for (const T value : values) {
+                mask |= Lanes512<T>::template compare<Compare::EQ>(loaded, Lanes512<T>::broadcast(value));
+            }
+            return mask;
+        });
+    }
+};
+
+/**
+ * column[row] is one of a set of codes of a dictionary-encoded column, built by code_set(). The codes are stored as
+ * bits relative to the smallest one, so a row is looked up with a subtraction, a range check and a bit test. A set of
+ * consecutive codes, e.g. of a prefix LIKE on a sorted dictionary, needs only the range check. Otherwise the 8-bit
+ * codes select their bits from up to four 64-bit words with bitshuffle, the 16-bit codes with a permute of the 16-bit
+ * words of the first 512 bits or with gathers of the 32-bit words.
+ */
+template<typename T>
+struct CodeSet {
+    static_assert(std::is_unsigned_v<T> && sizeof(T) <= 2, "codes are 8 or 16 bits");
+    static constexpr unsigned cost = 4 * sizeof(T);
+    static constexpr unsigned num_codes = 1u << (8 * sizeof(T));
+
+    const T *column;
+    T low = 0;                // smallest code of the set
+    T span = 0;               // largest code - low
+    bool empty = true;
+    bool consecutive = false; // all codes from low to low + span are in the set
+    std::array<uint64_t, num_codes / 64> bits{}; // bit code - low
+
+    [[nodiscard]] ZoneMatch zone(uint64_t) const { return empty ? ZoneMatch::NONE : ZoneMatch::SOME; }
+
+    [[gnu::always_inline, nodiscard]] bool contains(T code) const {
+        const auto relative = static_cast<T>(code - low);
+        return relative <= span && ((bits[relative / 64] >> (relative % 64)) & 1);
+    }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const { return contains(column[row]); }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        return static_cast<__mmask8>(lookup(_mm512_zextsi128_si512(Lanes8<T>::load(column + row))));
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        return combine_registers<T>(live, [&](unsigned offset) {
+            return lookup(Lanes512<T>::load(column + row + offset));
+        });
+    }
+
+private:
+    /** Mask of the codes of a register in the set */
+    [[gnu::always_inline, nodiscard]] uint64_t lookup(__m512i codes) const {
+        if constexpr (sizeof(T) == 1) {
+            const __m512i relative = _mm512_sub_epi8(codes, _mm512_set1_epi8(static_cast<char>(low)));
+            const uint64_t in_range = _mm512_cmple_epu8_mask(relative, _mm512_set1_epi8(static_cast<char>(span)));
+            if (consecutive || in_range == 0) {
+                return in_range;
+            }
+            if (span < 64) {
+                return _mm512_mask_bitshuffle_epi64_mask(in_range, _mm512_set1_epi64(bits[0]), relative);
+            }
+            // word of every code, the bits above 6 of each byte
+            const __m512i words = _mm512_and_si512(_mm512_srli_epi16(relative, 6), _mm512_set1_epi8(3));
+            uint64_t mask = 0;
+            for (unsigned word = 0; word <= span / 64u; ++word) {
+                const uint64_t in_word = _mm512_mask_cmpeq_epi8_mask(in_range, words,
+                                                                     _mm512_set1_epi8(static_cast<char>(word)));
+                mask |= _mm512_mask_bitshuffle_epi64_mask(in_word, _mm512_set1_epi64(bits[word]), relative);
+            }
+            return mask;
+        } else {
+            const __m512i relative = _mm512_sub_epi16(codes, _mm512_set1_epi16(static_cast<short>(low)));
+            const uint32_t in_range = _mm512_cmple_epu16_mask(relative, _mm512_set1_epi16(static_cast<short>(span)));
+            if (consecutive || in_range == 0) {
+                return in_range;
+            }
+            if (span < 512) {
+                const __m512i words = _mm512_permutexvar_epi16(_mm512_srli_epi16(relative, 4),
+                                                               _mm512_loadu_si512(bits.data()));
+                const __m512i shifted = _mm512_srlv_epi16(words, _mm512_and_si512(relative, _mm512_set1_epi16(15)));
+                return _mm512_mask_test_epi16_mask(in_range, shifted, _mm512_set1_epi16(1));
+            }
+            uint64_t mask = 0;
+            for (unsigned half = 0; half < 2; ++half) {
+                const __m512i wide = _mm512_cvtepu16_epi32(half == 0 ? _mm512_castsi512_si256(relative)
+                                                                     : _mm512_extracti64x4_epi64(relative, 1));
+                const auto in_half = static_cast<__mmask16>(in_range >> (16 * half));
+                const __m512i words = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), in_half,
+                                                                  _mm512_srli_epi32(wide, 5), bits.data(), 4);
+                const __m512i shifted = _mm512_srlv_epi32(words, _mm512_and_si512(wide, _mm512_set1_epi32(31)));
+                mask |= uint64_t{_mm512_mask_test_epi32_mask(in_half, shifted, _mm512_set1_epi32(1))} << (16 * half);
+            }
+            return mask;
+        }
+    }
+};
+
+/** Conjunction. The vectorized versions skip the right predicate for rows the left one already rejected. */
+template<typename Left, typename Right>
+struct And {
+    static constexpr unsigned cost = Left::cost + Right::cost;
+
+    And(Left left, Right right) : left(left), right(right) {}
+
+    [[nodiscard]] ZoneMatch zone(uint64_t zone) const { return std::min(left.zone(zone), right.zone(zone)); }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const { return left(row) & right(row); }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        const __mmask8 mask = left.mask8(row);
+        return mask ? static_cast<__mmask8>(mask & right.mask8(row)) : mask;
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        const uint64_t mask = left.mask64(row, live);
+        return mask ? right.mask64(row, mask) : mask;
+    }
+
+    Left left;
+    Right right;
+};
+
+/** Disjunction. The vectorized version of 64 rows only evaluates the right predicate for rows the left one rejected. */
+template<typename Left, typename Right>
+struct Or {
+    static constexpr unsigned cost = Left::cost + Right::cost;
+
+    Or(Left left, Right right) : left(left), right(right) {}
+
+    [[nodiscard]] ZoneMatch zone(uint64_t zone) const { return std::max(left.zone(zone), right.zone(zone)); }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const { return left(row) | right(row); }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        return left.mask8(row) | right.mask8(row);
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        const uint64_t mask = left.mask64(row, live);
+        const uint64_t rejected = live & ~mask;
+        return rejected ? mask | right.mask64(row, rejected) : mask;
+    }
+
+    Left left;
+    Right right;
+};
+
+/** True if row is set in a delete bitmap of the refresh functions, which may be nullptr */
+[[gnu::always_inline, nodiscard]] inline bool
+row_deleted(const uint64_t *deleted, uint64_t row) {
+    return deleted != nullptr && ((deleted[row / 64] >> (row % 64)) & 1);
+}
+
+/**
+ * Rows that the refresh function RF2 did not delete, see tpch_refresh.hpp. Without a delete bitmap, or in a zone
+ * without deleted rows, all rows match, so the conjunction with this predicate costs nothing on tables without
+ * deletes. The bitmap has a word beyond the last row, so 64 rows can be read from any row with two loads.
+ */
+struct NotDeleted {
+    static constexpr unsigned cost = 1;
+
+    const uint64_t *deleted;
+    const uint32_t *zone_deletes;
+
+    [[nodiscard]] ZoneMatch zone(uint64_t zone) const {
+        return deleted == nullptr || zone_deletes[zone] == 0 ? ZoneMatch::ALL : ZoneMatch::SOME;
+    }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const { return !row_deleted(deleted, row); }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        return static_cast<__mmask8>(~bits(row));
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const { return live & ~bits(row); }
+
+private:
+    /** Bits of the 64 rows from row on */
+    [[gnu::always_inline, nodiscard]] uint64_t bits(uint64_t row) const {
+        if (deleted == nullptr) {
+            return 0;
+        }
+        const uint64_t word = row / 64;
+        const unsigned shift = row % 64;
+        return shift == 0 ? deleted[word] : deleted[word] >> shift | deleted[word + 1] << (64 - shift);
+    }
+};
+
+/** Rows of lineitem not deleted by RF2 */
+[[nodiscard]] inline NotDeleted
+not_deleted(const LineItemTable &l) {
+    return {l.l_deleted, l.l_deleted_zones};
+}
+
+/** Rows of orders not deleted by RF2 */
+[[nodiscard]] inline NotDeleted
+not_deleted(const OrdersTable &o) {
+    return {o.o_deleted, o.o_deleted_zones};
+}
+
+/** Steps of 64 rows between two samples of an Adaptive predicate */
+constexpr uint32_t ADAPTIVE_SAMPLE_STEPS = 32;
+
+/** Samples of an Adaptive predicate between two reorderings, together one morsel of 64K rows */
+constexpr uint32_t ADAPTIVE_REORDER_SAMPLES = 32;
+
+enum class Junction { ALL, ANY };
+
+/**
+ * Conjunction (ALL) or disjunction (ANY) of predicates that orders its operands at runtime. A row is decided by an
+ * operand that rejects it in a conjunction or accepts it in a disjunction, later operands only evaluate the registers
+ * with undecided rows. Operands are evaluated in descending order of decided rows per cost.
+ *
+ * Every ADAPTIVE_SAMPLE_STEPS steps of 64 rows, all operands evaluate all live rows to sample their selectivity
+ * independently of the current order. Every ADAPTIVE_REORDER_SAMPLES samples, the operands are reordered and the
+ * counts are halved, so the order follows the data when its distribution changes across the table.
+ *
+ * The statistics are not synchronized, every thread needs its own copy of the predicate. The filter kernels and the
+ * operator pipelines copy their predicates per thread, the alignment keeps the copies on separate cache lines.
+ */
+template<Junction junction, typename... Predicates>
+class alignas(64) Adaptive {
+public:
+    static constexpr unsigned cost = (Predicates::cost + ...);
+
+    explicit Adaptive(Predicates... predicates) : predicates(predicates...) {
+        for (size_t i = 0; i < N; ++i) {
+            order[i] = static_cast<uint8_t>(i);
+        }
+    }
+
+    [[gnu::always_inline, nodiscard]] bool operator()(uint64_t row) const {
+        for (const uint8_t operand : order) {
+            if (visit(operand, [row](const auto &predicate) { return predicate(row); }) == (junction == Junction::ANY)) {
+                return junction == Junction::ANY;
+            }
+        }
+        return junction == Junction::ALL;
+    }
+
+    [[gnu::always_inline, nodiscard]] __mmask8 mask8(uint64_t row) const {
+        __mmask8 decided = 0;
+        __mmask8 undecided = 0xff;
+        for (const uint8_t operand : order) {
+            const __mmask8 mask = visit(operand, [row](const auto &predicate) { return predicate.mask8(row); });
+            decided |= junction == Junction::ALL ? static_cast<__mmask8>(undecided & ~mask) : mask & undecided;
+            undecided &= ~decided;
+            if (undecided == 0) {
+                break;
+            }
+        }
+        return junction == Junction::ALL ? undecided : decided;
+    }
+
+    [[nodiscard]] ZoneMatch zone(uint64_t zone) const {
+        return std::apply([zone](const auto &...predicate) {
+            return junction == Junction::ALL ? std::min({predicate.zone(zone)...})
+                                             : std::max({predicate.zone(zone)...});
+        }, predicates);
+    }
+
+    [[gnu::always_inline, nodiscard]] uint64_t mask64(uint64_t row, uint64_t live) const {
+        if (++steps == ADAPTIVE_SAMPLE_STEPS) {
+            return sample(row, live);
+        }
+        uint64_t undecided = live;
+        uint64_t accepted = 0;
+        for (const uint8_t operand : order) {
+            const uint64_t mask = visit(operand, [=](const auto &predicate) { return predicate.mask64(row, undecided); });
+            if constexpr (junction == Junction::ALL) {
+                undecided = mask;
+            } else {
+                accepted |= mask;
+                undecided &= ~mask;
+            }
+            if (undecided == 0) {
+                break;
+            }
+        }
+        return junction == Junction::ALL ? undecided : accepted;
+    }
+
+private:
+    static constexpr size_t N = sizeof...(Predicates);
+    static constexpr std::array<unsigned, N> costs{Predicates::cost...};
+
+    /** Calls function with the operand at index */
+    template<typename Function>
+    [[gnu::always_inline]] auto visit(size_t index, const Function &function) const {
+        return visit(index, function, std::index_sequence_for<Predicates...>{});
+    }
+
+    template<typename Function, size_t... I>
+    [[gnu::always_inline]] auto visit(size_t index, const Function &function, std::index_sequence<I...>) const {
+        decltype(function(std::get<0>(predicates))) result{};
+        static_cast<void>(((index == I && (result = function(std::get<I>(predicates)), true)) || ...));
+        return result;
+    }
+
+    [[nodiscard]] uint64_t sample(uint64_t row, uint64_t live) const {
+        steps = 0;
+        uint64_t all = live;
+        uint64_t any = 0;
+        for (size_t operand = 0; operand < N; ++operand) {
+            const uint64_t mask = visit(operand, [=](const auto &predicate) { return predicate.mask64(row, live); });
+            accepted_rows[operand] += __builtin_popcountll(mask);
+            all &= mask;
+            any |= mask;
+        }
+        sampled_rows += __builtin_popcountll(live);
+        if (++samples == ADAPTIVE_REORDER_SAMPLES) {
+            reorder();
+        }
+        return junction == Junction::ALL ? all : any;
+    }
+
+    void reorder() const {
+        std::array<uint64_t, N> decided_rows{};
+        for (size_t operand = 0; operand < N; ++operand) {
+            decided_rows[operand] = junction == Junction::ALL ? sampled_rows - accepted_rows[operand]
+                                                              : accepted_rows[operand];
+            accepted_rows[operand] /= 2;
+        }
+        // decided_rows[a] / costs[a] > decided_rows[b] / costs[b] without a division
+        std::stable_sort(order.begin(), order.end(), [&](uint8_t a, uint8_t b) {
+            return decided_rows[a] * costs[b] > decided_rows[b] * costs[a];
+        });
+        sampled_rows /= 2;
+        samples = 0;
+    }
+
+    std::tuple<Predicates...> predicates;
+    mutable std::array<uint8_t, N> order{};
+    mutable std::array<uint64_t, N> accepted_rows{};
+    mutable uint64_t sampled_rows = 0;
+    mutable uint32_t steps = 0;
+    mutable uint32_t samples = 0;
+};
+
+/* Expressions building the predicates above */
+
+/** A column in a predicate expression, see col() */
+template<typename T>
+struct Column {
+    const T *values;
+    const zone_t *zones = nullptr;
+};
+
+/** Wraps a column of a base table for use in a predicate expression */
+template<typename T>
+[[nodiscard]] Column<T>
+col(const T *values) {
+    return {values};
+}
+
+/** Wraps a date column with its zone map, which may be nullptr, for comparisons with constants that skip zones */
+[[nodiscard]] inline Column<uint64_t>
+col(const uint64_t *values, const zone_t *zones) {
+    return {values, zones};
+}
+
+/** Wraps a date column in days with its zone map, its values fill 32 lanes of a vector instead of 8 */
+[[nodiscard]] inline Column<uint16_t>
+col(const uint16_t *values, const zone_t *zones) {
+    return {values, zones};
+}
+
+/** Day number of a date in seconds, to compare the narrow date columns with the TIMESTAMP_* constants */
+[[nodiscard]] constexpr uint16_t
+to_days(uint64_t seconds) {
+    return static_cast<uint16_t>(seconds / SECONDS_PER_DAY);
+}
+
+/** Keeps constants from taking part in the deduction of the column type, so col(uint8_t *) == 1 compares uint8_t */
+template<typename T>
+struct NonDeduced {
+    using type = T;
+};
+
+template<typename T>
+using non_deduced_t = typename NonDeduced<T>::type;
+
+#define COLUMN_COMPARE_OPERATOR(symbol, op)                                                                           \
+    template<typename T>                                                                                              \
+    [[nodiscard]] ValueCompare<op, T> operator symbol(Column<T> column, non_deduced_t<T> value) {                     \
+        return {column.values, value, column.zones};                                                                  \
+    }                                                                                                                 \
+    template<typename T>                                                                                              \
+    [[nodiscard]] ColumnCompare<op, T> operator symbol(Column<T> left, Column<T> right) {                             \
+        return {left.values, right.values};                                                                           \
+    }
+
+COLUMN_COMPARE_OPERATOR(==, Compare::EQ)
+COLUMN_COMPARE_OPERATOR(!=, Compare::NE)
+COLUMN_COMPARE_OPERATOR(<, Compare::LT)
+COLUMN_COMPARE_OPERATOR(<=, Compare::LE)
+COLUMN_COMPARE_OPERATOR(>, Compare::GT)
+COLUMN_COMPARE_OPERATOR(>=, Compare::GE)
+
+#undef COLUMN_COMPARE_OPERATOR
+
+/** low <= column <= high */
+template<typename T>
+[[nodiscard]] Between<T>
+between(Column<T> column, non_deduced_t<T> low, non_deduced_t<T> high) {
+    return {column.values, low, high, column.zones};
+}
+
+/** column is one of the values of a braced list, e.g. in(col(p->p_size), {49, 14, 23}) */
+template<typename T, size_t N>
+[[nodiscard]] OneOf<T, N>
+in(Column<T> column, const non_deduced_t<T> (&values)[N]) {
+    OneOf<T, N> predicate{column.values, {}};
+    std::copy_n(values, N, predicate.values.begin());
+    return predicate;
+}
+
+/** A dictionary-encoded string column in a predicate expression, see col() */
+template<typename T>
+struct DictionaryColumn {
+    const T *codes;
+    const dictionary_t *dictionary;
+};
+
+/** Wraps a string column with the dictionary of its 8-bit codes */
+[[nodiscard]] inline DictionaryColumn<uint8_t>
+col(const uint8_t *codes, const dictionary_t &dictionary) {
+    return {codes, &dictionary};
+}
+
+/** Wraps a string column with the dictionary of its 16-bit codes */
+[[nodiscard]] inline DictionaryColumn<uint16_t>
+col(const uint16_t *codes, const dictionary_t &dictionary) {
+    return {codes, &dictionary};
+}
+
+/** Codes of the values of the dictionary of column for which match(value) is true */
+template<typename T, typename Match>
+[[nodiscard]] CodeSet<T>
+code_set(DictionaryColumn<T> column, const Match &match) {
+    CodeSet<T> set{column.codes};
+    const dictionary_t &dictionary = *column.dictionary;
+    const uint32_t num_values = std::min(dictionary.num_values, CodeSet<T>::num_codes);
+    uint32_t low = num_values;
+    uint32_t high = 0;
+    uint32_t count = 0;
+    for (uint32_t code = 0; code < num_values; ++code) {
+        if (match(dictionary_value(dictionary, code))) {
+            low = std::min(low, code);
+            high = code;
+            set.bits[code / 64] |= uint64_t{1} << (code % 64);
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return set;
+    }
+    // shift the bits down by low
+    const uint32_t words = low / 64;
+    const uint32_t shift = low % 64;
+    for (uint32_t word = 0; word < set.bits.size(); ++word) {
+        const uint64_t current = word + words < set.bits.size() ? set.bits[word + words] : 0;
+        const uint64_t next = word + words + 1 < set.bits.size() ? set.bits[word + words + 1] : 0;
+        set.bits[word] = shift == 0 ? current : current >> shift | next << (64 - shift);
+    }
+    set.low = static_cast<T>(low);
+    set.span = static_cast<T>(high - low);
+    set.empty = false;
+    set.consecutive = count == high - low + 1;
+    return set;
+}
+
+/** column = 'value' */
+template<typename T>
+[[nodiscard]] CodeSet<T>
+operator==(DictionaryColumn<T> column, const char *value) {
+    const std::string_view expected = value;
+    return code_set(column, [&](std::string_view candidate) { return candidate == expected; });
+}
+
+/** column IN ('value', ...), e.g. in(col(l->l_shipmode, l->l_shipmode_dict), {"MAIL", "SHIP"}) */
+template<typename T, size_t N>
+[[nodiscard]] CodeSet<T>
+in(DictionaryColumn<T> column, const char *const (&values)[N]) {
+    return code_set(column, [&](std::string_view candidate) {
+        return std::any_of(values, values + N, [&](const char *value) { return candidate == value; });
+    });
+}
+
+/** column LIKE pattern, see like_match() */
+template<typename T>
+[[nodiscard]] CodeSet<T>
+like(DictionaryColumn<T> column, const char *pattern) {
+    const std::string_view expected = pattern;
+    return code_set(column, [&](std::string_view candidate) { return like_match(candidate, expected); });
+}
+
+template<typename P, typename = void>
+struct IsPredicate : std::false_type {};
+
+template<typename P>
+struct IsPredicate<P, std::void_t<decltype(std::declval<const P &>().mask64(0, 0)),
+                                  decltype(std::declval<const P &>().zone(0))>> : std::true_type {};
+
+template<typename P>
+constexpr bool is_predicate_v = IsPredicate<P>::value;
+
+/** Conjunction of predicates, evaluated in the order that rejects the most rows per cost first */
+template<typename... Predicates>
+[[nodiscard]] Adaptive<Junction::ALL, Predicates...>
+all_of(Predicates... predicates) {
+    static_assert((is_predicate_v<Predicates> && ...), "all_of() combines predicates");
+    return Adaptive<Junction::ALL, Predicates...>(predicates...);
+}
+
+/** Disjunction of predicates, evaluated in the order that accepts the most rows per cost first */
+template<typename... Predicates>
+[[nodiscard]] Adaptive<Junction::ANY, Predicates...>
+any_of(Predicates... predicates) {
+    static_assert((is_predicate_v<Predicates> && ...), "any_of() combines predicates");
+    return Adaptive<Junction::ANY, Predicates...>(predicates...);
+}
+
+/** Rows of [begin, end) that can satisfy predicate according to the zone maps of its columns */
+template<typename Predicate>
+[[nodiscard]] ZoneMatch
+zone_match(const Predicate &predicate, uint64_t begin, uint64_t end) {
+    const uint64_t zone = begin / ZONE_ROWS;
+    return zone == (end - 1) / ZONE_ROWS ? predicate.zone(zone) : ZoneMatch::SOME;
+}
+
+/** Conjunctions are evaluated from left to right, so the most selective predicate on the narrowest column goes first */
+template<typename Left, typename Right, typename = std::enable_if_t<is_predicate_v<Left> && is_predicate_v<Right>>>
+[[nodiscard]] And<Left, Right>
+operator&&(Left left, Right right) {
+    return {left, right};
+}
+
+template<typename Left, typename Right, typename = std::enable_if_t<is_predicate_v<Left> && is_predicate_v<Right>>>
+[[nodiscard]] Or<Left, Right>
+operator||(Left left, Right right) {
+    return {left, right};
+}
+
+#endif//SGXV2_JOIN_BENCHMARKS_PREDICATES_HPP
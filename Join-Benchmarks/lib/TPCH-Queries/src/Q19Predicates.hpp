@@ -2,6 +2,7 @@
 #define Q19PREDICATES_HPP
 
 #include <pthread.h>
+#include "Predicates.hpp"
 #include "TpcHTypes.hpp"
 #include "data-types.h"
 #include "Logger.hpp"
@@ -24,11 +25,70 @@
 #include <atomic>
 #include <array>
 
+/** p_brand of the three branches of Q19 */
+constexpr const char *Q19_BRANDS[3] = {"Brand#12", "Brand#23", "Brand#34"};
+
+/** p_container of the three branches of Q19 */
+constexpr const char *Q19_CONTAINERS[3][4] = {{"SM CASE", "SM BOX", "SM PACK", "SM PKG"},
+                                              {"MED BAG", "MED BOX", "MED PKG", "MED PACK"},
+                                              {"LG CASE", "LG BOX", "LG PACK", "LG PKG"}};
+
+/** l_shipmode in ('AIR', 'AIR REG') */
+[[nodiscard]] inline CodeSet<uint8_t>
+q19_shipmodes(const LineItemTable &l) {
+    return in(col(l.l_shipmode, l.l_shipmode_dict), {"AIR", "AIR REG"});
+}
+
+/** l_shipinstruct = 'DELIVER IN PERSON' */
+[[nodiscard]] inline CodeSet<uint8_t>
+q19_shipinstruct(const LineItemTable &l) {
+    return col(l.l_shipinstruct, l.l_shipinstruct_dict) == "DELIVER IN PERSON";
+}
+
+/** p_brand of any of the three branches */
+[[nodiscard]] inline CodeSet<uint8_t>
+q19_brands(const PartTable &p) {
+    return in(col(p.p_brand, p.p_brand_dict), Q19_BRANDS);
+}
+
+/** p_container of any of the three branches */
+[[nodiscard]] inline CodeSet<uint8_t>
+q19_containers(const PartTable &p) {
+    return code_set(col(p.p_container, p.p_container_dict), [](std::string_view container) {
+        return std::any_of(std::begin(Q19_CONTAINERS), std::end(Q19_CONTAINERS), [&](const auto &branch) {
+            return std::find(std::begin(branch), std::end(branch), container) != std::end(branch);
+        });
+    });
+}
+
+/** Codes of the string constants of Q19, evaluated once per query on the dictionaries of the tables */
+struct Q19Codes {
+    CodeSet<uint8_t> brands[3];     // p_brand of each branch
+    CodeSet<uint8_t> containers[3]; // p_container of each branch
+    CodeSet<uint8_t> any_brand;
+    CodeSet<uint8_t> any_container;
+    CodeSet<uint8_t> shipmodes;
+    CodeSet<uint8_t> shipinstruct;
+};
+
+[[nodiscard]] inline Q19Codes
+q19_codes(const LineItemTable &l, const PartTable &p) {
+    Q19Codes codes{};
+    for (int branch = 0; branch < 3; ++branch) {
+        codes.brands[branch] = col(p.p_brand, p.p_brand_dict) == Q19_BRANDS[branch];
+        codes.containers[branch] = in(col(p.p_container, p.p_container_dict), Q19_CONTAINERS[branch]);
+    }
+    codes.any_brand = q19_brands(p);
+    codes.any_container = q19_containers(p);
+    codes.shipmodes = q19_shipmodes(l);
+    codes.shipinstruct = q19_shipinstruct(l);
+    return codes;
+}
+
 [[gnu::always_inline, nodiscard]] inline bool
-q19LineItemPredicate(const LineItemTable &l, uint64_t rowID) {
-    return (l.l_quantity[rowID] >= 1 && l.l_quantity[rowID] <= (20 + 10)) &&
-           (l.l_shipmode[rowID] == L_SHIPMODE_AIR || l.l_shipmode[rowID] == L_SHIPMODE_AIR_REG) &&
-           (l.l_shipinstruct[rowID] == L_SHIPINSTRUCT_DELIVER_IN_PERSON);
+q19LineItemPredicate(const LineItemTable &l, uint64_t rowID, const Q19Codes &codes) {
+    return (l.l_quantity[rowID] >= 1 && l.l_quantity[rowID] <= (20 + 10)) && codes.shipmodes(rowID) &&
+           codes.shipinstruct(rowID) && !row_deleted(l.l_deleted, rowID);
 }
 
 [[gnu::always_inline]] inline void
@@ -38,15 +98,8 @@ q19LineItemCopy(const LineItemTable &l, table_t &out, uint64_t from_index, uint6
 }
 
 [[gnu::always_inline, nodiscard]] inline bool
-q19PartPredicate(const PartTable &p, uint64_t rowID) {
-    return (p.p_brand[rowID] == P_BRAND_12 || p.p_brand[rowID] == P_BRAND_23 || p.p_brand[rowID] == P_BRAND_34) &&
-           (p.p_container[rowID] == P_CONTAINER_SM_CASE || p.p_container[rowID] == P_CONTAINER_SM_BOX ||
-            p.p_container[rowID] == P_CONTAINER_SM_PACK || p.p_container[rowID] == P_CONTAINER_SM_PKG ||
-            p.p_container[rowID] == P_CONTAINER_MED_BAG || p.p_container[rowID] == P_CONTAINER_MED_BOX ||
-            p.p_container[rowID] == P_CONTAINER_MED_PKG || p.p_container[rowID] == P_CONTAINER_MED_PACK ||
-            p.p_container[rowID] == P_CONTAINER_LG_CASE || p.p_container[rowID] == P_CONTAINER_LG_BOX ||
-            p.p_container[rowID] == P_CONTAINER_LG_PACK || p.p_container[rowID] == P_CONTAINER_LG_PKG) &&
-           (p.p_size[rowID] >= 1 && p.p_size[rowID] <= 15);
+q19PartPredicate(const PartTable &p, uint64_t rowID, const Q19Codes &codes) {
+    return codes.any_brand(rowID) && codes.any_container(rowID) && (p.p_size[rowID] >= 1 && p.p_size[rowID] <= 15);
 }
 
 [[gnu::always_inline]] inline void
@@ -55,22 +108,17 @@ q19PartCopy(const PartTable &p, table_t &out, uint64_t from_index, uint64_t to_i
 }
 
 [[gnu::always_inline, nodiscard]] inline bool
-q19FinalPredicate(const PartTable *p, uint64_t rowIdPart, const LineItemTable *l, uint64_t rowIdLineItem) {
-    bool p1 = p->p_brand[rowIdPart] == P_BRAND_12 &&
-              (p->p_container[rowIdPart] == P_CONTAINER_SM_CASE || p->p_container[rowIdPart] == P_CONTAINER_SM_BOX ||
-               p->p_container[rowIdPart] == P_CONTAINER_SM_PACK || p->p_container[rowIdPart] == P_CONTAINER_SM_PKG) &&
+q19FinalPredicate(const PartTable *p, uint64_t rowIdPart, const LineItemTable *l, uint64_t rowIdLineItem,
+                  const Q19Codes &codes) {
+    bool p1 = codes.brands[0](rowIdPart) && codes.containers[0](rowIdPart) &&
               (p->p_size[rowIdPart] >= 1 && p->p_size[rowIdPart] <= 5) &&
               (l->l_quantity[rowIdLineItem] >= 1 && l->l_quantity[rowIdLineItem] <= (1 + 10));
 
-    bool p2 = p->p_brand[rowIdPart] == P_BRAND_23 &&
-              (p->p_container[rowIdPart] == P_CONTAINER_MED_BAG || p->p_container[rowIdPart] == P_CONTAINER_MED_BOX ||
-               p->p_container[rowIdPart] == P_CONTAINER_MED_PKG || p->p_container[rowIdPart] == P_CONTAINER_MED_PACK) &&
+    bool p2 = codes.brands[1](rowIdPart) && codes.containers[1](rowIdPart) &&
               (p->p_size[rowIdPart] >= 1 && p->p_size[rowIdPart] <= 10) &&
               (l->l_quantity[rowIdLineItem] >= 10 && l->l_quantity[rowIdLineItem] <= (10 + 10));
 
-    bool p3 = p->p_brand[rowIdPart] == P_BRAND_34 &&
-              (p->p_container[rowIdPart] == P_CONTAINER_LG_CASE || p->p_container[rowIdPart] == P_CONTAINER_LG_BOX ||
-               p->p_container[rowIdPart] == P_CONTAINER_LG_PACK || p->p_container[rowIdPart] == P_CONTAINER_LG_PKG) &&
+    bool p3 = codes.brands[2](rowIdPart) && codes.containers[2](rowIdPart) &&
               (p->p_size[rowIdPart] >= 1 && p->p_size[rowIdPart] <= 15) &&
               (l->l_quantity[rowIdLineItem] >= 20 && l->l_quantity[rowIdLineItem] <= (20 + 10));
 
@@ -83,6 +131,7 @@ struct Q19ThreadArg {
     const LineItemTable *l;
     const PartTable *p;
     uint64_t nresults;
+    const Q19Codes *codes;
 };
 
 void *
@@ -92,7 +141,7 @@ q19FilterThread(void *param) {
     while (head != nullptr) {
         type_value rowIdPart = head->Rpayload;
         type_value rowIdLineItem = head->Spayload;
-        if (q19FinalPredicate(arg->p, rowIdPart, arg->l, rowIdLineItem)) {
+        if (q19FinalPredicate(arg->p, rowIdPart, arg->l, rowIdLineItem, *arg->codes)) {
             arg->matches++;
         }
         head = head->next;
@@ -101,7 +150,7 @@ q19FilterThread(void *param) {
 }
 
 uint64_t
-q19FilterJoinResults(result_t *jr, const LineItemTable *l, const PartTable *p) {
+q19FilterJoinResults(result_t *jr, const LineItemTable *l, const PartTable *p, const Q19Codes &codes) {
     int nthreads = jr->nthreads;
     pthread_t tid[nthreads];
     auto *args = new Q19ThreadArg[nthreads];
@@ -113,6 +162,7 @@ q19FilterJoinResults(result_t *jr, const LineItemTable *l, const PartTable *p) {
         args[i].nresults = thread_result.nresults;
         args[i].p = p;
         args[i].l = l;
+        args[i].codes = &codes;
         args[i].matches = 0;
         rv = pthread_create(&tid[i], nullptr, q19FilterThread, (void *) &args[i]);
         if (rv) {
@@ -138,6 +188,7 @@ struct Q19ChunkedThreadArg {
     std::atomic<uint64_t> *next_chunk;
     const LineItemTable *l;
     const PartTable *p;
+    const Q19Codes *codes;
 };
 
 void *
@@ -155,7 +206,7 @@ q19FilterChunkedThread(void *args) {
         for (uint64_t tuple_id = 0; tuple_id < chunk->num_tuples; ++tuple_id) {
             auto tuple = chunk->tuples[tuple_id];
             parameters->matches += static_cast<uint8_t>(q19FinalPredicate(parameters->p, tuple.Rpayload, parameters->l,
-                                                                          tuple.Spayload));
+                                                                          tuple.Spayload, *parameters->codes));
         }
         // Atomically get the next chunk id and increment, preventing two threads from getting the same chunk ID.
     } while ((chunk_id = parameters->next_chunk->fetch_add(1)) < parameters->input_table->num_chunks);
@@ -164,7 +215,8 @@ q19FilterChunkedThread(void *args) {
 }
 
 uint64_t
-q19FilterJoinResultsChunked(const result_t *join_result, const LineItemTable *l, const PartTable *p) {
+q19FilterJoinResultsChunked(const result_t *join_result, const LineItemTable *l, const PartTable *p,
+                            const Q19Codes &codes) {
     uint64_t num_threads = join_result->nthreads;
     std::vector<pthread_t> thread_ids(num_threads);
     std::vector<Q19ChunkedThreadArg> args(num_threads);
@@ -172,7 +224,7 @@ q19FilterJoinResultsChunked(const result_t *join_result, const LineItemTable *l,
     std::atomic next_chunk{num_threads};
 
     for (uint64_t thread_id = 0; thread_id < num_threads; ++thread_id) {
-        args[thread_id] = {0, thread_id, (chunked_table_t *) join_result->result, &next_chunk, l, p};
+        args[thread_id] = {0, thread_id, (chunked_table_t *) join_result->result, &next_chunk, l, p, &codes};
         int rv = pthread_create(&thread_ids[thread_id], nullptr, q19FilterChunkedThread, (void *) &args[thread_id]);
         if (rv) {
             logger(ERROR, "return code from pthread_create() is %d\n", rv);
@@ -190,202 +242,93 @@ q19FilterJoinResultsChunked(const result_t *join_result, const LineItemTable *l,
     return totalMatches;
 }
 
-table_t
-q19_lineitem_filter(uint64_t num_tuples, const row_t *orderkey, const type_key *partkey, const float *quantity,
-                    const uint8_t *shipmode, const uint8_t *shipinstruct) {
-    table_t filtered_table{};
-    uint64_t selectionMatches = 0;
-
-    filtered_table.tuples = (tuple_t *) aligned_alloc(64, sizeof(tuple_t) * num_tuples);
-    malloc_check(filtered_table.tuples);
+struct Q19ColumnarThreadArg {
+    uint64_t matches;
+    uint64_t thread_id;
+    const columnar_table_t *input_table;
+    std::atomic<uint64_t> *next_chunk;
+    const LineItemTable *l;
+    const PartTable *p;
+    const Q19Codes *codes;
+};
 
-    // every register contains 64 predicate values
-    auto predicate_vectors_8 = num_tuples / 64;
+void *
+q19FilterColumnarThread(void *args) {
+    auto parameters = static_cast<Q19ColumnarThreadArg *>(args);
 
-    __m512i shipmode_predicate_1 = _mm512_set1_epi8(L_SHIPMODE_AIR);
-    __m512i shipmode_predicate_2 = _mm512_set1_epi8(L_SHIPMODE_AIR_REG);
-    __m512i shipinstruct_predicate = _mm512_set1_epi8(L_SHIPINSTRUCT_DELIVER_IN_PERSON);
-    __m512 l_quantity_predicate_low = _mm512_set1_ps(1);
-    __m512 l_quantity_predicate_high = _mm512_set1_ps(30);
+    uint64_t chunk_id = parameters->thread_id;
+    while (chunk_id < parameters->input_table->num_chunks) {
+        const auto &chunk = parameters->input_table->chunks[chunk_id];
+        for (uint64_t tuple_id = 0; tuple_id < chunk.num_tuples; ++tuple_id) {
+            parameters->matches += static_cast<uint8_t>(q19FinalPredicate(
+                    parameters->p, chunk.Rpayloads[tuple_id], parameters->l, chunk.Spayloads[tuple_id],
+                    *parameters->codes));
+        }
+        chunk_id = parameters->next_chunk->fetch_add(1);
+    }
 
-    auto shipmode_array_vec = reinterpret_cast<const __m512i *>(shipmode);
-    auto shipinstruct_array_vec = reinterpret_cast<const __m512i *>(shipinstruct);
-    auto quantity_array_vec = reinterpret_cast<const __m512 *>(quantity);
+    return nullptr;
+}
 
-    for (uint64_t predicate_vector_i = 0; predicate_vector_i < predicate_vectors_8; ++predicate_vector_i) {
-        __m512i shipmode_vec = _mm512_stream_load_si512((void *) (shipmode_array_vec + predicate_vector_i));
-        __m512i shipinstruct_vec = _mm512_stream_load_si512((void *) (shipinstruct_array_vec + predicate_vector_i));
+/**
+ * Applies the final Q19 predicate to a columnar join result. The join must have projected COLUMN_RPAYLOAD and
+ * COLUMN_SPAYLOAD.
+ */
+uint64_t
+q19FilterJoinResultsColumnar(const result_t *join_result, const LineItemTable *l, const PartTable *p,
+                             const Q19Codes &codes) {
+    uint64_t num_threads = join_result->nthreads;
+    std::vector<pthread_t> thread_ids(num_threads);
+    std::vector<Q19ColumnarThreadArg> args(num_threads);
 
-        __mmask64 mask = _mm512_cmpeq_epu8_mask(shipmode_vec, shipmode_predicate_1);
-        mask = mask | _mm512_cmpeq_epu8_mask(shipmode_vec, shipmode_predicate_2);
-        mask = mask & _mm512_cmpeq_epu8_mask(shipinstruct_vec, shipinstruct_predicate);
+    std::atomic next_chunk{num_threads};
 
-        if (mask == 0) {
-            continue;
-        }
-        // Iteration for 4 bytes floats
-        auto pos_32 = predicate_vector_i * 4;
-        for (int k = 0; k < 4; ++k) {
-            __mmask16 part_mask_shipmode_instruct = (mask >> k * 16) & 0xffff;
-
-            if (part_mask_shipmode_instruct == 0) {
-                continue;
-            }
-
-            __m512 quantity_vec = _mm512_load_ps((void *) (quantity_array_vec + pos_32 + k));
-            __mmask16 quantity_mask = _mm512_cmpnlt_ps_mask(quantity_vec, l_quantity_predicate_low);
-            quantity_mask = quantity_mask & _mm512_cmple_ps_mask(quantity_vec, l_quantity_predicate_high);
-
-            __mmask16 mask_all = part_mask_shipmode_instruct & quantity_mask;
-
-            if (mask_all == 0) {
-                continue;
-            }
-
-            // I cannot be bothered to build table rows with SIMD right now.
-            // Although it would work by interleaved merging of two 256 bit vectors. It is unclear if the unaligned
-            // compress store used above even is better.
-            auto pos_64 = (predicate_vector_i * 64 + k * 16);
-            for (uint64_t bit = 0; bit < 16; ++bit, mask_all >>= 1) {
-                if (mask_all & 1) {
-                    filtered_table.tuples[selectionMatches] = {partkey[pos_64 + bit], orderkey[pos_64 + bit].payload};
-                    selectionMatches++;
-                }
-            }
+    for (uint64_t thread_id = 0; thread_id < num_threads; ++thread_id) {
+        args[thread_id] = {0, thread_id, (columnar_table_t *) join_result->result, &next_chunk, l, p, &codes};
+        int rv = pthread_create(&thread_ids[thread_id], nullptr, q19FilterColumnarThread, (void *) &args[thread_id]);
+        if (rv) {
+            logger(ERROR, "return code from pthread_create() is %d\n", rv);
         }
     }
 
-    // iterate over the remaining values from the last multiple of 64
-    auto rest_start = num_tuples & ~(64 - 1);
-    for (uint64_t i = rest_start; i < num_tuples; i++) {
-        if ((quantity[i] >= 1 && quantity[i] <= (20 + 10)) &&
-            (shipmode[i] == L_SHIPMODE_AIR || shipmode[i] == L_SHIPMODE_AIR_REG) &&
-            (shipinstruct[i] == L_SHIPINSTRUCT_DELIVER_IN_PERSON)) {
-            filtered_table.tuples[selectionMatches++] = {partkey[i], orderkey[i].payload};
-        }
+    for (auto thread_id: thread_ids) {
+        pthread_join(thread_id, nullptr);
     }
 
-    filtered_table.num_tuples = selectionMatches;
-    return filtered_table;
+    uint64_t totalMatches = 0;
+    for (const auto &arg: args) {
+        totalMatches += arg.matches;
+    }
+    return totalMatches;
 }
 
-table_t
-q19_part_filter(uint64_t num_tuples, const row_t *partkey, const uint32_t *size, const uint8_t *brand,
-                const uint8_t *container) {
-    table_t filtered_table{};
-    uint64_t selectionMatches = 0;
-
-    filtered_table.tuples = (tuple_t *) aligned_alloc(64, sizeof(tuple_t) * num_tuples);
-    malloc_check(filtered_table.tuples);
-
-    // every register contains 64 predicate values
-    auto predicate_vectors_8 = num_tuples / 64;
-
-    __m512i brand_predicate_1 = _mm512_set1_epi8(P_BRAND_12);
-    __m512i brand_predicate_2 = _mm512_set1_epi8(P_BRAND_23);
-    __m512i brand_predicate_3 = _mm512_set1_epi8(P_BRAND_34);
-    std::array<__m512i, 12> container_predicates{
-            _mm512_set1_epi8(P_CONTAINER_SM_CASE),
-            _mm512_set1_epi8(P_CONTAINER_SM_BOX),
-            _mm512_set1_epi8(P_CONTAINER_SM_PACK),
-            _mm512_set1_epi8(P_CONTAINER_SM_PKG),
-            _mm512_set1_epi8(P_CONTAINER_MED_BAG),
-            _mm512_set1_epi8(P_CONTAINER_MED_BOX),
-            _mm512_set1_epi8(P_CONTAINER_MED_PKG),
-            _mm512_set1_epi8(P_CONTAINER_MED_PACK),
-            _mm512_set1_epi8(P_CONTAINER_LG_CASE),
-            _mm512_set1_epi8(P_CONTAINER_LG_BOX),
-            _mm512_set1_epi8(P_CONTAINER_LG_PACK),
-            _mm512_set1_epi8(P_CONTAINER_LG_PKG),
-    };
-    __m512i size_predicate_low = _mm512_set1_epi32(1);
-    __m512i size_predicate_high = _mm512_set1_epi32(15);
-
-    auto brand_array_vec = reinterpret_cast<const __m512i *>(brand);
-    auto container_array_vec = reinterpret_cast<const __m512i *>(container);
-    auto size_array_vec = reinterpret_cast<const __m512i *>(size);
-    auto input_array_vec = reinterpret_cast<const __m512i *>(partkey);
-    auto output_buffer = filtered_table.tuples;
-
-    for (uint64_t predicate_vector_i = 0; predicate_vector_i < predicate_vectors_8; ++predicate_vector_i) {
-        __m512i brand_vec = _mm512_stream_load_si512((void *) (brand_array_vec + predicate_vector_i));
-        __m512i container_vec = _mm512_stream_load_si512((void *) (container_array_vec + predicate_vector_i));
-
-        __mmask64 mask_brand = _mm512_cmpeq_epu8_mask(brand_vec, brand_predicate_1) |
-                               _mm512_cmpeq_epu8_mask(brand_vec, brand_predicate_2) |
-                               _mm512_cmpeq_epu8_mask(brand_vec, brand_predicate_3);
-        __mmask64 mask_container = 0;
-        for (__m512i &predicate: container_predicates) {
-            mask_container |= _mm512_cmpeq_epu8_mask(container_vec, predicate);
-        }
-
-        __mmask64 mask_64 = mask_brand & mask_container;
-
-        if (mask_64 == 0) {
-            continue;
-        }
-        // Iteration for 4 bytes integers
-        auto pos_32 = predicate_vector_i * 4;
-        for (int k = 0; k < 4; ++k) {
-            __mmask16 part_mask = (mask_64 >> k * 16) & 0xffff;
-
-            if (part_mask == 0) {
-                continue;
-            }
-
-            __m512i size_vec = _mm512_stream_load_si512((void *) (size_array_vec + pos_32 + k));
-            __mmask16 size_mask = _mm512_cmpge_epi32_mask(size_vec, size_predicate_low) &
-                                  _mm512_cmple_epi32_mask(size_vec, size_predicate_high);
-            __mmask16 mask_all = part_mask & size_mask;
-
-            if (mask_all == 0) {
-                continue;
-            }
-
-            /*
-            // split mask into two 8 bit masks to use it for compress store
-            auto pos_64 = pos_32 * 2;
-            for (int j = 0; j < 2; ++j) {
-                __mmask8 mask_8 = (mask_all >> j * 8) & 0xff;
-                if (mask_8 == 0) {
-                    continue;
-                }
-                _mm512_mask_compressstoreu_epi64(reinterpret_cast<void *>(output_buffer + selectionMatches),
-                                                 mask_8,
-                                                 _mm512_stream_load_si512((void *) (input_array_vec + pos_64 + j)));
-                selectionMatches += __builtin_popcount(mask_8);
-            }
-             */
-            // I cannot be bothered to build table rows with SIMD right now.
-            // Although it would work by interleaved merging of two 256 bit vectors. It is unclear if the unaligned
-            // compress store used above even is better.
-            auto pos_64 = (predicate_vector_i * 64 + k * 16);
-            for (uint64_t bit = 0; bit < 16; ++bit, mask_all >>= 1) {
-                if (mask_all & 1) {
-                    filtered_table.tuples[selectionMatches] = partkey[pos_64 + bit];
-                    selectionMatches++;
-                }
-            }
-        }
-    }
+/** Predicate of the SIMD filter kernel, equivalent to q19LineItemPredicate(). The conjuncts are ordered at runtime. */
+[[nodiscard]] inline auto
+q19_lineitem_predicate(const LineItemTable &l) {
+    return all_of(q19_shipmodes(l), q19_shipinstruct(l), between(col(l.l_quantity), 1, 20 + 10)) &&
+           not_deleted(l);
+}
 
-    // iterate over the remaining values from the last multiple of 64
-    auto rest_start = num_tuples & ~(64 - 1);
-    for (uint64_t i = rest_start; i < num_tuples; i++) {
-        if ((brand[i] == P_BRAND_12 || brand[i] == P_BRAND_23 || brand[i] == P_BRAND_34) &&
-            (container[i] == P_CONTAINER_SM_CASE || container[i] == P_CONTAINER_SM_BOX ||
-            container[i] == P_CONTAINER_SM_PACK || container[i] == P_CONTAINER_SM_PKG ||
-            container[i] == P_CONTAINER_MED_BAG || container[i] == P_CONTAINER_MED_BOX ||
-            container[i] == P_CONTAINER_MED_PKG || container[i] == P_CONTAINER_MED_PACK ||
-            container[i] == P_CONTAINER_LG_CASE || container[i] == P_CONTAINER_LG_BOX ||
-            container[i] == P_CONTAINER_LG_PACK || container[i] == P_CONTAINER_LG_PKG) &&
-            (size[i] >= 1 && size[i] <= 15)) {
-            filtered_table.tuples[selectionMatches++] = partkey[i];
-        }
-    }
+/** q19_lineitem_predicate() on the 8-bit quantities, 64 rows per vector instead of 16 */
+[[nodiscard]] inline auto
+q19_lineitem_u8_predicate(const LineItemTable &l) {
+    return all_of(q19_shipmodes(l), q19_shipinstruct(l), between(col(l.l_quantity_u8), 1, 20 + 10)) &&
+           not_deleted(l);
+}
 
-    filtered_table.num_tuples = selectionMatches;
-    return filtered_table;
+/**
+ * Predicate of the SIMD filter kernel. Unlike q19PartPredicate(), it selects the parts of the three branches of
+ * q19FinalPredicate() only, without their l_quantity ranges. Both the branches and their conjuncts are ordered at
+ * runtime.
+ */
+[[nodiscard]] inline auto
+q19_part_predicate(const PartTable &p) {
+    const auto branch = [&p](int branch, uint32_t max_size) {
+        return all_of(col(p.p_brand, p.p_brand_dict) == Q19_BRANDS[branch],
+                      in(col(p.p_container, p.p_container_dict), Q19_CONTAINERS[branch]),
+                      between(col(p.p_size), 1, max_size));
+    };
+    return any_of(branch(0, 5), branch(1, 10), branch(2, 15));
 }
 
 
@@ -0,0 +1,286 @@
+#ifndef Q1PREDICATES_HPP
+#define Q1PREDICATES_HPP
+
+#include "Decimal.hpp"
+#include "Predicates.hpp"
+#include "TpcHTypes.hpp"
+#include "data-types.h"
+#include <algorithm>
+
+#ifdef ENCLAVE
+#include "avx512bwintrin.h"
+#include "avx512dqintrin.h"
+#include "avx512fintrin.h"
+#include "avx512vlbwintrin.h"
+#include "avx512vlintrin.h"
+#include "avxintrin.h"
+#include "emmintrin.h"
+#else
+#include <immintrin.h>
+#endif
+
+/*
+ * Q1 groups lineitem by (l_returnflag, l_linestatus). The groups are the combinations of the three return flags and
+ * the two line states, group f * 2 + s is flag Q1_RETURNFLAGS[f] with state Q1_LINESTATUS[s], which is also the order
+ * of the query result.
+ *
+ * If lineitem has the decimal columns, the groups are summed up exactly from them in Q1DecimalGroup, otherwise from
+ * the float columns in Q1Group.
+ */
+
+constexpr char Q1_RETURNFLAGS[] = {L_RETURNFLAG_A, L_RETURNFLAG_N, L_RETURNFLAG_R};
+constexpr char Q1_LINESTATUS[] = {L_LINESTATUS_F, L_LINESTATUS_O};
+constexpr int Q1_GROUPS = 6;
+
+struct Q1Group {
+    double sum_qty;
+    double sum_base_price;
+    double sum_disc_price;
+    double sum_charge;
+    double sum_disc;
+    uint64_t count;
+
+    Q1Group &
+    operator+=(const Q1Group &other) {
+        sum_qty += other.sum_qty;
+        sum_base_price += other.sum_base_price;
+        sum_disc_price += other.sum_disc_price;
+        sum_charge += other.sum_charge;
+        sum_disc += other.sum_disc;
+        count += other.count;
+        return *this;
+    }
+};
+
+/**
+ * Q1Group of the decimal columns. Quantities, prices and discounts are summed at scale 2, the discounted prices at
+ * scale 4 and the charges at scale 6, all of them exactly.
+ */
+struct Q1DecimalGroup {
+    __int128 sum_qty;
+    __int128 sum_base_price;
+    __int128 sum_disc_price;
+    __int128 sum_charge;
+    __int128 sum_disc;
+    uint64_t count;
+
+    Q1DecimalGroup &
+    operator+=(const Q1DecimalGroup &other) {
+        sum_qty += other.sum_qty;
+        sum_base_price += other.sum_base_price;
+        sum_disc_price += other.sum_disc_price;
+        sum_charge += other.sum_charge;
+        sum_disc += other.sum_disc;
+        count += other.count;
+        return *this;
+    }
+};
+
+/** @return true if l has the decimal columns Q1 reads */
+[[gnu::always_inline]] inline bool
+q1_has_decimals(const LineItemTable &l) {
+    return l.l_quantity_dec != nullptr && l.l_extendedprice_dec != nullptr && l.l_discount_dec != nullptr &&
+           l.l_tax_dec != nullptr;
+}
+
+/** @return group of the row, -1 for flags and states that do not occur in TPC-H */
+[[gnu::always_inline]] inline int
+q1Group(const LineItemTable &l, uint64_t rowID) {
+    int flag;
+    switch (l.l_returnflag[rowID]) {
+        case L_RETURNFLAG_A: flag = 0; break;
+        case L_RETURNFLAG_N: flag = 1; break;
+        case L_RETURNFLAG_R: flag = 2; break;
+        default: return -1;
+    }
+    switch (l.l_linestatus[rowID]) {
+        case L_LINESTATUS_F: return flag * 2;
+        case L_LINESTATUS_O: return flag * 2 + 1;
+        default: return -1;
+    }
+}
+
+/** Adds the rows [begin, end) shipped until 1998-09-02 and not deleted to their groups */
+void
+q1_aggregate_lineitem(const LineItemTable &l, uint64_t begin, uint64_t end, Q1Group *groups) {
+    for (uint64_t i = begin; i < end; ++i) {
+        if (l.l_shipdate[i] > TIMESTAMP_1998_09_02_SECONDS || row_deleted(l.l_deleted, i)) {
+            continue;
+        }
+        const int group = q1Group(l, i);
+        if (group < 0) {
+            continue;
+        }
+        const double price = l.l_extendedprice[i];
+        const double discount = l.l_discount[i];
+        const double disc_price = price * (1 - discount);
+        groups[group].sum_qty += l.l_quantity[i];
+        groups[group].sum_base_price += price;
+        groups[group].sum_disc_price += disc_price;
+        groups[group].sum_charge += disc_price * (1 + static_cast<double>(l.l_tax[i]));
+        groups[group].sum_disc += discount;
+        ++groups[group].count;
+    }
+}
+
+/**
+ * AVX-512 version of q1_aggregate_lineitem. Evaluates 8 rows at once: the shipdate predicate and the group of every
+ * row become bit masks, the sums of every group are 8 lanes wide and only add the lanes of their mask. The lanes are
+ * summed up once at the end.
+ */
+void
+q1_aggregate_lineitem_simd(const LineItemTable &l, uint64_t begin, uint64_t end, Q1Group *groups) {
+    __m512d sum_qty[Q1_GROUPS];
+    __m512d sum_base_price[Q1_GROUPS];
+    __m512d sum_disc_price[Q1_GROUPS];
+    __m512d sum_charge[Q1_GROUPS];
+    __m512d sum_disc[Q1_GROUPS];
+    for (int g = 0; g < Q1_GROUPS; ++g) {
+        sum_qty[g] = sum_base_price[g] = sum_disc_price[g] = sum_charge[g] = sum_disc[g] = _mm512_setzero_pd();
+    }
+    const __m512i max_shipdate = _mm512_set1_epi64(TIMESTAMP_1998_09_02_SECONDS);
+    const __m512d one = _mm512_set1_pd(1);
+    const NotDeleted live = not_deleted(l);
+
+    uint64_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __mmask8 selected =
+                _mm512_cmple_epu64_mask(_mm512_loadu_si512(l.l_shipdate + i), max_shipdate) & live.mask8(i);
+        if (selected == 0) {
+            continue;
+        }
+        const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(l.l_returnflag + i));
+        const __m128i states = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(l.l_linestatus + i));
+        const __m512d quantity = _mm512_cvtps_pd(_mm256_loadu_ps(l.l_quantity + i));
+        const __m512d price = _mm512_cvtps_pd(_mm256_loadu_ps(l.l_extendedprice + i));
+        const __m512d discount = _mm512_cvtps_pd(_mm256_loadu_ps(l.l_discount + i));
+        const __m512d tax = _mm512_cvtps_pd(_mm256_loadu_ps(l.l_tax + i));
+        const __m512d disc_price = _mm512_mul_pd(price, _mm512_sub_pd(one, discount));
+        const __m512d charge = _mm512_mul_pd(disc_price, _mm512_add_pd(one, tax));
+
+        for (int f = 0; f < 3; ++f) {
+            const __mmask8 flag_mask = selected & _mm_cmpeq_epi8_mask(flags, _mm_set1_epi8(Q1_RETURNFLAGS[f]));
+            if (flag_mask == 0) {
+                continue;
+            }
+            for (int s = 0; s < 2; ++s) {
+                const __mmask8 mask = flag_mask & _mm_cmpeq_epi8_mask(states, _mm_set1_epi8(Q1_LINESTATUS[s]));
+                if (mask == 0) {
+                    continue;
+                }
+                const int g = f * 2 + s;
+                sum_qty[g] = _mm512_mask_add_pd(sum_qty[g], mask, sum_qty[g], quantity);
+                sum_base_price[g] = _mm512_mask_add_pd(sum_base_price[g], mask, sum_base_price[g], price);
+                sum_disc_price[g] = _mm512_mask_add_pd(sum_disc_price[g], mask, sum_disc_price[g], disc_price);
+                sum_charge[g] = _mm512_mask_add_pd(sum_charge[g], mask, sum_charge[g], charge);
+                sum_disc[g] = _mm512_mask_add_pd(sum_disc[g], mask, sum_disc[g], discount);
+                groups[g].count += __builtin_popcount(mask);
+            }
+        }
+    }
+
+    for (int g = 0; g < Q1_GROUPS; ++g) {
+        groups[g].sum_qty += _mm512_reduce_add_pd(sum_qty[g]);
+        groups[g].sum_base_price += _mm512_reduce_add_pd(sum_base_price[g]);
+        groups[g].sum_disc_price += _mm512_reduce_add_pd(sum_disc_price[g]);
+        groups[g].sum_charge += _mm512_reduce_add_pd(sum_charge[g]);
+        groups[g].sum_disc += _mm512_reduce_add_pd(sum_disc[g]);
+    }
+
+    q1_aggregate_lineitem(l, i, end, groups);
+}
+
+/** q1_aggregate_lineitem on the decimal columns */
+void
+q1_aggregate_lineitem(const LineItemTable &l, uint64_t begin, uint64_t end, Q1DecimalGroup *groups) {
+    for (uint64_t i = begin; i < end; ++i) {
+        if (l.l_shipdate[i] > TIMESTAMP_1998_09_02_SECONDS || row_deleted(l.l_deleted, i)) {
+            continue;
+        }
+        const int group = q1Group(l, i);
+        if (group < 0) {
+            continue;
+        }
+        const int64_t price = l.l_extendedprice_dec[i];
+        const int64_t discount = l.l_discount_dec[i];
+        const int64_t disc_price = price * (DECIMAL_ONE - discount);
+        groups[group].sum_qty += l.l_quantity_dec[i];
+        groups[group].sum_base_price += price;
+        groups[group].sum_disc_price += disc_price;
+        groups[group].sum_charge += disc_price * (DECIMAL_ONE + l.l_tax_dec[i]);
+        groups[group].sum_disc += discount;
+        ++groups[group].count;
+    }
+}
+
+/**
+ * AVX-512 version of q1_aggregate_lineitem on the decimal columns. Like the float version, but the products are
+ * 64-bit integer multiplications and the lanes of the sums are 64-bit integers, which are added to the 128-bit sums
+ * of the groups every DECIMAL_FLUSH_ROWS rows.
+ */
+void
+q1_aggregate_lineitem_simd(const LineItemTable &l, uint64_t begin, uint64_t end, Q1DecimalGroup *groups) {
+    const __m512i max_shipdate = _mm512_set1_epi64(TIMESTAMP_1998_09_02_SECONDS);
+    const __m512i one = _mm512_set1_epi64(DECIMAL_ONE);
+    const NotDeleted live = not_deleted(l);
+
+    uint64_t i = begin;
+    while (i + 8 <= end) {
+        __m512i sum_qty[Q1_GROUPS];
+        __m512i sum_base_price[Q1_GROUPS];
+        __m512i sum_disc_price[Q1_GROUPS];
+        __m512i sum_charge[Q1_GROUPS];
+        __m512i sum_disc[Q1_GROUPS];
+        for (int g = 0; g < Q1_GROUPS; ++g) {
+            sum_qty[g] = sum_base_price[g] = sum_disc_price[g] = sum_charge[g] = sum_disc[g] = _mm512_setzero_si512();
+        }
+        const uint64_t block_end = std::min(end, i + DECIMAL_FLUSH_ROWS);
+        for (; i + 8 <= block_end; i += 8) {
+            const __mmask8 selected =
+                    _mm512_cmple_epu64_mask(_mm512_loadu_si512(l.l_shipdate + i), max_shipdate) & live.mask8(i);
+            if (selected == 0) {
+                continue;
+            }
+            const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(l.l_returnflag + i));
+            const __m128i states = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(l.l_linestatus + i));
+            const __m512i quantity = _mm512_loadu_si512(l.l_quantity_dec + i);
+            const __m512i price = _mm512_loadu_si512(l.l_extendedprice_dec + i);
+            const __m512i discount = _mm512_loadu_si512(l.l_discount_dec + i);
+            const __m512i tax = _mm512_loadu_si512(l.l_tax_dec + i);
+            const __m512i disc_price = _mm512_mullo_epi64(price, _mm512_sub_epi64(one, discount));
+            const __m512i charge = _mm512_mullo_epi64(disc_price, _mm512_add_epi64(one, tax));
+
+            for (int f = 0; f < 3; ++f) {
+                const __mmask8 flag_mask = selected & _mm_cmpeq_epi8_mask(flags, _mm_set1_epi8(Q1_RETURNFLAGS[f]));
+                if (flag_mask == 0) {
+                    continue;
+                }
+                for (int s = 0; s < 2; ++s) {
+                    const __mmask8 mask = flag_mask & _mm_cmpeq_epi8_mask(states, _mm_set1_epi8(Q1_LINESTATUS[s]));
+                    if (mask == 0) {
+                        continue;
+                    }
+                    const int g = f * 2 + s;
+                    sum_qty[g] = _mm512_mask_add_epi64(sum_qty[g], mask, sum_qty[g], quantity);
+                    sum_base_price[g] = _mm512_mask_add_epi64(sum_base_price[g], mask, sum_base_price[g], price);
+                    sum_disc_price[g] = _mm512_mask_add_epi64(sum_disc_price[g], mask, sum_disc_price[g], disc_price);
+                    sum_charge[g] = _mm512_mask_add_epi64(sum_charge[g], mask, sum_charge[g], charge);
+                    sum_disc[g] = _mm512_mask_add_epi64(sum_disc[g], mask, sum_disc[g], discount);
+                    groups[g].count += __builtin_popcount(mask);
+                }
+            }
+        }
+
+        for (int g = 0; g < Q1_GROUPS; ++g) {
+            groups[g].sum_qty += _mm512_reduce_add_epi64(sum_qty[g]);
+            groups[g].sum_base_price += _mm512_reduce_add_epi64(sum_base_price[g]);
+            groups[g].sum_disc_price += _mm512_reduce_add_epi64(sum_disc_price[g]);
+            groups[g].sum_charge += _mm512_reduce_add_epi64(sum_charge[g]);
+            groups[g].sum_disc += _mm512_reduce_add_epi64(sum_disc[g]);
+        }
+    }
+
+    q1_aggregate_lineitem(l, i, end, groups);
+}
+
+#endif//Q1PREDICATES_HPP
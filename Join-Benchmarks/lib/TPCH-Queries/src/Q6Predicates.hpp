@@ -0,0 +1,154 @@
+#ifndef Q6PREDICATES_HPP
+#define Q6PREDICATES_HPP
+
+#include "Decimal.hpp"
+#include "Predicates.hpp"
+#include "TpcHTypes.hpp"
+#include "data-types.h"
+#include <algorithm>
+
+#ifdef ENCLAVE
+#include "avx512dqintrin.h"
+#include "avx512fintrin.h"
+#include "avx512vlintrin.h"
+#include "avxintrin.h"
+#else
+#include <immintrin.h>
+#endif
+
+constexpr float Q6_DISCOUNT_LOW = 0.05f;
+constexpr float Q6_DISCOUNT_HIGH = 0.07f;
+constexpr float Q6_QUANTITY = 24;
+constexpr decimal_t Q6_DISCOUNT_LOW_DEC = to_decimal(Q6_DISCOUNT_LOW);
+constexpr decimal_t Q6_DISCOUNT_HIGH_DEC = to_decimal(Q6_DISCOUNT_HIGH);
+constexpr decimal_t Q6_QUANTITY_DEC = to_decimal(Q6_QUANTITY);
+
+struct Q6Revenue {
+    double revenue;
+    uint64_t matches;
+};
+
+/** Q6Revenue of the decimal columns, the revenue is exact at scale 4 */
+struct Q6DecimalRevenue {
+    __int128 revenue;
+    uint64_t matches;
+};
+
+/** @return true if l has the decimal columns Q6 reads */
+[[gnu::always_inline]] inline bool
+q6_has_decimals(const LineItemTable &l) {
+    return l.l_quantity_dec != nullptr && l.l_extendedprice_dec != nullptr && l.l_discount_dec != nullptr;
+}
+
+[[gnu::always_inline]] inline bool
+q6Predicate(const LineItemTable &l, uint64_t rowID) {
+    return l.l_shipdate[rowID] >= TIMESTAMP_1994_01_01_SECONDS && l.l_shipdate[rowID] < TIMESTAMP_1995_01_01_SECONDS &&
+           l.l_discount[rowID] >= Q6_DISCOUNT_LOW && l.l_discount[rowID] <= Q6_DISCOUNT_HIGH &&
+           l.l_quantity[rowID] < Q6_QUANTITY && !row_deleted(l.l_deleted, rowID);
+}
+
+/** Adds sum(l_extendedprice * l_discount) of the qualifying rows in [begin, end) to result */
+void
+q6_revenue(const LineItemTable &l, uint64_t begin, uint64_t end, Q6Revenue &result) {
+    for (uint64_t i = begin; i < end; ++i) {
+        if (q6Predicate(l, i)) {
+            result.revenue += static_cast<double>(l.l_extendedprice[i]) * static_cast<double>(l.l_discount[i]);
+            ++result.matches;
+        }
+    }
+}
+
+/**
+ * AVX-512 version of q6_revenue. The five comparisons of 8 rows are combined into one bit mask, the revenue of the
+ * selected lanes is added to an 8 lane wide sum. The discount and quantity columns are only read for rows in the
+ * shipdate range.
+ */
+void
+q6_revenue_simd(const LineItemTable &l, uint64_t begin, uint64_t end, Q6Revenue &result) {
+    const __m512i shipdate_low = _mm512_set1_epi64(TIMESTAMP_1994_01_01_SECONDS);
+    const __m512i shipdate_high = _mm512_set1_epi64(TIMESTAMP_1995_01_01_SECONDS);
+    const __m256 discount_low = _mm256_set1_ps(Q6_DISCOUNT_LOW);
+    const __m256 discount_high = _mm256_set1_ps(Q6_DISCOUNT_HIGH);
+    const __m256 max_quantity = _mm256_set1_ps(Q6_QUANTITY);
+    __m512d revenue = _mm512_setzero_pd();
+    const NotDeleted live = not_deleted(l);
+
+    uint64_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m512i shipdate = _mm512_loadu_si512(l.l_shipdate + i);
+        __mmask8 mask = _mm512_cmpge_epu64_mask(shipdate, shipdate_low) &
+                        _mm512_cmplt_epu64_mask(shipdate, shipdate_high) & live.mask8(i);
+        if (mask == 0) {
+            continue;
+        }
+        const __m256 discount = _mm256_loadu_ps(l.l_discount + i);
+        mask &= _mm256_cmp_ps_mask(discount, discount_low, _CMP_GE_OQ) &
+                _mm256_cmp_ps_mask(discount, discount_high, _CMP_LE_OQ) &
+                _mm256_cmp_ps_mask(_mm256_loadu_ps(l.l_quantity + i), max_quantity, _CMP_LT_OQ);
+        if (mask == 0) {
+            continue;
+        }
+        const __m512d price = _mm512_cvtps_pd(_mm256_loadu_ps(l.l_extendedprice + i));
+        revenue = _mm512_mask_add_pd(revenue, mask, revenue, _mm512_mul_pd(price, _mm512_cvtps_pd(discount)));
+        result.matches += __builtin_popcount(mask);
+    }
+    result.revenue += _mm512_reduce_add_pd(revenue);
+
+    q6_revenue(l, i, end, result);
+}
+
+/** q6_revenue on the decimal columns */
+void
+q6_revenue(const LineItemTable &l, uint64_t begin, uint64_t end, Q6DecimalRevenue &result) {
+    for (uint64_t i = begin; i < end; ++i) {
+        if (l.l_shipdate[i] >= TIMESTAMP_1994_01_01_SECONDS && l.l_shipdate[i] < TIMESTAMP_1995_01_01_SECONDS &&
+            l.l_discount_dec[i] >= Q6_DISCOUNT_LOW_DEC && l.l_discount_dec[i] <= Q6_DISCOUNT_HIGH_DEC &&
+            l.l_quantity_dec[i] < Q6_QUANTITY_DEC && !row_deleted(l.l_deleted, i)) {
+            result.revenue += l.l_extendedprice_dec[i] * l.l_discount_dec[i];
+            ++result.matches;
+        }
+    }
+}
+
+/**
+ * AVX-512 version of q6_revenue on the decimal columns. Like the float version, with 64-bit integer comparisons and
+ * products, the 64-bit lanes of the revenue are added to the 128-bit result every DECIMAL_FLUSH_ROWS rows.
+ */
+void
+q6_revenue_simd(const LineItemTable &l, uint64_t begin, uint64_t end, Q6DecimalRevenue &result) {
+    const __m512i shipdate_low = _mm512_set1_epi64(TIMESTAMP_1994_01_01_SECONDS);
+    const __m512i shipdate_high = _mm512_set1_epi64(TIMESTAMP_1995_01_01_SECONDS);
+    const __m512i discount_low = _mm512_set1_epi64(Q6_DISCOUNT_LOW_DEC);
+    const __m512i discount_high = _mm512_set1_epi64(Q6_DISCOUNT_HIGH_DEC);
+    const __m512i max_quantity = _mm512_set1_epi64(Q6_QUANTITY_DEC);
+    const NotDeleted live = not_deleted(l);
+
+    uint64_t i = begin;
+    while (i + 8 <= end) {
+        __m512i revenue = _mm512_setzero_si512();
+        const uint64_t block_end = std::min(end, i + DECIMAL_FLUSH_ROWS);
+        for (; i + 8 <= block_end; i += 8) {
+            const __m512i shipdate = _mm512_loadu_si512(l.l_shipdate + i);
+            __mmask8 mask = _mm512_cmpge_epu64_mask(shipdate, shipdate_low) &
+                            _mm512_cmplt_epu64_mask(shipdate, shipdate_high) & live.mask8(i);
+            if (mask == 0) {
+                continue;
+            }
+            const __m512i discount = _mm512_loadu_si512(l.l_discount_dec + i);
+            mask &= _mm512_cmpge_epi64_mask(discount, discount_low) &
+                    _mm512_cmple_epi64_mask(discount, discount_high) &
+                    _mm512_cmplt_epi64_mask(_mm512_loadu_si512(l.l_quantity_dec + i), max_quantity);
+            if (mask == 0) {
+                continue;
+            }
+            const __m512i price = _mm512_loadu_si512(l.l_extendedprice_dec + i);
+            revenue = _mm512_mask_add_epi64(revenue, mask, revenue, _mm512_mullo_epi64(price, discount));
+            result.matches += __builtin_popcount(mask);
+        }
+        result.revenue += _mm512_reduce_add_epi64(revenue);
+    }
+
+    q6_revenue(l, i, end, result);
+}
+
+#endif//Q6PREDICATES_HPP
@@ -1,130 +1,334 @@
 #ifndef SGXV2_JOIN_BENCHMARKS_FILTERS_HPP
 #define SGXV2_JOIN_BENCHMARKS_FILTERS_HPP
 
-#include "Barrier.hpp"
 #include "Logger.hpp"
+#include "PartitionedTable.hpp"
+#include "Predicates.hpp"
 #include "Q19Predicates.hpp"
 #include "TpcHTypes.hpp"
+#include "WorkerPool.hpp"
+#include "radix/radix_join.h"
+#include "util.hpp"
 
 #include <algorithm>
-#include <pthread.h>
-#include <tuple>
+#include <cstdlib>
+#include <vector>
 
+/**
+ * Scan of the SIMD filters: writes the matches among the first num_tuples rows of the columns args into output, which
+ * has room for num_tuples rows, and returns the number of matches.
+ */
 template<typename... Args>
-using FilterFunctionType = table_t (*)(uint64_t, Args...);
+using FilterFunctionType = uint64_t (*)(uint64_t, row_t *, Args...);
 
-template<typename... Args>
-struct parallel_filter_parameters {
-    std::vector<table_t> *results;
-    Barrier *b;
-    table_t *result_table;
-    uint64_t num_threads;
-    std::vector<uint64_t> *thread_start_positions;
-    uint64_t thread_id;
-    uint64_t tuple_count;
-    FilterFunctionType<Args...> filter_function;
-    std::tuple<Args...> var_args;
+/*
+ * Outputs of the filter kernels compiled from predicate expressions. An output builds the join input row of a matching
+ * row of the base table, for one row and for 8 consecutive rows at once.
+ */
+
+/** 32-bit values of a column, zero-extended to the lanes of a 512-bit register */
+template<typename T>
+struct Values32 {
+    static_assert(sizeof(T) == 4, "Only 32-bit columns fit into a row_t");
+    const T *column;
+
+    [[gnu::always_inline, nodiscard]] uint32_t operator()(uint64_t row) const { return column[row]; }
+
+    [[gnu::always_inline, nodiscard]] __m512i load8(uint64_t row) const {
+        return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(column + row)));
+    }
 };
 
-template<typename... Args>
-table_t
-parallel_filter(uint64_t num_threads, FilterFunctionType<Args...> filter_function, uint64_t num_tuples, Args... args) {
-    auto tuples_per_thread = num_tuples / num_threads;
-    tuples_per_thread = tuples_per_thread & ~63;// make sure that tuples_per_thread is divisible by 64
-    auto tuples_last_thread = num_tuples - (tuples_per_thread * (num_threads - 1));
+/** Keys of a row_t column */
+struct Keys {
+    const row_t *rows;
 
-    std::vector<table_t> results(num_threads);
-    std::vector<pthread_t> worker_threads(num_threads - 1);
-    std::vector<uint64_t> thread_start_positions(num_threads);
-    table_t result_table{};
-    Barrier b{num_threads};
-
-    auto thread_function = [](void *arg_void_ptr) -> void * {
-        auto parameters = reinterpret_cast<parallel_filter_parameters<Args...> *>(arg_void_ptr);
-        // Each thread filters its results
-        // Let's hope copy elision works as intended here...
-
-        auto filter_function_varargs = [tuple_count = parameters->tuple_count,
-                                        f_function = parameters->filter_function](Args... varargs) {
-            return f_function(tuple_count, varargs...);
-        };
-
-        parameters->results->at(parameters->thread_id) = std::apply(filter_function_varargs, parameters->var_args);
-
-        // last thread calculates number of tuples, start positions for writes and allocates memory
-        parameters->b->wait([parameters] {
-            uint64_t num_t = parameters->num_threads;
-            for (uint64_t tid = 0; tid < num_t; ++tid) {
-                parameters->thread_start_positions->at(tid) = parameters->result_table->num_tuples;
-                parameters->result_table->num_tuples += parameters->results->at(tid).num_tuples;
-            }
-
-            parameters->result_table->tuples =
-                    reinterpret_cast<row_t *>(malloc(parameters->result_table->num_tuples * sizeof(row_t)));
-
-            return true;
-        });
-
-        // All threads copy their tuples to the right position in the output table
-        std::copy_n(parameters->results->at(parameters->thread_id).tuples,
-                    parameters->results->at(parameters->thread_id).num_tuples,
-                    parameters->result_table->tuples + parameters->thread_start_positions->at(parameters->thread_id));
-
-        free(parameters->results->at(parameters->thread_id).tuples);
-        return nullptr;
-    };
-
-    std::vector<parallel_filter_parameters<Args...>> thread_params{};
-
-    // Create parameters for the worker threads
-    for (uint64_t thread_id = 1; thread_id < num_threads; ++thread_id) {
-        uint64_t start_index = tuples_per_thread * thread_id;
-        uint64_t tuples_to_scan = thread_id < (num_threads - 1) ? tuples_per_thread : tuples_last_thread;
-        thread_params.push_back({&results, &b, &result_table, num_threads, &thread_start_positions, thread_id,
-                                 tuples_to_scan, filter_function, std::tuple<Args...>{(args + start_index)...}});
+    [[gnu::always_inline, nodiscard]] uint32_t operator()(uint64_t row) const { return rows[row].key; }
+
+    [[gnu::always_inline, nodiscard]] __m512i load8(uint64_t row) const {
+        return _mm512_and_si512(_mm512_loadu_si512(rows + row), _mm512_set1_epi64(0xffffffff));
     }
+};
 
-    // Start worker threads (cannot be combined with previous loop since the previous loop is increasing the vector size)
-    for (uint64_t worker_thread_id = 0; worker_thread_id < (num_threads - 1); ++worker_thread_id) {
-        pthread_create(&worker_threads[worker_thread_id], nullptr, thread_function,
-                       (void *) &thread_params[worker_thread_id]);
+/** Payloads of a row_t column */
+struct Payloads {
+    const row_t *rows;
+
+    [[gnu::always_inline, nodiscard]] uint32_t operator()(uint64_t row) const { return rows[row].payload; }
+
+    [[gnu::always_inline, nodiscard]] __m512i load8(uint64_t row) const {
+        return _mm512_srli_epi64(_mm512_loadu_si512(rows + row), 32);
     }
+};
+
+/** Copies the rows of a row_t column */
+struct Rows {
+    const row_t *rows;
+
+    [[gnu::always_inline, nodiscard]] row_t operator()(uint64_t row) const { return rows[row]; }
 
-    // Do the first work package on the main thread
-    parallel_filter_parameters<Args...> parameters{&results,
-                                                   &b,
-                                                   &result_table,
-                                                   num_threads,
-                                                   &thread_start_positions,
-                                                   0,
-                                                   num_threads > 1 ? tuples_per_thread : tuples_last_thread,
-                                                   filter_function,
-                                                   std::tuple<Args...>{args...}};
-    thread_function((void *) &parameters);
-
-    // Synchronize and wait for all worker threads to finish
-    for (auto worker_thread: worker_threads) {
-        pthread_join(worker_thread, nullptr);
+    [[gnu::always_inline, nodiscard]] __m512i load8(uint64_t row) const { return _mm512_loadu_si512(rows + row); }
+};
+
+/** Builds rows from a key and a payload, each one of Values32, Keys, or Payloads */
+template<typename Key, typename Payload>
+struct RowsOf {
+    Key key;
+    Payload payload;
+
+    [[gnu::always_inline, nodiscard]] row_t operator()(uint64_t row) const { return {key(row), payload(row)}; }
+
+    [[gnu::always_inline, nodiscard]] __m512i load8(uint64_t row) const {
+        return _mm512_or_si512(key.load8(row), _mm512_slli_epi64(payload.load8(row), 32));
     }
+};
 
+template<typename T>
+[[nodiscard]] Values32<T>
+values(const T *column) {
+    return {column};
+}
+
+[[nodiscard]] inline Keys
+keys(const row_t *rows) {
+    return {rows};
+}
+
+[[nodiscard]] inline Payloads
+payloads(const row_t *rows) {
+    return {rows};
+}
+
+[[nodiscard]] inline Rows
+rows(const row_t *rows) {
+    return {rows};
+}
+
+template<typename Key, typename Payload>
+[[nodiscard]] RowsOf<Key, Payload>
+rows(Key key, Payload payload) {
+    return {key, payload};
+}
+
+/**
+ * Filter kernel compiled from a predicate expression (see Predicates.hpp): writes output(row) of the rows in
+ * [begin, end) that satisfy predicate into matches and returns their number. Every step evaluates 64 rows into one
+ * mask, each column with as many registers as its width requires, and conjuncts after the first only load the
+ * registers that still have live rows. Every 8 rows with a match are built and compress-stored in one go. The rows
+ * after the last full step are evaluated without branches.
+ */
+template<typename Predicate, typename Output>
+[[nodiscard]] uint64_t
+scan_rows(const Predicate &predicate, const Output &output, uint64_t begin, uint64_t end, row_t *matches) {
+    uint64_t num_matches = 0;
+    uint64_t row = begin;
+    for (; row + 64 <= end; row += 64) {
+        uint64_t mask = predicate.mask64(row, ~uint64_t{0});
+        while (mask != 0) {
+            const unsigned offset = __builtin_ctzll(mask) & ~7u;
+            const auto group = static_cast<__mmask8>(mask >> offset);
+            _mm512_mask_compressstoreu_epi64(matches + num_matches, group, output.load8(row + offset));
+            num_matches += __builtin_popcount(group);
+            mask &= ~(uint64_t{0xff} << offset);
+        }
+    }
+    for (; row < end; ++row) {
+        matches[num_matches] = output(row);
+        num_matches += predicate(row);
+    }
+    return num_matches;
+}
+
+/** Writes output(row) of all rows in [begin, end) into matches and returns their number */
+template<typename Output>
+[[nodiscard]] uint64_t
+copy_rows(const Output &output, uint64_t begin, uint64_t end, row_t *matches) {
+    uint64_t row = begin;
+    for (; row + 8 <= end; row += 8) {
+        _mm512_storeu_si512(matches + (row - begin), output.load8(row));
+    }
+    for (; row < end; ++row) {
+        matches[row - begin] = output(row);
+    }
+    return end - begin;
+}
+
+/**
+ * Filters the rows [begin, end) zone by zone with scan_rows(). Zones in which the zone maps of the predicate rule out
+ * every row are skipped, zones in which they guarantee every row are copied without evaluating the predicate.
+ */
+template<typename Predicate, typename Output>
+[[nodiscard]] uint64_t
+filter_rows(const Predicate &predicate, const Output &output, uint64_t begin, uint64_t end, row_t *matches) {
+    uint64_t num_matches = 0;
+    while (begin < end) {
+        const uint64_t zone = begin / ZONE_ROWS;
+        const uint64_t zone_end = std::min(end, (zone + 1) * ZONE_ROWS);
+        switch (predicate.zone(zone)) {
+            case ZoneMatch::NONE:
+                break;
+            case ZoneMatch::SOME:
+                num_matches += scan_rows(predicate, output, begin, zone_end, matches + num_matches);
+                break;
+            case ZoneMatch::ALL:
+                num_matches += copy_rows(output, begin, zone_end, matches + num_matches);
+                break;
+        }
+        begin = zone_end;
+    }
+    return num_matches;
+}
+
+/** Matches of one thread, grows with the morsels the thread filtered */
+struct alignas(64) FilterOutput {
+    row_t *tuples = nullptr;
+    uint64_t num_tuples = 0;
+    uint64_t capacity = 0;
+
+    void
+    reserve(uint64_t min_capacity) {
+        if (min_capacity <= capacity) {
+            return;
+        }
+        capacity = std::max(min_capacity, 2 * capacity);
+        tuples = static_cast<row_t *>(realloc(tuples, capacity * sizeof(row_t)));
+        malloc_check(tuples)
+    }
+};
+
+/**
+ * Filters with num_threads threads of the worker pool. The threads take morsels of MORSEL_TUPLES rows and append the
+ * matches to their own output, so neither threads nor worst-case sized outputs are created per filter, and skewed
+ * selectivity does not leave threads idle. The outputs are concatenated into the result in parallel.
+ *
+ * filter_morsel(thread_id, begin, end, output) writes the matches among the rows [begin, end) into output, which has
+ * room for end - begin rows, and returns their number.
+ */
+template<typename FilterMorsel>
+table_t
+parallel_filter_morsels(uint64_t num_threads, uint64_t num_tuples, const FilterMorsel &filter_morsel) {
+    auto &pool = WorkerPool::global();
+    const int nthreads = static_cast<int>(num_threads);
+    std::vector<FilterOutput> outputs(num_threads);
+
+    pool.for_each_morsel(nthreads, num_tuples, MORSEL_TUPLES, [&](int thread_id, uint64_t begin, uint64_t end) {
+        auto &output = outputs[thread_id];
+        output.reserve(output.num_tuples + (end - begin));
+        output.num_tuples += filter_morsel(thread_id, begin, end, output.tuples + output.num_tuples);
+    });
+
+    std::vector<uint64_t> offsets(num_threads + 1, 0);
+    for (uint64_t thread_id = 0; thread_id < num_threads; ++thread_id) {
+        offsets[thread_id + 1] = offsets[thread_id] + outputs[thread_id].num_tuples;
+    }
+    table_t result_table{};
+    result_table.num_tuples = offsets[num_threads];
+    result_table.tuples = static_cast<row_t *>(malloc(std::max<uint64_t>(result_table.num_tuples, 1) * sizeof(row_t)));
+    malloc_check(result_table.tuples)
+
+    pool.run(nthreads, [&](int thread_id) {
+        std::copy_n(outputs[thread_id].tuples, outputs[thread_id].num_tuples, result_table.tuples + offsets[thread_id]);
+        free(outputs[thread_id].tuples);
+    });
     return result_table;
 }
 
+/** Filters with a hand-written kernel, see parallel_filter_morsels() */
+template<typename... Args>
+table_t
+parallel_filter(uint64_t num_threads, FilterFunctionType<Args...> filter_function, uint64_t num_tuples, Args... args) {
+    return parallel_filter_morsels(num_threads, num_tuples, [&](int, uint64_t begin, uint64_t end, row_t *output) {
+        return filter_function(end - begin, output, (args + begin)...);
+    });
+}
+
+/**
+ * Filters with the kernel compiled from a predicate expression and an output, see filter_rows(). Every thread filters
+ * with its own copy of the predicate, which keeps the statistics of adaptive predicates.
+ */
+template<typename Predicate, typename Output, typename = std::enable_if_t<is_predicate_v<Predicate>>>
+table_t
+parallel_filter(uint64_t num_threads, uint64_t num_tuples, const Predicate &predicate, const Output &output) {
+    std::vector<Predicate> predicates(num_threads, predicate);
+    return parallel_filter_morsels(num_threads, num_tuples,
+                                   [&](int thread_id, uint64_t begin, uint64_t end, row_t *matches) {
+                                       return filter_rows(predicates[thread_id], output, begin, end, matches);
+                                   });
+}
+
+/** Rows a thread filters at once in parallel_filter_partition(), their matches stay in L1 until they are partitioned */
+constexpr uint64_t FILTER_PARTITION_STEP = 1024;
+
+/**
+ * Filters like parallel_filter_morsels(), but radix partitions the matches for the first pass of a radix join with
+ * num_radix_bits radix bits instead of concatenating them. The matches of every FILTER_PARTITION_STEP rows are
+ * partitioned while they are still in the cache, so the filter output is never written to memory unpartitioned and
+ * the join skips the first partitioning pass for it.
+ */
+template<typename FilterMorsel>
+partitioned_table_t *
+parallel_filter_partition_morsels(uint64_t num_threads, uint32_t num_radix_bits, uint64_t num_tuples,
+                                  const FilterMorsel &filter_morsel) {
+    auto &pool = WorkerPool::global();
+    const int nthreads = static_cast<int>(num_threads);
+    const uint32_t fanout = radix_join_fanout(num_radix_bits);
+    std::vector<PartitionWriter> writers;
+    writers.reserve(num_threads);
+    for (uint64_t thread_id = 0; thread_id < num_threads; ++thread_id) {
+        writers.emplace_back(fanout);
+    }
+
+    pool.for_each_morsel(nthreads, num_tuples, MORSEL_TUPLES, [&](int thread_id, uint64_t begin, uint64_t end) {
+        alignas(64) row_t matches[FILTER_PARTITION_STEP];
+        for (uint64_t step = begin; step < end; step += FILTER_PARTITION_STEP) {
+            const uint64_t num_matches =
+                    filter_morsel(thread_id, step, std::min(step + FILTER_PARTITION_STEP, end), matches);
+            writers[thread_id].write(matches, num_matches);
+        }
+    });
+    pool.run(nthreads, [&](int thread_id) { writers[thread_id].finish(); });
+    return merge_partitions(writers, num_radix_bits);
+}
+
+/** Filters with a hand-written kernel, see parallel_filter_partition_morsels() */
+template<typename... Args>
+partitioned_table_t *
+parallel_filter_partition(uint64_t num_threads, uint32_t num_radix_bits, FilterFunctionType<Args...> filter_function,
+                          uint64_t num_tuples, Args... args) {
+    return parallel_filter_partition_morsels(
+            num_threads, num_radix_bits, num_tuples, [&](int, uint64_t begin, uint64_t end, row_t *output) {
+                return filter_function(end - begin, output, (args + begin)...);
+            });
+}
+
+/** Filters with the kernel compiled from a predicate expression and an output, see parallel_filter() */
+template<typename Predicate, typename Output, typename = std::enable_if_t<is_predicate_v<Predicate>>>
+partitioned_table_t *
+parallel_filter_partition(uint64_t num_threads, uint32_t num_radix_bits, uint64_t num_tuples,
+                          const Predicate &predicate, const Output &output) {
+    std::vector<Predicate> predicates(num_threads, predicate);
+    return parallel_filter_partition_morsels(
+            num_threads, num_radix_bits, num_tuples, [&](int thread_id, uint64_t begin, uint64_t end, row_t *matches) {
+                return filter_rows(predicates[thread_id], output, begin, end, matches);
+            });
+}
+
 template<class TableType>
 using FilterPredicateType = bool (*)(const TableType &, uint64_t);
 template<class TableType>
 using CopyFunctionType = void (*)(const TableType &, table_t &, uint64_t, uint64_t);
 
-template<class TableType, FilterPredicateType<TableType> FilterPredicate, CopyFunctionType<TableType> CopyFunction>
+/** Copies the rows of table for which predicate(row) is true, e.g. a CodeSet or a lambda over a CodeSet */
+template<class TableType, CopyFunctionType<TableType> CopyFunction, typename Predicate>
 table_t
-filter_table(const TableType &table) {
+filter_table_where(const TableType &table, const Predicate &predicate) {
     table_t filtered_table{};
 
     uint64_t selectionMatches = 0;
     filtered_table.tuples = (tuple_t *) malloc(sizeof(tuple_t) * table.numTuples);
     malloc_check(filtered_table.tuples);
     for (uint64_t i = 0; i < table.numTuples; i++) {
-        if (FilterPredicate(table, i)) {
+        if (predicate(i)) {
             CopyFunction(table, filtered_table, i, selectionMatches++);
         }
     }
@@ -137,5 +341,13 @@ filter_table(const TableType &table) {
     return filtered_table;
 }
 
+template<class TableType, FilterPredicateType<TableType> FilterPredicate, CopyFunctionType<TableType> CopyFunction>
+table_t
+filter_table(const TableType &table) {
+    return filter_table_where<TableType, CopyFunction>(table, [&table](uint64_t row) {
+        return FilterPredicate(table, row);
+    });
+}
+
 
 #endif//SGXV2_JOIN_BENCHMARKS_FILTERS_HPP
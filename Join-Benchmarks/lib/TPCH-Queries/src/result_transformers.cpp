@@ -1,10 +1,11 @@
 #include "result_transformers.hpp"
 #include "Logger.hpp"
+#include "WorkerPool.hpp"
 #include "util.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <vector>
-#include "pthread.h"
 
 #ifndef ENCLAVE
 #include "ocalls.hpp"
@@ -18,6 +19,7 @@ struct JrToTableArg {
     uint64_t nresults;
     tuple_t *out;
     const type_key *keyToExtract;
+    const tuple_t *tupleKeyToExtract; // used instead of keyToExtract if set
 
     //for ST
     int nthreads;
@@ -41,7 +43,8 @@ toTableThread_RpToKeySpST(void *param) {
             if (tlist == nullptr) {
                 logger(ERROR, "Error retrieving join tuple");
             }
-            arg->out[output_index].key = arg->keyToExtract[tlist->Rpayload];
+            arg->out[output_index].key = arg->tupleKeyToExtract != nullptr ? arg->tupleKeyToExtract[tlist->Rpayload].key
+                                                                           : arg->keyToExtract[tlist->Rpayload];
             arg->out[output_index].payload = tlist->Spayload;
             output_index++;
             tlist = tlist->next;
@@ -64,7 +67,8 @@ toTableThread_RpToKeySp(void *param) {
         if (tmp == nullptr) {
             logger(ERROR, "Error retrieving join tuple");
         }
-        arg->out[i].key = arg->keyToExtract[tmp->Rpayload];
+        arg->out[i].key = arg->tupleKeyToExtract != nullptr ? arg->tupleKeyToExtract[tmp->Rpayload].key
+                                                            : arg->keyToExtract[tmp->Rpayload];
         arg->out[i].payload = tmp->Spayload;
         tmp = tmp->next;
     }
@@ -88,7 +92,8 @@ toTableThread_SpToTupleST(void *param) {
             if (tlist == nullptr) {
                 logger(ERROR, "Error retrieving join tuple");
             }
-            arg->out[i].key = arg->keyToExtract[tlist->Spayload];
+            arg->out[i].key = arg->tupleKeyToExtract != nullptr ? arg->tupleKeyToExtract[tlist->Spayload].key
+                                                                : arg->keyToExtract[tlist->Spayload];
             i++;
             tlist = tlist->next;
         }
@@ -110,7 +115,9 @@ toTableThread_SpToTuple(void *param) {
         if (tmp == nullptr) {
             logger(ERROR, "Error retrieving join tuple");
         }
-        arg->out[i].key = arg->keyToExtract[tmp->Spayload];
+        arg->out[i].key = arg->tupleKeyToExtract != nullptr ? arg->tupleKeyToExtract[tmp->Spayload].key
+                                                            : arg->keyToExtract[tmp->Spayload];
+        arg->out[i].payload = 0;
         tmp = tmp->next;
     }
     return nullptr;
@@ -152,15 +159,15 @@ void *
 toTableThread_SpSp(void *param) {
     auto *arg = static_cast<JrToTableArg *>(param);
     output_list_t *tmp = arg->threadresult;
-    uint64_t i = 0;
-    while (tmp != nullptr) {
+    // The lists are not null-terminated by every join, so nresults decides when to stop
+    for (uint64_t i = 0; i < arg->nresults; i++) {
+        if (tmp == nullptr) {
+            logger(ERROR, "Error retrieving join tuple");
+        }
         arg->out[i].key = tmp->Spayload;
         arg->out[i].payload = tmp->Spayload;
         tmp = tmp->next;
-        i++;
     }
-
-    //SGX_ASSERT(i == arg->nresults, "iterated over wrong number of elements");
     return nullptr;
 }
 
@@ -192,9 +199,9 @@ toTableThread_RkSp(void *param) {
  * @param t_thread
  * @param keyToExtract
  */
-void
-joinResultToTableST(table_t *table, const result_t *jr, ToTableThread t_thread,
-                    const type_key *keyToExtract) {
+static void
+joinResultToTableST(table_t *table, const result_t *jr, ToTableThread t_thread, const type_key *keyToExtract,
+                    const tuple_t *tupleKeyToExtract) {
     if (!jr->materialized) {
         logger(ERROR, "Trying to build table out of non-materialized join result!");
         ocall_exit(EXIT_FAILURE);
@@ -212,55 +219,82 @@ joinResultToTableST(table_t *table, const result_t *jr, ToTableThread t_thread,
     args->resultlist = (threadresult_t *) jr->result;
     args->out = table->tuples;
     args->keyToExtract = keyToExtract;
+    args->tupleKeyToExtract = tupleKeyToExtract;
     t_thread(args.get());
 }
 
 /**
- * Constructs table using the ToTableThread function and keyToExtract if given. Uses jr->nthreads threads.
+ * Constructs table using the ToTableThread function and keyToExtract if given on the calling thread.
  * @param table [out] written to
  * @param jr
  * @param t_thread
  * @param keyToExtract
  */
 void
-joinResultToTable(table_t *table, const result_t *jr, ToTableThread t_thread, const type_key *keyToExtract) {
+joinResultToTableST(table_t *table, const result_t *jr, ToTableThread t_thread, const type_key *keyToExtract) {
+    joinResultToTableST(table, jr, t_thread, keyToExtract, nullptr);
+}
+
+/**
+ * Constructs table using the ToTableThread function and keyToExtract if given. The result lists of the jr->nthreads
+ * join threads are copied in parallel on the worker pool.
+ * @param table [out] written to
+ * @param jr
+ * @param t_thread
+ * @param keyToExtract
+ */
+static void
+joinResultToTable(table_t *table, const result_t *jr, ToTableThread t_thread, const type_key *keyToExtract,
+                  const tuple_t *tupleKeyToExtract) {
     if (!jr->materialized) {
         logger(ERROR, "Trying to build table out of non-materialized join result!");
         ocall_exit(EXIT_FAILURE);
     }
+    if (jr->result_type != 0) {
+        logger(ERROR, "Trying to build table out wrong result type. Is %d expected 0!", jr->result_type);
+        ocall_exit(EXIT_FAILURE);
+    }
     table->tuples = (tuple_t *) malloc(sizeof(tuple_t) * jr->totalresults);
     malloc_check(table->tuples);
     table->num_tuples = jr->totalresults;
-    int nthreads = jr->nthreads;
-    std::vector<uint64_t> offset(nthreads);
-    offset[0] = 0;
-    for (int i = 1; i < nthreads; i++) {
-        offset[i] = offset[i - 1] + ((threadresult_t *) jr->result)[i - 1].nresults;
-    }
-
-    std::vector<JrToTableArg> args(nthreads);
-    std::vector<pthread_t> tid(nthreads);
-    int rv;
-    for (int i = 0; i < jr->nthreads; i++) {
-        auto thread_result = ((threadresult_t *) jr->result)[i];
-        args[i].tid = thread_result.threadid;
-        args[i].threadresult = thread_result.results;
-        args[i].nresults = thread_result.nresults;
-        args[i].out = table->tuples + offset[i];
-        args[i].keyToExtract = keyToExtract;
-        rv = pthread_create(&tid[i], nullptr, t_thread, (void *) &args[i]);
-        if (rv) {
-            logger(ERROR, "return code from pthread_create() is %d\n", rv);
-        }
-    }
+    table->ratio_holes = 0;
+    table->sorted = 0;
+    const int nthreads = jr->nthreads;
+    const auto *thread_results = static_cast<const threadresult_t *>(jr->result);
+    std::vector<uint64_t> offset(nthreads + 1, 0);
     for (int i = 0; i < nthreads; i++) {
-        pthread_join(tid[i], nullptr);
+        offset[i + 1] = offset[i] + thread_results[i].nresults;
     }
+
+    // every morsel is the result list of one join thread, the lists cannot be split without walking them
+    WorkerPool::global().for_each_morsel(nthreads, nthreads, 1, [&](int, uint64_t list, uint64_t) {
+        JrToTableArg arg{};
+        arg.tid = thread_results[list].threadid;
+        arg.threadresult = thread_results[list].results;
+        arg.nresults = thread_results[list].nresults;
+        arg.out = table->tuples + offset[list];
+        arg.keyToExtract = keyToExtract;
+        arg.tupleKeyToExtract = tupleKeyToExtract;
+        t_thread(&arg);
+    });
+}
+
+/**
+ * Constructs table using the ToTableThread function and keyToExtract if given. Uses jr->nthreads threads, each one
+ * copies the list of one join thread to its precomputed offset in the output.
+ * @param table [out] written to
+ * @param jr
+ * @param t_thread
+ * @param keyToExtract
+ */
+void
+joinResultToTable(table_t *table, const result_t *jr, ToTableThread t_thread, const type_key *keyToExtract) {
+    joinResultToTable(table, jr, t_thread, keyToExtract, nullptr);
 }
 
 /**
- * Constructs table using the ToTableThread function and keyToExtract if given. Extracts keyToExtract for
- * joinResultToTableST from the tuples in the parameter keyToExtract.
+ * Constructs table using the ToTableThread function and keyToExtract if given. toTableThread_RpToKeySpST and
+ * toTableThread_SpToTupleST read the keys directly from the tuples in the parameter keyToExtract.
  * @param table [out] written to
  * @param jr
  * @param t_thread
@@ -269,17 +303,13 @@ joinResultToTable(table_t *table, const result_t *jr, ToTableThread t_thread, co
 void
 joinResultToTableST(table_t *table, const result_t *jr, ToTableThread t_thread, const tuple_t *keyToExtract,
                     uint64_t keySize) {
-    auto *tmp = (type_key *) malloc(sizeof(type_key) * keySize);
-    for (uint64_t i = 0; i < keySize; i++) {
-        tmp[i] = keyToExtract[i].key;
-    }
-    joinResultToTableST(table, jr, t_thread, tmp);
-    free(tmp);
+    (void) keySize; // no extracted copy of the keys needed
+    joinResultToTableST(table, jr, t_thread, nullptr, keyToExtract);
 }
 
 /**
  * Constructs table using the ToTableThread function and keyToExtract if given. Uses jr->nthreads threads.
- * Extracts keyToExtract for joinResultToTableST from the tuples in the parameter keyToExtract.
+ * Only toTableThread_RpToKeySp and toTableThread_SpToTuple look up keys, they read them from the tuples.
  * @param table [out] written to
  * @param jr
  * @param t_thread
@@ -288,10 +318,15 @@ joinResultToTableST(table_t *table, const result_t *jr, ToTableThread t_thread,
 void
 joinResultToTable(table_t *table, const result_t *jr, ToTableThread t_thread, const tuple_t *keyToExtract,
                   uint64_t keySize) {
-    auto *tmp = (type_key *) malloc(sizeof(type_key) * keySize);
-    for (uint64_t i = 0; i < keySize; i++) {
-        tmp[i] = keyToExtract[i].key;
-    }
-    joinResultToTable(table, jr, t_thread, tmp);
-    free(tmp);
+    (void) keySize; // the threads read the keys directly from the tuples, no extracted copy needed
+    joinResultToTable(table, jr, t_thread, nullptr, keyToExtract);
+}
+
+void
+copy_chunks_parallel(int nthreads, uint64_t num_chunks, void (*copy_chunk)(uint64_t chunk_index, const void *context),
+                     const void *context) {
+    nthreads = static_cast<int>(std::min<uint64_t>(nthreads, num_chunks));
+    WorkerPool::global().for_each_morsel(nthreads, num_chunks, 1, [=](int, uint64_t chunk_index, uint64_t) {
+        copy_chunk(chunk_index, context);
+    });
 }
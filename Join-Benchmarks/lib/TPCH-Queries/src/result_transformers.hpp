@@ -3,7 +3,9 @@
 
 #include "data-types.h"
 #include "Logger.hpp"
+#include "util.hpp"
 #include <cstdlib>
+#include <vector>
 
 using ToTableThread = void *(*) (void *param);
 
@@ -63,67 +65,216 @@ copy_SpToTupleST(const output_triple_t &triple, const tuple_t *lookup_table) {
     return {lookup_table[triple.Spayload].key, 0};
 }
 
+/* Projections for join results that are fed directly into the next join, see run_join_chunked */
+
+[[nodiscard]] inline row_t
+project_Sp_Sp(type_key, type_value, type_value Spayload, const void *) {
+    return {Spayload, Spayload};
+}
+
+/** context: type_key column indexed by Rpayload */
+[[nodiscard]] inline row_t
+project_RpToKeySp(type_key, type_value Rpayload, type_value Spayload, const void *context) {
+    return {static_cast<const type_key *>(context)[Rpayload], Spayload};
+}
+
+/** context: tuple_t column indexed by Spayload */
+[[nodiscard]] inline row_t
+project_SpToTuple(type_key, type_value, type_value Spayload, const void *context) {
+    return {static_cast<const tuple_t *>(context)[Spayload].key, 0};
+}
+
+using ColumnsToTupleFunctionType = row_t (*)(const column_chunk_t &, uint64_t);
+template<typename LookupTableType>
+using ColumnsToTupleLookupFunctionType = row_t (*)(const column_chunk_t &, uint64_t, const LookupTableType *);
+
+/** Requires COLUMN_SPAYLOAD */
+[[gnu::always_inline, nodiscard]] inline row_t
+copy_Sp_Sp_columns(const column_chunk_t &chunk, uint64_t index) {
+    return {chunk.Spayloads[index], chunk.Spayloads[index]};
+}
+
+/** Requires COLUMN_RPAYLOAD | COLUMN_SPAYLOAD */
+template<typename LookupTableType>
+[[gnu::always_inline, nodiscard]] inline row_t
+copy_RpToKeySp_columns(const column_chunk_t &chunk, uint64_t index, const LookupTableType *lookup_table) {
+    return {lookup_table[chunk.Rpayloads[index]], chunk.Spayloads[index]};
+}
+
+/** Requires COLUMN_SPAYLOAD */
+[[gnu::always_inline, nodiscard]] inline row_t
+copy_SpToTupleST_columns(const column_chunk_t &chunk, uint64_t index, const tuple_t *lookup_table) {
+    return {lookup_table[chunk.Spayloads[index]].key, 0};
+}
+
 /**
- * Copies all tuples from all chunks to the returned solid table. Uses copy_function to transform triples to tuples.
- * TODO make copy_function compile time polymorph to allow inlining. All in all, this function is similar to the
- *  other translation functions in TpcHECalls
- * TODO enable parallel copy of chunks in threads
- * @param input_table
- * @param copy_function
- * @return
+ * Calls copy_chunk for every chunk index. The chunks are handed out to nthreads threads of the worker pool one at a
+ * time, so large and small chunks are balanced over the threads.
+ * @param nthreads
+ * @param num_chunks
+ * @param copy_chunk
+ * @param context passed on to copy_chunk
  */
-template<TripleToTupleFunctionType CopyFunction>
 void
-chunked_to_solid_table(table_t *result_table, const chunked_table_t *input_table) {
-    // Initialize result table
-    result_table->num_tuples = input_table->num_tuples;
-    result_table->tuples = static_cast<row_t *>(malloc(sizeof(row_t) * input_table->num_tuples));
+copy_chunks_parallel(int nthreads, uint64_t num_chunks, void (*copy_chunk)(uint64_t chunk_index, const void *context),
+                     const void *context);
+
+/**
+ * Allocates the result table and returns the output offset of every chunk, the exclusive prefix sum of the chunk
+ * sizes. With these offsets, every chunk can be copied independently.
+ */
+template<typename ChunkSize>
+[[nodiscard]] std::vector<uint64_t>
+init_solid_table(table_t *result_table, uint64_t num_tuples, uint64_t num_chunks, ChunkSize &&chunk_size) {
+    result_table->num_tuples = num_tuples;
+    result_table->tuples = static_cast<row_t *>(malloc(sizeof(row_t) * num_tuples));
+    malloc_check(result_table->tuples)
     result_table->ratio_holes = 0;
     result_table->sorted = 0;
 
-    // Copy all tuples from all chunks over
-    uint64_t output_row_index = 0;
-    for (uint64_t chunk_index = 0; chunk_index < input_table->num_chunks; ++chunk_index) {
-        auto chunk = input_table->chunks[chunk_index];
-        for (uint64_t tuple_index = 0; tuple_index < chunk->num_tuples; ++tuple_index) {
-            result_table->tuples[output_row_index++] = CopyFunction(chunk->tuples[tuple_index]);
-        }
+    std::vector<uint64_t> offsets(num_chunks + 1);
+    offsets[0] = 0;
+    for (uint64_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+        offsets[chunk_index + 1] = offsets[chunk_index] + chunk_size(chunk_index);
+    }
+    return offsets;
+}
+
+template<typename InputTable, typename LookupTableType>
+struct SolidTableCopyContext {
+    table_t *result_table;
+    const InputTable *input_table;
+    const LookupTableType *lookup_table;
+    const uint64_t *offsets;
+};
+
+template<TripleToTupleFunctionType CopyFunction>
+void
+copy_chunk_to_solid_table(uint64_t chunk_index, const void *context) {
+    auto ctx = static_cast<const SolidTableCopyContext<chunked_table_t, void> *>(context);
+    auto chunk = ctx->input_table->chunks[chunk_index];
+    auto out = ctx->result_table->tuples + ctx->offsets[chunk_index];
+    for (uint64_t tuple_index = 0; tuple_index < chunk->num_tuples; ++tuple_index) {
+        out[tuple_index] = CopyFunction(chunk->tuples[tuple_index]);
     }
-    if (output_row_index != input_table->num_tuples) {
+}
+
+template<typename LookupTableType, TripleToTupleLookupFunctionType<LookupTableType> CopyFunction>
+void
+copy_chunk_to_solid_table(uint64_t chunk_index, const void *context) {
+    auto ctx = static_cast<const SolidTableCopyContext<chunked_table_t, LookupTableType> *>(context);
+    auto chunk = ctx->input_table->chunks[chunk_index];
+    auto out = ctx->result_table->tuples + ctx->offsets[chunk_index];
+    for (uint64_t tuple_index = 0; tuple_index < chunk->num_tuples; ++tuple_index) {
+        out[tuple_index] = CopyFunction(chunk->tuples[tuple_index], ctx->lookup_table);
+    }
+}
+
+template<ColumnsToTupleFunctionType CopyFunction>
+void
+copy_column_chunk_to_solid_table(uint64_t chunk_index, const void *context) {
+    auto ctx = static_cast<const SolidTableCopyContext<columnar_table_t, void> *>(context);
+    const auto &chunk = ctx->input_table->chunks[chunk_index];
+    auto out = ctx->result_table->tuples + ctx->offsets[chunk_index];
+    for (uint64_t tuple_index = 0; tuple_index < chunk.num_tuples; ++tuple_index) {
+        out[tuple_index] = CopyFunction(chunk, tuple_index);
+    }
+}
+
+template<typename LookupTableType, ColumnsToTupleLookupFunctionType<LookupTableType> CopyFunction>
+void
+copy_column_chunk_to_solid_table(uint64_t chunk_index, const void *context) {
+    auto ctx = static_cast<const SolidTableCopyContext<columnar_table_t, LookupTableType> *>(context);
+    const auto &chunk = ctx->input_table->chunks[chunk_index];
+    auto out = ctx->result_table->tuples + ctx->offsets[chunk_index];
+    for (uint64_t tuple_index = 0; tuple_index < chunk.num_tuples; ++tuple_index) {
+        out[tuple_index] = CopyFunction(chunk, tuple_index, ctx->lookup_table);
+    }
+}
+
+/**
+ * Copies all tuples from all chunks to the returned solid table. Uses CopyFunction to transform triples to tuples.
+ * The output offset of every chunk is computed upfront, then nthreads threads copy the chunks concurrently.
+ * @param result_table
+ * @param input_table
+ * @param nthreads
+ */
+template<TripleToTupleFunctionType CopyFunction>
+void
+chunked_to_solid_table(table_t *result_table, const chunked_table_t *input_table, int nthreads = 1) {
+    auto offsets = init_solid_table(result_table, input_table->num_tuples, input_table->num_chunks,
+                                    [input_table](uint64_t i) { return input_table->chunks[i]->num_tuples; });
+    if (offsets.back() != input_table->num_tuples) {
         logger(ERROR, "Chunked to solid table failed!");
     }
+    SolidTableCopyContext<chunked_table_t, void> context{result_table, input_table, nullptr, offsets.data()};
+    copy_chunks_parallel(nthreads, input_table->num_chunks, copy_chunk_to_solid_table<CopyFunction>, &context);
 }
 
 /**
- * Copies all tuples from all chunks to the returned solid table. Uses copy_function to transform triples to tuples.
- * TODO make copy_function compile time polymorph to allow inlining. All in all, this function is similar to the
- *  other translation functions in TpcHECalls
- * TODO enable parallel copy of chunks in threads
+ * Copies all tuples from all chunks to the returned solid table. Uses CopyFunction to transform triples to tuples.
+ * The output offset of every chunk is computed upfront, then nthreads threads copy the chunks concurrently.
+ * @param result_table
  * @param input_table
- * @param copy_function
- * @return
+ * @param lookup_table
+ * @param nthreads
  */
 template<typename LookupTableType, TripleToTupleLookupFunctionType<LookupTableType> CopyFunction>
 void
-chunked_to_solid_table(table_t *result_table, const chunked_table_t *input_table, const LookupTableType *lookup_table) {
-    // Initialize result table
-    result_table->num_tuples = input_table->num_tuples;
-    result_table->tuples = static_cast<row_t *>(malloc(sizeof(row_t) * input_table->num_tuples));
-    result_table->ratio_holes = 0;
-    result_table->sorted = 0;
+chunked_to_solid_table(table_t *result_table, const chunked_table_t *input_table, const LookupTableType *lookup_table,
+                       int nthreads = 1) {
+    auto offsets = init_solid_table(result_table, input_table->num_tuples, input_table->num_chunks,
+                                    [input_table](uint64_t i) { return input_table->chunks[i]->num_tuples; });
+    if (offsets.back() != input_table->num_tuples) {
+        logger(ERROR, "Chunked to solid table failed!");
+    }
+    SolidTableCopyContext<chunked_table_t, LookupTableType> context{result_table, input_table, lookup_table,
+                                                                    offsets.data()};
+    copy_chunks_parallel(nthreads, input_table->num_chunks,
+                         copy_chunk_to_solid_table<LookupTableType, CopyFunction>, &context);
+}
 
-    // Copy all tuples from all chunks over
-    uint64_t output_row_index = 0;
-    for (uint64_t chunk_index = 0; chunk_index < input_table->num_chunks; ++chunk_index) {
-        auto chunk = input_table->chunks[chunk_index];
-        for (uint64_t tuple_index = 0; tuple_index < chunk->num_tuples; ++tuple_index) {
-            result_table->tuples[output_row_index++] = CopyFunction(chunk->tuples[tuple_index], lookup_table);
-        }
+/**
+ * Copies all tuples from all chunks of a columnar table to the returned solid table. CopyFunction may only read the
+ * columns that were projected when the table was written. Chunks are copied by nthreads threads concurrently.
+ * @param result_table
+ * @param input_table
+ * @param nthreads
+ */
+template<ColumnsToTupleFunctionType CopyFunction>
+void
+columnar_to_solid_table(table_t *result_table, const columnar_table_t *input_table, int nthreads = 1) {
+    auto offsets = init_solid_table(result_table, input_table->num_tuples, input_table->num_chunks,
+                                    [input_table](uint64_t i) { return input_table->chunks[i].num_tuples; });
+    if (offsets.back() != input_table->num_tuples) {
+        logger(ERROR, "Columnar to solid table failed!");
     }
+    SolidTableCopyContext<columnar_table_t, void> context{result_table, input_table, nullptr, offsets.data()};
+    copy_chunks_parallel(nthreads, input_table->num_chunks, copy_column_chunk_to_solid_table<CopyFunction>,
+                         &context);
+}
 
-    if (output_row_index != input_table->num_tuples) {
-        logger(ERROR, "Chunked to solid table failed!");
+/**
+ * Copies all tuples from all chunks of a columnar table to the returned solid table. CopyFunction may only read the
+ * columns that were projected when the table was written. Chunks are copied by nthreads threads concurrently.
+ * @param result_table
+ * @param input_table
+ * @param lookup_table
+ * @param nthreads
+ */
+template<typename LookupTableType, ColumnsToTupleLookupFunctionType<LookupTableType> CopyFunction>
+void
+columnar_to_solid_table(table_t *result_table, const columnar_table_t *input_table,
+                        const LookupTableType *lookup_table, int nthreads = 1) {
+    auto offsets = init_solid_table(result_table, input_table->num_tuples, input_table->num_chunks,
+                                    [input_table](uint64_t i) { return input_table->chunks[i].num_tuples; });
+    if (offsets.back() != input_table->num_tuples) {
+        logger(ERROR, "Columnar to solid table failed!");
     }
+    SolidTableCopyContext<columnar_table_t, LookupTableType> context{result_table, input_table, lookup_table,
+                                                                     offsets.data()};
+    copy_chunks_parallel(nthreads, input_table->num_chunks,
+                         copy_column_chunk_to_solid_table<LookupTableType, CopyFunction>, &context);
 }
 
 #endif//SGXV2_JOIN_BENCHMARKS_RESULT_TRANSFORMERS_HPP
@@ -11,7 +11,7 @@ TPCHTimers
 timers_to_us(const TPCHTimers &src) {
     return TPCHTimers{src.selection_1 / CPMS, src.selection_2 / CPMS, src.selection_3 / CPMS, src.join_1 / CPMS,
                       src.join_2 / CPMS, src.join_3 / CPMS,
-                      src.copy / CPMS, src.total / CPMS};
+                      src.copy / CPMS, src.aggregation / CPMS, src.total / CPMS};
 }
 
 void
@@ -28,6 +28,8 @@ print_query_results(const TPCHTimers &timers, uint64_t numTuples) {
            (100 * (double) join_time / (double) timers.total));
     logger(INFO, "QueryTimeCopy (us)          : %u (%.2lf%%)", timers.copy,
            (100 * (double) timers.copy / (double) timers.total));
+    logger(INFO, "QueryTimeAggregation (us)   : %u (%.2lf%%)", timers.aggregation,
+           (100 * (double) timers.aggregation / (double) timers.total));
     logger(INFO, "QueryTimeJoin 1 (us)         : %u", timers.join_1);
     logger(INFO, "QueryTimeJoin 2 (us)         : %u", timers.join_2);
     logger(INFO, "QueryTimeJoin 3 (us)         : %u", timers.join_3);
@@ -11,6 +11,7 @@ struct TPCHTimers {
     uint64_t join_2;
     uint64_t join_3;
     uint64_t copy;
+    uint64_t aggregation;
     uint64_t total;
 };
 
@@ -1,8 +1,10 @@
+#ifndef OPERATOR_PIPELINE
 #include "Q10Predicates.hpp"
 #include "Q12Predicates.hpp"
 #include "Q19Predicates.hpp"
 #include "Q3Predicates.hpp"
 #include "filters.hpp"
+#endif
 
 #include "result_transformers.hpp"
 #include "time_print.hpp"
@@ -12,6 +14,9 @@
 #include "rdtscpWrapper.h"
 
 #include "ChunkedTable.hpp"
+#include "ColumnarTable.hpp"
+#include "JoinInput.hpp"
+#include "npj/multiway_probe_join.hpp"
 #include "tpch.hpp"
 #include <algorithm>
 
@@ -33,6 +38,18 @@ compare_tables(const table_t &a, const table_t &b) {
     return equal;
 }
 
+#if defined(QUERY_AGGREGATION) && !defined(OPERATOR_PIPELINE)
+#error "QUERY_AGGREGATION is implemented with the operator pipelines, define OPERATOR_PIPELINE as well"
+#endif
+
+#if defined(PARTITIONED_FILTER) && !(defined(SIMD) && defined(CHUNKED_INPUT))
+#error "PARTITIONED_FILTER partitions the SIMD filter outputs into chunked join inputs, define SIMD and CHUNKED_INPUT"
+#endif
+
+#ifndef OPERATOR_PIPELINE
+// With OPERATOR_PIPELINE, the queries are composed from operator pipelines instead, see tpch_pipeline.cpp
+
+#ifndef MULTIWAY_PROBE
 void
 tpch_q3(result_t *result, const struct CustomerTable *c, const struct OrdersTable *o, const struct LineItemTable *l,
         const char *algorithm, struct joinconfig_t *config) {
@@ -45,15 +62,30 @@ tpch_q3(result_t *result, const struct CustomerTable *c, const struct OrdersTabl
 
     //selection
 #ifndef SIMD
-    table_t customers_filtered = filter_table<CustomerTable, q3CustomerPredicate, q3CustomerCopy>(*c);
+    table_t customers_filtered = filter_table_where<CustomerTable, q3CustomerCopy>(*c, q3_customer_predicate(*c));
     auto timer_selections_1 = rdtscp_s();
     table_t orders_filtered = filter_table<OrdersTable, q3OrdersPredicate, q3OrderCopy>(*o);
 #else
-    table_t customers_filtered = parallel_filter<const row_t *, const uint8_t *>(
-            config->NTHREADS, q3_filter_customer_simd, c->numTuples, c->c_custkey, c->c_mktsegment);
+    table_t customers_filtered = parallel_filter(config->NTHREADS, c->numTuples, q3_customer_predicate(*c),
+                                                 rows(c->c_custkey));
     auto timer_selections_1 = rdtscp_s();
-    table_t orders_filtered = parallel_filter<const type_key *, const row_t *, const uint64_t *>(
-            config->NTHREADS, q3_filter_orders_simd, o->numTuples, o->o_custkey, o->o_orderkey, o->o_orderdate);
+#ifndef PARTITIONED_FILTER
+    const auto filter_orders = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, o->numTuples, predicate,
+                               rows(values(o->o_custkey), keys(o->o_orderkey)));
+    };
+    table_t orders_filtered = o->o_orderdate_days != nullptr ? filter_orders(q3_orders_days_predicate(*o))
+                                                             : filter_orders(q3_orders_predicate(*o));
+#else
+    const auto filter_orders = [&](const auto &predicate) {
+        return parallel_filter_partition(config->NTHREADS,
+                                         radix_join_bits(customers_filtered.num_tuples, config->NTHREADS),
+                                         o->numTuples, predicate, rows(values(o->o_custkey), keys(o->o_orderkey)));
+    };
+    partitioned_table_t *orders_filtered = o->o_orderdate_days != nullptr
+                                                   ? filter_orders(q3_orders_days_predicate(*o))
+                                                   : filter_orders(q3_orders_predicate(*o));
+#endif
 #endif
     auto timer_selections_2 = rdtscp_s();
     t.selection_1 = timer_selections_1 - timer_start;
@@ -61,51 +93,107 @@ tpch_q3(result_t *result, const struct CustomerTable *c, const struct OrdersTabl
 
 
     //join customers and orders
-    logger(INFO, "Join customers=%u with orders=%u", customers_filtered.num_tuples, orders_filtered.num_tuples);
     result_t o_c_join_result;
     config->MATERIALIZE = true;
+    config->OUTPUT_COLUMNS = COLUMN_SPAYLOAD;
+#ifndef PARTITIONED_FILTER
+    logger(INFO, "Join customers=%u with orders=%u", customers_filtered.num_tuples, orders_filtered.num_tuples);
     // TODO: make sure that all required joins correctly return their results. Done: CrkJoin, RHO, PHT
     run_join(&o_c_join_result, &customers_filtered, &orders_filtered, algorithm, config);
+#else
+    logger(INFO, "Join customers=%u with orders=%u", customers_filtered.num_tuples, orders_filtered->num_tuples);
+    const join_input_t customers_input = table_input(&customers_filtered);
+    const join_input_t orders_input = partitioned_input(orders_filtered);
+    run_join_chunked(&o_c_join_result, &customers_input, &orders_input, algorithm, config);
+#endif
     auto timer_join1_end = rdtscp_s();
     t.join_1 = (timer_join1_end - timer_selections_2);
     logger(INFO, "Join 1 timer (cycles) : %lu", t.join_1);
     free(customers_filtered.tuples);
+#ifndef PARTITIONED_FILTER
     free(orders_filtered.tuples);
+#else
+    destroy_table(orders_filtered);
+    free(orders_filtered);
+#endif
 
+#ifndef CHUNKED_INPUT
     //transform joinResult to relation_t
     table_t o_c_joined_table{};
     if (o_c_join_result.result_type == 0) {
-        joinResultToTableST(&o_c_joined_table, &o_c_join_result, toTableThread_SpSpST);
+        joinResultToTable(&o_c_joined_table, &o_c_join_result, toTableThread_SpSp);
+    } else if (o_c_join_result.result_type == 2) {
+        auto columnar_table = reinterpret_cast<columnar_table_t *>(o_c_join_result.result);
+        columnar_to_solid_table<copy_Sp_Sp_columns>(&o_c_joined_table, columnar_table, config->NTHREADS);
+        destroy_table(columnar_table);
+        free(columnar_table);
     } else {
         chunked_to_solid_table<copy_Sp_Sp>(&o_c_joined_table,
-                                           reinterpret_cast<chunked_table_t *>(o_c_join_result.result));
+                                           reinterpret_cast<chunked_table_t *>(o_c_join_result.result),
+                                           config->NTHREADS);
         destroy_table(reinterpret_cast<chunked_table_t *>(o_c_join_result.result));
     }
     logger(INFO, "U tuples=%u", o_c_joined_table.num_tuples);
     auto timer_copy_1_end = rdtscp_s();
     t.copy += timer_copy_1_end - timer_join1_end;
+#else
+    // The next join reads the chunks of this join result in place
+    const join_input_t o_c_joined_input = join_result_input(&o_c_join_result, project_Sp_Sp);
+    auto timer_copy_1_end = timer_join1_end;
+#endif
 
     // selection 2
 #ifndef SIMD
     table_t lineitem_filtered = filter_table<LineItemTable, q3LineitemPredicate, q3LineitemCopy>(*l);
+#elif !defined(PARTITIONED_FILTER)
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, l->numTuples, predicate, rows(l->l_orderkey));
+    };
+    table_t lineitem_filtered = l->l_shipdate_days != nullptr ? filter_lineitems(q3_lineitem_days_predicate(*l))
+                                                              : filter_lineitems(q3_lineitem_predicate(*l));
 #else
-    table_t lineitem_filtered = parallel_filter<const row_t *, const uint64_t *>(
-            config->NTHREADS, q3_filter_lineitem_simd, l->numTuples, l->l_orderkey, l->l_shipdate);
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter_partition(
+                config->NTHREADS, radix_join_bits(input_num_tuples(&o_c_joined_input), config->NTHREADS),
+                l->numTuples, predicate, rows(l->l_orderkey));
+    };
+    partitioned_table_t *lineitem_filtered = l->l_shipdate_days != nullptr
+                                                     ? filter_lineitems(q3_lineitem_days_predicate(*l))
+                                                     : filter_lineitems(q3_lineitem_predicate(*l));
 #endif
     auto timer_selection_3_end = rdtscp_s();
     t.selection_3 = timer_selection_3_end - timer_copy_1_end;
 
     //join with lineitems
-    logger(INFO, "Join U=%u with lineitems=%u", o_c_joined_table.num_tuples, lineitem_filtered.num_tuples);
     config->MATERIALIZE = false;
+#ifndef CHUNKED_INPUT
+    logger(INFO, "Join U=%u with lineitems=%u", o_c_joined_table.num_tuples, lineitem_filtered.num_tuples);
     run_join(result, &o_c_joined_table, &lineitem_filtered, algorithm, config);
+#elif !defined(PARTITIONED_FILTER)
+    logger(INFO, "Join U=%u with lineitems=%u", input_num_tuples(&o_c_joined_input), lineitem_filtered.num_tuples);
+    const join_input_t lineitem_input = table_input(&lineitem_filtered);
+    run_join_chunked(result, &o_c_joined_input, &lineitem_input, algorithm, config);
+#else
+    logger(INFO, "Join U=%u with lineitems=%u", input_num_tuples(&o_c_joined_input), lineitem_filtered->num_tuples);
+    const join_input_t lineitem_input = partitioned_input(lineitem_filtered);
+    run_join_chunked(result, &o_c_joined_input, &lineitem_input, algorithm, config);
+#endif
     auto timerEnd = rdtscp_s();
     t.join_2 += (timerEnd - timer_selection_3_end);
     logger(INFO, "Join 2 timer (cycles) : %lu", (t.join_2));
 
     //clean up
+#ifndef PARTITIONED_FILTER
     free(lineitem_filtered.tuples);
+#else
+    destroy_table(lineitem_filtered);
+    free(lineitem_filtered);
+#endif
+#ifndef CHUNKED_INPUT
     free(o_c_joined_table.tuples);
+#else
+    destroy_join_result(&o_c_join_result);
+#endif
 
     // print
     uint64_t numTuples = (l->numTuples + o->numTuples + c->numTuples);
@@ -127,87 +215,170 @@ tpch_q10(result_t *result, const CustomerTable *c, const OrdersTable *o, const L
     table_t customer_table{c->c_custkey, c->numTuples, 0, 0};
 #ifndef SIMD
     table_t filtered_orders = filter_table<OrdersTable, q10OrdersPredicate, q10OrderCopy>(*o);
+#elif !defined(PARTITIONED_FILTER)
+    const auto filter_orders = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, o->numTuples, predicate,
+                               rows(values(o->o_custkey), payloads(o->o_orderkey)));
+    };
+    table_t filtered_orders = o->o_orderdate_days != nullptr ? filter_orders(q10_orders_days_predicate(*o))
+                                                             : filter_orders(q10_orders_predicate(*o));
 #else
-    table_t filtered_orders = parallel_filter<const type_key *, const row_t *, const uint64_t *>(
-            config->NTHREADS, q10_filter_order_simd, o->numTuples, o->o_custkey, o->o_orderkey, o->o_orderdate);
+    const auto filter_orders = [&](const auto &predicate) {
+        return parallel_filter_partition(config->NTHREADS,
+                                         radix_join_bits(customer_table.num_tuples, config->NTHREADS), o->numTuples,
+                                         predicate, rows(values(o->o_custkey), payloads(o->o_orderkey)));
+    };
+    partitioned_table_t *filtered_orders = o->o_orderdate_days != nullptr
+                                                   ? filter_orders(q10_orders_days_predicate(*o))
+                                                   : filter_orders(q10_orders_predicate(*o));
 #endif
     auto timer_selection_1_end = rdtscp_s();
     t.selection_1 = timer_selection_1_end - timer_start;
 
     //join orders and customer
-    logger(INFO, "Join Customer=%u with Orders=%u", customer_table.num_tuples, filtered_orders.num_tuples);
     config->MATERIALIZE = true;
+    config->OUTPUT_COLUMNS = COLUMN_RPAYLOAD | COLUMN_SPAYLOAD;
     result_t joinResult;
+#ifndef PARTITIONED_FILTER
+    logger(INFO, "Join Customer=%u with Orders=%u", customer_table.num_tuples, filtered_orders.num_tuples);
     run_join(&joinResult, &customer_table, &filtered_orders, algorithm, config);
+#else
+    logger(INFO, "Join Customer=%u with Orders=%u", customer_table.num_tuples, filtered_orders->num_tuples);
+    const join_input_t customer_input = table_input(&customer_table);
+    const join_input_t orders_input = partitioned_input(filtered_orders);
+    run_join_chunked(&joinResult, &customer_input, &orders_input, algorithm, config);
+#endif
     auto timer_join_1_end = rdtscp_s();
     t.join_1 = timer_join_1_end - timer_selection_1_end;
     logger(INFO, "Join 1 timer : %lu", t.join_1);
+#ifndef PARTITIONED_FILTER
     free(filtered_orders.tuples);
+#else
+    destroy_table(filtered_orders);
+    free(filtered_orders);
+#endif
 
+#ifndef CHUNKED_INPUT
     //transform joinResult to relation_t
     table_t c_o_joined{};
     if (joinResult.result_type == 0) {
-        joinResultToTableST(&c_o_joined, &joinResult, toTableThread_RpToKeySpST, c->c_nationkey);
+        joinResultToTable(&c_o_joined, &joinResult, toTableThread_RpToKeySp, c->c_nationkey);
+    } else if (joinResult.result_type == 2) {
+        auto columnar_table = reinterpret_cast<columnar_table_t *>(joinResult.result);
+        logger(INFO, "Join result tuples: %d", joinResult.totalresults);
+        columnar_to_solid_table<type_key, copy_RpToKeySp_columns>(&c_o_joined, columnar_table, c->c_nationkey,
+                                                                  config->NTHREADS);
+        destroy_table(columnar_table);
+        free(columnar_table);
     } else {
         auto chunked_table = reinterpret_cast<chunked_table_t *>(joinResult.result);
         logger(INFO, "Join result tuples: %d", joinResult.totalresults);
         logger(INFO, "Chunked Table Tuples: %d", chunked_table->num_tuples);
-        chunked_to_solid_table<type_key, copy_RpToKeySp>(&c_o_joined, chunked_table, c->c_nationkey);
+        chunked_to_solid_table<type_key, copy_RpToKeySp>(&c_o_joined, chunked_table, c->c_nationkey,
+                                                         config->NTHREADS);
         destroy_table(chunked_table);
     }
     logger(INFO, "Solid table tuples=%u", c_o_joined.num_tuples);
     auto timer_copy_1_end = rdtscp_s();
     t.copy += timer_copy_1_end - timer_join_1_end;
+#else
+    // The next join reads the chunks of this join result in place
+    const join_input_t c_o_joined_input = join_result_input(&joinResult, project_RpToKeySp, c->c_nationkey);
+    auto timer_copy_1_end = timer_join_1_end;
+#endif
 
     //join nation and previous
     table_t nation_table{n->n_nationkey, n->numTuples, 0, 0};
     config->MATERIALIZE = true;
-    logger(INFO, "Join Nation=%u with U=%u", n->numTuples, c_o_joined.num_tuples);
+    config->OUTPUT_COLUMNS = COLUMN_SPAYLOAD;
     result_t join_result_2;
+#ifndef CHUNKED_INPUT
+    logger(INFO, "Join Nation=%u with U=%u", n->numTuples, c_o_joined.num_tuples);
     run_join(&join_result_2, &nation_table, &c_o_joined, algorithm, config);
+#else
+    logger(INFO, "Join Nation=%u with U=%u", n->numTuples, input_num_tuples(&c_o_joined_input));
+    const join_input_t nation_input = table_input(&nation_table);
+    run_join_chunked(&join_result_2, &nation_input, &c_o_joined_input, algorithm, config);
+#endif
     auto timer_join_2_end = rdtscp_s();
     t.join_2 += (timer_join_2_end - timer_copy_1_end);
     logger(INFO, "Join 2 timer (cycles) : %lu", t.join_2);
+#ifndef CHUNKED_INPUT
     free(c_o_joined.tuples);
 
     //transform joinResult to relation_t
     table_t c_o_n_joined{};
     if (join_result_2.result_type == 0) {
-        joinResultToTableST(&c_o_n_joined, &join_result_2, toTableThread_SpToTupleST, o->o_orderkey, o->numTuples);
+        joinResultToTable(&c_o_n_joined, &join_result_2, toTableThread_SpToTuple, o->o_orderkey, o->numTuples);
+    } else if (join_result_2.result_type == 2) {
+        auto columnar_table = reinterpret_cast<columnar_table_t *>(join_result_2.result);
+        logger(INFO, "Join result tuples: %d", join_result_2.totalresults);
+        columnar_to_solid_table<row_t, copy_SpToTupleST_columns>(&c_o_n_joined, columnar_table, o->o_orderkey,
+                                                                 config->NTHREADS);
+        destroy_table(columnar_table);
+        free(columnar_table);
     } else {
         auto chunked_table = reinterpret_cast<chunked_table_t *>(join_result_2.result);
         logger(INFO, "Join result tuples: %d", join_result_2.totalresults);
         logger(INFO, "Chunked Table Tuples: %d", chunked_table->num_tuples);
         chunked_to_solid_table<row_t, copy_SpToTupleST>(
-                &c_o_n_joined, chunked_table, o->o_orderkey);
+                &c_o_n_joined, chunked_table, o->o_orderkey, config->NTHREADS);
         destroy_table(chunked_table);
     }
     logger(INFO, "Solid table tuples=%u", c_o_n_joined.num_tuples);
     auto timer_copy_2_end = rdtscp_s();
     t.copy += timer_copy_2_end - timer_join_2_end;
+#else
+    destroy_join_result(&joinResult);
+    const join_input_t c_o_n_joined_input = join_result_input(&join_result_2, project_SpToTuple, o->o_orderkey);
+    auto timer_copy_2_end = timer_join_2_end;
+#endif
 
     //filter lineitem
 #ifndef SIMD
     table_t lineitem_filtered = filter_table<LineItemTable, q10LineItemPredicate, q10LineItemCopy>(*l);
+#elif !defined(PARTITIONED_FILTER)
+    table_t lineitem_filtered = parallel_filter(config->NTHREADS, l->numTuples,
+                                                q10_lineitem_predicate(*l), rows(l->l_orderkey));
 #else
-    table_t lineitem_filtered = parallel_filter<const row_t *, const char *>(
-            config->NTHREADS, q10_filter_lineitem_simd, l->numTuples, l->l_orderkey, l->l_returnflag);
+    partitioned_table_t *lineitem_filtered = parallel_filter_partition(
+            config->NTHREADS, radix_join_bits(input_num_tuples(&c_o_n_joined_input), config->NTHREADS), l->numTuples,
+            q10_lineitem_predicate(*l), rows(l->l_orderkey));
 #endif
     auto timer_selection_2_end = rdtscp_s();
     t.selection_2 = timer_selection_2_end - timer_copy_2_end;
 
     //join lineitem and previous
-    logger(INFO, "Join U=%u with LineItem=%u", c_o_n_joined.num_tuples, lineitem_filtered.num_tuples);
     config->MATERIALIZE = false;
+#ifndef CHUNKED_INPUT
+    logger(INFO, "Join U=%u with LineItem=%u", c_o_n_joined.num_tuples, lineitem_filtered.num_tuples);
     run_join(result, &c_o_n_joined, &lineitem_filtered, algorithm, config);
+#elif !defined(PARTITIONED_FILTER)
+    logger(INFO, "Join U=%u with LineItem=%u", input_num_tuples(&c_o_n_joined_input), lineitem_filtered.num_tuples);
+    const join_input_t lineitem_input = table_input(&lineitem_filtered);
+    run_join_chunked(result, &c_o_n_joined_input, &lineitem_input, algorithm, config);
+#else
+    logger(INFO, "Join U=%u with LineItem=%u", input_num_tuples(&c_o_n_joined_input), lineitem_filtered->num_tuples);
+    const join_input_t lineitem_input = partitioned_input(lineitem_filtered);
+    run_join_chunked(result, &c_o_n_joined_input, &lineitem_input, algorithm, config);
+#endif
     auto timer_join_3_end = rdtscp_s();
     t.join_3 += (timer_join_3_end - timer_selection_2_end);
     logger(INFO, "Join 3 timer : %lu", t.join_3);
     logger(INFO, "Join result tuples: %d", result->totalresults);
 
     // clean + print
+#ifndef CHUNKED_INPUT
     free(c_o_n_joined.tuples);
+#else
+    destroy_join_result(&join_result_2);
+#endif
+#ifndef PARTITIONED_FILTER
     free(lineitem_filtered.tuples);
+#else
+    destroy_table(lineitem_filtered);
+    free(lineitem_filtered);
+#endif
 
     uint64_t numTuples = (l->numTuples + o->numTuples + c->numTuples + n->numTuples);
     t.total = timer_join_3_end - timer_start;
@@ -215,6 +386,151 @@ tpch_q10(result_t *result, const CustomerTable *c, const OrdersTable *o, const L
     result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
 }
 
+#else
+// With MULTIWAY_PROBE, Q3 and Q10 are a single multi-way probe join each: lineitem probes the chain of the other
+// filtered tables, so the joins of customer and orders (and nation) are never materialized. The algorithm argument is
+// not used for these joins.
+
+/** Filtered orders of Q3 are (o_custkey, o_orderkey), the hash table is built on o_orderkey */
+[[nodiscard]] static row_t
+q3_orders_stage(row_t tuple, const void *) {
+    return {tuple.payload, tuple.key};
+}
+
+/** Filtered orders of Q10 are (o_custkey, row), context: o_orderkey */
+[[nodiscard]] static row_t
+q10_orders_stage(row_t tuple, const void *context) {
+    return {static_cast<const row_t *>(context)[tuple.payload].key, tuple.key};
+}
+
+/** Customers of Q10 are (c_custkey, row), context: c_nationkey */
+[[nodiscard]] static row_t
+q10_customer_stage(row_t tuple, const void *context) {
+    return {tuple.key, static_cast<const type_key *>(context)[tuple.payload]};
+}
+
+void
+tpch_q3(result_t *result, const struct CustomerTable *c, const struct OrdersTable *o, const struct LineItemTable *l,
+        const char *algorithm, struct joinconfig_t *config) {
+    (void) algorithm;
+    logger(INFO, "%s", __FUNCTION__);
+    logger(INFO, "LineItemTable size: %u, OrdersTable size: %u, CustomerTable size: %u", l->numTuples, o->numTuples,
+           c->numTuples);
+    TPCHTimers t{};
+    auto timer_start = rdtscp_s();
+
+    //selection
+#ifndef SIMD
+    table_t customers_filtered = filter_table_where<CustomerTable, q3CustomerCopy>(*c, q3_customer_predicate(*c));
+    auto timer_selections_1 = rdtscp_s();
+    table_t orders_filtered = filter_table<OrdersTable, q3OrdersPredicate, q3OrderCopy>(*o);
+    auto timer_selections_2 = rdtscp_s();
+    table_t lineitem_filtered = filter_table<LineItemTable, q3LineitemPredicate, q3LineitemCopy>(*l);
+#else
+    table_t customers_filtered = parallel_filter(config->NTHREADS, c->numTuples, q3_customer_predicate(*c),
+                                                 rows(c->c_custkey));
+    auto timer_selections_1 = rdtscp_s();
+    const auto filter_orders = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, o->numTuples, predicate,
+                               rows(values(o->o_custkey), keys(o->o_orderkey)));
+    };
+    table_t orders_filtered = o->o_orderdate_days != nullptr ? filter_orders(q3_orders_days_predicate(*o))
+                                                             : filter_orders(q3_orders_predicate(*o));
+    auto timer_selections_2 = rdtscp_s();
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, l->numTuples, predicate, rows(l->l_orderkey));
+    };
+    table_t lineitem_filtered = l->l_shipdate_days != nullptr ? filter_lineitems(q3_lineitem_days_predicate(*l))
+                                                              : filter_lineitems(q3_lineitem_predicate(*l));
+#endif
+    auto timer_selections_3 = rdtscp_s();
+    t.selection_1 = timer_selections_1 - timer_start;
+    t.selection_2 = timer_selections_2 - timer_selections_1;
+    t.selection_3 = timer_selections_3 - timer_selections_2;
+
+    // lineitem -> orders -> customers
+    logger(INFO, "Probe lineitems=%u through orders=%u and customers=%u", lineitem_filtered.num_tuples,
+           orders_filtered.num_tuples, customers_filtered.num_tuples);
+    const probe_stage_t stages[] = {{&orders_filtered, q3_orders_stage, nullptr},
+                                    {&customers_filtered, nullptr, nullptr}};
+    config->MATERIALIZE = false;
+    result_t *join_result = multiway_probe_join(&lineitem_filtered, stages, 2, config);
+    *result = *join_result;
+    free(join_result);
+    auto timerEnd = rdtscp_s();
+    t.join_1 = timerEnd - timer_selections_3;
+    logger(INFO, "Join 1 timer (cycles) : %lu", t.join_1);
+
+    //clean up
+    free(customers_filtered.tuples);
+    free(orders_filtered.tuples);
+    free(lineitem_filtered.tuples);
+
+    // print
+    uint64_t numTuples = (l->numTuples + o->numTuples + c->numTuples);
+    t.total = timerEnd - timer_start;
+    print_query_results(timers_to_us(t), numTuples);
+    result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
+}
+
+void
+tpch_q10(result_t *result, const CustomerTable *c, const OrdersTable *o, const LineItemTable *l, const NationTable *n,
+         const char *algorithm, joinconfig_t *config) {
+    (void) algorithm;
+    logger(INFO, "%s", __FUNCTION__);
+    logger(INFO, "CustomerTable: %u, OrdersTable size: %u, LineItemTable size: %u, NationTable: %u", c->numTuples,
+           o->numTuples, l->numTuples, n->numTuples);
+    TPCHTimers t{};
+    auto timer_start = rdtscp_s();
+
+    //selection
+    table_t customer_table{c->c_custkey, c->numTuples, 0, 0};
+    table_t nation_table{n->n_nationkey, n->numTuples, 0, 0};
+#ifndef SIMD
+    table_t filtered_orders = filter_table<OrdersTable, q10OrdersPredicate, q10OrderCopy>(*o);
+    auto timer_selection_1_end = rdtscp_s();
+    table_t lineitem_filtered = filter_table<LineItemTable, q10LineItemPredicate, q10LineItemCopy>(*l);
+#else
+    const auto filter_orders = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, o->numTuples, predicate,
+                               rows(values(o->o_custkey), payloads(o->o_orderkey)));
+    };
+    table_t filtered_orders = o->o_orderdate_days != nullptr ? filter_orders(q10_orders_days_predicate(*o))
+                                                             : filter_orders(q10_orders_predicate(*o));
+    auto timer_selection_1_end = rdtscp_s();
+    table_t lineitem_filtered = parallel_filter(config->NTHREADS, l->numTuples,
+                                                q10_lineitem_predicate(*l), rows(l->l_orderkey));
+#endif
+    auto timer_selection_2_end = rdtscp_s();
+    t.selection_1 = timer_selection_1_end - timer_start;
+    t.selection_2 = timer_selection_2_end - timer_selection_1_end;
+
+    // lineitem -> orders -> customer -> nation
+    logger(INFO, "Probe LineItem=%u through Orders=%u, Customer=%u and Nation=%u", lineitem_filtered.num_tuples,
+           filtered_orders.num_tuples, customer_table.num_tuples, nation_table.num_tuples);
+    const probe_stage_t stages[] = {{&filtered_orders, q10_orders_stage, o->o_orderkey},
+                                    {&customer_table, q10_customer_stage, c->c_nationkey},
+                                    {&nation_table, nullptr, nullptr}};
+    config->MATERIALIZE = false;
+    result_t *join_result = multiway_probe_join(&lineitem_filtered, stages, 3, config);
+    *result = *join_result;
+    free(join_result);
+    auto timer_join_1_end = rdtscp_s();
+    t.join_1 = timer_join_1_end - timer_selection_2_end;
+    logger(INFO, "Join 1 timer : %lu", t.join_1);
+    logger(INFO, "Join result tuples: %d", result->totalresults);
+
+    // clean + print
+    free(filtered_orders.tuples);
+    free(lineitem_filtered.tuples);
+
+    uint64_t numTuples = (l->numTuples + o->numTuples + c->numTuples + n->numTuples);
+    t.total = timer_join_1_end - timer_start;
+    print_query_results(timers_to_us(t), numTuples);
+    result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
+}
+#endif
+
 void
 tpch_q12(result_t *result, const LineItemTable *l, const OrdersTable *o, const char *algorithm, joinconfig_t *config) {
     logger(INFO, "%s", __FUNCTION__);
@@ -222,29 +538,53 @@ tpch_q12(result_t *result, const LineItemTable *l, const OrdersTable *o, const c
     TPCHTimers t{};
     auto timer_start = rdtscp_s();
 
-    // selection 1
+    // selection 1, of lineitem only: RF2 deletes the lineitems of the orders it deletes, so the orders it deleted
+    // find no lineitem to join with
     table_t order_table{o->o_orderkey, o->numTuples, 0, 0};
 #ifndef SIMD
-    table_t lineitem_filtered = filter_table<LineItemTable, q12Predicate, q12Copy>(*l);
+    const CodeSet<uint8_t> shipmodes = q12_shipmodes(*l);
+    table_t lineitem_filtered = filter_table_where<LineItemTable, q12Copy>(*l, [&](uint64_t row) {
+        return q12Predicate(*l, row, shipmodes);
+    });
+#elif !defined(PARTITIONED_FILTER)
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, l->numTuples, predicate, rows(l->l_orderkey));
+    };
+    table_t lineitem_filtered = q12_days_loaded(*l) ? filter_lineitems(q12_lineitem_days_predicate(*l))
+                                                    : filter_lineitems(q12_lineitem_predicate(*l));
 #else
-    table_t lineitem_filtered =
-            parallel_filter<const row_t *, const uint8_t *, const uint64_t *, const uint64_t *, const uint64_t *>(
-                    config->NTHREADS, q12_filter_lineitem, l->numTuples, l->l_orderkey, l->l_shipmode, l->l_commitdate,
-                    l->l_shipdate, l->l_receiptdate);
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter_partition(config->NTHREADS, radix_join_bits(order_table.num_tuples, config->NTHREADS),
+                                         l->numTuples, predicate, rows(l->l_orderkey));
+    };
+    partitioned_table_t *lineitem_filtered = q12_days_loaded(*l) ? filter_lineitems(q12_lineitem_days_predicate(*l))
+                                                                 : filter_lineitems(q12_lineitem_predicate(*l));
 #endif
     auto timer_selection_1_end = rdtscp_s();
     t.selection_1 = timer_selection_1_end - timer_start;
 
     // join l and o
-    logger(INFO, "Join lineitem=%u with order=%u tuples", lineitem_filtered.num_tuples, order_table.num_tuples);
     config->MATERIALIZE = false;
+#ifndef PARTITIONED_FILTER
+    logger(INFO, "Join lineitem=%u with order=%u tuples", lineitem_filtered.num_tuples, order_table.num_tuples);
     run_join(result, &order_table, &lineitem_filtered, algorithm, config);
+#else
+    logger(INFO, "Join lineitem=%u with order=%u tuples", lineitem_filtered->num_tuples, order_table.num_tuples);
+    const join_input_t order_input = table_input(&order_table);
+    const join_input_t lineitem_input = partitioned_input(lineitem_filtered);
+    run_join_chunked(result, &order_input, &lineitem_input, algorithm, config);
+#endif
     auto timer_join_1_end = rdtscp_s();
     t.join_1 = timer_join_1_end - timer_selection_1_end;
     logger(INFO, "Join 1 timer : %lu", t.join_1);
 
     // clean up + print
+#ifndef PARTITIONED_FILTER
     free(lineitem_filtered.tuples);
+#else
+    destroy_table(lineitem_filtered);
+    free(lineitem_filtered);
+#endif
     uint64_t numTuples = (l->numTuples + o->numTuples);
     t.total = timer_join_1_end - timer_start;
     print_query_results(timers_to_us(t), numTuples);
@@ -259,27 +599,52 @@ tpch_q19(result_t *result, const LineItemTable *l, const PartTable *p, const cha
     auto timer_start = rdtscp_s();
 
     //selection
+    const Q19Codes codes = q19_codes(*l, *p);
 #ifndef SIMD
-    table_t part_filtered = filter_table<PartTable, q19PartPredicate, q19PartCopy>(*p);
+    table_t part_filtered = filter_table_where<PartTable, q19PartCopy>(*p, [&](uint64_t row) {
+        return q19PartPredicate(*p, row, codes);
+    });
     auto timer_selection_1_end = rdtscp_s();
-    table_t lineitem_filtered = filter_table<LineItemTable, q19LineItemPredicate, q19LineItemCopy>(*l);
+    table_t lineitem_filtered = filter_table_where<LineItemTable, q19LineItemCopy>(*l, [&](uint64_t row) {
+        return q19LineItemPredicate(*l, row, codes);
+    });
 #else
-    table_t part_filtered = parallel_filter<const row_t *, const uint32_t *, const uint8_t *, const uint8_t *>(
-            config->NTHREADS, q19_part_filter, p->numTuples, p->p_partkey, p->p_size, p->p_brand, p->p_container);
+    table_t part_filtered =
+            parallel_filter(config->NTHREADS, p->numTuples, q19_part_predicate(*p), rows(p->p_partkey));
     auto timer_selection_1_end = rdtscp_s();
-    table_t lineitem_filtered =
-            parallel_filter<const row_t *, const type_key *, const float *, const uint8_t *, const uint8_t *>(
-                    config->NTHREADS, q19_lineitem_filter, l->numTuples, l->l_orderkey, l->l_partkey, l->l_quantity,
-                    l->l_shipmode, l->l_shipinstruct);
+#ifndef PARTITIONED_FILTER
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter(config->NTHREADS, l->numTuples, predicate,
+                               rows(values(l->l_partkey), payloads(l->l_orderkey)));
+    };
+    table_t lineitem_filtered = l->l_quantity_u8 != nullptr ? filter_lineitems(q19_lineitem_u8_predicate(*l))
+                                                            : filter_lineitems(q19_lineitem_predicate(*l));
+#else
+    const auto filter_lineitems = [&](const auto &predicate) {
+        return parallel_filter_partition(config->NTHREADS, radix_join_bits(part_filtered.num_tuples, config->NTHREADS),
+                                         l->numTuples, predicate, rows(values(l->l_partkey), payloads(l->l_orderkey)));
+    };
+    partitioned_table_t *lineitem_filtered = l->l_quantity_u8 != nullptr
+                                                     ? filter_lineitems(q19_lineitem_u8_predicate(*l))
+                                                     : filter_lineitems(q19_lineitem_predicate(*l));
+#endif
 #endif
     auto timer_selection_2_end = rdtscp_s();
     t.selection_1 = timer_selection_1_end - timer_start;
     t.selection_2 = timer_selection_2_end - timer_selection_1_end;
 
     //join 1
-    logger(INFO, "Join Part=%u with LineItem=%u", part_filtered.num_tuples, lineitem_filtered.num_tuples);
     config->MATERIALIZE = true;
+    config->OUTPUT_COLUMNS = COLUMN_RPAYLOAD | COLUMN_SPAYLOAD;
+#ifndef PARTITIONED_FILTER
+    logger(INFO, "Join Part=%u with LineItem=%u", part_filtered.num_tuples, lineitem_filtered.num_tuples);
     run_join(result, &part_filtered, &lineitem_filtered, algorithm, config);
+#else
+    logger(INFO, "Join Part=%u with LineItem=%u", part_filtered.num_tuples, lineitem_filtered->num_tuples);
+    const join_input_t part_input = table_input(&part_filtered);
+    const join_input_t lineitem_input = partitioned_input(lineitem_filtered);
+    run_join_chunked(result, &part_input, &lineitem_input, algorithm, config);
+#endif
     auto timer_join_1_end = rdtscp_s();
     t.join_1 = timer_join_1_end - timer_selection_2_end;
     logger(INFO, "Join 1 timer : %lu", t.join_1);
@@ -287,12 +652,14 @@ tpch_q19(result_t *result, const LineItemTable *l, const PartTable *p, const cha
     //filter the join results
     uint64_t matches;
     if (result->result_type == 0) {
-        matches = q19FilterJoinResults(result, l, p);
+        matches = q19FilterJoinResults(result, l, p, codes);
+    } else if (result->result_type == 2) {
+        matches = q19FilterJoinResultsColumnar(result, l, p, codes);
     } else {
         auto chunked_table = reinterpret_cast<chunked_table_t *>(result->result);
         logger(WARN, "Number of Tuples: %d", chunked_table->num_tuples);
         logger(WARN, "Number of Chunks: %d", chunked_table->num_chunks);
-        matches = q19FilterJoinResultsChunked(result, l, p);
+        matches = q19FilterJoinResultsChunked(result, l, p, codes);
     }
     auto timer_selection_3_end = rdtscp_s();
     t.selection_3 = timer_selection_3_end - timer_join_1_end;
@@ -301,9 +668,16 @@ tpch_q19(result_t *result, const LineItemTable *l, const PartTable *p, const cha
 
     // clean + print
     free(part_filtered.tuples);
+#ifndef PARTITIONED_FILTER
     free(lineitem_filtered.tuples);
+#else
+    destroy_table(lineitem_filtered);
+    free(lineitem_filtered);
+#endif
     uint64_t numTuples = (l->numTuples + p->numTuples);
     t.total = timerEnd - timer_start;
     print_query_results(timers_to_us(t), numTuples);
     result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
 }
+
+#endif
@@ -0,0 +1,192 @@
+#include "Aggregation.hpp"
+#include "JoinGraph.hpp"
+#include "Pipeline.hpp"
+#include "time_print.hpp"
+
+#include "Logger.hpp"
+#include "rdtscpWrapper.h"
+#include "tpch.hpp"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+/*
+ * The TPC-H queries that join six tables. Their join order is not fixed: the filtered tables and the join predicates
+ * go into a JoinGraph, which orders the joins by the cardinalities of the filtered tables. Like the other join
+ * queries, they end with the size of the join result unless QUERY_AGGREGATION is defined.
+ *
+ * Q9 is simplified: the LIKE '%green%' on p_name is evaluated when the tables are loaded (P_NAME_GREEN), as the part
+ * names are nearly unique and would not fit a dictionary, nations are ordered by n_nationkey instead of n_name, and
+ * the join with partsupp on (partkey, suppkey) joins on the partkey and checks the suppkey on the join result.
+ */
+
+#ifdef QUERY_AGGREGATION
+/** Year of a timestamp in seconds since 1970-01-01, days to civil date after Howard Hinnant */
+[[nodiscard]] static uint32_t
+year_of(uint64_t timestamp) {
+    const uint64_t days = timestamp / SECONDS_PER_DAY + 719468;
+    const uint64_t era = days / 146097;
+    const uint64_t day_of_era = days - era * 146097;
+    const uint64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const uint64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const uint64_t month = (5 * day_of_year + 2) / 153; // counted from March
+    return static_cast<uint32_t>(year_of_era + era * 400 + (month >= 10));
+}
+#endif
+
+void
+tpch_q5(result_t *result, const CustomerTable *c, const OrdersTable *o, const LineItemTable *l, const SupplierTable *s,
+        const NationTable *n, const RegionTable *r, const char *algorithm, joinconfig_t *config) {
+    logger(INFO, "%s", __FUNCTION__);
+    logger(INFO,
+           "CustomerTable size: %u, OrdersTable size: %u, LineItemTable size: %u, SupplierTable size: %u, "
+           "NationTable size: %u, RegionTable size: %u",
+           c->numTuples, o->numTuples, l->numTuples, s->numTuples, n->numTuples, r->numTuples);
+    const int nthreads = config->NTHREADS;
+    TPCHTimers t{};
+    auto timer_start = rdtscp_s();
+
+    JoinGraph graph(nthreads, algorithm, config);
+    const int region = graph.add_table(
+            "region", r->numTuples,
+            select_rows(nthreads, r->numTuples, col(r->r_name, r->r_name_dict) == "ASIA"));
+    const int orders = graph.add_table(
+            "orders", o->numTuples,
+            select_rows(nthreads, o->numTuples,
+                        And{And{ValueCompare<Compare::GE, uint64_t>{o->o_orderdate, TIMESTAMP_1994_01_01_SECONDS},
+                                ValueCompare<Compare::LT, uint64_t>{o->o_orderdate, TIMESTAMP_1995_01_01_SECONDS}},
+                            not_deleted(*o)}));
+    auto timer_selection_end = rdtscp_s();
+    t.selection_1 = timer_selection_end - timer_start;
+    const int nation = graph.add_table("nation", n->numTuples);
+    const int customer = graph.add_table("customer", c->numTuples);
+    const int supplier = graph.add_table("supplier", s->numTuples);
+    // RF2 deletes the lineitems of the orders it deletes, the join with the remaining orders drops them
+    const int lineitem = graph.add_table("lineitem", l->numTuples);
+
+    graph.add_join(region, key_column(r->r_regionkey), nation, key_column(n->n_regionkey), r->numTuples);
+    graph.add_join(nation, key_column(n->n_nationkey), customer, key_column(c->c_nationkey), n->numTuples);
+    graph.add_join(nation, key_column(n->n_nationkey), supplier, key_column(s->s_nationkey), n->numTuples);
+    graph.add_join(customer, key_column(c->c_nationkey), supplier, key_column(s->s_nationkey), n->numTuples);
+    graph.add_join(customer, key_column(c->c_custkey), orders, key_column(o->o_custkey), c->numTuples);
+    graph.add_join(orders, key_column(o->o_orderkey), lineitem, key_column(l->l_orderkey), o->numTuples);
+    graph.add_join(supplier, key_column(s->s_suppkey), lineitem, key_column(l->l_suppkey), s->numTuples);
+    const JoinedRows joined = graph.run(t);
+    auto timer_join_end = rdtscp_s();
+    logger(INFO, "Join result tuples: %lu", joined.size);
+    result->totalresults = static_cast<int64_t>(joined.size);
+    auto timerEnd = timer_join_end;
+
+#ifdef QUERY_AGGREGATION
+    // revenue per nation, by revenue descending
+    HashAggregation<DecimalSum> revenue(nthreads);
+    const type_value *nations = joined.rows[nation].data();
+    const type_value *lineitems = joined.rows[lineitem].data();
+    scan_table(nthreads, joined.size, [&](int thread_id) {
+        return revenue.sink(thread_id, [n, l, nations, lineitems](uint64_t i) {
+            return std::pair{n->n_nationkey[nations[i]].key, DecimalSum{lineitem_revenue(l, lineitems[i])}};
+        });
+    });
+    const auto groups = revenue.finish();
+    const auto order = top_k(nthreads, decimal_scores(nthreads, groups.states).data(), groups.size(),
+                             static_cast<uint32_t>(groups.size()), [&groups](uint64_t a, uint64_t b) {
+        if (groups.states[a].value != groups.states[b].value) {
+            return groups.states[a].value > groups.states[b].value;
+        }
+        return groups.keys[a] < groups.keys[b];
+    });
+    for (const auto group: order) {
+        char formatted[DECIMAL_CHARS];
+        logger(INFO, "n_nationkey=%u revenue=%s", groups.keys[group],
+               format_decimal(formatted, groups.states[group].value, 2 * DECIMAL_SCALE));
+    }
+    timerEnd = rdtscp_s();
+    t.aggregation = timerEnd - timer_join_end;
+#endif
+
+    uint64_t numTuples = c->numTuples + o->numTuples + l->numTuples + s->numTuples + n->numTuples + r->numTuples;
+    t.total = timerEnd - timer_start;
+    print_query_results(timers_to_us(t), numTuples);
+    result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
+}
+
+void
+tpch_q9(result_t *result, const PartTable *p, const SupplierTable *s, const LineItemTable *l, const PartSuppTable *ps,
+        const OrdersTable *o, const NationTable *n, const char *algorithm, joinconfig_t *config) {
+    logger(INFO, "%s", __FUNCTION__);
+    logger(INFO,
+           "PartTable size: %u, SupplierTable size: %u, LineItemTable size: %u, PartSuppTable size: %u, "
+           "OrdersTable size: %u, NationTable size: %u",
+           p->numTuples, s->numTuples, l->numTuples, ps->numTuples, o->numTuples, n->numTuples);
+    const int nthreads = config->NTHREADS;
+    TPCHTimers t{};
+    auto timer_start = rdtscp_s();
+
+    JoinGraph graph(nthreads, algorithm, config);
+    const int part = graph.add_table(
+            "part", p->numTuples,
+            select_rows(nthreads, p->numTuples, ValueCompare<Compare::EQ, uint8_t>{p->p_name, P_NAME_GREEN}));
+    auto timer_selection_end = rdtscp_s();
+    t.selection_1 = timer_selection_end - timer_start;
+    const int supplier = graph.add_table("supplier", s->numTuples);
+    const int lineitem = graph.add_table("lineitem", l->numTuples);
+    const int partsupp = graph.add_table("partsupp", ps->numTuples);
+    // without the orders deleted by RF2, the join with orders drops their lineitems as well
+    const int orders = o->o_deleted == nullptr
+                               ? graph.add_table("orders", o->numTuples)
+                               : graph.add_table("orders", o->numTuples,
+                                                 select_rows(nthreads, o->numTuples, not_deleted(*o)));
+    const int nation = graph.add_table("nation", n->numTuples);
+
+    graph.add_join(part, key_column(p->p_partkey), lineitem, key_column(l->l_partkey), p->numTuples);
+    graph.add_join(part, key_column(p->p_partkey), partsupp, key_column(ps->ps_partkey), p->numTuples);
+    graph.add_join(partsupp, key_column(ps->ps_partkey), lineitem, key_column(l->l_partkey), p->numTuples);
+    graph.add_join(partsupp, key_column(ps->ps_suppkey), lineitem, key_column(l->l_suppkey), s->numTuples);
+    graph.add_join(supplier, key_column(s->s_suppkey), lineitem, key_column(l->l_suppkey), s->numTuples);
+    graph.add_join(supplier, key_column(s->s_suppkey), partsupp, key_column(ps->ps_suppkey), s->numTuples);
+    graph.add_join(orders, key_column(o->o_orderkey), lineitem, key_column(l->l_orderkey), o->numTuples);
+    graph.add_join(nation, key_column(n->n_nationkey), supplier, key_column(s->s_nationkey), n->numTuples);
+    const JoinedRows joined = graph.run(t);
+    auto timer_join_end = rdtscp_s();
+    logger(INFO, "Join result tuples: %lu", joined.size);
+    result->totalresults = static_cast<int64_t>(joined.size);
+    auto timerEnd = timer_join_end;
+
+#ifdef QUERY_AGGREGATION
+    // profit per nation and year, by nation and year descending
+    HashAggregation<DecimalSum> profit(nthreads);
+    const type_value *nations = joined.rows[nation].data();
+    const type_value *lineitems = joined.rows[lineitem].data();
+    const type_value *partsupps = joined.rows[partsupp].data();
+    const type_value *orders_rows = joined.rows[orders].data();
+    scan_table(nthreads, joined.size, [&](int thread_id) {
+        return profit.sink(thread_id, [n, l, ps, o, nations, lineitems, partsupps, orders_rows](uint64_t i) {
+            const type_key group = n->n_nationkey[nations[i]].key << 16 | year_of(o->o_orderdate[orders_rows[i]]);
+            const int64_t amount = lineitem_revenue(l, lineitems[i]) -
+                                   lineitem_supplycost(ps, partsupps[i], l, lineitems[i]);
+            return std::pair{group, DecimalSum{amount}};
+        });
+    });
+    const auto groups = profit.finish();
+    std::vector<uint64_t> order(groups.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&groups](uint64_t a, uint64_t b) {
+        if (groups.keys[a] >> 16 != groups.keys[b] >> 16) {
+            return groups.keys[a] >> 16 < groups.keys[b] >> 16;
+        }
+        return groups.keys[a] > groups.keys[b];
+    });
+    for (const auto group: order) {
+        char formatted[DECIMAL_CHARS];
+        logger(INFO, "n_nationkey=%u o_year=%u sum_profit=%s", groups.keys[group] >> 16, groups.keys[group] & 0xFFFF,
+               format_decimal(formatted, groups.states[group].value, 2 * DECIMAL_SCALE));
+    }
+    timerEnd = rdtscp_s();
+    t.aggregation = timerEnd - timer_join_end;
+#endif
+
+    uint64_t numTuples = p->numTuples + s->numTuples + l->numTuples + ps->numTuples + o->numTuples + n->numTuples;
+    t.total = timerEnd - timer_start;
+    print_query_results(timers_to_us(t), numTuples);
+    result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
+}
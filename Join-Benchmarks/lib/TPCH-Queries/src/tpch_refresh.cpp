@@ -0,0 +1,869 @@
+#include "tpch_refresh.hpp"
+#include "Predicates.hpp"
+
+#include "Decimal.hpp"
+#include "Dictionary.hpp"
+#include "Logger.hpp"
+#include "WorkerPool.hpp"
+#include "rdtscpWrapper.h"
+#include "util.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <pthread.h>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#ifndef ENCLAVE
+#include "ocalls.hpp"
+#else
+#include "ocalls_t.h"
+#endif
+
+static_assert(MORSEL_TUPLES == ZONE_ROWS, "a merge rebuilds one zone per morsel");
+
+/** Lineitems TPC-H generates for an order at most, the delta reserves room for as many per order */
+constexpr uint64_t MAX_LINES_PER_ORDER = 7;
+
+/** End of the lineitem list of an order, and the row of an orderkey that is not in the index */
+constexpr uint32_t NO_ROW = UINT32_MAX;
+
+/** The tables from one merge to the next: the main rows of the merge, then the rows inserted since */
+struct refresh_version_t {
+    OrdersTable o;
+    LineItemTable l;
+    uint64_t o_main;
+    uint64_t l_main;
+    uint64_t o_capacity;
+    uint64_t l_capacity;
+    uint64_t o_deleted_rows;
+    uint64_t l_deleted_rows;
+    tuple_t *index; // orderkey -> row of the order, open addressing, key 0 marks a free slot
+    uint32_t index_bits;
+    uint32_t *first_line; // first lineitem of every order, NO_ROW if it has none
+    uint32_t *next_line;  // next lineitem of the same order
+};
+
+struct refresh_store_t {
+    refresh_version_t *version;
+    uint64_t delta_orders;
+    int nthreads;
+    uint64_t merges;
+    uint64_t forced_merges;
+    uint64_t merge_cycles;
+    uint64_t install_cycles;
+    uint64_t wait_cycles;
+
+    // reader-writer lock of the version, writers go first so that a stream of queries cannot starve them
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    uint32_t readers;
+    uint32_t waiting_writers;
+    bool writer;
+    bool merging;
+};
+
+static void
+lock_shared(refresh_store_t *store) {
+    pthread_mutex_lock(&store->mutex);
+    while (store->writer || store->waiting_writers > 0) {
+        pthread_cond_wait(&store->changed, &store->mutex);
+    }
+    ++store->readers;
+    pthread_mutex_unlock(&store->mutex);
+}
+
+static void
+unlock_shared(refresh_store_t *store) {
+    pthread_mutex_lock(&store->mutex);
+    if (--store->readers == 0) {
+        pthread_cond_broadcast(&store->changed);
+    }
+    pthread_mutex_unlock(&store->mutex);
+}
+
+static void
+lock_exclusive(refresh_store_t *store) {
+    pthread_mutex_lock(&store->mutex);
+    ++store->waiting_writers;
+    while (store->writer || store->readers > 0) {
+        pthread_cond_wait(&store->changed, &store->mutex);
+    }
+    --store->waiting_writers;
+    store->writer = true;
+    pthread_mutex_unlock(&store->mutex);
+}
+
+static void
+unlock_exclusive(refresh_store_t *store) {
+    pthread_mutex_lock(&store->mutex);
+    store->writer = false;
+    pthread_cond_broadcast(&store->changed);
+    pthread_mutex_unlock(&store->mutex);
+}
+
+static bool
+merge_running(refresh_store_t *store) {
+    pthread_mutex_lock(&store->mutex);
+    const bool merging = store->merging;
+    pthread_mutex_unlock(&store->mutex);
+    return merging;
+}
+
+static void
+wait_for_merge(refresh_store_t *store) {
+    pthread_mutex_lock(&store->mutex);
+    while (store->merging) {
+        pthread_cond_wait(&store->changed, &store->mutex);
+    }
+    pthread_mutex_unlock(&store->mutex);
+}
+
+/* Calls column(target, source) for the columns an insert copies, and for their narrow encodings it derives */
+
+template<typename Function>
+static void
+copied_columns(OrdersTable &t, const OrdersTable &s, Function &&column) {
+    column(t.o_orderkey, s.o_orderkey);
+    column(t.o_orderdate, s.o_orderdate);
+    column(t.o_custkey, s.o_custkey);
+    column(t.o_orderpriority, s.o_orderpriority);
+    column(t.o_shippriority, s.o_shippriority);
+}
+
+template<typename Function>
+static void
+derived_columns(OrdersTable &t, const OrdersTable &s, Function &&column) {
+    column(t.o_orderdate_days, s.o_orderdate_days);
+}
+
+template<typename Function>
+static void
+copied_columns(LineItemTable &t, const LineItemTable &s, Function &&column) {
+    column(t.l_orderkey, s.l_orderkey);
+    column(t.l_shipdate, s.l_shipdate);
+    column(t.l_commitdate, s.l_commitdate);
+    column(t.l_receiptdate, s.l_receiptdate);
+    column(t.l_shipmode, s.l_shipmode);
+    column(t.l_partkey, s.l_partkey);
+    column(t.l_quantity, s.l_quantity);
+    column(t.l_shipinstruct, s.l_shipinstruct);
+    column(t.l_returnflag, s.l_returnflag);
+    column(t.l_extendedprice, s.l_extendedprice);
+    column(t.l_discount, s.l_discount);
+    column(t.l_tax, s.l_tax);
+    column(t.l_linestatus, s.l_linestatus);
+    column(t.l_suppkey, s.l_suppkey);
+}
+
+template<typename Function>
+static void
+derived_columns(LineItemTable &t, const LineItemTable &s, Function &&column) {
+    column(t.l_shipdate_days, s.l_shipdate_days);
+    column(t.l_commitdate_days, s.l_commitdate_days);
+    column(t.l_receiptdate_days, s.l_receiptdate_days);
+    column(t.l_quantity_u8, s.l_quantity_u8);
+    column(t.l_quantity_dec, s.l_quantity_dec);
+    column(t.l_extendedprice_dec, s.l_extendedprice_dec);
+    column(t.l_discount_dec, s.l_discount_dec);
+    column(t.l_tax_dec, s.l_tax_dec);
+}
+
+/* Calls column(codes, dictionary, other) for the dictionary-encoded columns of t, other is the dictionary of s */
+
+template<typename Function>
+static void
+dictionary_columns(OrdersTable &t, const OrdersTable &s, Function &&column) {
+    column(t.o_orderpriority, t.o_orderpriority_dict, s.o_orderpriority_dict);
+}
+
+template<typename Function>
+static void
+dictionary_columns(LineItemTable &t, const LineItemTable &s, Function &&column) {
+    column(t.l_shipmode, t.l_shipmode_dict, s.l_shipmode_dict);
+    column(t.l_shipinstruct, t.l_shipinstruct_dict, s.l_shipinstruct_dict);
+}
+
+/* Calls zone_map(zones, column) for the zone maps of a table and the columns they summarize */
+
+template<typename Function>
+static void
+zone_maps(OrdersTable &t, Function &&zone_map) {
+    zone_map(t.o_orderdate_zones, t.o_orderdate);
+    zone_map(t.o_orderdate_days_zones, t.o_orderdate_days);
+}
+
+template<typename Function>
+static void
+zone_maps(LineItemTable &t, Function &&zone_map) {
+    zone_map(t.l_shipdate_zones, t.l_shipdate);
+    zone_map(t.l_commitdate_zones, t.l_commitdate);
+    zone_map(t.l_receiptdate_zones, t.l_receiptdate);
+    zone_map(t.l_shipdate_days_zones, t.l_shipdate_days);
+    zone_map(t.l_commitdate_days_zones, t.l_commitdate_days);
+    zone_map(t.l_receiptdate_days_zones, t.l_receiptdate_days);
+}
+
+static uint64_t
+zones_of(uint64_t rows) {
+    return (rows + ZONE_ROWS - 1) / ZONE_ROWS;
+}
+
+/** Words of a delete bitmap of rows rows, with the word beyond the last row that NotDeleted reads */
+static uint64_t
+bitmap_words(uint64_t rows) {
+    return rows / 64 + 2;
+}
+
+template<typename T>
+static T *
+allocate(uint64_t count) {
+    auto *values = static_cast<T *>(aligned_alloc(64, std::max<uint64_t>((count * sizeof(T) + 63) / 64 * 64, 64)));
+    malloc_check(values)
+    return values;
+}
+
+template<typename T>
+static T *
+allocate_zeroed(uint64_t count) {
+    auto *values = static_cast<T *>(calloc(std::max<uint64_t>(count, 1), sizeof(T)));
+    malloc_check(values)
+    return values;
+}
+
+/** Gives table the columns and zone maps of shape for capacity rows. A zone map is only allocated with its column. */
+template<typename Table>
+static void
+allocate_table(Table &table, const Table &shape, uint64_t capacity) {
+    // the pointers of shape, replaced by allocations where they are set
+    table = shape;
+    table.numTuples = 0;
+    const auto allocate_like = [capacity](auto *&target, const auto *) {
+        if (target != nullptr) {
+            target = allocate<std::remove_reference_t<decltype(*target)>>(capacity);
+        }
+    };
+    copied_columns(table, shape, allocate_like);
+    derived_columns(table, shape, allocate_like);
+    zone_maps(table, [capacity](zone_t *&zones, const auto *column) {
+        zones = zones != nullptr && column != nullptr ? allocate<zone_t>(zones_of(capacity)) : nullptr;
+    });
+    // the dictionaries of shape may go with its version
+    dictionary_columns(table, shape, [](const uint8_t *, dictionary_t &dictionary, const dictionary_t &) {
+        if (dictionary.values != nullptr) {
+            char *values = allocate<char>(dictionary.size);
+            memcpy(values, dictionary.values, dictionary.size);
+            dictionary.values = values;
+        }
+    });
+}
+
+template<typename Table>
+static void
+free_table(Table &table) {
+    const auto free_column = [](auto *&target, const auto *) {
+        free(target);
+        target = nullptr;
+    };
+    copied_columns(table, table, free_column);
+    derived_columns(table, table, free_column);
+    zone_maps(table, [](zone_t *&zones, const auto *) {
+        free(zones);
+        zones = nullptr;
+    });
+    dictionary_columns(table, table, [](const uint8_t *, dictionary_t &dictionary, const dictionary_t &) {
+        free(dictionary.values);
+        dictionary = {};
+    });
+}
+
+static void
+free_version(refresh_version_t *version) {
+    free_table(version->o);
+    free_table(version->l);
+    free(version->o.o_deleted);
+    free(version->o.o_deleted_zones);
+    free(version->l.l_deleted);
+    free(version->l.l_deleted_zones);
+    free(version->index);
+    free(version->first_line);
+    free(version->next_line);
+    delete version;
+}
+
+/* The orderkey index */
+
+static uint64_t
+index_slot(const refresh_version_t &version, type_key key) {
+    return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> (64 - version.index_bits);
+}
+
+/** @return the row of the order, NO_ROW if the orderkey is not in the index */
+static uint32_t
+find_order(const refresh_version_t &version, type_key key) {
+    const uint64_t mask = (uint64_t{1} << version.index_bits) - 1;
+    for (uint64_t slot = index_slot(version, key);; slot = (slot + 1) & mask) {
+        if (version.index[slot].key == key) {
+            return version.index[slot].payload;
+        }
+        if (version.index[slot].key == 0) {
+            return NO_ROW;
+        }
+    }
+}
+
+static void
+index_order(refresh_version_t &version, type_key key, uint32_t row) {
+    const uint64_t mask = (uint64_t{1} << version.index_bits) - 1;
+    uint64_t slot = index_slot(version, key);
+    while (version.index[slot].key != 0 && version.index[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    version.index[slot] = {key, row};
+}
+
+/** Adds the lineitem at row to the list of its order, if the order is in the table */
+static void
+link_line(refresh_version_t &version, uint64_t row, uint32_t order) {
+    if (order == NO_ROW) {
+        version.next_line[row] = NO_ROW;
+        return;
+    }
+    version.next_line[row] = version.first_line[order];
+    version.first_line[order] = static_cast<uint32_t>(row);
+}
+
+/** Marks a row deleted, @return false if it was deleted before */
+static bool
+mark_deleted(uint64_t *deleted, uint32_t *zone_deletes, uint64_t row) {
+    const uint64_t bit = uint64_t{1} << (row % 64);
+    if (deleted[row / 64] & bit) {
+        return false;
+    }
+    deleted[row / 64] |= bit;
+    ++zone_deletes[row / ZONE_ROWS];
+    return true;
+}
+
+/* Merges */
+
+/**
+ * Rows not set in the delete bitmap before every word of it, which is the row the first live row of the word gets in
+ * the merged table. deleted may be nullptr if no row is deleted.
+ */
+static std::vector<uint32_t>
+live_before_words(const uint64_t *deleted, uint64_t rows, int nthreads) {
+    const uint64_t words = (rows + 63) / 64;
+    std::vector<uint32_t> live_before(words + 1);
+    WorkerPool::global().for_each_morsel(nthreads, words, MORSEL_TUPLES / 64, [&](int, uint64_t begin, uint64_t end) {
+        for (uint64_t word = begin; word < end; ++word) {
+            const uint64_t word_rows = std::min<uint64_t>(64, rows - word * 64);
+            const uint64_t deleted_rows = deleted == nullptr ? 0 : __builtin_popcountll(deleted[word]);
+            live_before[word + 1] = static_cast<uint32_t>(word_rows - deleted_rows);
+        }
+    });
+    for (uint64_t word = 0; word < words; ++word) {
+        live_before[word + 1] += live_before[word];
+    }
+    return live_before;
+}
+
+/** Copies the live rows of source in [begin, end) to target from row to on, begin is a multiple of 64 */
+template<typename T>
+static void
+compact_column(T *target, const T *source, const uint64_t *deleted, uint64_t begin, uint64_t end, uint64_t to) {
+    const uint64_t first = to;
+    if (deleted == nullptr) {
+        memcpy(target + to, source + begin, (end - begin) * sizeof(T));
+        to += end - begin;
+    } else {
+        for (uint64_t row = begin; row < end; row += 64) {
+            const uint64_t rows = std::min<uint64_t>(64, end - row);
+            uint64_t live = ~deleted[row / 64] & (rows == 64 ? ~uint64_t{0} : (uint64_t{1} << rows) - 1);
+            if (live == ~uint64_t{0}) {
+                memcpy(target + to, source + row, 64 * sizeof(T));
+                to += 64;
+                continue;
+            }
+            for (; live != 0; live &= live - 1) {
+                target[to++] = source[row + __builtin_ctzll(live)];
+            }
+        }
+    }
+    if constexpr (std::is_same_v<T, tuple_t>) {
+        // the payloads are the row IDs
+        for (uint64_t row = first; row < to; ++row) {
+            target[row].payload = static_cast<type_value>(row);
+        }
+    }
+}
+
+template<typename Table>
+static void
+compact_table(Table &target, const Table &source, const uint64_t *deleted, const std::vector<uint32_t> &live_before,
+              int nthreads) {
+    WorkerPool::global().for_each_morsel(nthreads, source.numTuples, MORSEL_TUPLES,
+                                         [&](int, uint64_t begin, uint64_t end) {
+        const uint64_t to = live_before[begin / 64];
+        const auto compact = [&](auto *target_column, const auto *source_column) {
+            if (target_column != nullptr) {
+                compact_column(target_column, source_column, deleted, begin, end, to);
+            }
+        };
+        copied_columns(target, source, compact);
+        derived_columns(target, source, compact);
+    });
+    target.numTuples = live_before.back();
+    WorkerPool::global().for_each_morsel(nthreads, target.numTuples, ZONE_ROWS, [&](int, uint64_t begin, uint64_t end) {
+        zone_maps(target, [&](zone_t *zones, const auto *column) {
+            if (zones == nullptr) {
+                return;
+            }
+            const auto [min, max] = std::minmax_element(column + begin, column + end);
+            zones[begin / ZONE_ROWS] = {static_cast<uint64_t>(*min), static_cast<uint64_t>(*max)};
+        });
+    });
+}
+
+/** Builds the orderkey index and the lineitem lists of a version */
+static void
+index_version(refresh_version_t &version) {
+    uint32_t bits = 1;
+    while ((uint64_t{1} << bits) < 2 * version.o_capacity) {
+        ++bits;
+    }
+    version.index_bits = bits;
+    version.index = allocate_zeroed<tuple_t>(uint64_t{1} << bits);
+    version.first_line = allocate<uint32_t>(version.o_capacity);
+    version.next_line = allocate<uint32_t>(version.l_capacity);
+    for (uint64_t row = 0; row < version.o.numTuples; ++row) {
+        index_order(version, version.o.o_orderkey[row].key, static_cast<uint32_t>(row));
+        version.first_line[row] = NO_ROW;
+    }
+    // backwards, so that every list is in the order of the rows; the lineitems of an order are adjacent
+    type_key last_key = 0;
+    uint32_t order = NO_ROW;
+    for (uint64_t row = version.l.numTuples; row-- > 0;) {
+        const type_key key = version.l.l_orderkey[row].key;
+        if (key != last_key) {
+            last_key = key;
+            order = find_order(version, key);
+        }
+        link_line(version, row, order);
+    }
+}
+
+/**
+ * Builds a version of the live rows of o and l, with room for delta_orders orders and delta_lines lineitems behind
+ * them. The delete bitmaps may be nullptr, live_before are their live_before_words().
+ */
+static refresh_version_t *
+build_version(const OrdersTable &o, const LineItemTable &l, const uint64_t *o_deleted, const uint64_t *l_deleted,
+              const std::vector<uint32_t> &o_live_before, const std::vector<uint32_t> &l_live_before,
+              uint64_t delta_orders, uint64_t delta_lines, int nthreads) {
+    auto *version = new refresh_version_t{};
+    version->o_capacity = o_live_before.back() + delta_orders;
+    version->l_capacity = l_live_before.back() + delta_lines;
+    if (version->l_capacity >= NO_ROW) {
+        logger(ERROR, "The refreshed tables exceed the row IDs of the joins");
+        ocall_exit(EXIT_FAILURE);
+    }
+    allocate_table(version->o, o, version->o_capacity);
+    allocate_table(version->l, l, version->l_capacity);
+    version->o.o_deleted = allocate_zeroed<uint64_t>(bitmap_words(version->o_capacity));
+    version->o.o_deleted_zones = allocate_zeroed<uint32_t>(zones_of(version->o_capacity));
+    version->l.l_deleted = allocate_zeroed<uint64_t>(bitmap_words(version->l_capacity));
+    version->l.l_deleted_zones = allocate_zeroed<uint32_t>(zones_of(version->l_capacity));
+
+    compact_table(version->o, o, o_deleted, o_live_before, nthreads);
+    compact_table(version->l, l, l_deleted, l_live_before, nthreads);
+    version->o_main = version->o.numTuples;
+    version->l_main = version->l.numTuples;
+    index_version(*version);
+    return version;
+}
+
+/** A merge of all rows of version, with room for at least delta_orders orders behind them */
+static refresh_version_t *
+merge_version(const refresh_version_t &version, uint64_t delta_orders, int nthreads) {
+    const auto o_live_before = live_before_words(version.o.o_deleted, version.o.numTuples, nthreads);
+    const auto l_live_before = live_before_words(version.l.l_deleted, version.l.numTuples, nthreads);
+    return build_version(version.o, version.l, version.o.o_deleted, version.l.l_deleted, o_live_before,
+                         l_live_before, delta_orders, delta_orders * MAX_LINES_PER_ORDER, nthreads);
+}
+
+/* Appends */
+
+template<typename Table>
+static void
+widen_zones(Table &table, uint64_t row) {
+    zone_maps(table, [row](zone_t *zones, const auto *column) {
+        if (zones == nullptr) {
+            return;
+        }
+        const auto value = static_cast<uint64_t>(column[row]);
+        zone_t &zone = zones[row / ZONE_ROWS];
+        if (row % ZONE_ROWS == 0) {
+            zone = {value, value};
+        } else {
+            zone.min = std::min(zone.min, value);
+            zone.max = std::max(zone.max, value);
+        }
+    });
+}
+
+/** Appends row of source to the orders of version */
+static void
+append_order(refresh_version_t &version, const OrdersTable &source, uint64_t row) {
+    OrdersTable &o = version.o;
+    const uint64_t to = o.numTuples;
+    copied_columns(o, source, [row, to](auto *target, const auto *column) {
+        if (target != nullptr) {
+            target[to] = column[row];
+        }
+    });
+    o.o_orderkey[to].payload = static_cast<type_value>(to);
+    if (o.o_orderdate_days != nullptr) {
+        o.o_orderdate_days[to] = static_cast<uint16_t>(o.o_orderdate[to] / SECONDS_PER_DAY);
+    }
+    widen_zones(o, to);
+    index_order(version, o.o_orderkey[to].key, static_cast<uint32_t>(to));
+    version.first_line[to] = NO_ROW;
+    o.numTuples = to + 1;
+}
+
+/** Appends row of source to the lineitems of version and to the list of its order */
+static void
+append_line(refresh_version_t &version, const LineItemTable &source, uint64_t row) {
+    LineItemTable &l = version.l;
+    const uint64_t to = l.numTuples;
+    copied_columns(l, source, [row, to](auto *target, const auto *column) {
+        if (target != nullptr) {
+            target[to] = column[row];
+        }
+    });
+    l.l_orderkey[to].payload = static_cast<type_value>(to);
+    const auto to_days = [to](uint16_t *days, const uint64_t *seconds) {
+        if (days != nullptr) {
+            days[to] = static_cast<uint16_t>(seconds[to] / SECONDS_PER_DAY);
+        }
+    };
+    to_days(l.l_shipdate_days, l.l_shipdate);
+    to_days(l.l_commitdate_days, l.l_commitdate);
+    to_days(l.l_receiptdate_days, l.l_receiptdate);
+    if (l.l_quantity_u8 != nullptr) {
+        l.l_quantity_u8[to] = static_cast<uint8_t>(l.l_quantity[to]);
+    }
+    const auto to_dec = [to](decimal_t *decimals, const float *values) {
+        if (decimals != nullptr) {
+            decimals[to] = to_decimal(values[to]);
+        }
+    };
+    to_dec(l.l_quantity_dec, l.l_quantity);
+    to_dec(l.l_extendedprice_dec, l.l_extendedprice);
+    to_dec(l.l_discount_dec, l.l_discount);
+    to_dec(l.l_tax_dec, l.l_tax);
+    widen_zones(l, to);
+    link_line(version, to, find_order(version, l.l_orderkey[to].key));
+    l.numTuples = to + 1;
+}
+
+/** @return true if every column of target is in source as well */
+template<typename Table>
+static bool
+has_columns(Table target, const Table &source) {
+    bool present = true;
+    copied_columns(target, source, [&](const auto *column, const auto *source_column) {
+        present &= column == nullptr || source_column != nullptr;
+    });
+    return present;
+}
+
+/**
+ * Replaces the string columns of source by copies in the codes of the dictionaries of target, which recoded keeps. A
+ * value target does not hold gets the code of the empty value if target has one, which stands for the values a legacy
+ * dictionary does not distinguish. Columns are copied as they are if either table has no dictionary for them.
+ * @return false if a row of source has a value that target cannot encode
+ */
+template<typename Table>
+static bool
+recode_table(Table &source, const Table &target, std::vector<std::unique_ptr<uint8_t[]>> &recoded) {
+    bool encoded = true;
+    dictionary_columns(source, target, [&](uint8_t *&codes, dictionary_t &dictionary, const dictionary_t &other) {
+        if (codes == nullptr || dictionary.values == nullptr || other.values == nullptr ||
+            dictionary_equal(dictionary, other)) {
+            return;
+        }
+        const uint32_t empty = dictionary_code(other, "");
+        std::vector<uint32_t> code_map(dictionary.num_values);
+        for (uint32_t code = 0; code < dictionary.num_values; ++code) {
+            const uint32_t mapped = dictionary_code(other, dictionary_value(dictionary, code));
+            code_map[code] = mapped < other.num_values ? mapped : empty;
+        }
+        recoded.emplace_back(new uint8_t[std::max<uint64_t>(source.numTuples, 1)]);
+        uint8_t *copy = recoded.back().get();
+        for (uint64_t row = 0; row < source.numTuples; ++row) {
+            const uint32_t mapped = codes[row] < code_map.size() ? code_map[codes[row]] : other.num_values;
+            encoded &= mapped < other.num_values;
+            copy[row] = static_cast<uint8_t>(mapped);
+        }
+        codes = copy;
+        dictionary = other;
+    });
+    return encoded;
+}
+
+/* The store */
+
+refresh_store_t *
+refresh_store_create(const OrdersTable *o, const LineItemTable *l, uint64_t delta_orders, int nthreads) {
+    uint64_t start = rdtscp_s();
+    auto *store = new refresh_store_t{};
+    store->delta_orders = std::max<uint64_t>(delta_orders, 1);
+    store->nthreads = std::max(nthreads, 1);
+    pthread_mutex_init(&store->mutex, nullptr);
+    pthread_cond_init(&store->changed, nullptr);
+    store->version = build_version(*o, *l, nullptr, nullptr, live_before_words(nullptr, o->numTuples, store->nthreads),
+                                   live_before_words(nullptr, l->numTuples, store->nthreads), store->delta_orders,
+                                   store->delta_orders * MAX_LINES_PER_ORDER, store->nthreads);
+    logger(INFO, "Refresh store of %lu orders and %lu lineitems, delta of %lu orders, created in %lu cycles",
+           o->numTuples, l->numTuples, store->delta_orders, rdtscp_s() - start);
+    return store;
+}
+
+void
+refresh_store_free(refresh_store_t *store) {
+    free_version(store->version);
+    pthread_mutex_destroy(&store->mutex);
+    pthread_cond_destroy(&store->changed);
+    delete store;
+}
+
+uint64_t
+refresh_insert(refresh_store_t *store, const OrdersTable *o, const LineItemTable *l) {
+    lock_exclusive(store);
+    refresh_version_t *version = store->version;
+    if (!has_columns(version->o, *o) || !has_columns(version->l, *l)) {
+        unlock_exclusive(store);
+        logger(ERROR, "RF1 misses columns of the refreshed tables");
+        return 0;
+    }
+    // the dictionaries stay the same across merges
+    std::vector<std::unique_ptr<uint8_t[]>> recoded;
+    OrdersTable orders = *o;
+    LineItemTable lineitems = *l;
+    if (!recode_table(orders, version->o, recoded) || !recode_table(lineitems, version->l, recoded)) {
+        unlock_exclusive(store);
+        logger(ERROR, "RF1 has values the dictionaries of the refreshed tables do not hold");
+        return 0;
+    }
+    while (version->o.numTuples + o->numTuples > version->o_capacity ||
+           version->l.numTuples + l->numTuples > version->l_capacity) {
+        if (merge_running(store)) {
+            // the running merge makes room
+            unlock_exclusive(store);
+            wait_for_merge(store);
+            lock_exclusive(store);
+            version = store->version;
+            continue;
+        }
+        const uint64_t delta_orders = std::max(
+                {store->delta_orders, o->numTuples, (l->numTuples + MAX_LINES_PER_ORDER - 1) / MAX_LINES_PER_ORDER});
+        logger(WARN, "RF1 of %lu orders does not fit into the delta, merging first", o->numTuples);
+        refresh_version_t *merged = merge_version(*version, delta_orders, store->nthreads);
+        free_version(version);
+        store->version = version = merged;
+        ++store->forced_merges;
+    }
+
+    // orders stored before this RF1 are skipped with their lineitems, repeated orders of the batch keep theirs
+    std::unordered_set<type_key> appended;
+    std::unordered_set<type_key> skipped;
+    uint64_t repeated = 0;
+    for (uint64_t row = 0; row < o->numTuples; ++row) {
+        const type_key key = o->o_orderkey[row].key;
+        if (appended.count(key) != 0) {
+            ++repeated;
+            continue;
+        }
+        if (key == 0 || find_order(*version, key) != NO_ROW) {
+            skipped.insert(key);
+            continue;
+        }
+        append_order(*version, orders, row);
+        appended.insert(key);
+    }
+    for (uint64_t row = 0; row < l->numTuples; ++row) {
+        if (skipped.empty() || skipped.count(l->l_orderkey[row].key) == 0) {
+            append_line(*version, lineitems, row);
+        }
+    }
+    unlock_exclusive(store);
+    if (!skipped.empty() || repeated > 0) {
+        logger(WARN, "RF1 skipped %lu orders that are in the table already and %lu repeated orders", skipped.size(),
+               repeated);
+    }
+    return appended.size();
+}
+
+/** Deletes the order at row and its lineitems */
+static bool
+delete_order(refresh_version_t &version, uint32_t row) {
+    if (!mark_deleted(version.o.o_deleted, version.o.o_deleted_zones, row)) {
+        return false;
+    }
+    ++version.o_deleted_rows;
+    for (uint32_t line = version.first_line[row]; line != NO_ROW; line = version.next_line[line]) {
+        version.l_deleted_rows += mark_deleted(version.l.l_deleted, version.l.l_deleted_zones, line);
+    }
+    return true;
+}
+
+uint64_t
+refresh_delete(refresh_store_t *store, const type_key *orderkeys, uint64_t num_keys) {
+    lock_exclusive(store);
+    refresh_version_t &version = *store->version;
+    uint64_t deleted = 0;
+    for (uint64_t i = 0; i < num_keys; ++i) {
+        const uint32_t row = find_order(version, orderkeys[i]);
+        if (row != NO_ROW) {
+            deleted += delete_order(version, row);
+        }
+    }
+    unlock_exclusive(store);
+    return deleted;
+}
+
+/**
+ * Applies the deletes since a snapshot of a delete bitmap of rows rows to the merged table, whose rows are the live
+ * rows of the snapshot
+ */
+static uint64_t
+catch_up_deletes(const uint64_t *deleted, const std::vector<uint64_t> &snapshot, uint64_t rows,
+                 const std::vector<uint32_t> &live_before, uint64_t *merged_deleted, uint32_t *merged_zone_deletes) {
+    uint64_t caught_up = 0;
+    for (uint64_t word = 0; word * 64 < rows; ++word) {
+        const uint64_t rows_of_word = std::min<uint64_t>(64, rows - word * 64);
+        uint64_t added = deleted[word] & ~snapshot[word];
+        if (rows_of_word < 64) {
+            added &= (uint64_t{1} << rows_of_word) - 1;
+        }
+        for (; added != 0; added &= added - 1) {
+            const uint64_t bit = __builtin_ctzll(added);
+            const uint64_t live_below = ~snapshot[word] & ((uint64_t{1} << bit) - 1);
+            caught_up += mark_deleted(merged_deleted, merged_zone_deletes,
+                                      live_before[word] + __builtin_popcountll(live_below));
+        }
+    }
+    return caught_up;
+}
+
+bool
+refresh_merge(refresh_store_t *store, int nthreads) {
+    pthread_mutex_lock(&store->mutex);
+    if (store->merging) {
+        pthread_mutex_unlock(&store->mutex);
+        return false;
+    }
+    store->merging = true;
+    pthread_mutex_unlock(&store->mutex);
+
+    // Snapshot of the rows and deletes. Until this merge is done, the version is only replaced by this merge, and
+    // refreshes only append rows and set bits, so its rows up to the snapshot stay as they are.
+    lock_shared(store);
+    refresh_version_t *version = store->version;
+    OrdersTable o = version->o;
+    LineItemTable l = version->l;
+    std::vector<uint64_t> o_deleted(o.o_deleted, o.o_deleted + bitmap_words(o.numTuples));
+    std::vector<uint64_t> l_deleted(l.l_deleted, l.l_deleted + bitmap_words(l.numTuples));
+    const uint64_t delta_orders = std::max(store->delta_orders, version->o_capacity - o.numTuples);
+    const uint64_t delta_lines = std::max(store->delta_orders * MAX_LINES_PER_ORDER, version->l_capacity - l.numTuples);
+    unlock_shared(store);
+
+    const uint64_t start = rdtscp_s();
+    const auto o_live_before = live_before_words(o_deleted.data(), o.numTuples, nthreads);
+    const auto l_live_before = live_before_words(l_deleted.data(), l.numTuples, nthreads);
+    refresh_version_t *merged = build_version(o, l, o_deleted.data(), l_deleted.data(), o_live_before, l_live_before,
+                                              delta_orders, delta_lines, nthreads);
+    const uint64_t built = rdtscp_s();
+
+    lock_exclusive(store);
+    // waiting for the running queries to release the version is not part of the install
+    const uint64_t locked = rdtscp_s();
+    // the refreshes since the snapshot
+    for (uint64_t row = o.numTuples; row < version->o.numTuples; ++row) {
+        append_order(*merged, version->o, row);
+        if (row_deleted(version->o.o_deleted, row)) {
+            merged->o_deleted_rows += mark_deleted(merged->o.o_deleted, merged->o.o_deleted_zones,
+                                                   merged->o.numTuples - 1);
+        }
+    }
+    for (uint64_t row = l.numTuples; row < version->l.numTuples; ++row) {
+        append_line(*merged, version->l, row);
+        if (row_deleted(version->l.l_deleted, row)) {
+            merged->l_deleted_rows += mark_deleted(merged->l.l_deleted, merged->l.l_deleted_zones,
+                                                   merged->l.numTuples - 1);
+        }
+    }
+    merged->o_deleted_rows += catch_up_deletes(version->o.o_deleted, o_deleted, o.numTuples, o_live_before,
+                                               merged->o.o_deleted, merged->o.o_deleted_zones);
+    merged->l_deleted_rows += catch_up_deletes(version->l.l_deleted, l_deleted, l.numTuples, l_live_before,
+                                               merged->l.l_deleted, merged->l.l_deleted_zones);
+    store->version = merged;
+    ++store->merges;
+    store->merge_cycles = built - start;
+    store->wait_cycles = locked - built;
+    store->install_cycles = rdtscp_s() - locked;
+    logger(INFO, "Merged %lu orders and %lu lineitems into %lu and %lu in %lu cycles, installed in %lu cycles after "
+                 "waiting %lu cycles for the queries", o.numTuples, l.numTuples, merged->o_main, merged->l_main,
+           store->merge_cycles, store->install_cycles, store->wait_cycles);
+    unlock_exclusive(store);
+    free_version(version);
+
+    pthread_mutex_lock(&store->mutex);
+    store->merging = false;
+    pthread_cond_broadcast(&store->changed);
+    pthread_mutex_unlock(&store->mutex);
+    return true;
+}
+
+void
+refresh_store_acquire(refresh_store_t *store, OrdersTable *o, LineItemTable *l) {
+    lock_shared(store);
+    const refresh_version_t &version = *store->version;
+    *o = version.o;
+    *l = version.l;
+    if (version.o_deleted_rows == 0) {
+        o->o_deleted = nullptr;
+        o->o_deleted_zones = nullptr;
+    }
+    if (version.l_deleted_rows == 0) {
+        l->l_deleted = nullptr;
+        l->l_deleted_zones = nullptr;
+    }
+}
+
+void
+refresh_store_release(refresh_store_t *store) {
+    unlock_shared(store);
+}
+
+void
+refresh_store_stats(refresh_store_t *store, refresh_stats_t *stats) {
+    lock_shared(store);
+    const refresh_version_t &version = *store->version;
+    stats->orders_main = version.o_main;
+    stats->orders_delta = version.o.numTuples - version.o_main;
+    stats->orders_deleted = version.o_deleted_rows;
+    stats->lineitems_main = version.l_main;
+    stats->lineitems_delta = version.l.numTuples - version.l_main;
+    stats->lineitems_deleted = version.l_deleted_rows;
+    stats->merges = store->merges;
+    stats->forced_merges = store->forced_merges;
+    stats->merge_cycles = store->merge_cycles;
+    stats->install_cycles = store->install_cycles;
+    stats->wait_cycles = store->wait_cycles;
+    unlock_shared(store);
+}
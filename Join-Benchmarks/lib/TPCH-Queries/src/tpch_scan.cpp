@@ -0,0 +1,164 @@
+#include "Q1Predicates.hpp"
+#include "Q6Predicates.hpp"
+#include "time_print.hpp"
+
+#include "Logger.hpp"
+#include "WorkerPool.hpp"
+#include "rdtscpWrapper.h"
+#include "tpch.hpp"
+#include <vector>
+
+/*
+ * The scan-bound TPC-H queries. Both read lineitem once and do not join, the filters are fused with the aggregation
+ * into one pass over every morsel, so the whole query time is accounted as aggregation. Both compute on the decimal
+ * columns if lineitem has them and on the float columns otherwise.
+ */
+
+/** Sums the Q1 groups of lineitem into groups, Group is Q1Group or Q1DecimalGroup */
+template<typename Group>
+static void
+q1_groups(const LineItemTable *l, int nthreads, Group *groups) {
+    struct alignas(64) ThreadGroups {
+        Group groups[Q1_GROUPS];
+    };
+    std::vector<ThreadGroups> thread_groups(nthreads);
+    WorkerPool::global().for_each_morsel(nthreads, l->numTuples, MORSEL_TUPLES,
+                                         [&](int thread_id, uint64_t begin, uint64_t end) {
+#ifndef SIMD
+        q1_aggregate_lineitem(*l, begin, end, thread_groups[thread_id].groups);
+#else
+        q1_aggregate_lineitem_simd(*l, begin, end, thread_groups[thread_id].groups);
+#endif
+    });
+    for (const auto &thread: thread_groups) {
+        for (int g = 0; g < Q1_GROUPS; ++g) {
+            groups[g] += thread.groups[g];
+        }
+    }
+}
+
+static void
+log_q1_group(int g, const Q1Group &group) {
+    const auto count = static_cast<double>(group.count);
+    logger(INFO,
+           "l_returnflag=%c l_linestatus=%c sum_qty=%.2lf sum_base_price=%.2lf sum_disc_price=%.2lf "
+           "sum_charge=%.2lf avg_qty=%.2lf avg_price=%.2lf avg_disc=%.4lf count_order=%lu",
+           Q1_RETURNFLAGS[g / 2], Q1_LINESTATUS[g % 2], group.sum_qty, group.sum_base_price, group.sum_disc_price,
+           group.sum_charge, group.sum_qty / count, group.sum_base_price / count, group.sum_disc / count,
+           group.count);
+}
+
+static void
+log_q1_group(int g, const Q1DecimalGroup &group) {
+    const auto count = static_cast<double>(group.count);
+    char sum_qty[DECIMAL_CHARS], sum_base_price[DECIMAL_CHARS], sum_disc_price[DECIMAL_CHARS];
+    char sum_charge[DECIMAL_CHARS];
+    logger(INFO,
+           "l_returnflag=%c l_linestatus=%c sum_qty=%s sum_base_price=%s sum_disc_price=%s sum_charge=%s "
+           "avg_qty=%.2lf avg_price=%.2lf avg_disc=%.4lf count_order=%lu",
+           Q1_RETURNFLAGS[g / 2], Q1_LINESTATUS[g % 2], format_decimal(sum_qty, group.sum_qty, DECIMAL_SCALE),
+           format_decimal(sum_base_price, group.sum_base_price, DECIMAL_SCALE),
+           format_decimal(sum_disc_price, group.sum_disc_price, 2 * DECIMAL_SCALE),
+           format_decimal(sum_charge, group.sum_charge, 3 * DECIMAL_SCALE),
+           decimal_to_double(group.sum_qty, DECIMAL_SCALE) / count,
+           decimal_to_double(group.sum_base_price, DECIMAL_SCALE) / count,
+           decimal_to_double(group.sum_disc, DECIMAL_SCALE) / count, group.count);
+}
+
+/** Sums the Q6 revenue of lineitem into revenue, Revenue is Q6Revenue or Q6DecimalRevenue */
+template<typename Revenue>
+static void
+q6_total_revenue(const LineItemTable *l, int nthreads, Revenue &revenue) {
+    struct alignas(64) ThreadRevenue {
+        Revenue revenue;
+    };
+    std::vector<ThreadRevenue> thread_revenue(nthreads);
+    WorkerPool::global().for_each_morsel(nthreads, l->numTuples, MORSEL_TUPLES,
+                                         [&](int thread_id, uint64_t begin, uint64_t end) {
+#ifndef SIMD
+        q6_revenue(*l, begin, end, thread_revenue[thread_id].revenue);
+#else
+        q6_revenue_simd(*l, begin, end, thread_revenue[thread_id].revenue);
+#endif
+    });
+    for (const auto &thread: thread_revenue) {
+        revenue.revenue += thread.revenue.revenue;
+        revenue.matches += thread.revenue.matches;
+    }
+}
+
+void
+tpch_q1(result_t *result, const LineItemTable *l, joinconfig_t *config) {
+    logger(INFO, "%s", __FUNCTION__);
+    logger(INFO, "LineItemTable size: %u", l->numTuples);
+    const int nthreads = config->NTHREADS;
+    TPCHTimers t{};
+    auto timer_start = rdtscp_s();
+
+    const bool decimal = q1_has_decimals(*l);
+    Q1Group groups[Q1_GROUPS]{};
+    Q1DecimalGroup decimal_groups[Q1_GROUPS]{};
+    if (decimal) {
+        q1_groups(l, nthreads, decimal_groups);
+    } else {
+        q1_groups(l, nthreads, groups);
+    }
+    auto timerEnd = rdtscp_s();
+    t.aggregation = timerEnd - timer_start;
+
+    uint64_t matches = 0;
+    for (int g = 0; g < Q1_GROUPS; ++g) {
+        const uint64_t count = decimal ? decimal_groups[g].count : groups[g].count;
+        if (count == 0) {
+            continue;
+        }
+        if (decimal) {
+            log_q1_group(g, decimal_groups[g]);
+        } else {
+            log_q1_group(g, groups[g]);
+        }
+        matches += count;
+    }
+
+    uint64_t numTuples = l->numTuples;
+    t.total = timerEnd - timer_start;
+    print_query_results(timers_to_us(t), numTuples);
+    result->totalresults = static_cast<int64_t>(matches);
+    result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
+}
+
+void
+tpch_q6(result_t *result, const LineItemTable *l, joinconfig_t *config) {
+    logger(INFO, "%s", __FUNCTION__);
+    logger(INFO, "LineItemTable size: %u", l->numTuples);
+    const int nthreads = config->NTHREADS;
+    TPCHTimers t{};
+    auto timer_start = rdtscp_s();
+
+    const bool decimal = q6_has_decimals(*l);
+    uint64_t matches;
+    Q6Revenue revenue{};
+    Q6DecimalRevenue decimal_revenue{};
+    if (decimal) {
+        q6_total_revenue(l, nthreads, decimal_revenue);
+        matches = decimal_revenue.matches;
+    } else {
+        q6_total_revenue(l, nthreads, revenue);
+        matches = revenue.matches;
+    }
+    auto timerEnd = rdtscp_s();
+    t.aggregation = timerEnd - timer_start;
+    if (decimal) {
+        char formatted[DECIMAL_CHARS];
+        logger(INFO, "revenue=%s of %lu lineitems",
+               format_decimal(formatted, decimal_revenue.revenue, 2 * DECIMAL_SCALE), matches);
+    } else {
+        logger(INFO, "revenue=%.2lf of %lu lineitems", revenue.revenue, matches);
+    }
+
+    uint64_t numTuples = l->numTuples;
+    t.total = timerEnd - timer_start;
+    print_query_results(timers_to_us(t), numTuples);
+    result->totalresults = static_cast<int64_t>(matches);
+    result->throughput = static_cast<double>(numTuples) / static_cast<double>(t.total);
+}